@@ -9,7 +9,7 @@
 #include "stm32f1xx_gpio.h"
 
 void delay (void){
-	for(uint32_t i=0; i<500000; i++);
+	SysTick_DelayMs(500); // Sleeps in WFI between the SysTick ticks
 }
 
 int main (void){
@@ -20,6 +20,7 @@ int main (void){
 	gpioLED.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_10;
 	//gpioLED.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_PP;
 
+	SysTick_Init(); // Time base of delay()
 	GPIO_PeriClkCtrl(GPIOC,ENABLE); // Clock enable
 	GPIO_Init(&gpioLED); // GPIO Initialization
 
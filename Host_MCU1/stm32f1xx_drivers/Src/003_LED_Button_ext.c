@@ -9,13 +9,15 @@
 #include "stm32f1xx_gpio.h"
 
 void delay (void){
-	for(uint32_t i=0; i<500000/2; i++);
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
 }
 
 int main (void){
 
 	GPIO_Handle_t gpioLED, gpioBtn; // Variable for the GPIO Handle
 
+	SysTick_Init(); // Time base of delay()
+
 	// GPIO Button Configuration
 	gpioBtn.pGPIOx = GPIOA; // Initialize variable and select port
 	gpioBtn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
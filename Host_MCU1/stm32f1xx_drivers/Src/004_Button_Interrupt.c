@@ -10,7 +10,7 @@
 #include "stm32f1xx_gpio.h"
 
 void delay (void){
-	for(uint32_t i=0; i<500000/2; i++);
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
 }
 
 int main (void){
@@ -19,6 +19,8 @@ int main (void){
 	memset(&gpioLED, 0, sizeof(gpioLED)); // Set value to 0
 	memset(&gpioBtn, 0, sizeof(gpioBtn)); // Set value to 0
 
+	SysTick_Init(); // Time base of delay()
+
 	// GPIO Button Configuration
 	gpioBtn.pGPIOx = GPIOA; // Initialize variable and select port
 	gpioBtn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
@@ -17,8 +17,10 @@
  * Alternate function: default
  */
 
+#define ARDUINO_SPI_MAX_SCLK	1000000U // The Arduino sketch handles one byte per SPI interrupt
+
 void delay (void){
-	for(uint32_t i=0; i<500000/2; i++);
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
 }
 
 void SPI_GPIOInits (void){
@@ -57,7 +59,7 @@ void SPI1_Inits(void){
 	SPI1Handle.pSPIx = SPI1;
 	SPI1Handle.SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD ;
 	SPI1Handle.SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
-	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_SCLK_SPEED_DIV_8;
+	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_CalcBaudRate(SPI1, ARDUINO_SPI_MAX_SCLK, NULL); // 1 MHz at any PCLK2
 	SPI1Handle.SPI_Config.SPI_DFF = SPI_DFF_8BITS;
 	SPI1Handle.SPI_Config.SPI_CPOL = SPI_CPOL_LOW;
 	SPI1Handle.SPI_Config.SPI_CPHA = SPI_CPHA_LOW;
@@ -82,6 +84,8 @@ int main (void){
 
 	char user_data[] = "Hello Word";
 
+	SysTick_Init(); // Time base of delay()
+
 	GPIO_ButtonInit();
 
 	SPI_GPIOInits(); // Function to initialize the GPIO pins to behave as SPI1
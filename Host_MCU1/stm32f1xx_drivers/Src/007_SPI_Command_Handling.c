@@ -38,10 +38,12 @@
 // Arduino LED
 #define LED_PIN				13
 
+#define ARDUINO_SPI_MAX_SCLK	1000000U // The Arduino sketch handles one byte per SPI interrupt
+
 /*                                     FUNCTIONS                                          */
 
 void delay (void){
-	for(uint32_t i=0; i<500000/2; i++);
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
 }
 
 void SPI_GPIOInits (void){
@@ -80,7 +82,7 @@ void SPI1_Inits(void){
 	SPI1Handle.pSPIx = SPI1;
 	SPI1Handle.SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD ;
 	SPI1Handle.SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
-	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_SCLK_SPEED_DIV_8;
+	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_CalcBaudRate(SPI1, ARDUINO_SPI_MAX_SCLK, NULL); // 1 MHz at any PCLK2
 	SPI1Handle.SPI_Config.SPI_DFF = SPI_DFF_8BITS;
 	SPI1Handle.SPI_Config.SPI_CPOL = SPI_CPOL_LOW;
 	SPI1Handle.SPI_Config.SPI_CPHA = SPI_CPHA_LOW;
@@ -112,31 +114,31 @@ uint8_t SPI_VerifyResponse (uint8_t ackbyte){
 	}
 }
 
-/*** Send command #1 CMD LED CTRL. You have to send pin number and value ***/
-void CMD_LED_CTRL (uint8_t commandcode){
-
-	SPI_SendData(SPI1, &commandcode, 1);
+/*** Sends the command code and returns the response from the slave (ACK or NACK) ***/
+uint8_t SPI_SendCommand (uint8_t commandcode){
 
-	// Read the dummy to clear off RXNE
+	// The byte received with the command is a dummy. It also clears off RXNE
 	uint8_t dummyread;
-	SPI_ReceiveData(SPI1, &dummyread, 1);
-
-	// Send some dummy byte to fetch the response from the slave (ACK or NACK)
-	uint8_t dummywrite = 0xff;
-	SPI_SendData(SPI1, &dummywrite, 1);
+	SPI_TransferData(SPI1, &commandcode, &dummyread, 1);
 
-	// Read the response from the slave
+	// Send some dummy byte (NULL = 0xFF) to fetch the response from the slave
 	uint8_t ackbyte;
-	SPI_ReceiveData(SPI1, &ackbyte, 1);
+	SPI_TransferData(SPI1, NULL, &ackbyte, 1);
+
+	return ackbyte;
+}
+
+/*** Send command #1 CMD LED CTRL. You have to send pin number and value ***/
+void CMD_LED_CTRL (uint8_t commandcode){
 
 	// Array of arguments
 	uint8_t args[2]; // args[0] = Pin number, args[1] = Value
 
-	if (SPI_VerifyResponse(ackbyte)){
-		// Send arguments pin number and value
+	if (SPI_VerifyResponse(SPI_SendCommand(commandcode))){
+		// Send arguments pin number and value. The received bytes are dummies
 		args[0] = LED_PIN;
 		args[1] = LED_ON;
-		SPI_SendData(SPI1, args, 2);
+		SPI_TransferData(SPI1, args, NULL, 2);
 		printf("Control LED executed\n");
 	}
 }
@@ -144,40 +146,20 @@ void CMD_LED_CTRL (uint8_t commandcode){
 /*** Send command #2 CMD SENSOR READ. You have to send analog pin number ***/
 void CMD_SENSOR(uint8_t commandcode){
 
-	SPI_SendData(SPI1, &commandcode, 1);
-
-	// Read the dummy to clear off RXNE
-	uint8_t dummyread;
-	SPI_ReceiveData(SPI1, &dummyread, 1);
-
-	// Send some dummy byte to fetch the response from the slave (ACK or NACK)
-	uint8_t dummywrite = 0xff;
-	SPI_SendData(SPI1, &dummywrite, 1);
-
-	// Read the response from the slave
-	uint8_t ackbyte;
-	SPI_ReceiveData(SPI1, &ackbyte, 1);
-
 	// Array of arguments
 	uint8_t args[1]; // args[0] = Analog pin number
 
-	if (SPI_VerifyResponse(ackbyte)){
-		// Send arguments pin number and value
+	if (SPI_VerifyResponse(SPI_SendCommand(commandcode))){
+		// Send arguments pin number
 		args[0] = ANALOG_PIN0;
-		SPI_SendData(SPI1, args, 1);
-
-		// Read RNXE again
-		SPI_ReceiveData(SPI1, &dummyread, 1);
+		SPI_TransferData(SPI1, args, NULL, 1);
 
 		// Some delay so the sensor has time to read
 		delay();
 
-		// Send dummy byte to fetch the response
-		SPI_SendData(SPI1, &dummywrite, 1);
-
-		// Read the value of the sensor
+		// Send dummy byte to fetch the value of the sensor
 		uint8_t analog_read;
-		SPI_ReceiveData(SPI1, &analog_read, 1);
+		SPI_TransferData(SPI1, NULL, &analog_read, 1);
 		printf("Value read: %d\n", analog_read);
 		printf("Sensor read executed\n");
 	}
@@ -185,37 +167,20 @@ void CMD_SENSOR(uint8_t commandcode){
 
 void CMD_LED_READ(uint8_t commandcode){
 
-	SPI_SendData(SPI1,&commandcode, 1);
-
-	uint8_t dummyread;
-	SPI_ReceiveData(SPI1, &dummyread, 1);
-
-	uint8_t dummywrite = 0xff;
-	SPI_SendData(SPI1, &dummywrite, 1);
-
-	uint8_t ackbyte;
-	SPI_ReceiveData(SPI1, &ackbyte, 1);
-
 	// Array of arguments
 	uint8_t args[1]; // args[0] = Digital pin number
 
-	if (SPI_VerifyResponse(ackbyte)){
-		// Send arguments pin number and value
+	if (SPI_VerifyResponse(SPI_SendCommand(commandcode))){
+		// Send arguments pin number
 		args[0] = LED_PIN;
-		SPI_SendData(SPI1, args, 1);
+		SPI_TransferData(SPI1, args, NULL, 1);
 
-		// Read RNXE again
-		SPI_ReceiveData(SPI1, &dummyread, 1);
-
-		// Some delay so the sensor has time to read
+		// Some delay so the slave has time to read
 		delay();
 
-		// Send dummy byte to fetch the response
-		SPI_SendData(SPI1, &dummywrite, 1);
-
-		// Read the value of the sensor
+		// Send dummy byte to fetch the status of the LED
 		uint8_t led_status;
-		SPI_ReceiveData(SPI1, &led_status,1);
+		SPI_TransferData(SPI1, NULL, &led_status, 1);
 		printf("Value read: %d\n", led_status);
 		printf("Sensor LED executed\n");
 	}
@@ -224,60 +189,32 @@ void CMD_LED_READ(uint8_t commandcode){
 
 void CMD_PRINT (uint8_t commandcode){
 
-	SPI_SendData(SPI1,&commandcode, 1);
-
-	uint8_t dummyread;
-	SPI_ReceiveData(SPI1, &dummyread, 1);
-
-	uint8_t dummywrite = 0xff;
-	SPI_SendData(SPI1, &dummywrite, 1);
-
-	uint8_t ackbyte;
-	SPI_ReceiveData(SPI1, &ackbyte, 1);
-
 	uint8_t message[] = "Hello Word";
 	uint8_t args[1];
 
-	if (SPI_VerifyResponse(ackbyte)){
+	if (SPI_VerifyResponse(SPI_SendCommand(commandcode))){
 		args[0] = strlen((char*)message);
 
-		SPI_SendData(SPI1,args,1);
-
-		SPI_ReceiveData(SPI1,&dummyread,1);
+		SPI_TransferData(SPI1, args, NULL, 1);
 
 		delay();
 
-		for(int i = 0 ; i < args[0] ; i++){
-			SPI_SendData(SPI1,&message[i],1);
-			SPI_ReceiveData(SPI1,&dummyread,1);
-		}
+		// The whole message in one transfer
+		SPI_TransferData(SPI1, message, NULL, args[0]);
 		printf("Print executed\n");
 	}
 }
 
 void CMD_ID (uint8_t commandcode){
 
-	SPI_SendData(SPI1,&commandcode, 1);
-
-	uint8_t dummyread;
-	SPI_ReceiveData(SPI1, &dummyread, 1);
-
-	uint8_t dummywrite = 0xff;
-	SPI_SendData(SPI1, &dummywrite, 1);
-
-	uint8_t ackbyte;
-	SPI_ReceiveData(SPI1, &ackbyte, 1);
-
 	uint8_t id[11];
 
-	if(SPI_VerifyResponse(ackbyte)){
-		for (uint32_t i = 0; i<10; i++){
-			SPI_SendData(SPI1, &dummywrite, 1);
-			SPI_ReceiveData(SPI1, &id[i], 1);
-		}
+	if(SPI_VerifyResponse(SPI_SendCommand(commandcode))){
+		// 10 dummy bytes to fetch the ID
+		SPI_TransferData(SPI1, NULL, id, 10);
 		id[10] = '\0';
 
-		printf("ID: %d\n", id);
+		printf("ID: %s\n", id);
 		printf("Print ID executed\n");
 	}
 }
@@ -286,6 +223,8 @@ extern void initialise_monitor_handles(void);
 
 int main (void){
 
+	SysTick_Init(); // Time base of delay()
+
 	initialise_monitor_handles();
 
 	printf("It works!\n");
@@ -9,7 +9,8 @@
  *  - User enters a message using the Arduino serial port.
  *  - Arduino notifies the STM32 about message availability.
  *  - STM32 reads and prints the message.
- *  - Uses interrupts.
+ *  - Uses interrupts. The whole message is one full-duplex transfer (SPI_TransferData_Inter): the ISR
+ *    stores the bytes in a ring buffer and main() fetches them in batches, without a callback per byte.
  *
  */
 
@@ -21,21 +22,20 @@ SPI_Handle_t SPI1Handle;
 
 #define MAX_LEN 500
 
+#define RING_SIZE 64 // Power of 2
+
+#define ARDUINO_SPI_MAX_SCLK	1000000U // The Arduino sketch handles one byte per SPI interrupt
+
 char RcvBuff[MAX_LEN];
 
-volatile char ReadByte;
+uint8_t RxRingBuff[RING_SIZE];
+RingBuf_t RxRing;
 
 volatile uint8_t rcvStop = 0;
 
 /*This flag will be set in the interrupt handler of the Arduino interrupt GPIO */
 volatile uint8_t dataAvailable = 0;
 
-void delay(void)
-{
-	for(uint32_t i = 0 ; i < 500000/2 ; i ++);
-}
-
-
 void SPI_GPIOInits(void){
 
 	GPIO_Handle_t SPIPins;
@@ -68,11 +68,10 @@ void SPI_GPIOInits(void){
 
 void SPI_Inits(void){
 
-	SPI_Handle_t SPI1Handle;
 	SPI1Handle.pSPIx = SPI1;
 	SPI1Handle.SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD ;
 	SPI1Handle.SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
-	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_SCLK_SPEED_DIV_8;
+	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_CalcBaudRate(SPI1, ARDUINO_SPI_MAX_SCLK, NULL); // 1 MHz at any PCLK2
 	SPI1Handle.SPI_Config.SPI_DFF = SPI_DFF_8BITS;
 	SPI1Handle.SPI_Config.SPI_CPOL = SPI_CPOL_LOW;
 	SPI1Handle.SPI_Config.SPI_CPHA = SPI_CPHA_LOW;
@@ -109,7 +108,7 @@ int main(void){
 	initialise_monitor_handles();
 	printf("It works!\n");
 
-	uint8_t dummy = 0xff;
+	uint32_t i, n;
 
 	Slave_GPIO_InterruptPinInit(); // Initializes pin to deliver the interrupt
 	printf("Interrupt pin initialized\n");
@@ -130,6 +129,12 @@ int main(void){
 	*/
 	SPI_SSOEConfig(SPI1,ENABLE);
 
+	RingBuf_Init(&RxRing, RxRingBuff, RING_SIZE);
+	if (SPI_SetRxRing(&SPI1Handle, &RxRing) != SPI_OK){
+		printf("RING_SIZE must be a power of 2\n");
+		while (1);
+	}
+
 	SPI_IRQConfig(IRQ_NO_SPI1,ENABLE); // Enable interrupts for SPI
 
 	while(1){
@@ -145,18 +150,33 @@ int main(void){
 		SPI_PeripheralControl(SPI1,ENABLE);
 
 
+		// Dummy bytes (NULL = 0xFF) clock the message out of the slave. The ISR stores it in RxRing
+		SPI_TransferData_Inter(&SPI1Handle, NULL, MAX_LEN);
+
+		// Fetch the bytes in batches until '\0' arrives
+		i = 0;
 		while(!rcvStop)
 		{
-			/* fetch the data from the SPI peripheral byte by byte in interrupt mode */
-			while (SPI_SendData_Inter(&SPI1Handle, &dummy, 1) == SPI_BUSY_IN_TX);
-			// While the device is sending data (Busy in Tx, the program is going to stay in this loop
-			while (SPI_ReceiveData_Inter(&SPI1Handle, &ReadByte, 1) == SPI_BUSY_IN_RX);
-			/* - While the device is receiving data (Busy in Rx, the program is going to stay in this loop
-			   - The data is read byte by byte
-			   - When the functions completes execution, the program executes SPI1_IRQHandler
-			*/
+			n = SPI_RxRingRead(&SPI1Handle, (uint8_t*)&RcvBuff[i], MAX_LEN - i);
+			for (; n > 0; n--, i++){
+				if (RcvBuff[i] == '\0'){
+					rcvStop = 1;
+				}
+			}
+			if (i == MAX_LEN){
+				RcvBuff[MAX_LEN - 1] = '\0';
+				rcvStop = 1;
+			}
+#ifdef STM32F1_HOST_SIM
+			SIM_IRQPoll(); // This loop does not access any register
+#endif
 		}
 
+		// The rest of the bytes are not needed
+		SPI_IRQConfig(IRQ_NO_SPI1,DISABLE);
+		SPI_CloseTransfer(&SPI1Handle);
+		RingBuf_Flush(&RxRing); // The bytes after '\0' are not needed
+		SPI_IRQConfig(IRQ_NO_SPI1,ENABLE);
 
 		// confirm SPI is not busy
 		while( SPI_GetFlagStatus(SPI1,SPI_BUSY_FLAG) );
@@ -164,6 +184,9 @@ int main(void){
 		//Disable the SPI2 peripheral
 		SPI_PeripheralControl(SPI1,DISABLE);
 
+		// A frame that was still in flight is left in DR
+		SPI_ClearOVRFlag(SPI1);
+
 		printf("Rcvd data = %s\n",RcvBuff);
 
 		dataAvailable = 0;
@@ -182,22 +205,6 @@ void SPI1_IRQHandler(void)
 	SPI_IRQHandling(&SPI1Handle);
 }
 
-void SPI_ApplicationEventCallback(SPI_Handle_t *pSPIHandle,uint8_t AppEv)
-{
-	static uint32_t i = 0;
-	/* In the RX complete event , copy data in to rcv buffer . '\0' indicates end of message(rcvStop = 1) */
-	if(AppEv == SPI_EVENT_RX_COMPLETE)
-	{
-				RcvBuff[i++] = ReadByte;
-				if(ReadByte == '\0' || ( i == MAX_LEN)){ // Receives data until it encounter \0 or the length of data is max
-					rcvStop = 1;
-					RcvBuff[i-1] = '\0';
-					i = 0;
-				}
-	}
-
-}
-
 /* Slave data available interrupt handler */
 void EXTI9_5_IRQHandler(void)
 {
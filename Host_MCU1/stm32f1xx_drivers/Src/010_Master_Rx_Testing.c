@@ -16,7 +16,7 @@ I2C_Handle_t I2C1Handle;
 
 void delay(void)
 {
-	for(uint32_t i = 0 ; i < 500000/2 ; i ++);
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
 }
 
 void I2C_GPIOInits(void){
@@ -64,6 +64,8 @@ extern void initialise_monitor_handles(void);
 
 int main (void){
 
+	SysTick_Init(); // Time base of delay()
+
 	initialise_monitor_handles();
 	printf("It works!\n");
 
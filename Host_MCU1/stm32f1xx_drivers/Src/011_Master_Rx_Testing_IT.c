@@ -10,15 +10,20 @@
 #include "stm32f103xx.h"
 
 #define SLAVE_ADDR	0x68
+#define DEBOUNCE_US		200000U
+#define LED_PERIOD_US	500000U
+
 uint8_t received_buff[32];
-uint8_t rxComp = RESET;
+uint8_t command_length = 0x51;
+uint8_t command_data = 0x52;
+uint8_t length;
 
 I2C_Handle_t I2C1Handle;
+I2C_Transaction_t SlaveBatch[2];
 
-void delay(void)
-{
-	for(uint32_t i = 0 ; i < 500000/2 ; i ++);
-}
+// The slave conversation and the LED share main() as coroutines (stm32f1xx_pt.h)
+PT_t SlavePt;
+PT_t LedPt;
 
 void I2C_GPIOInits(void){
 
@@ -61,6 +66,83 @@ void GPIO_ButtonInit(void){
 	GPIO_Init(&gpioBtn);
 }
 
+void GPIO_LEDInit(void){
+	GPIO_Handle_t gpioLED;
+
+	gpioLED.pGPIOx = GPIOC;
+	gpioLED.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_13;
+	gpioLED.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_2;
+	gpioLED.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_PP;
+
+	GPIO_Init(&gpioLED);
+}
+
+/* The command/length/payload sequence is one batch. The I2C interrupt chains its 4 phases with
+ * repeated STARTs, so the bus is never idle between them */
+void I2C_BatchInit(void){
+
+	// Master sends 0x51 to the slave so it knows it has to send length, and reads it
+	SlaveBatch[0].pTxBuffer = &command_length;
+	SlaveBatch[0].TxLen = 1;
+	SlaveBatch[0].pRxBuffer = &length;
+	SlaveBatch[0].RxLen = 1;
+	SlaveBatch[0].SlaveAddr = SLAVE_ADDR;
+	SlaveBatch[0].Flags = I2C_TR_SR;
+
+	// Master sends 0x52 to the slave so it knows it has to send data, and reads length bytes
+	SlaveBatch[1].pTxBuffer = &command_data;
+	SlaveBatch[1].TxLen = 1;
+	SlaveBatch[1].pRxBuffer = received_buff;
+	SlaveBatch[1].RxLen = sizeof(received_buff) - 1; // Room for the null character
+	SlaveBatch[1].SlaveAddr = SLAVE_ADDR;
+	SlaveBatch[1].Flags = I2C_TR_LEN_FROM_PREV;
+}
+
+/* Reads the data of the slave each time the button is pressed. The thread yields while the batch runs */
+PT_THREAD(Slave_Thread(PT_t *pt)){
+
+	// Locals are lost when the thread yields
+	static DWT_Timeout_t debounce;
+
+	PT_BEGIN(pt);
+
+	while (1){
+		// Wait till button is pressed
+		PT_WAIT_WHILE(pt, GPIO_ReadFromInputPin(GPIOA, GPIO_PIN_0));
+		DWT_TimeoutStart(&debounce, DEBOUNCE_US);
+		PT_WAIT_UNTIL(pt, DWT_TimeoutExpired(&debounce));
+
+		PT_WAIT_UNTIL(pt, I2C_QueueSubmit(&I2C1Handle, SlaveBatch, 2) == I2C_OK);
+		PT_WAIT_UNTIL(pt, SlaveBatch[1].Status != I2C_TR_PENDING);
+		if (SlaveBatch[1].Status != I2C_OK){
+			continue; // The error is printed by I2C_PrintEvent. Wait for the next press
+		}
+
+		received_buff[SlaveBatch[1].RxCount] = '\0'; //Buffer needs to be terminated with the null character so we are adding it
+
+		// Print data
+		printf("Data received: %s\n", received_buff);
+	}
+
+	PT_END(pt);
+}
+
+/* Blinks the LED. Keeps its period while the I2C transfers run */
+PT_THREAD(LED_Thread(PT_t *pt)){
+
+	static DWT_Timeout_t period;
+
+	PT_BEGIN(pt);
+
+	while (1){
+		GPIO_ToggleOutputPin(GPIOC, GPIO_PIN_13);
+		DWT_TimeoutStart(&period, LED_PERIOD_US);
+		PT_WAIT_UNTIL(pt, DWT_TimeoutExpired(&period));
+	}
+
+	PT_END(pt);
+}
+
 extern void initialise_monitor_handles(void);
 
 int main (void){
@@ -68,8 +150,11 @@ int main (void){
 	initialise_monitor_handles();
 	printf("It works!\n");
 
-	uint8_t command_code;
-	uint8_t length;
+	// The callback messages are printed by the deferred work (PendSV)
+	Defer_Init();
+
+	GPIO_ButtonInit();
+	GPIO_LEDInit();
 
 	// Initialize GPIOs a IC2 pins
 	I2C_GPIOInits();
@@ -87,38 +172,15 @@ int main (void){
 	// Enable acking after PE = 1
 	I2C_ManageAcking(I2C1, I2C_ACK_ENABLE);
 
-	while (1){
-		uint8_t button_value = GPIO_ReadFromInputPin(GPIOA, GPIO_PIN_0);
-
-		// Button pressed for the 1st time
-		while((button_value));
-		delay();
-
-		//Master sends 0x51 to the slave so it knows it has to send length
-		command_code = 0x51;
-		// Wait until the app sends
-		while (I2C_MasterReceiveDataIT(&I2C1Handle, &command_code, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
-
-		// Slave returns length of the data and master reads it
-		while (I2C_MasterReceiveDataIT(&I2C1Handle, &length, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
+	I2C_BatchInit();
 
-		//Master sends 0x52 to the slave so it knows it has to send data
-		command_code = 0x52;
-		while (I2C_MasterReceiveDataIT(&I2C1Handle, &command_code, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
-
-		// Slave sends data and masters receives it
-		while (I2C_MasterReceiveDataIT(&I2C1Handle, received_buff, length, SLAVE_ADDR, I2C_NO_SR) != I2C_READY);
-
-		rxComp = RESET; // Flag was set when master received the first byte
-
-		while (rxComp != SET);
-
-		received_buff[length+1] = '\0'; //Buffer needs to be terminated with the null character so we are adding it
-
-		// Print data
-		printf("Data received: %s", received_buff);
+	PT_INIT(&SlavePt);
+	PT_INIT(&LedPt);
 
-		rxComp = RESET;
+	// Each call runs a thread until it has to wait
+	while (1){
+		Slave_Thread(&SlavePt);
+		LED_Thread(&LedPt);
 	}
 }
 
@@ -132,51 +194,30 @@ void I2C1_ER_IRQHandler (void){
 	I2C_ER_IRQHandling(&I2C1Handle);
 }
 
-void I2C_ApplicationEventCallback (I2C_Handle_t *pI2CxHandle, uint8_t AppEv){
-
-	if (AppEv == I2C_EV_TX_COMPLETE){
-		printf("Tx is complete\n");
-	} else if (AppEv == I2C_EV_RX_COMPLETE){
-		printf("Rx is complete\n");
-		rxComp = SET;
-	} else if (AppEv == I2C_ERROR_AF){
-		printf("Acknowledgment failure\n");
+/* Runs in PendSV, after the I2C interrupts: a semihosting printf takes milliseconds */
+void I2C_PrintEvent(void *pContext, uint32_t AppEv){
 
-		// Close communication
-		I2C_CloseSendData(pI2CxHandle);
-		//Generate stop condition
-		I2C_GenerateStopCondition(I2C1);
-		// Hang in infinite loop
-		while (1);
+	(void)pContext; // No context posted
 
+	if (AppEv == I2C_ERROR_AF){
+		printf("Acknowledgment failure\n");
 	} else if (AppEv == I2C_ERROR_BERR){
 		printf("Bus error\n");
-
-		// Close communication
-		I2C_CloseSendData(pI2CxHandle);
-		//Generate stop condition
-		I2C_GenerateStopCondition(I2C1);
-		// Hang in infinite loop
-		while (1);
-
-	}else if (AppEv == I2C_ERROR_OVR){
+	} else if (AppEv == I2C_ERROR_ARLO){
+		printf("Arbitration lost\n");
+	} else if (AppEv == I2C_ERROR_OVR){
 		printf("Overrun or underrun error\n");
-
-		// Close communication
-		I2C_CloseSendData(pI2CxHandle);
-		//Generate stop condition
-		I2C_GenerateStopCondition(I2C1);
-		// Hang in infinite loop
-		while (1);
-
 	} else if (AppEv == I2C_ERROR_TIMEOUT){
 		printf("Timeout error\n");
+	} else if (AppEv == I2C_ERROR_BUS_STUCK){
+		printf("Bus stuck\n");
+	}
+}
+
+// The transactions that fail are closed by the I2C queue. Only the messages are left
+void I2C_ApplicationEventCallback (I2C_Handle_t *pI2CxHandle, uint8_t AppEv){
 
-		// Close communication
-		I2C_CloseSendData(pI2CxHandle);
-		//Generate stop condition
-		I2C_GenerateStopCondition(I2C1);
-		// Hang in infinite loop
-		while (1);
+	if (AppEv >= I2C_ERROR_BERR){
+		Defer_Post(I2C_PrintEvent, pI2CxHandle, AppEv);
 	}
 }
@@ -14,11 +14,6 @@ uint8_t tx_buff[32] = "Hellooo";
 
 I2C_Handle_t I2C1Handle;
 
-void delay(void)
-{
-	for(uint32_t i = 0 ; i < 500000/2 ; i ++);
-}
-
 void I2C_GPIOInits(void){
 
 	GPIO_Handle_t I2CPins;
@@ -0,0 +1,193 @@
+/*
+ * 013_SPI_DMA_Rx.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Same as 008_SPI_Interrupts.c but the message is read with DMA
+ *  - Arduino notifies the STM32 about message availability.
+ *  - STM32 reads the whole buffer (MAX_LEN bytes) with SPI_TransferDMA at SPI_SCLK_SPEED_DIV_2.
+ *  - The CPU is free while the SPI bus runs. It only counts loops until the DMA callback arrives.
+ *  - STM32 prints the message (up to the first '\0').
+ *
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include "stm32f103xx.h"
+
+SPI_Handle_t SPI1Handle;
+
+#define MAX_LEN 500
+
+uint8_t RcvBuff[MAX_LEN];
+
+volatile uint8_t rcvStop = 0;
+
+/*This flag will be set in the interrupt handler of the Arduino interrupt GPIO */
+volatile uint8_t dataAvailable = 0;
+
+void SPI_GPIOInits(void){
+
+	GPIO_Handle_t SPIPins;
+	SPIPins.pGPIOx = GPIOA;
+
+	// NSS -- Not used in this case
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 1;
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Floating Input
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_4;
+	GPIO_Init(&SPIPins);
+
+	// SCLK
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz for SPI_SCLK_SPEED_DIV_2
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_5;
+	GPIO_Init(&SPIPins);
+
+	// MISO
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 0; // Input
+	SPIPins.GPIO_PinConfig.GPIO_Config = 1; // Floating input
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&SPIPins);
+
+	//MOSI
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz for SPI_SCLK_SPEED_DIV_2
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&SPIPins);
+}
+
+void SPI_Inits(void){
+
+	SPI1Handle.pSPIx = SPI1;
+	SPI1Handle.SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD ;
+	SPI1Handle.SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
+	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_SCLK_SPEED_DIV_2;
+	SPI1Handle.SPI_Config.SPI_DFF = SPI_DFF_8BITS;
+	SPI1Handle.SPI_Config.SPI_CPOL = SPI_CPOL_LOW;
+	SPI1Handle.SPI_Config.SPI_CPHA = SPI_CPHA_LOW;
+	SPI1Handle.SPI_Config.SPI_SSM = SPI_SSM_DI;
+
+	SPI_Init(&SPI1Handle);
+}
+
+/*This function configures the gpio pin over which SPI peripheral issues data available interrupt */
+void Slave_GPIO_InterruptPinInit(void){
+
+	GPIO_Handle_t SPI_Inter_Pin; // Variable for the GPIO Handle
+	memset(&SPI_Inter_Pin, 0, sizeof(SPI_Inter_Pin)); // Set value to 0
+
+	SPI_Inter_Pin.pGPIOx = GPIOA; // Initialize variable and select port
+	SPI_Inter_Pin.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_9;
+	SPI_Inter_Pin.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN ;
+	SPI_Inter_Pin.GPIO_PinConfig.GPIO_Config = GPIO_IN_TYPE_PP;
+	GPIO_PeriClkCtrl(GPIOA,ENABLE);
+	GPIO_Init(&SPI_Inter_Pin);
+
+	// Button interrupt configuration
+	GPIO_InterHandler(&SPI_Inter_Pin, INTER_FALLING_EDGE); //Trigger Interrupt in the falling edge
+
+	GPIO_IRQPriority(IRQ_NO_EXTI9_5, NVIC_PRIO_15);
+	GPIO_IRQConfig(IRQ_NO_EXTI9_5, ENABLE);
+}
+
+extern void initialise_monitor_handles(void);
+
+int main(void){
+
+	uint32_t cpu_loops;
+
+	initialise_monitor_handles();
+	printf("It works!\n");
+
+	// The callback messages are printed by the deferred work (PendSV)
+	Defer_Init();
+
+	Slave_GPIO_InterruptPinInit(); // Initializes pin to deliver the interrupt
+
+	SPI_GPIOInits();
+
+	SPI_Inits();
+
+	SPI_SSOEConfig(SPI1,ENABLE);
+
+	// SPI1_RX is served by DMA1 channel 2 and SPI1_TX by DMA1 channel 3
+	DMA_IRQConfig(IRQ_NO_DMA1_CH2, ENABLE);
+	DMA_IRQConfig(IRQ_NO_DMA1_CH3, ENABLE);
+
+	while(1){
+
+		rcvStop = 0;
+
+		while(!dataAvailable); //wait till data available interrupt from transmitter device(slave)
+
+		GPIO_IRQConfig(IRQ_NO_EXTI9_5,DISABLE); // Interrupts are disable while the communication happens
+
+		//enable the SPI1 peripheral
+		SPI_PeripheralControl(SPI1,ENABLE);
+
+		// Rx only: the Tx channel clocks out 0xFF
+		SPI_TransferDMA(&SPI1Handle, NULL, RcvBuff, MAX_LEN);
+
+		// The CPU is free here. Count how much work could have been done
+		cpu_loops = 0;
+		while(!rcvStop){
+			cpu_loops++;
+#ifdef STM32F1_HOST_SIM
+			SIM_IRQPoll(); // This loop does not access any register
+#endif
+		}
+
+		// confirm SPI is not busy
+		while( SPI_GetFlagStatus(SPI1,SPI_BUSY_FLAG) );
+
+		//Disable the SPI1 peripheral
+		SPI_PeripheralControl(SPI1,DISABLE);
+
+		RcvBuff[MAX_LEN - 1] = '\0';
+		printf("Rcvd data = %s\n",RcvBuff);
+		printf("CPU loops during the transfer = %lu\n", (unsigned long)cpu_loops);
+
+		dataAvailable = 0;
+
+		GPIO_IRQConfig(IRQ_NO_EXTI9_5,ENABLE);
+	}
+
+	return 0;
+}
+
+/* Slave data available interrupt handler */
+void EXTI9_5_IRQHandler(void){
+
+	GPIO_IRQHandling(GPIO_PIN_9);
+	dataAvailable = 1;
+}
+
+/* SPI1_RX DMA channel */
+void DMA1_Channel2_IRQHandler(void){
+
+	SPI_DMA_IRQHandling(&SPI1Handle);
+}
+
+/* SPI1_TX DMA channel. Only transfer errors are enabled */
+void DMA1_Channel3_IRQHandler(void){
+
+	SPI_DMA_IRQHandling(&SPI1Handle);
+}
+
+/* Runs in PendSV, after the DMA interrupts: a semihosting printf takes milliseconds */
+void SPI_PrintError(void *pContext, uint32_t AppEv){
+
+	printf("DMA transfer error\n");
+}
+
+void SPI_ApplicationEventCallback(SPI_Handle_t *pSPIHandle,uint8_t AppEv){
+
+	if (AppEv == SPI_EVENT_DMA_COMPLETE){
+		rcvStop = 1;
+	} else if (AppEv == SPI_EVENT_DMA_ERROR){
+		Defer_Post(SPI_PrintError, pSPIHandle, AppEv);
+		rcvStop = 1;
+	}
+}
@@ -0,0 +1,213 @@
+/*
+ * 014_Master_Rx_Testing_DMA.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Same as 011_Master_Rx_Testing_IT.c but the bytes are moved by DMA1
+ *  - Master sends 0x51 and reads the length of the message (1 byte).
+ *  - Master sends 0x52 and reads the message (length bytes).
+ *  - Each transaction takes the SB and ADDR interrupts plus one DMA interrupt, instead of one
+ *    interrupt per byte.
+ *  - 72 MHz clock tree (PCLK1 = 36 MHz). The I2C timing is solved and checked at build time.
+ *
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include "stm32f103xx.h"
+
+#define SLAVE_ADDR	0x68
+#define I2C_PCLK1	36000000U	// PCLK1 after RCC_SetSysClk72MHz
+
+// CCR/TRISE/FREQ calculated by the compiler. The build fails if SCL is more than 1 % slower than 100 kHz
+static const I2C_Timing_t I2C1Timing = I2C_TIMING(I2C_PCLK1, I2C_CLK_SPEED_SM, I2C_FM_DUTYCLYCLE_2);
+I2C_TIMING_ASSERT(I2C_PCLK1, I2C_CLK_SPEED_SM, I2C_FM_DUTYCLYCLE_2, 10000);
+uint8_t received_buff[32];
+volatile uint8_t txComp = RESET;
+volatile uint8_t rxComp = RESET;
+
+I2C_Handle_t I2C1Handle;
+
+void delay(void)
+{
+	SysTick_DelayMs(250); // Sleeps in WFI between the SysTick ticks
+}
+
+void I2C_GPIOInits(void){
+
+	GPIO_Handle_t I2CPins;
+	I2CPins.pGPIOx = GPIOB;
+
+	// SCL -> B6
+	I2CPins.GPIO_PinConfig.GPIO_PinMode = 1; // Speed = 10 MHz
+	I2CPins.GPIO_PinConfig.GPIO_Config = 3; // Alternate function Open Drain
+	I2CPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&I2CPins);
+
+	// SDA -> B7
+	I2CPins.GPIO_PinConfig.GPIO_PinMode = 1; // Speed = 10 MHz
+	I2CPins.GPIO_PinConfig.GPIO_Config = 3; // Alternate function Open Drain
+	I2CPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&I2CPins);
+}
+
+void I2C_Inits(void){
+
+	I2C1Handle.pI2Cx= I2C1;
+	I2C1Handle.I2C_Config.I2C_ACKControl = I2C_ACK_ENABLE;
+	I2C1Handle.I2C_Config.I2C_DeviceAddress = 0x61; // This doesn't matter in this application bc MCU is acting like master
+	I2C1Handle.I2C_Config.I2C_FMDutyCycle = I2C_FM_DUTYCLYCLE_2; // Not used
+	I2C1Handle.I2C_Config.I2C_SCLSpeed = I2C_CLK_SPEED_SM; // Standard mode
+	I2C1Handle.I2C_Config.pI2C_Timing = &I2C1Timing; // Written as it is: PCLK1 matches
+
+	I2C_Init(&I2C1Handle);
+}
+
+void GPIO_ButtonInit(void){
+	GPIO_Handle_t gpioBtn; // Variable for the GPIO Handle
+
+	// GPIO Button Configuration
+	gpioBtn.pGPIOx = GPIOA; // Initialize variable and select port
+	gpioBtn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_0;
+	gpioBtn.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN ;
+	gpioBtn.GPIO_PinConfig.GPIO_Config = GPIO_IN_TYPE_PP;
+
+	GPIO_Init(&gpioBtn);
+}
+
+extern void initialise_monitor_handles(void);
+
+int main (void){
+
+	RCC_SetSysClk72MHz();
+	SysTick_Init(); // Time base of delay()
+
+	initialise_monitor_handles();
+	printf("It works!\n");
+
+	// The callback messages are printed by the deferred work (PendSV)
+	Defer_Init();
+
+	uint8_t command_code;
+	uint8_t length;
+
+	GPIO_ButtonInit();
+
+	// Initialize GPIOs a IC2 pins
+	I2C_GPIOInits();
+
+	// Configure I2C
+	I2C_Inits();
+
+	// IRQ Config for events and errors
+	I2C_IRQConfig(IRQ_NO_I2C1_EV, ENABLE);
+	I2C_IRQConfig(IRQ_NO_I2C1_ER, ENABLE);
+
+	// I2C1_TX is served by DMA1 channel 6 and I2C1_RX by DMA1 channel 7
+	DMA_IRQConfig(IRQ_NO_DMA1_CH6, ENABLE);
+	DMA_IRQConfig(IRQ_NO_DMA1_CH7, ENABLE);
+
+	// Enable I2C peripheral
+	I2C_PeripheralControl(I2C1, ENABLE);
+
+	// Enable acking after PE = 1
+	I2C_ManageAcking(I2C1, I2C_ACK_ENABLE);
+
+	while (1){
+
+		// Wait till button is pressed
+		while(GPIO_ReadFromInputPin(GPIOA, GPIO_PIN_0));
+		delay();
+
+		//Master sends 0x51 to the slave so it knows it has to send length
+		command_code = 0x51;
+		txComp = RESET;
+		while (I2C_MasterSendDataDMA(&I2C1Handle, &command_code, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
+		while (txComp != SET);
+
+		// Slave returns length of the data and master reads it
+		rxComp = RESET;
+		while (I2C_MasterReceiveDataDMA(&I2C1Handle, &length, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
+		while (rxComp != SET);
+
+		if (length >= sizeof(received_buff)){
+			length = sizeof(received_buff) - 1;
+		}
+
+		//Master sends 0x52 to the slave so it knows it has to send data
+		command_code = 0x52;
+		txComp = RESET;
+		while (I2C_MasterSendDataDMA(&I2C1Handle, &command_code, 1, SLAVE_ADDR, I2C_SR) != I2C_READY);
+		while (txComp != SET);
+
+		// Slave sends data and masters receives it
+		rxComp = RESET;
+		while (I2C_MasterReceiveDataDMA(&I2C1Handle, received_buff, length, SLAVE_ADDR, I2C_NO_SR) != I2C_READY);
+		while (rxComp != SET);
+
+		received_buff[length] = '\0'; //Buffer needs to be terminated with the null character so we are adding it
+
+		// Print data
+		printf("Data received: %s\n", received_buff);
+	}
+}
+
+// Whenever an event happens, this function will be called
+void I2C1_EV_IRQHandler (void){
+	I2C_EV_IRQHandling(&I2C1Handle);
+}
+
+// Whenever an error happens, this function will be called
+void I2C1_ER_IRQHandler (void){
+	I2C_ER_IRQHandling(&I2C1Handle);
+}
+
+/* I2C1_TX DMA channel */
+void DMA1_Channel6_IRQHandler(void){
+	I2C_DMA_IRQHandling(&I2C1Handle);
+}
+
+/* I2C1_RX DMA channel */
+void DMA1_Channel7_IRQHandler(void){
+	I2C_DMA_IRQHandling(&I2C1Handle);
+}
+
+/* Runs in PendSV, after the I2C interrupts: a semihosting printf takes milliseconds */
+void I2C_PrintEvent(void *pContext, uint32_t AppEv){
+
+	if (AppEv == I2C_ERROR_DMA){
+		printf("DMA transfer error\n");
+		while (1); // Hang in infinite loop
+	} else if (AppEv == I2C_ERROR_AF){
+		printf("Acknowledgment failure\n");
+		while (1); // Hang in infinite loop
+	} else if (AppEv == I2C_ERROR_BERR){
+		printf("Bus error\n");
+		while (1); // Hang in infinite loop
+	} else if (AppEv == I2C_ERROR_OVR){
+		printf("Overrun or underrun error\n");
+		while (1); // Hang in infinite loop
+	} else if (AppEv == I2C_ERROR_TIMEOUT){
+		printf("Timeout error\n");
+		while (1); // Hang in infinite loop
+	}
+}
+
+void I2C_ApplicationEventCallback (I2C_Handle_t *pI2CxHandle, uint8_t AppEv){
+
+	if (AppEv == I2C_EV_TX_COMPLETE){
+		txComp = SET;
+	} else if (AppEv == I2C_EV_RX_COMPLETE){
+		rxComp = SET;
+	} else if ((AppEv == I2C_ERROR_AF) || (AppEv == I2C_ERROR_BERR) || (AppEv == I2C_ERROR_OVR) || (AppEv == I2C_ERROR_TIMEOUT)){
+		// Close communication
+		I2C_CloseSendData(pI2CxHandle);
+		//Generate stop condition
+		I2C_GenerateStopCondition(I2C1);
+	}
+
+	// Only the register work is done here. The messages are printed outside the interrupt
+	Defer_Post(I2C_PrintEvent, pI2CxHandle, AppEv);
+}
@@ -0,0 +1,109 @@
+/*
+ * 015_SPI_Bus_Devices.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Two slaves with different modes on SPI1, managed by the SPI bus manager (stm32f1xx_spibus.h)
+ *  - Flash (mode 0, 8 bits, up to 18 MHz). CS -> PA4. The JEDEC ID is read with command 0x9F.
+ *  - ADC (mode 3, 16 bits, up to 1 MHz). CS -> PB0. One frame returns one sample.
+ *  - Every 500 ms both devices are read and the values printed. The switch between them only
+ *    writes the CR1 bits that differ and the chip select.
+ *
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include "stm32f1xx_spibus.h"
+
+#define FLASH_CMD_JEDEC_ID	0x9F
+#define PERIOD_US			500000U
+
+SPI_Handle_t SPI1Handle;
+SPIBus_t SPI1Bus;
+SPIBus_Device_t Flash;
+SPIBus_Device_t ADC;
+
+void SPI_GPIOInits(void){
+
+	GPIO_Handle_t SPIPins;
+	SPIPins.pGPIOx = GPIOA;
+
+	// SCLK
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_5;
+	GPIO_Init(&SPIPins);
+
+	// MISO
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 0; // Input
+	SPIPins.GPIO_PinConfig.GPIO_Config = 1; // Floating input
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&SPIPins);
+
+	//MOSI
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&SPIPins);
+
+	// The chip selects are configured by SPIBus_AddDevice
+}
+
+void SPI_BusInits(void){
+
+	SPIBus_DeviceConfig_t device;
+
+	SPI1Handle.pSPIx = SPI1;
+	SPIBus_Init(&SPI1Bus, &SPI1Handle);
+
+	// Flash
+	device.SPI_CPOL = SPI_CPOL_LOW;
+	device.SPI_CPHA = SPI_CPHA_LOW;
+	device.SPI_DFF = SPI_DFF_8BITS;
+	device.MaxSCLK_Hz = 18000000U;
+	device.pCSPort = GPIOA;
+	device.CSPin = GPIO_PIN_4;
+	printf("Flash SCK: %lu Hz\n", (unsigned long)SPIBus_AddDevice(&SPI1Bus, &Flash, &device));
+
+	// ADC
+	device.SPI_CPOL = SPI_CPOL_HIGH;
+	device.SPI_CPHA = SPI_CPHA_HIGH;
+	device.SPI_DFF = SPI_DFF_16BITS;
+	device.MaxSCLK_Hz = 1000000U;
+	device.pCSPort = GPIOB;
+	device.CSPin = GPIO_PIN_0;
+	printf("ADC SCK: %lu Hz\n", (unsigned long)SPIBus_AddDevice(&SPI1Bus, &ADC, &device));
+}
+
+extern void initialise_monitor_handles(void);
+
+int main (void){
+
+	uint8_t flash_tx[4] = {FLASH_CMD_JEDEC_ID, 0, 0, 0};
+	uint8_t flash_rx[4];
+	uint16_t adc_sample;
+
+	initialise_monitor_handles();
+	printf("It works!\n");
+
+	SPI_GPIOInits();
+	SPI_BusInits();
+
+	while (1){
+		// Flash: command and 3 ID bytes (manufacturer, type, capacity)
+		SPIBus_Select(&SPI1Bus, &Flash);
+		SPI_TransferData(SPI1, flash_tx, flash_rx, sizeof(flash_tx));
+		SPIBus_Deselect(&SPI1Bus);
+
+		// ADC: one 16-bit frame
+		SPIBus_Select(&SPI1Bus, &ADC);
+		SPI_TransferData(SPI1, NULL, (uint8_t*)&adc_sample, sizeof(adc_sample));
+		SPIBus_Deselect(&SPI1Bus);
+
+		printf("Flash ID: %02X %02X %02X  ADC: %u\n", flash_rx[1], flash_rx[2], flash_rx[3], adc_sample);
+
+		DWT_DelayUs(PERIOD_US);
+	}
+}
@@ -0,0 +1,145 @@
+/*
+ * 016_USART_DMA_Echo.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Frames of any length received on USART2 are sent back, at 2 Mbaud (72 MHz clock tree, PCLK1 = 36 MHz)
+ *  - USART2: TX -> PA2, RX -> PA3. 8 bits, no parity, 1 stop bit.
+ *  - Reception: circular DMA. A frame ends when the line goes idle, and it is copied to the echo buffer
+ *    from USART_RxDataCallback.
+ *  - Transmission: the echo is sent with USART_SendDMA from main().
+ *
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include "stm32f103xx.h"
+
+#define USART_BAUD			2000000U
+#define RX_RING_SIZE		256		// 1.28 ms of data at 2 Mbaud between two deliveries (half buffer)
+#define FRAME_MAX			512
+
+USART_Handle_t USART2Handle;
+uint8_t RxRing[RX_RING_SIZE];
+uint8_t Frame[FRAME_MAX];
+uint8_t Echo[FRAME_MAX];
+volatile uint32_t FrameLen;
+volatile uint8_t FrameReady;
+volatile uint32_t Errors;
+
+void USART2_GPIOInits(void){
+
+	GPIO_Handle_t USARTPins;
+	USARTPins.pGPIOx = GPIOA;
+
+	// TX
+	USARTPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz
+	USARTPins.GPIO_PinConfig.GPIO_Config = 2; // Alternate Push Pull
+	USARTPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_2;
+	GPIO_Init(&USARTPins);
+
+	// RX
+	USARTPins.GPIO_PinConfig.GPIO_PinMode = 0; // Input
+	USARTPins.GPIO_PinConfig.GPIO_Config = 1; // Floating input
+	USARTPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_3;
+	GPIO_Init(&USARTPins);
+}
+
+void USART2_Inits(void){
+
+	uint32_t baud;
+
+	USART2Handle.pUSARTx = USART2;
+	USART2Handle.USART_Config.USART_Baud = USART_BAUD;
+	USART2Handle.USART_Config.USART_Mode = USART_MODE_TXRX;
+	USART2Handle.USART_Config.USART_WordLength = USART_WORDLEN_8BITS;
+	USART2Handle.USART_Config.USART_StopBits = USART_STOPBITS_1;
+	USART2Handle.USART_Config.USART_Parity = USART_PARITY_NONE;
+	USART2Handle.USART_Config.USART_HWFlowControl = USART_HW_FLOW_CTRL_NONE;
+	USART_Init(&USART2Handle);
+
+	USART_CalcBRR(USART2, USART_BAUD, &baud);
+	printf("USART2: %lu baud\n", (unsigned long)baud);
+
+	// Same priority for the USART and the Rx channel: both deliver from the same position
+	USART_IRQPriority(IRQ_NO_USART2, NVIC_PRIO_2);
+	USART_IRQPriority(IRQ_NO_DMA1_CH6, NVIC_PRIO_2);
+	USART_IRQPriority(IRQ_NO_DMA1_CH7, NVIC_PRIO_3);
+	USART_IRQConfig(IRQ_NO_USART2, ENABLE);
+	USART_IRQConfig(IRQ_NO_DMA1_CH6, ENABLE);
+	USART_IRQConfig(IRQ_NO_DMA1_CH7, ENABLE);
+}
+
+extern void initialise_monitor_handles(void);
+
+int main (void){
+
+	initialise_monitor_handles();
+	printf("It works!\n");
+
+	RCC_SetSysClk72MHz();
+
+	USART2_GPIOInits();
+	USART2_Inits();
+
+	USART_StartRxDMA(&USART2Handle, RxRing, sizeof(RxRing));
+
+	while (1){
+		if (!FrameReady){
+			continue;
+		}
+
+		// Copy the frame so the next one can be received during the echo
+		uint32_t len = FrameLen;
+		memcpy(Echo, Frame, len);
+		FrameLen = 0;
+		FrameReady = 0;
+
+		while (USART_SendDMA(&USART2Handle, Echo, len) == USART_BUSY_IN_TX);
+	}
+}
+
+void USART2_IRQHandler(void){
+
+	USART_IRQHandling(&USART2Handle);
+}
+
+void DMA1_Channel6_IRQHandler(void){
+
+	USART_DMA_IRQHandling(&USART2Handle);
+}
+
+void DMA1_Channel7_IRQHandler(void){
+
+	USART_DMA_IRQHandling(&USART2Handle);
+}
+
+void USART_RxDataCallback (USART_Handle_t *pUSARTHandle, const uint8_t *pData, uint16_t len, uint8_t FrameEnd){
+
+	static uint8_t dropping;
+
+	// A frame that starts before main() took the previous one is dropped up to its end
+	if (FrameReady || dropping){
+		dropping = !FrameEnd;
+		return;
+	}
+
+	if (FrameLen + len > FRAME_MAX){
+		len = FRAME_MAX - FrameLen;
+	}
+	memcpy(&Frame[FrameLen], pData, len);
+	FrameLen += len;
+
+	if (FrameEnd && (FrameLen != 0)){
+		FrameReady = 1;
+	}
+}
+
+void USART_ApplicationEventCallback (USART_Handle_t *pUSARTHandle, uint8_t AppEv){
+
+	if (AppEv != USART_EVENT_TX_COMPLETE){
+		Errors++;
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * 017_Binary_Log.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Logs the presses of a button without printf (72 MHz clock tree)
+ *  - Button on PA0 (falling edge interrupt). The ISR logs the press count and the cycles taken by its
+ *    own previous log site.
+ *  - The records go out on ITM port 1 (SWO, PB3 at ITM_SWO_BAUD) from the idle loop. Capture the SWO
+ *    stream with the debugger, then on the PC:
+ *      Tools/log_decode.py --itm 1 Debug/stm32f1xx_drivers.elf swo.bin
+ *  - No printf: the format strings are not in the flash (log_fmt section) and nothing is formatted
+ *    on the board.
+ *
+ */
+
+#include "stm32f103xx.h"
+
+volatile uint32_t Presses;
+volatile uint32_t LogCycles;
+
+void Button_GPIOInits(void){
+
+	GPIO_Handle_t gpioBtn;
+	gpioBtn.pGPIOx = GPIOA;
+	gpioBtn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_0;
+	gpioBtn.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN;
+	gpioBtn.GPIO_PinConfig.GPIO_Config = GPIO_IN_TYPE_PP;
+
+	GPIO_PeriClkCtrl(GPIOA, ENABLE);
+	GPIO_Init(&gpioBtn);
+	GPIO_InterHandler(&gpioBtn, INTER_FALLING_EDGE);
+
+	GPIO_IRQPriority(IRQ_NO_EXTI0, NVIC_PRIO_15);
+	GPIO_IRQConfig(IRQ_NO_EXTI0, ENABLE);
+}
+
+int main (void){
+
+	LOG_Stats_t stats;
+	uint32_t swo, dropped = 0;
+
+	RCC_SetSysClk72MHz();
+	swo = ITM_Init(ITM_SWO_BAUD);
+
+	LOG_Init(LOG_OutputITM, NULL);
+	LOG("Binary log started, HCLK %lu Hz, SWO %lu Hz", RCC_GetHCLKValue(), swo);
+
+	Button_GPIOInits();
+
+	while (1){
+		// Idle loop: the records are sent while nothing else runs
+		if (LOG_Process() == 0){
+			LOG_GetStats(&stats);
+			if (stats.Dropped != dropped){
+				dropped = stats.Dropped;
+				LOG("%lu records dropped (ring high water %lu words)", dropped, stats.MaxWords);
+			}
+		}
+	}
+}
+
+void EXTI0_IRQHandler (void){
+
+	uint32_t start;
+
+	GPIO_IRQHandling(GPIO_PIN_0);
+	Presses++;
+
+	start = DWT_GetCycles();
+	LOG("Button press %lu, last log site %lu cycles", Presses, LogCycles);
+	LogCycles = DWT_GetCycles() - start;
+}
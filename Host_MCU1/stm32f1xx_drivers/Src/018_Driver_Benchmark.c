@@ -0,0 +1,369 @@
+/*
+ * 018_Driver_Benchmark.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Measures the cost of the driver APIs with the DWT cycle counter (72 MHz clock tree)
+ *  - Each API runs BENCH_RUNS times. The table gives the min/mean/max cycles of one call, without the
+ *    cost of the measurement itself, and the bytes per second of the data transfers.
+ *  - SPI1 master at 18 MHz: SCLK -> PA5, MISO -> PA6, MOSI -> PA7. Connect PA7 to PA6 (loopback) for
+ *    SPI_TransferData: the received bytes are checked.
+ *  - I2C1 master at 100 kHz: SCL -> PB6, SDA -> PB7. A slave must answer at BENCH_I2C_ADDR (the
+ *    Arduino of apps 009-012). Calls that fail are counted in the "fail" column.
+ *  - ISR: EXTI1 is triggered by software (SWIER). The time is from the trigger to the return of
+ *    the handler.
+ *  - The same file runs in the host simulator. There the cycles follow the host time; the register
+ *    accesses per call ("regs" column) are exact and do not change between runs: compare them to find
+ *    regressions.
+ *
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include "stm32f103xx.h"
+
+#define BENCH_RUNS			100
+#define BENCH_SPI_LEN		16
+#define BENCH_I2C_LEN		8
+#define BENCH_I2C_ADDR		0x68
+
+// One benchmarked API
+typedef struct{
+	const char *Name;
+	void (*pSetup)(void);		// Runs before each call, not measured. Can be NULL
+	uint8_t (*pFunc)(void);		// Measured call. Returns 0 when it failed
+	uint32_t Bytes;				// Bytes moved by one call. 0 = no throughput
+}Bench_t;
+
+// Results of one API
+typedef struct{
+	uint32_t Min;
+	uint32_t Max;
+	uint64_t Total;
+	uint32_t Fails;
+	uint64_t Regs;				// Register accesses (host simulator only)
+}Bench_Result_t;
+
+SPI_Handle_t SPI1Handle;
+I2C_Handle_t I2C1Handle;
+GPIO_Handle_t gpioOut;
+RingBuf_t Ring;
+uint8_t RingMem[64];
+uint8_t SPITx[BENCH_SPI_LEN];
+uint8_t SPIRx[BENCH_SPI_LEN];
+uint8_t I2CTx[BENCH_I2C_LEN];
+volatile uint8_t ISRDone;
+uint32_t Overhead;				// Cycles of the measurement itself
+uint32_t RegOverhead;			// Register accesses of the measurement itself (CYCCNT reads)
+
+/* 					Benchmarked calls 								*/
+
+uint8_t Bench_Empty(void){
+	return 1;
+}
+
+uint8_t Bench_GPIO_Init(void){
+	GPIO_Init(&gpioOut);
+	return 1;
+}
+
+uint8_t Bench_GPIO_Write(void){
+	GPIO_WriteToOutputPin(GPIOA, GPIO_PIN_8, 1);
+	return 1;
+}
+
+uint8_t Bench_GPIO_Toggle(void){
+	GPIO_ToggleOutputPin(GPIOA, GPIO_PIN_8);
+	return 1;
+}
+
+uint8_t Bench_GPIO_Read(void){
+	return GPIO_ReadFromInputPin(GPIOA, GPIO_PIN_1) | 1;
+}
+
+uint8_t Bench_SPI_Send(void){
+	SPI_SendData(SPI1, SPITx, BENCH_SPI_LEN);
+	return 1;
+}
+
+void Bench_SPI_Clear(void){
+	memset(SPIRx, 0, sizeof(SPIRx));
+	// SPI_SendData does not read DR: drop the last byte received and the overrun (DR then SR read)
+	(void)SPI1->DR;
+	(void)SPI1->SR;
+}
+
+uint8_t Bench_SPI_Transfer(void){
+	SPI_TransferData(SPI1, SPITx, SPIRx, BENCH_SPI_LEN);
+	return memcmp(SPITx, SPIRx, BENCH_SPI_LEN) == 0;
+}
+
+uint8_t Bench_I2C_Send(void){
+	return I2C_MasterSendData(&I2C1Handle, I2CTx, BENCH_I2C_LEN, BENCH_I2C_ADDR, I2C_NO_SR) == I2C_OK;
+}
+
+uint8_t Bench_USART_BRR(void){
+	return USART_CalcBRR(USART2, 115200, NULL) != 0;
+}
+
+uint8_t Bench_RingBuf(void){
+	uint8_t data;
+	RingBuf_Put(&Ring, 0x55);
+	return RingBuf_Get(&Ring, &data);
+}
+
+uint32_t Bench_LOG_Discard(void *pContext, const uint8_t *pData, uint32_t len){
+	return len;
+}
+
+void Bench_LOG_Drain(void){
+	LOG_Process();
+}
+
+uint8_t Bench_LOG(void){
+	LOG("bench %u %u", 1u, 2u);
+	return 1;
+}
+
+uint8_t Bench_ISR(void){
+	ISRDone = 0;
+	EXTI->SWIER = (1 << GPIO_PIN_1);
+	while (!ISRDone){
+#ifdef STM32F1_HOST_SIM
+		SIM_IRQPoll(); // This loop does not access any register
+#endif
+	}
+	return 1;
+}
+
+const Bench_t Benches[] = {
+	{"GPIO_Init",				NULL,				Bench_GPIO_Init,		0},
+	{"GPIO_WriteToOutputPin",	NULL,				Bench_GPIO_Write,		0},
+	{"GPIO_ToggleOutputPin",	NULL,				Bench_GPIO_Toggle,		0},
+	{"GPIO_ReadFromInputPin",	NULL,				Bench_GPIO_Read,		0},
+	{"SPI_SendData",			NULL,				Bench_SPI_Send,			BENCH_SPI_LEN},
+	{"SPI_TransferData",		Bench_SPI_Clear,	Bench_SPI_Transfer,		BENCH_SPI_LEN},
+	{"I2C_MasterSendData",		NULL,				Bench_I2C_Send,			BENCH_I2C_LEN},
+	{"USART_CalcBRR",			NULL,				Bench_USART_BRR,		0},
+	{"RingBuf_Put+Get",			NULL,				Bench_RingBuf,			0},
+	{"LOG (2 arguments)",		Bench_LOG_Drain,	Bench_LOG,				0},
+	{"EXTI ISR (SWIER)",		NULL,				Bench_ISR,				0},
+};
+
+/* 					Measurement 									*/
+
+// Sum of the register reads and writes done so far (host simulator only)
+uint64_t Bench_RegAccesses(void){
+#ifdef STM32F1_HOST_SIM
+	SIM_Stats_t stats;
+	SIM_GetStats(&stats);
+	return stats.RegReads + stats.RegWrites;
+#else
+	return 0;
+#endif
+}
+
+// Cycles of one call, without the measurement overhead
+uint32_t Bench_Measure(uint8_t (*pFunc)(void), uint8_t *pOk){
+	uint32_t start, cycles;
+
+	start = DWT_GetCycles();
+	*pOk = pFunc();
+	cycles = DWT_GetCycles() - start;
+
+	return (cycles > Overhead) ? cycles - Overhead : 0;
+}
+
+void Bench_Run(const Bench_t *pBench, Bench_Result_t *pResult){
+	uint32_t cycles;
+	uint64_t regs;
+	uint8_t ok;
+
+	pResult->Min = 0xFFFFFFFFU;
+	pResult->Max = 0;
+	pResult->Total = 0;
+	pResult->Fails = 0;
+	pResult->Regs = 0;
+
+	for (uint32_t i = 0; i < BENCH_RUNS; i++){
+		if (pBench->pSetup){
+			pBench->pSetup();
+		}
+		regs = Bench_RegAccesses();
+		cycles = Bench_Measure(pBench->pFunc, &ok);
+		pResult->Regs += Bench_RegAccesses() - regs;
+
+		if (!ok){
+			pResult->Fails++;
+		}
+		if (cycles < pResult->Min){
+			pResult->Min = cycles;
+		}
+		if (cycles > pResult->Max){
+			pResult->Max = cycles;
+		}
+		pResult->Total += cycles;
+	}
+}
+
+void Bench_Print(const Bench_t *pBench, const Bench_Result_t *pResult){
+	uint32_t mean = (uint32_t)(pResult->Total / BENCH_RUNS);
+	uint64_t regs = pResult->Regs / BENCH_RUNS - RegOverhead;
+	char rate[24] = "-";
+
+	if (pBench->Bytes && mean){
+		snprintf(rate, sizeof(rate), "%lu", (unsigned long)((uint64_t)pBench->Bytes * RCC_GetHCLKValue() / mean));
+	}
+	printf("%-24s %8lu %8lu %8lu %10s %5lu %6lu\n", pBench->Name, (unsigned long)pResult->Min, (unsigned long)mean,
+			(unsigned long)pResult->Max, rate, (unsigned long)pResult->Fails, (unsigned long)regs);
+}
+
+/* 					Peripheral setup 								*/
+
+void Bench_GPIOInits(void){
+
+	GPIO_Handle_t gpioIn;
+
+	// Output pin used by the GPIO calls
+	gpioOut.pGPIOx = GPIOA;
+	gpioOut.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_8;
+	gpioOut.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_10;
+	gpioOut.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_PP;
+	GPIO_PeriClkCtrl(GPIOA, ENABLE);
+	GPIO_Init(&gpioOut);
+
+	// Input pin, also the EXTI line triggered by software
+	gpioIn.pGPIOx = GPIOA;
+	gpioIn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_1;
+	gpioIn.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN;
+	gpioIn.GPIO_PinConfig.GPIO_Config = GPIO_IN_TYPE_PP;
+	GPIO_Init(&gpioIn);
+	GPIO_InterHandler(&gpioIn, INTER_FALLING_EDGE);
+	GPIO_IRQPriority(IRQ_NO_EXTI1, NVIC_PRIO_15);
+	GPIO_IRQConfig(IRQ_NO_EXTI1, ENABLE);
+}
+
+void Bench_SPIInits(void){
+
+	GPIO_Handle_t SPIPins;
+	SPIPins.pGPIOx = GPIOA;
+
+	// SCLK
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_5;
+	GPIO_Init(&SPIPins);
+
+	// MISO
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 0; // Input
+	SPIPins.GPIO_PinConfig.GPIO_Config = 1; // Floating input
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_Init(&SPIPins);
+
+	//MOSI
+	SPIPins.GPIO_PinConfig.GPIO_PinMode = 3; // Speed = 50 MHz
+	SPIPins.GPIO_PinConfig.GPIO_Config = 2; // Master Alternate Push Pull
+	SPIPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&SPIPins);
+
+	SPI1Handle.pSPIx = SPI1;
+	SPI1Handle.SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD;
+	SPI1Handle.SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
+	SPI1Handle.SPI_Config.SPI_SCLKSpeed = SPI_SCLK_SPEED_DIV_4; // PCLK2 72 MHz / 4
+	SPI1Handle.SPI_Config.SPI_DFF = SPI_DFF_8BITS;
+	SPI1Handle.SPI_Config.SPI_CPOL = SPI_CPOL_LOW;
+	SPI1Handle.SPI_Config.SPI_CPHA = SPI_CPHA_LOW;
+	SPI1Handle.SPI_Config.SPI_SSM = SPI_SSM_DI;
+	SPI_Init(&SPI1Handle);
+
+	SPI_SSOEConfig(SPI1, ENABLE);
+	SPI_PeripheralControl(SPI1, ENABLE);
+}
+
+void Bench_I2CInits(void){
+
+	GPIO_Handle_t I2CPins;
+	I2CPins.pGPIOx = GPIOB;
+
+	// SCL
+	I2CPins.GPIO_PinConfig.GPIO_PinMode = 1; // Speed = 10 MHz
+	I2CPins.GPIO_PinConfig.GPIO_Config = 3; // Alternate function Open Drain
+	I2CPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_6;
+	GPIO_PeriClkCtrl(GPIOB, ENABLE);
+	GPIO_Init(&I2CPins);
+
+	// SDA
+	I2CPins.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_7;
+	GPIO_Init(&I2CPins);
+
+	I2C1Handle.pI2Cx = I2C1;
+	I2C1Handle.I2C_Config.I2C_ACKControl = I2C_ACK_ENABLE;
+	I2C1Handle.I2C_Config.I2C_DeviceAddress = 0x61; // Not used: master
+	I2C1Handle.I2C_Config.I2C_FMDutyCycle = I2C_FM_DUTYCLYCLE_2; // Not used
+	I2C1Handle.I2C_Config.I2C_SCLSpeed = I2C_CLK_SPEED_SM;
+	I2C1Handle.I2C_Config.I2C_Timeout = 2000; // A missing slave fails in 2 ms
+	I2C_Init(&I2C1Handle);
+	I2C_PeripheralControl(I2C1, ENABLE);
+}
+
+#ifdef STM32F1_HOST_SIM
+// Simulated I2C slave: ACKs everything
+static uint8_t SimI2C_Start(void *pContext, uint8_t Read){ (void)pContext; (void)Read; return 1; }
+static uint8_t SimI2C_Write(void *pContext, uint8_t Data){ (void)pContext; (void)Data; return 1; }
+static const SIM_I2CDevice_t SimI2CSlave = {SimI2C_Start, SimI2C_Write, NULL, NULL};
+#endif
+
+extern void initialise_monitor_handles(void);
+
+int main (void){
+
+	const Bench_t empty = {"", NULL, Bench_Empty, 0};
+	Bench_Result_t result;
+
+	initialise_monitor_handles();
+	printf("It works!\n");
+
+	RCC_SetSysClk72MHz();
+	DWT_Init();
+
+#ifdef STM32F1_HOST_SIM
+	SIM_SPI_AttachDevice(SPI1, NULL, NULL); // MOSI looped to MISO
+	SIM_I2C_AttachDevice(I2C1, BENCH_I2C_ADDR, &SimI2CSlave, NULL);
+#endif
+
+	Bench_GPIOInits();
+	Bench_SPIInits();
+	Bench_I2CInits();
+	RingBuf_Init(&Ring, RingMem, sizeof(RingMem));
+	LOG_Init(Bench_LOG_Discard, NULL);
+	for (uint32_t i = 0; i < BENCH_SPI_LEN; i++){
+		SPITx[i] = (uint8_t)(0xA5 + i);
+	}
+
+	// Measurement overhead: the fastest empty call. Its register accesses are the CYCCNT reads
+	Bench_Run(&empty, &result);
+	Overhead = result.Min;
+	RegOverhead = result.Regs / BENCH_RUNS;
+	printf("HCLK %lu Hz, %u runs, overhead %lu cycles\n", (unsigned long)RCC_GetHCLKValue(), BENCH_RUNS, (unsigned long)Overhead);
+
+	printf("%-24s %8s %8s %8s %10s %5s %6s\n", "API", "min", "mean", "max", "bytes/s", "fail", "regs");
+	for (uint32_t i = 0; i < sizeof(Benches) / sizeof(Benches[0]); i++){
+		Bench_Run(&Benches[i], &result);
+		Bench_Print(&Benches[i], &result);
+	}
+
+	while (1);
+}
+
+void EXTI1_IRQHandler (void){
+
+	GPIO_IRQHandling(GPIO_PIN_1);
+	ISRDone = 1;
+}
+
+void I2C_ApplicationEventCallback (I2C_Handle_t *pI2CHandle, uint8_t AppEv){
+
+	// Blocking calls only: no events
+}
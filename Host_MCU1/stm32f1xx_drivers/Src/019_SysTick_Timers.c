@@ -0,0 +1,97 @@
+/*
+ * 019_SysTick_Timers.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ *
+ *  EXERCISE
+ *  Blinks the LED and debounces a button with SysTick software timers, sleeping in between (72 MHz clock tree)
+ *  - LED on PC13 toggled by a periodic 500 ms timer.
+ *  - Button on PA0 (falling edge interrupt). The ISR only starts a 20 ms one shot timer; the timer reads
+ *    the pin again and counts the press if it is still low.
+ *  - The idle loop prints the presses with their time in us, then calls SysTick_Idle: the core sleeps
+ *    until the next timer (tickless) instead of waking up every millisecond.
+ *
+ */
+
+#include<stdio.h>
+#include "stm32f103xx.h"
+
+#define BLINK_MS			500
+#define DEBOUNCE_MS			20
+
+SysTick_Timer_t BlinkTimer;
+SysTick_Timer_t DebounceTimer;
+volatile uint32_t Presses;
+volatile uint64_t PressTime;
+
+void LED_Button_GPIOInits(void){
+
+	GPIO_Handle_t gpioLED, gpioBtn;
+
+	gpioLED.pGPIOx = GPIOC;
+	gpioLED.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_13;
+	gpioLED.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_10;
+	gpioLED.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_PP;
+
+	gpioBtn.pGPIOx = GPIOA;
+	gpioBtn.GPIO_PinConfig.GPIO_PinNumber = GPIO_PIN_0;
+	gpioBtn.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN;
+	gpioBtn.GPIO_PinConfig.GPIO_Config = GPIO_IN_TYPE_PP;
+
+	GPIO_PeriClkCtrl(GPIOA, ENABLE);
+	GPIO_PeriClkCtrl(GPIOC, ENABLE);
+	GPIO_Init(&gpioLED);
+	GPIO_Init(&gpioBtn);
+	GPIO_InterHandler(&gpioBtn, INTER_FALLING_EDGE);
+
+	GPIO_IRQPriority(IRQ_NO_EXTI0, NVIC_PRIO_15);
+	GPIO_IRQConfig(IRQ_NO_EXTI0, ENABLE);
+}
+
+void Blink(void *pContext){
+
+	(void)pContext; // No context
+	GPIO_ToggleOutputPin(GPIOC, GPIO_PIN_13);
+}
+
+void Debounce(void *pContext){
+
+	(void)pContext; // No context
+	if (GPIO_ReadFromInputPin(GPIOA, GPIO_PIN_0) == GPIO_PIN_RESET){
+		PressTime = SysTick_GetTimeUs();
+		Presses++;
+	}
+}
+
+extern void initialise_monitor_handles(void);
+
+int main (void){
+
+	uint32_t printed = 0;
+
+	initialise_monitor_handles();
+
+	RCC_SetSysClk72MHz();
+	if (SysTick_Init() != SYSTICK_OK){
+		printf("SysTick cannot run at %lu Hz\n", (unsigned long)RCC_GetHCLKValue());
+		while (1);
+	}
+
+	LED_Button_GPIOInits();
+	SysTick_TimerStart(&BlinkTimer, BLINK_MS, BLINK_MS, Blink, NULL);
+
+	while (1){
+		if (Presses != printed){
+			printed = Presses;
+			printf("Press %lu at %lu ms\n", (unsigned long)printed, (unsigned long)(PressTime / 1000U));
+		}
+		SysTick_Idle();
+	}
+}
+
+void EXTI0_IRQHandler (void){
+
+	GPIO_IRQHandling(GPIO_PIN_0);
+	SysTick_TimerStart(&DebounceTimer, DEBOUNCE_MS, 0, Debounce, NULL); // A bounce restarts it
+}
@@ -14,11 +14,6 @@ uint8_t some_data[] = "Testing\n";
 
 I2C_Handle_t I2C1Handle;
 
-void delay(void)
-{
-	for(uint32_t i = 0 ; i < 500000/2 ; i ++);
-}
-
 void I2C_GPIOInits_1(void){
 
 	GPIO_Handle_t I2CPins;
@@ -69,5 +64,16 @@ int main (void){
 
 	I2C_GPIOInits_1();
 
+	I2C_Inits();
+
+	// Errata 2.13.7 (BUSY flag stuck after the analog filter sees a glitch on the lines): the lines
+	// are driven by hand as GPIO, a STOP is sent and SWRST clears the flag
+	if (I2C_BusRecovery(&I2C1Handle) != I2C_OK){
+		while(1); // A slave keeps SDA or SCL low
+	}
+
+	I2C_PeripheralControl(I2C1, ENABLE);
+	I2C_ManageAcking(I2C1, I2C_ACK_ENABLE);
+
 	return 0;
 }
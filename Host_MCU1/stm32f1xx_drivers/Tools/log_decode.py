@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+#
+# log_decode.py
+#
+#  Created on: Oct 17, 2026
+#      Author: Daniela
+#
+# Rebuilds the text of the binary log (drivers/Inc/stm32f1xx_log.h) from the ELF file of the application.
+# Only the Python standard library is used.
+#
+# Usage:
+#   log_decode.py Debug/stm32f1xx_drivers.elf log.bin               (LOG_OutputFile / LOG_OutputUSART capture)
+#   log_decode.py --itm 1 Debug/stm32f1xx_drivers.elf swo.bin       (SWO capture, ITM port LOG_ITM_PORT)
+#   ... | log_decode.py Debug/stm32f1xx_drivers.elf -               (read from stdin)
+#
+# Record: header (format ID << 8 | 0x80 | data flag 0x40 | words), DWT cycles, argument words. Little endian.
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_FMT_SECTION = "log_fmt"
+HDR_MARKER = 0x80
+HDR_DATA = 0x40
+HDR_WORDS_MASK = 0x3F
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(hh|h|ll|l|z|t|j)?([diouxXcspn%])")
+
+
+class Elf:
+	"""Sections of an ELF file (32 or 64 bits, little endian)"""
+
+	def __init__(self, path):
+		with open(path, "rb") as f:
+			self.data = f.read()
+		if self.data[:4] != b"\x7fELF" or self.data[5] != 1:
+			raise ValueError("%s: not a little endian ELF file" % path)
+		if self.data[4] == 1:
+			shoff, = struct.unpack_from("<I", self.data, 0x20)
+			shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+			fmt = "<IIIIIIIIII"
+		else:
+			shoff, = struct.unpack_from("<Q", self.data, 0x28)
+			shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x3A)
+			fmt = "<IIQQQQIIQQ"
+		headers = [struct.unpack_from(fmt, self.data, shoff + i * shentsize) for i in range(shnum)]
+		names = headers[shstrndx][4]
+		self.sections = {}
+		for name, stype, flags, addr, offset, size, *_ in headers:
+			end = self.data.index(b"\0", names + name)
+			label = self.data[names + name:end].decode()
+			# SHT_NOBITS (.bss) has no data in the file
+			self.sections[label] = (addr, offset, 0 if stype == 8 else size, flags)
+
+	def section(self, name):
+		if name not in self.sections:
+			raise KeyError("no %s section: the application does not use LOG" % name)
+		addr, offset, size, _ = self.sections[name]
+		return self.data[offset:offset + size]
+
+	def string_at(self, address):
+		"""Constant string of a %s argument, found in the loaded sections"""
+		for addr, offset, size, flags in self.sections.values():
+			if (flags & 0x2) and addr <= address < addr + size:
+				start = offset + address - addr
+				end = self.data.index(b"\0", start)
+				return self.data[start:end].decode("latin-1")
+		return "<0x%08x>" % address
+
+
+def itm_port_data(stream, port):
+	"""Payload of the software packets of one ITM stimulus port (SWO without formatter)"""
+	out = bytearray()
+	i = 0
+	while i < len(stream):
+		header = stream[i]
+		i += 1
+		if header == 0x00:
+			continue					# Synchronization (zeros then 0x80)
+		if header == 0x80 or header == 0x70:
+			continue					# End of synchronization, overflow
+		size = header & 0x3
+		if size == 0:
+			# Protocol packet (timestamps): continuation bit on the header and each payload byte
+			more = header & 0x80
+			while more and i < len(stream):
+				more = stream[i] & 0x80
+				i += 1
+			continue
+		length = 4 if size == 3 else size
+		if not (header & 0x4) and (header >> 3) == port:
+			out += stream[i:i + length]
+		i += length
+	return bytes(out)
+
+
+def format_record(fmt, args, data, elf):
+	"""printf with 32-bit arguments. %s takes the data of a LOG_DATA record or a string of the ELF file"""
+	out = []
+	pos = 0
+	args = list(args)
+
+	def next_arg():
+		return args.pop(0) if args else 0
+
+	for m in CONVERSION.finditer(fmt):
+		out.append(fmt[pos:m.start()])
+		pos = m.end()
+		flags, width, precision, length, conv = m.groups()
+		if conv == "%":
+			out.append("%")
+			continue
+		if width == "*":
+			width = str(struct.unpack("<i", struct.pack("<I", next_arg()))[0])
+		if precision == "*":
+			precision = str(next_arg())
+		spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+		if conv == "s":
+			if data is not None:
+				text, data = data.decode("latin-1"), None
+				text = "".join(c if c.isprintable() else "\\x%02x" % ord(c) for c in text)
+			else:
+				text = elf.string_at(next_arg())
+			out.append((spec + "s") % text)
+			continue
+		value = next_arg()
+		if conv in "di":
+			bits = {"hh": 8, "h": 16}.get(length, 32)
+			value &= (1 << bits) - 1
+			if value >> (bits - 1):
+				value -= 1 << bits
+			out.append((spec + "d") % value)
+		elif conv == "u":
+			out.append((spec + "d") % value)
+		elif conv == "c":
+			out.append((spec + "c") % chr(value & 0xFF))
+		elif conv == "p":
+			out.append("0x%08x" % value)
+		elif conv == "n":
+			pass
+		else:
+			out.append((spec + conv) % value)
+	out.append(fmt[pos:])
+	return "".join(out)
+
+
+def decode(elf, stream, hclk):
+	strings = elf.section(LOG_FMT_SECTION)
+	i = 0
+	last = None
+	elapsed = 0
+	while i + 8 <= len(stream):
+		header, cycles = struct.unpack_from("<II", stream, i)
+		words = header & HDR_WORDS_MASK
+		fmt_id = header >> 8
+		if not (header & HDR_MARKER) or fmt_id >= len(strings) or i + 8 + 4 * words > len(stream):
+			i += 1						# Lost bytes: look for the next header
+			continue
+		args = struct.unpack_from("<%dI" % words, stream, i + 8)
+		i += 8 + 4 * words
+
+		end = strings.index(b"\0", fmt_id)
+		fmt = strings[fmt_id:end].decode("latin-1")
+		data = None
+		if header & HDR_DATA:
+			data = struct.pack("<%dI" % (words - 1), *args[1:])[:args[0]]
+			args = ()
+
+		# The cycle counter wraps every 2^32 cycles (60 s at 72 MHz)
+		if last is not None:
+			elapsed += (cycles - last) & 0xFFFFFFFF
+		last = cycles
+		yield "[%12.6f] %s" % (elapsed / hclk, format_record(fmt, args, data, elf).rstrip("\n"))
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Decodes the binary log of the stm32f1xx drivers")
+	parser.add_argument("elf", help="ELF file of the application (the log_fmt section holds the format strings)")
+	parser.add_argument("log", help="captured log data, - for stdin")
+	parser.add_argument("--itm", type=int, metavar="PORT", help="the capture is an SWO stream: keep this ITM port")
+	parser.add_argument("--hclk", type=float, default=72e6, help="core clock in Hz for the timestamps (default 72 MHz)")
+	opts = parser.parse_args()
+
+	elf = Elf(opts.elf)
+	if opts.log == "-":
+		stream = sys.stdin.buffer.read()
+	else:
+		with open(opts.log, "rb") as f:
+			stream = f.read()
+	if opts.itm is not None:
+		stream = itm_port_data(stream, opts.itm)
+
+	for line in decode(elf, stream, opts.hclk):
+		print(line)
+
+
+if __name__ == "__main__":
+	main()
@@ -15,22 +15,70 @@
 
 /*********************** Processor specific macros ******************************/
 
-/* ARM Cortex-MX Processor NVIC ISERx Register Addresses. Taken from ARM Cortex-MX User Guide*/
-#define NVIC_ISER0				((volatile uint32_t*)0xE000E100)
-#define NVIC_ISER1				((volatile uint32_t*)0xE000E104)
-#define NVIC_ISER2				((volatile uint32_t*)0xE000E108)
-
-/* ARM Cortex-MX Processor NVIC ICERx Register Addresses */
-#define NVIC_ICER0				((volatile uint32_t*)0xE000E180)
-#define NVIC_ICER1				((volatile uint32_t*)0XE000E184)
-#define NVIC_ICER2				((volatile uint32_t*)0XE000E188)
-
-/* ARM Cortex-MX Processor Priority Register Addresses Calculation */
-#define NVIC_PRIO_BASEADDR		((volatile uint32_t*)0xE000E400)
+/* ARM Cortex-MX Processor NVIC base address (ISER0). Taken from ARM Cortex-MX User Guide */
+#define NVIC_BASEADDR			0xE000E100U
 
 /* ARM Cortex-MX Processor number of priority bits implemented in the Priority Register  */
 #define NO_PR_BITS_IMPLEMENTED	4
 
+/* ARM Cortex-M3 Application Interrupt and Reset Control Register. Holds the priority grouping */
+#define SCB_AIRCR				((volatile uint32_t*)0xE000ED0C)
+#define SCB_AIRCR_PRIGROUP		8		// Bits [10:8]
+#define SCB_AIRCR_VECTKEY		16		// Bits [31:16]. Writes are ignored without the key
+#define SCB_AIRCR_VECTKEY_VALUE	0x05FAU
+
+/* ARM Cortex-M3 Interrupt Control and State Register. Pends and un-pends PendSV (write 1) */
+#define SCB_ICSR				((volatile uint32_t*)0xE000ED04)
+#define SCB_ICSR_PENDSTCLR		25
+#define SCB_ICSR_PENDSTSET		26		// Also reads 1 while SysTick is pending
+#define SCB_ICSR_PENDSVCLR		27
+#define SCB_ICSR_PENDSVSET		28
+
+/* ARM Cortex-M3 System Handler Priority Register 3. One byte per handler, like the NVIC IP bytes */
+#define SCB_SHPR3				((volatile uint32_t*)0xE000ED20)
+#define SCB_SHPR3_PENDSV		16		// Bits [23:16]
+#define SCB_SHPR3_SYSTICK		24		// Bits [31:24]
+
+/* ARM Cortex-M3 SysTick timer. 24-bit down counter clocked by HCLK (or HCLK/8) */
+#define SYSTICK_BASEADDR		0xE000E010U
+
+/* ARM Cortex-M3 Debug Exception and Monitor Control Register. TRCENA powers the DWT unit */
+#define DEMCR					((volatile uint32_t*)0xE000EDFC)
+#define DEMCR_TRCENA			24
+
+/* ARM Cortex-M3 interrupt masking (PRIMASK) and sleep. WFI also wakes up on an interrupt that is
+ * pending while PRIMASK is set: it runs after IRQ_ENABLE.
+ * IRQ_SAVE_DISABLE/IRQ_RESTORE nest: State (uint32_t) keeps PRIMASK, so a function called with the
+ * interrupts already masked does not unmask them on exit */
+#ifdef STM32F1_HOST_SIM
+#define IRQ_DISABLE()			SIM_SetPRIMASK(1)
+#define IRQ_ENABLE()			SIM_SetPRIMASK(0)
+#define IRQ_SAVE_DISABLE(State)	do{ (State) = SIM_GetPRIMASK(); SIM_SetPRIMASK(1); }while(0)
+#define IRQ_RESTORE(State)		SIM_SetPRIMASK((uint8_t)(State))
+#define WFI()					SIM_WaitForInterrupt()
+#else
+#define IRQ_DISABLE()			__asm volatile ("cpsid i" : : : "memory")
+#define IRQ_ENABLE()			__asm volatile ("cpsie i" : : : "memory")
+#define IRQ_SAVE_DISABLE(State)	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (State) : : "memory")
+#define IRQ_RESTORE(State)		__asm volatile ("msr primask, %0" : : "r" (State) : "memory")
+#define WFI()					__asm volatile ("wfi" : : : "memory")
+#endif
+
+/* ARM Cortex-M3 Data Watchpoint and Trace unit. Holds the cycle counter (CYCCNT) */
+#define DWT_BASEADDR			0xE0001000U
+
+/* ARM Cortex-M3 Instrumentation Trace Macrocell. Data written to a stimulus port goes out on SWO */
+#define ITM_BASEADDR			0xE0000000U
+#define ITM_LAR_KEY				0xC5ACCE55U	// Lock Access Register value that unlocks TCR/TER/TPR
+
+/* ARM Cortex-M3 Trace Port Interface Unit. Protocol and bit rate of the SWO pin */
+#define TPIU_BASEADDR			0xE0040000U
+
+/* STM32F1 Debug MCU configuration register. TRACE_IOEN gives PB3 to TRACESWO */
+#define DBGMCU_CR				((volatile uint32_t*)0xE0042004)
+#define DBGMCU_CR_TRACE_IOEN	5
+#define DBGMCU_CR_TRACE_MODE	6		// Bits [7:6]. 00 = asynchronous (SWO only)
+
 /**************************** MCU specific macros ***********************************/
 
 /* Base address of Flash and SRAM Memories */
@@ -45,8 +93,18 @@
 #define APB2PERIPH_BASEADDR		0X40010000U		// Base memory for APB2
 #define AHB1PERIPH_BASEADDR		0X40018000U		// Base memory for AHB1
 
+/* Bit-band alias region of the peripherals (Cortex-M3). Each bit of the first MB of the peripheral region has
+ * its own word in the alias region: a read returns the bit as 0/1 and a write of 0/1 changes only that bit.
+ * Polling a flag is a single load with no masking. The register address can be a *_BASEADDR + offset or
+ * &pPeriph->REG: with a constant base the alias address is calculated at compile time */
+#define PERIPH_BB_BASEADDR		0x42000000U
+#define BITBAND_PERIPH_ADDR(RegAddr, Bit)	(PERIPH_BB_BASEADDR + ((((uint32_t)(uintptr_t)(RegAddr)) - PERIPH_BASEADDR) << 5) + ((uint32_t)(Bit) << 2))
+#define BITBAND_PERIPH(RegAddr, Bit)		(*(volatile uint32_t*)(uintptr_t)BITBAND_PERIPH_ADDR(RegAddr, Bit))
+
 /* Base addresses of peripherals hanging on AHB1 */
 #define RCC_BASEADDR			0x40021000U // Base address for RCC
+#define DMA1_BASEADDR			0x40020000U // Base address for DMA1
+#define FLASH_R_BASEADDR		0x40022000U // Base address for the flash memory interface registers
 
 /* Base addresses of peripherals hanging on APB1 */
 #define SPI2_BASEADDR 			(APB1PERIPH_BASEADDR + 0x3800) // Base address for SPI2
@@ -115,6 +173,20 @@ typedef struct
 	volatile uint32_t CFGR2;	// Clock Configuration Register 2			Offset 0x002C
 }RCC_RegDef_t;
 
+/* Flash memory interface registers definitions structures */
+typedef struct
+{
+	volatile uint32_t ACR;		// Access Control Register					Offset 0x0000
+	volatile uint32_t KEYR;		// Key Register								Offset 0x0004
+	volatile uint32_t OPTKEYR;	// Option Key Register						Offset 0x0008
+	volatile uint32_t SR;		// Status Register							Offset 0x000C
+	volatile uint32_t CR;		// Control Register							Offset 0x0010
+	volatile uint32_t AR;		// Address Register							Offset 0x0014
+	uint32_t RESERVED;			// Reserved									Offset 0x0018
+	volatile uint32_t OBR;		// Option Byte Register						Offset 0x001C
+	volatile uint32_t WRPR;		// Write Protection Register				Offset 0x0020
+}FLASH_RegDef_t;
+
 /* EXTI registers definitions structures */
 typedef struct
 {
@@ -126,6 +198,21 @@ typedef struct
 	volatile uint32_t PR;		// Pending Register							Offset 0x0014
 }EXTI_RegDef_t;
 
+/* DMA registers definitions structures */
+typedef struct{
+	volatile uint32_t CCR;		// DMA Channel Configuration Register		Offset 0x00
+	volatile uint32_t CNDTR;	// DMA Channel Number of Data Register		Offset 0x04
+	volatile uint32_t CPAR;		// DMA Channel Peripheral Address Register	Offset 0x08
+	volatile uint32_t CMAR;		// DMA Channel Memory Address Register		Offset 0x0C
+	uint32_t RESERVED;			// Reserved									Offset 0x10
+}DMA_Channel_RegDef_t;
+
+typedef struct{
+	volatile uint32_t ISR;		// DMA Interrupt Status Register			Offset 0x00
+	volatile uint32_t IFCR;		// DMA Interrupt Flag Clear Register		Offset 0x04
+	DMA_Channel_RegDef_t CH[7];	// DMA Channels 1-7							Offset 0x08 + 20*(x-1)
+}DMA_RegDef_t;
+
 /* SPI registers definitions structures */
 typedef struct{
 	volatile uint32_t CR1;		// SPI Control Register 1					Offset 0x00
@@ -151,6 +238,75 @@ typedef struct{
 	volatile uint32_t TRISE;	// I2C TRISE Register						Offset 0x20
 }I2C_RegDef_t;
 
+/* USART registers definitions structures */
+typedef struct{
+	volatile uint32_t SR;		// USART Status Register					Offset 0x00
+	volatile uint32_t DR;		// USART Data Register						Offset 0x04
+	volatile uint32_t BRR;		// USART Baud Rate Register					Offset 0x08
+	volatile uint32_t CR1;		// USART Control Register 1					Offset 0x0C
+	volatile uint32_t CR2;		// USART Control Register 2					Offset 0x10
+	volatile uint32_t CR3;		// USART Control Register 3					Offset 0x14
+	volatile uint32_t GTPR;		// USART Guard Time and Prescaler Register	Offset 0x18
+}USART_RegDef_t;
+
+/* NVIC registers definitions structures */
+typedef struct{
+	volatile uint32_t ISER[8];		// Interrupt Set-Enable Registers (write 1)		Offset 0x000
+	uint32_t RESERVED0[24];
+	volatile uint32_t ICER[8];		// Interrupt Clear-Enable Registers (write 1)		Offset 0x080
+	uint32_t RESERVED1[24];
+	volatile uint32_t ISPR[8];		// Interrupt Set-Pending Registers (write 1)		Offset 0x100
+	uint32_t RESERVED2[24];
+	volatile uint32_t ICPR[8];		// Interrupt Clear-Pending Registers (write 1)	Offset 0x180
+	uint32_t RESERVED3[24];
+	volatile uint32_t IABR[8];		// Interrupt Active Bit Registers (read only)		Offset 0x200
+	uint32_t RESERVED4[56];
+	volatile uint8_t  IP[240];		// Interrupt Priority Registers, one byte per IRQ	Offset 0x300
+	uint32_t RESERVED5[644];
+	volatile uint32_t STIR;			// Software Trigger Interrupt Register			Offset 0xE00
+}NVIC_RegDef_t;
+
+/* SysTick registers definitions structures */
+typedef struct{
+	volatile uint32_t CSR;		// SysTick Control and Status Register		Offset 0x00
+	volatile uint32_t RVR;		// SysTick Reload Value Register (24 bits)	Offset 0x04
+	volatile uint32_t CVR;		// SysTick Current Value Register			Offset 0x08
+	volatile uint32_t CALIB;	// SysTick Calibration Value Register		Offset 0x0C
+}SysTick_RegDef_t;
+
+/* DWT registers definitions structures (only the cycle counter part) */
+typedef struct{
+	volatile uint32_t CTRL;		// DWT Control Register						Offset 0x00
+	volatile uint32_t CYCCNT;	// DWT Cycle Count Register					Offset 0x04
+}DWT_RegDef_t;
+
+/* ITM registers definitions structures */
+typedef struct{
+	volatile uint32_t PORT[32];		// Stimulus Port Registers. Read: bit 0 = FIFO ready	Offset 0x000
+	uint32_t RESERVED0[864];
+	volatile uint32_t TER;			// Trace Enable Register (one bit per port)			Offset 0xE00
+	uint32_t RESERVED1[15];
+	volatile uint32_t TPR;			// Trace Privilege Register							Offset 0xE40
+	uint32_t RESERVED2[15];
+	volatile uint32_t TCR;			// Trace Control Register							Offset 0xE80
+	uint32_t RESERVED3[75];
+	volatile uint32_t LAR;			// Lock Access Register (write only)				Offset 0xFB0
+	volatile uint32_t LSR;			// Lock Status Register								Offset 0xFB4
+}ITM_RegDef_t;
+
+/* TPIU registers definitions structures */
+typedef struct{
+	volatile uint32_t SSPSR;		// Supported Parallel Port Sizes Register			Offset 0x000
+	volatile uint32_t CSPSR;		// Current Parallel Port Size Register				Offset 0x004
+	uint32_t RESERVED0[2];
+	volatile uint32_t ACPR;			// Asynchronous Clock Prescaler Register			Offset 0x010
+	uint32_t RESERVED1[55];
+	volatile uint32_t SPPR;			// Selected Pin Protocol Register					Offset 0x0F0
+	uint32_t RESERVED2[131];
+	volatile uint32_t FFSR;			// Formatter and Flush Status Register				Offset 0x300
+	volatile uint32_t FFCR;			// Formatter and Flush Control Register				Offset 0x304
+}TPIU_RegDef_t;
+
 /* GPIO Peripherals Definitions: Peripheral base address typecasted to GPIO_RegDef_t */
 #define GPIOA						((GPIO_RegDef_t*)GPIOA_BASEADDR)
 #define GPIOB						((GPIO_RegDef_t*)GPIOB_BASEADDR)
@@ -164,6 +320,8 @@ typedef struct{
 
 #define RCC							((RCC_RegDef_t*)RCC_BASEADDR)
 
+#define FLASH						((FLASH_RegDef_t*)FLASH_R_BASEADDR)
+
 #define EXTI 						((EXTI_RegDef_t*)EXTI_BASEADDR)
 
 /* SPI Peripherals Definitions: Peripheral base address typecasted to SPI_RegDef_t */
@@ -171,10 +329,33 @@ typedef struct{
 #define SPI2						((SPI_RegDef_t*)SPI2_BASEADDR)
 #define SPI3						((SPI_RegDef_t*)SPI3_BASEADDR)
 
+/* DMA Peripherals Definitions: Peripheral base address typecasted to DMA_RegDef_t */
+#define DMA1						((DMA_RegDef_t*)DMA1_BASEADDR)
+
 /* I2C Peripherals Definitions: Peripheral base address typecasted to I2C_RegDef_t */
 #define I2C1						((I2C_RegDef_t*)I2C1_BASEADDR)
 #define I2C2						((I2C_RegDef_t*)I2C2_BASEADDR)
 
+/* USART Peripherals Definitions: Peripheral base address typecasted to USART_RegDef_t */
+#define USART1						((USART_RegDef_t*)USART1_BASEADDR)
+#define USART2						((USART_RegDef_t*)USART2_BASEADDR)
+#define USART3						((USART_RegDef_t*)USART3_BASEADDR)
+#define UART4						((USART_RegDef_t*)UART4_BASEADDR)
+#define UART5						((USART_RegDef_t*)UART5_BASEADDR)
+
+/* NVIC Definition: Core peripheral base address typecasted to NVIC_RegDef_t */
+#define NVIC						((NVIC_RegDef_t*)NVIC_BASEADDR)
+
+/* SysTick Definition: Core peripheral base address typecasted to SysTick_RegDef_t */
+#define SYSTICK						((SysTick_RegDef_t*)SYSTICK_BASEADDR)
+
+/* DWT Definition: Core peripheral base address typecasted to DWT_RegDef_t */
+#define DWT							((DWT_RegDef_t*)DWT_BASEADDR)
+
+/* ITM and TPIU Definitions: Core peripheral base address typecasted to ITM_RegDef_t/TPIU_RegDef_t */
+#define ITM							((ITM_RegDef_t*)ITM_BASEADDR)
+#define TPIU						((TPIU_RegDef_t*)TPIU_BASEADDR)
+
 /* Clock enable macros for GPIO peripherals */
 #define GPIOA_PCLK_EN()				(RCC->APB2ENR |=(1 << 2)) // Bit 2 to enable RCC for port A
 #define GPIOB_PCLK_EN()				(RCC->APB2ENR |=(1 << 3)) // Bit 3 to enable RCC for port B
@@ -196,10 +377,13 @@ typedef struct{
 #define SPI2_PCLK_EN()				(RCC->APB1ENR |=(1 << 14)) // Bit 14 to enable RCC for SPI2
 #define SPI3_PCLK_EN()				(RCC->APB1ENR |=(1 << 15)) // Bit 15 to enable RCC for SPI3
 
+/* Clock enable macros for DMA peripherals */
+#define DMA1_PCLK_EN()				(RCC->AHBENR |=(1 << 0)) // Bit 0 to enable RCC for DMA1
+
 /* Clock enable macros for USART peripherals */
-#define USART1_PCLK_EN()			(RCC->APB2ENR |=(1 << 14)) // Bit 12 to enable RCC for USART1
-#define USART2_PCLK_EN()			(RCC->APB1ENR |=(1 << 17)) // Bit 12 to enable RCC for USART2
-#define USART3_PCLK_EN()			(RCC->APB1ENR |=(1 << 18)) // Bit 12 to enable RCC for USART3
+#define USART1_PCLK_EN()			(RCC->APB2ENR |=(1 << 14)) // Bit 14 to enable RCC for USART1
+#define USART2_PCLK_EN()			(RCC->APB1ENR |=(1 << 17)) // Bit 17 to enable RCC for USART2
+#define USART3_PCLK_EN()			(RCC->APB1ENR |=(1 << 18)) // Bit 18 to enable RCC for USART3
 
 /* Clock disable macros for GPIO peripherals */
 #define GPIOA_PCLK_DI()				(RCC->APB2ENR &= ~(1 << 2)) // Bit 2 to disable RCC for port A
@@ -213,46 +397,48 @@ typedef struct{
 /* Clock disable macros for AFIO peripherals */
 #define AFIO_PCLK_DI()				(RCC->APB2ENR &= ~(1 << 0)) // Bit 0 to disable RCC for AFIO
 
-/* Clock enable macros for I2C peripherals */
+/* Clock disable macros for I2C peripherals */
 #define I2C1_PCLK_DI()				(RCC->APB1ENR &= ~(1 << 21)) // Bit 21 to disable RCC for I2C1
 #define I2C2_PCLK_DI()				(RCC->APB1ENR &= ~(1 << 22)) // Bit 22 to disable RCC for I2C2
 
-/* Clock enable macros for SPI peripherals */
-#define SPI1_PCLK_DI()				(RCC->APB2ENR &= ~(1 << 12)) // Bit 12 to disable RCC for I2C1
+/* Clock disable macros for SPI peripherals */
+#define SPI1_PCLK_DI()				(RCC->APB2ENR &= ~(1 << 12)) // Bit 12 to disable RCC for SPI1
 #define SPI2_PCLK_DI()				(RCC->APB1ENR &= ~(1 << 14)) // Bit 14 to disable RCC for SPI2
 #define SPI3_PCLK_DI()				(RCC->APB1ENR &= ~(1 << 15)) // Bit 15 to disable RCC for SPI3
 
-/* Clock enable macros for USART peripherals */
-#define USART1_PCLK_DI()			(RCC->APB2ENR &= ~(1 << 14)) // Bit 12 to disable RCC for USART1
-#define USART2_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 17)) // Bit 12 to disable RCC for USART2
-#define USART3_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 18)) // Bit 12 to disable RCC for USART3
+/* Clock disable macros for DMA peripherals */
+#define DMA1_PCLK_DI()				(RCC->AHBENR &= ~(1 << 0)) // Bit 0 to disable RCC for DMA1
+
+/* Clock disable macros for USART peripherals */
+#define USART1_PCLK_DI()			(RCC->APB2ENR &= ~(1 << 14)) // Bit 14 to disable RCC for USART1
+#define USART2_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 17)) // Bit 17 to disable RCC for USART2
+#define USART3_PCLK_DI()			(RCC->APB1ENR &= ~(1 << 18)) // Bit 18 to disable RCC for USART3
 
 /* Macros to reset GPIOx Peripherals */
-#define GPIOA_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 3)); (RCC->APB2RSTR &= ~(1 << 3));} while (0) // To execute more than one instruction per line
-#define GPIOB_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 4)); (RCC->APB2RSTR &= ~(1 << 4));} while (0)
-#define GPIOC_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 5)); (RCC->APB2RSTR &= ~(1 << 5));} while (0)
-#define GPIOD_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 6)); (RCC->APB2RSTR &= ~(1 << 6));} while (0)
-#define GPIOE_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 7)); (RCC->APB2RSTR &= ~(1 << 7));} while (0)
-#define GPIOF_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 8)); (RCC->APB2RSTR &= ~(1 << 8));} while (0)
-#define GPIOG_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 9)); (RCC->APB2RSTR &= ~(1 << 9));} while (0)
+#define GPIOA_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 2)); (RCC->APB2RSTR &= ~(1 << 2));} while (0) // To execute more than one instruction per line
+#define GPIOB_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 3)); (RCC->APB2RSTR &= ~(1 << 3));} while (0)
+#define GPIOC_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 4)); (RCC->APB2RSTR &= ~(1 << 4));} while (0)
+#define GPIOD_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 5)); (RCC->APB2RSTR &= ~(1 << 5));} while (0)
+#define GPIOE_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 6)); (RCC->APB2RSTR &= ~(1 << 6));} while (0)
+#define GPIOF_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 7)); (RCC->APB2RSTR &= ~(1 << 7));} while (0)
+#define GPIOG_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 8)); (RCC->APB2RSTR &= ~(1 << 8));} while (0)
 
 /* Macros to reset SPIx Peripherals */
-#define SPI1_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 13)); (RCC->APB2RSTR &= ~(1 << 13));} while (0)
-#define SPI2_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 15)); (RCC->APB2RSTR &= ~(1 << 15));} while (0)
-#define SPI3_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 16)); (RCC->APB2RSTR &= ~(1 << 16));} while (0)
+#define SPI1_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 12)); (RCC->APB2RSTR &= ~(1 << 12));} while (0)
+#define SPI2_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 14)); (RCC->APB1RSTR &= ~(1 << 14));} while (0)
+#define SPI3_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 15)); (RCC->APB1RSTR &= ~(1 << 15));} while (0)
 
-/* Macros to reset SPIx Peripherals */
-#define I2C1_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 21)); (RCC->APB2RSTR &= ~(1 << 21));} while (0)
-#define I2C2_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 22)); (RCC->APB2RSTR &= ~(1 << 22));} while (0)
-
-/* Macro to get a portcode given GPIOx base address*/ //If x==GPIOA, then return 0, else
-#define GPIO_BASEADDR_TO_CODE(x)	((x == GPIOA) ? 0 :\
-									 (x == GPIOB) ? 1 :\
-									 (x == GPIOC) ? 2 :\
-									 (x == GPIOD) ? 3 :\
-									 (x == GPIOE) ? 4 :\
-									 (x == GPIOF) ? 5 :\
-									 (x == GPIOG) ? 6 :0)
+/* Macros to reset I2Cx Peripherals */
+#define I2C1_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 21)); (RCC->APB1RSTR &= ~(1 << 21));} while (0)
+#define I2C2_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 22)); (RCC->APB1RSTR &= ~(1 << 22));} while (0)
+
+/* Macros to reset USARTx Peripherals */
+#define USART1_REG_RESET()			do {(RCC->APB2RSTR|=(1 << 14)); (RCC->APB2RSTR &= ~(1 << 14));} while (0)
+#define USART2_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 17)); (RCC->APB1RSTR &= ~(1 << 17));} while (0)
+#define USART3_REG_RESET()			do {(RCC->APB1RSTR|=(1 << 18)); (RCC->APB1RSTR &= ~(1 << 18));} while (0)
+
+/* Macro to get a portcode given GPIOx base address (0 for GPIOA, 1 for GPIOB...). Taken from the RCC peripheral table */
+#define GPIO_BASEADDR_TO_CODE(x)	(RCC_GetPeriDesc(x)->Code)
 
 /* IRQ Numbers */
 #define IRQ_NO_EXTI0		6
@@ -265,10 +451,22 @@ typedef struct{
 #define IRQ_NO_SPI2			36
 #define IRQ_NO_EXTI15_10	40
 #define IRQ_NO_SPI3			51
+#define IRQ_NO_USART1		37
+#define IRQ_NO_USART2		38
+#define IRQ_NO_USART3		39
+#define IRQ_NO_UART4		52
+#define IRQ_NO_UART5		53
 #define IRQ_NO_I2C1_EV		31
 #define IRQ_NO_I2C1_ER		32
 #define IRQ_NO_I2C2_EV		33
 #define IRQ_NO_I2C2_ER		34
+#define IRQ_NO_DMA1_CH1		11
+#define IRQ_NO_DMA1_CH2		12
+#define IRQ_NO_DMA1_CH3		13
+#define IRQ_NO_DMA1_CH4		14
+#define IRQ_NO_DMA1_CH5		15
+#define IRQ_NO_DMA1_CH6		16
+#define IRQ_NO_DMA1_CH7		17
 
 /* IRQ Priority */
 #define NVIC_PRIO_0			0
@@ -342,6 +540,8 @@ typedef struct{
 #define I2C_CR2_ITERREN		8
 #define I2C_CR2_ITEVTEN		9
 #define I2C_CR2_ITBUFEN		10
+#define I2C_CR2_DMAEN		11
+#define I2C_CR2_LAST		12
 
 #define I2C_SR1_SB			0
 #define I2C_SR1_ADDR		1
@@ -366,8 +566,131 @@ typedef struct{
 #define	I2C_CCR_DUTY		14
 #define	I2C_CCR_FS			15
 
+/* Bit positions definition for USART Peripheral*/
+#define USART_SR_PE			0
+#define USART_SR_FE			1
+#define USART_SR_NE			2
+#define USART_SR_ORE		3
+#define USART_SR_IDLE		4
+#define USART_SR_RXNE		5
+#define USART_SR_TC			6
+#define USART_SR_TXE		7
+#define USART_SR_LBD		8
+#define USART_SR_CTS		9
+
+#define USART_BRR_FRACTION	0	// 4 bits
+#define USART_BRR_MANTISSA	4	// 12 bits
+
+#define USART_CR1_SBK		0
+#define USART_CR1_RWU		1
+#define USART_CR1_RE		2
+#define USART_CR1_TE		3
+#define USART_CR1_IDLEIE	4
+#define USART_CR1_RXNEIE	5
+#define USART_CR1_TCIE		6
+#define USART_CR1_TXEIE		7
+#define USART_CR1_PEIE		8
+#define USART_CR1_PS		9
+#define USART_CR1_PCE		10
+#define USART_CR1_WAKE		11
+#define USART_CR1_M			12
+#define USART_CR1_UE		13
+
+#define USART_CR2_STOP		12	// 2 bits
+
+#define USART_CR3_EIE		0
+#define USART_CR3_HDSEL		3
+#define USART_CR3_DMAR		6
+#define USART_CR3_DMAT		7
+#define USART_CR3_RTSE		8
+#define USART_CR3_CTSE		9
+
+/* Bit positions definition for RCC Peripheral*/
+#define RCC_CR_HSION		0
+#define RCC_CR_HSIRDY		1
+#define RCC_CR_HSEON		16
+#define RCC_CR_HSERDY		17
+#define RCC_CR_HSEBYP		18
+#define RCC_CR_PLLON		24
+#define RCC_CR_PLLRDY		25
+
+#define RCC_CFGR_SW			0	// 2 bits
+#define RCC_CFGR_SWS		2	// 2 bits
+#define RCC_CFGR_HPRE		4	// 4 bits
+#define RCC_CFGR_PPRE1		8	// 3 bits
+#define RCC_CFGR_PPRE2		11	// 3 bits
+#define RCC_CFGR_PLLSRC		16
+#define RCC_CFGR_PLLXTPRE	17
+#define RCC_CFGR_PLLMUL		18	// 4 bits
+
+/* Bit positions definition for the flash memory interface*/
+#define FLASH_ACR_LATENCY	0	// 3 bits
+#define FLASH_ACR_PRFTBE	4
+
+/* Bit positions definition for AFIO Peripheral*/
+#define AFIO_MAPR_I2C1_REMAP	1	// I2C1 on PB8 (SCL) and PB9 (SDA) instead of PB6/PB7
+
+/* Bit positions definition for DMA Peripheral*/
+#define DMA_CCR_EN			0
+#define DMA_CCR_TCIE		1
+#define DMA_CCR_HTIE		2
+#define DMA_CCR_TEIE		3
+#define DMA_CCR_DIR			4
+#define DMA_CCR_CIRC		5
+#define DMA_CCR_PINC		6
+#define DMA_CCR_MINC		7
+#define DMA_CCR_PSIZE		8
+#define DMA_CCR_MSIZE		10
+#define DMA_CCR_PL			12
+#define DMA_CCR_MEM2MEM		14
+
+#define DMA_ISR_GIF			0	// Each channel uses 4 bits: channel x starts at bit 4*(x-1)
+#define DMA_ISR_TCIF		1
+#define DMA_ISR_HTIF		2
+#define DMA_ISR_TEIF		3
+
+/* Bit positions definition for SysTick */
+#define SYSTICK_CSR_ENABLE		0
+#define SYSTICK_CSR_TICKINT		1
+#define SYSTICK_CSR_CLKSOURCE	2	// 1 = HCLK, 0 = HCLK/8
+#define SYSTICK_CSR_COUNTFLAG	16	// Cleared by reading CSR
+#define SYSTICK_RVR_MAX			0x00FFFFFFU
+
+/* Bit positions definition for DWT */
+#define DWT_CTRL_CYCCNTENA	0
+
+/* Bit positions definition for ITM and TPIU */
+#define ITM_PORT_FIFOREADY	0
+#define ITM_TCR_ITMENA		0
+#define ITM_TCR_TSENA		1
+#define ITM_TCR_SYNCENA		2
+#define ITM_TCR_DWTENA		3
+#define ITM_TCR_SWOENA		4
+#define ITM_TCR_TRACEBUSID	16	// 7 bits
+#define ITM_TCR_BUSY		23
+
+#define TPIU_ACPR_PRESCALER	0	// 13 bits. SWO bit rate = HCLK / (PRESCALER + 1)
+#define TPIU_SPPR_TXMODE	0	// 2 bits. 1 = Manchester, 2 = NRZ (UART like)
+#define TPIU_FFCR_ENFCONT	1	// Formatter. Off for SWO
+#define TPIU_FFCR_TRIGIN	8
+
+#include "stm32f1xx_ringbuf.h"
+#include "stm32f1xx_pt.h"
+#include "stm32f1xx_rcc.h"
+#include "stm32f1xx_nvic.h"
+#include "stm32f1xx_defer.h"
+#include "stm32f1xx_dwt.h"
+#include "stm32f1xx_systick.h"
+#include "stm32f1xx_itm.h"
 #include "stm32f1xx_gpio.h"
+#include "stm32f1xx_dma.h"
 #include "stm32f1xx_spi.h"
 #include "stm32f1xx_i2c.h"
+#include "stm32f1xx_usart.h"
+#include "stm32f1xx_log.h"
+
+#ifdef STM32F1_HOST_SIM
+#include "stm32f1xx_sim.h"
+#endif
 
 #endif /* INC_STM32F103XX_H_ */
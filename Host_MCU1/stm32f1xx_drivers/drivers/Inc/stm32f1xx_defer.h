@@ -0,0 +1,62 @@
+/*
+ * stm32f1xx_defer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// Deferred work queue (bottom halves). The ISRs and the application callbacks only do the register work
+// and post the rest (printf, protocol handling...) here. PendSV runs the posted work at the lowest
+// priority, once no other interrupt is running:
+// - Defer_Post is O(1) and can be called from any ISR and from main(). A slot is reserved with a compare
+//   and swap on Head (LDREX/STREX on the Cortex-M3), so ISRs that preempt each other do not need to
+//   disable interrupts.
+// - A slot is published by storing its function last. PendSV runs the slots in the order they were
+//   reserved and stops at one that is still being written: its producer pends PendSV again when done.
+// - When the queue is full the work is not stored, Defer_Post returns DEFER_FULL and the loss is counted.
+
+#ifndef INC_STM32F1XX_DEFER_H_
+#define INC_STM32F1XX_DEFER_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Deferred function. Runs in the PendSV handler with the context and argument given to Defer_Post
+typedef void (*Defer_Func_t)(void *pContext, uint32_t Arg);
+
+// Queue slot
+typedef struct{
+	volatile Defer_Func_t pFunc;	// NULL while the slot is free or being written
+	void 				*pContext;
+	uint32_t			Arg;
+}Defer_Work_t;
+
+// Queue statistics
+typedef struct{
+	uint32_t Posted;		// Work items stored
+	uint32_t Dropped;		// Work items lost because the queue was full
+	uint32_t MaxDepth;		// Most items waiting at the same time. Size the queue with it
+}Defer_Stats_t;
+
+/* 							Macros  								*/
+#ifndef DEFER_QUEUE_SIZE
+#define DEFER_QUEUE_SIZE		32		// Power of 2. Can be set from the build options
+#endif
+
+#if (DEFER_QUEUE_SIZE & (DEFER_QUEUE_SIZE - 1)) != 0
+#error "DEFER_QUEUE_SIZE must be a power of 2"
+#endif
+
+/*                Defer_Post return values                          */
+#define DEFER_OK				0
+#define DEFER_FULL				1	// Queue full, the work was dropped
+#define DEFER_INVALID			2	// NULL function
+
+/*					APIs Supported by this driver 					*/
+void Defer_Init(void);																// Empties the queue and sets PendSV to the lowest priority
+uint8_t Defer_Post(Defer_Func_t pFunc, void *pContext, uint32_t Arg);				// ISR or main. Returns DEFER_OK/DEFER_FULL/DEFER_INVALID
+void Defer_Run(void);																// Runs the queued work. Called by PendSV_Handler only
+void Defer_GetStats(Defer_Stats_t *pStats);
+
+#endif /* INC_STM32F1XX_DEFER_H_ */
@@ -0,0 +1,121 @@
+/*
+ * stm32f1xx_dma.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+#ifndef INC_STM32F1XX_DMA_H_
+#define INC_STM32F1XX_DMA_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Configuration structure for a DMA channel
+typedef struct{
+	uint8_t DMA_Direction;	// Possible values @DMA_Direction
+	uint8_t DMA_PeriSize;	// Possible values @DMA_Size
+	uint8_t DMA_MemSize;	// Possible values @DMA_Size
+	uint8_t DMA_MemInc;		// ENABLE/DISABLE. The peripheral address never increments
+	uint8_t DMA_Priority;	// Possible values @DMA_Priority
+	uint8_t DMA_Mode;		// Possible values @DMA_Mode
+}DMA_Config_t;
+
+// Handle structure for a DMA channel
+typedef struct{
+	DMA_RegDef_t	*pDMAx;		// Pointer to hold the base address of the DMA (DMA1)
+	uint8_t			Channel;	// 1-7
+	DMA_Config_t	DMA_Config;	// Holds channel configuration settings
+}DMA_Handle_t;
+
+/* 							Macros  								*/
+// DMA channel numbers
+#define DMA_CHANNEL_1				1
+#define DMA_CHANNEL_2				2
+#define DMA_CHANNEL_3				3
+#define DMA_CHANNEL_4				4
+#define DMA_CHANNEL_5				5
+#define DMA_CHANNEL_6				6
+#define DMA_CHANNEL_7				7
+
+// DMA1 channel requests (RM0008 Table 78)
+#define DMA_CH_SPI1_RX				DMA_CHANNEL_2
+#define DMA_CH_SPI1_TX				DMA_CHANNEL_3
+#define DMA_CH_SPI2_RX				DMA_CHANNEL_4
+#define DMA_CH_SPI2_TX				DMA_CHANNEL_5
+#define DMA_CH_I2C1_TX				DMA_CHANNEL_6
+#define DMA_CH_I2C1_RX				DMA_CHANNEL_7
+#define DMA_CH_I2C2_TX				DMA_CHANNEL_4
+#define DMA_CH_I2C2_RX				DMA_CHANNEL_5
+#define DMA_CH_USART1_TX			DMA_CHANNEL_4
+#define DMA_CH_USART1_RX			DMA_CHANNEL_5
+#define DMA_CH_USART2_TX			DMA_CHANNEL_7
+#define DMA_CH_USART2_RX			DMA_CHANNEL_6
+#define DMA_CH_USART3_TX			DMA_CHANNEL_2
+#define DMA_CH_USART3_RX			DMA_CHANNEL_3
+
+// @DMA_Direction
+#define DMA_DIR_PERI_TO_MEM			0	// Read from peripheral
+#define DMA_DIR_MEM_TO_PERI			1	// Read from memory
+
+// @DMA_Size
+#define DMA_SIZE_8BITS				0
+#define DMA_SIZE_16BITS				1
+#define DMA_SIZE_32BITS				2
+
+// @DMA_Priority
+#define DMA_PRIORITY_LOW			0
+#define DMA_PRIORITY_MEDIUM			1
+#define DMA_PRIORITY_HIGH			2
+#define DMA_PRIORITY_VERY_HIGH		3
+
+// @DMA_Mode
+#define DMA_MODE_NORMAL				0
+#define DMA_MODE_CIRCULAR			1
+
+/*                 Flag related status definitions                  */
+#define DMA_GIF_FLAG				(1 << DMA_ISR_GIF)	// Shifted to the channel position by the APIs
+#define DMA_TCIF_FLAG				(1 << DMA_ISR_TCIF)
+#define DMA_HTIF_FLAG				(1 << DMA_ISR_HTIF)
+#define DMA_TEIF_FLAG				(1 << DMA_ISR_TEIF)
+
+/*                Possible DMA Application Events                   */
+#define DMA_EVENT_HALF_COMPLETE		1
+#define DMA_EVENT_COMPLETE			2
+#define DMA_ERROR_TRANSFER			3
+
+/* The memory address register is 32 bits. The simulator translates host pointers */
+#ifdef STM32F1_HOST_SIM
+#define DMA_MEM_ADDR(p)				SIM_DMA_MemAddr(p)
+#else
+#define DMA_MEM_ADDR(p)				((uint32_t)(uintptr_t)(p))
+#endif
+
+/*					APIs Supported by this driver 					*/
+// Enable/Disable peripheral clock
+void DMA_PeriClkCtrl(DMA_RegDef_t *pDMAx, uint8_t EnOrDi);
+
+// Initialize/De-initialize a DMA channel
+void DMA_Init(DMA_Handle_t *pDMAHandle);
+void DMA_DeInit(DMA_Handle_t *pDMAHandle);
+
+// Transfer control
+void DMA_Start(DMA_Handle_t *pDMAHandle, volatile void *pPeriAddr, void *pMemAddr, uint16_t len);	// len in items
+void DMA_Stop(DMA_Handle_t *pDMAHandle);
+uint16_t DMA_GetRemaining(DMA_Handle_t *pDMAHandle);
+void DMA_InterruptControl(DMA_Handle_t *pDMAHandle, uint32_t Interrupts, uint8_t EnOrDi);			// Interrupts: DMA_xxIF_FLAG ORed
+
+// IQR configuration and handling
+void DMA_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);									// To set IRQ Number
+void DMA_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority);							// To set the priority in IRQ
+void DMA_IRQHandling(DMA_Handle_t *pDMAHandle);											// To process interrupt
+
+// Other APIs
+uint8_t DMA_GetFlagStatus(DMA_RegDef_t *pDMAx, uint8_t Channel, uint32_t FlagName);
+void DMA_ClearFlag(DMA_RegDef_t *pDMAx, uint8_t Channel, uint32_t FlagName);
+
+// Application callback
+void DMA_ApplicationEventCallback (DMA_Handle_t *pDMAHandle, uint8_t AppEv);
+
+#endif /* INC_STM32F1XX_DMA_H_ */
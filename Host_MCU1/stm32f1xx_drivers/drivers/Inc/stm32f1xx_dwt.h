@@ -0,0 +1,56 @@
+/*
+ * stm32f1xx_dwt.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// Time base built on the DWT cycle counter (CYCCNT). It counts core clock cycles (HCLK), so it has the
+// resolution of one instruction and it does not need an interrupt. It is used for the deadlines of the
+// blocking driver calls:
+// - DWT_TimeoutStart takes the start time and turns the microseconds into cycles once.
+// - DWT_TimeoutExpired is one load of CYCCNT, one subtraction and one compare. The unsigned subtraction
+//   gives the right elapsed time even after CYCCNT wraps around.
+// - CYCCNT is 32 bits: the longest deadline is 2^32 cycles (59 s at 72 MHz, 536 s at 8 MHz).
+
+#ifndef INC_STM32F1XX_DWT_H_
+#define INC_STM32F1XX_DWT_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Deadline of a blocking call
+typedef struct{
+	uint32_t Start;		// CYCCNT when the timeout was started
+	uint32_t Cycles;	// Length of the timeout in cycles
+}DWT_Timeout_t;
+
+/* 							Macros  								*/
+#define DWT_WAIT_FOREVER		0xFFFFFFFFU	// Timeout value that never expires
+
+/*					APIs Supported by this driver 					*/
+void DWT_Init(void);													// Starts CYCCNT. Call it again after changing HCLK
+uint32_t DWT_UsToCycles(uint32_t Timeout_us);							// Saturates at DWT_WAIT_FOREVER
+uint32_t DWT_CyclesToUs(uint32_t Cycles);								// For measured durations
+void DWT_TimeoutStart(DWT_Timeout_t *pTimeout, uint32_t Timeout_us);	// Calls DWT_Init the first time
+void DWT_DelayUs(uint32_t Delay_us);									// Busy wait
+
+/* The check is inline: it runs in every iteration of the poll loops */
+
+// Current value of the cycle counter
+static inline uint32_t DWT_GetCycles(void){
+	return DWT->CYCCNT;
+}
+
+// Starts the same deadline again from now. The length in cycles is kept
+static inline void DWT_TimeoutRestart(DWT_Timeout_t *pTimeout){
+	pTimeout->Start = DWT->CYCCNT;
+}
+
+// Returns 1 when the deadline has passed
+static inline uint8_t DWT_TimeoutExpired(const DWT_Timeout_t *pTimeout){
+	return (DWT->CYCCNT - pTimeout->Start) > pTimeout->Cycles;
+}
+
+#endif /* INC_STM32F1XX_DWT_H_ */
@@ -46,6 +46,9 @@ typedef struct
 #define GPIO_PIN_14		14
 #define GPIO_PIN_15		15
 
+// Pin mask for the multi-pin functions (GPIO_WriteToOutputPins, GPIO_SetPins...)
+#define GPIO_PIN_MASK(n)	((uint16_t)(1 << (n)))
+
 // @ GPIO Pin possible modes
 #define GPIO_MODE_IN 			0 // Input
 #define GPIO_MODE_OUT_SPEED_10 	1 // Output, max speed 10 MHz
@@ -68,6 +71,10 @@ typedef struct
 #define INTER_FALLING_EDGE		2 // Triggers interrupt in the falling edge
 #define INTER_RISING_FALLING	3 // Triggers interrupt in both edges
 
+// GPIO_SetEventRing return values
+#define GPIO_OK					0
+#define GPIO_INVALID			1 // Ring refused by RingBuf_Init. The queue is not changed
+
 /*					APIs Supported by this driver 					*/
 
 // Enable/Disable peripheral clock
@@ -83,7 +90,9 @@ uint8_t GPIO_ReadFromInputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber);				// R
 uint16_t GPIO_ReadFromInputPort(GPIO_RegDef_t *pGPIOx);									// Read from port. Output 0/1 for each pin
 void GPIO_WriteToOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t value);	// Write to pin. Value = 1/0
 void GPIO_WriteToOutputPort(GPIO_RegDef_t *pGPIOx, uint16_t value);						// Write to port
+void GPIO_WriteToOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, uint16_t value);	// Write the pins in the mask. Other pins are not touched
 void GPIO_ToggleOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber);					// Toggle GPIO pin
+void GPIO_ToggleOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask);					// Toggle the pins in the mask
 
 // Interrupt handling
 void GPIO_InterHandler(GPIO_Handle_t *pGPIOHandle, uint8_t InterType);
@@ -92,6 +101,33 @@ void GPIO_InterHandler(GPIO_Handle_t *pGPIOHandle, uint8_t InterType);
 void GPIO_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);									// To set IRQ Number
 void GPIO_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority);							// To set the priority in IRQ
 void GPIO_IRQHandling(uint8_t PinNumber);												// To process interrupt
-
+uint8_t GPIO_SetEventRing(RingBuf_t *pRing);											// GPIO_IRQHandling queues the pin numbers here. NULL = no queue
+
+/* Inline variants for bit-banged protocols and trigger pins. Each one is a single store to BSRR/BRR:
+ * - Only the pins written with 1 change, so there is no read-modify-write of ODR and no critical section
+ *   is needed when an ISR drives other pins of the same port.
+ * - In BSRR bits 0-15 set the pins and bits 16-31 reset them. Set has priority if both are written */
+
+// Set the pins in the mask
+static inline void GPIO_SetPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask){
+	pGPIOx->BSRR = PinMask;
+}
+
+// Reset the pins in the mask
+static inline void GPIO_ResetPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask){
+	pGPIOx->BRR = PinMask;
+}
+
+// Write value to the pins in the mask. The other bits of value are ignored
+static inline void GPIO_WritePins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, uint16_t value){
+	pGPIOx->BSRR = ((uint32_t)(PinMask & ~value) << 16) | (PinMask & value);
+}
+
+// Toggle the pins in the mask. ODR is read once: an ISR that changes one of these same pins in between is
+// overwritten, but the other pins of the port are never touched
+static inline void GPIO_TogglePins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask){
+	uint32_t odr = pGPIOx->ODR;
+	pGPIOx->BSRR = ((odr & PinMask) << 16) | (~odr & PinMask);
+}
 
 #endif /* INC_STM32F1XX_GPIO_H_ */
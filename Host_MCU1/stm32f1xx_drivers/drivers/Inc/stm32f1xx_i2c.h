@@ -10,14 +10,54 @@
 
 #include "stm32f103xx.h" // MCU specific header file
 
+// Bus recovery statistics (I2C_BusRecovery)
+typedef struct{
+	uint32_t Count;			// Recoveries run
+	uint32_t Failures;		// Recoveries that could not free the bus (I2C_BUS_STUCK)
+	uint32_t LastTime_us;	// Duration of the last recovery
+	uint32_t MaxTime_us;	// Longest recovery
+	uint8_t  LastPulses;	// SCL pulses that the last recovery needed to free SDA
+}I2C_RecoveryStats_t;
+
+// Register values for a SCL speed. Built by I2C_TIMING (compile time) or I2C_CalcTiming
+typedef struct{
+	uint32_t PCLK1;		// APB1 clock the values are calculated for
+	uint32_t SCL_Hz;	// Achieved SCL frequency. Never above the requested one
+	uint16_t CCR;		// CCR register: FS, DUTY and CCR fields
+	uint8_t  FREQ;		// CR2 FREQ field (PCLK1 in MHz)
+	uint8_t  TRISE;		// TRISE register
+}I2C_Timing_t;
+
 // Configuration structure for a I2Cx Peripheral
 typedef struct{
 	uint32_t I2C_SCLSpeed;
 	uint8_t  I2C_DeviceAddress; // This value is mentioned by the user
 	uint8_t  I2C_ACKControl;
 	uint16_t I2C_FMDutyCycle; // Duty cycle of the serial clock in fast mode
+	uint32_t I2C_Timeout;	  // Time in us that a blocking call waits for each flag. 0 = I2C_TIMEOUT_DEFAULT_US
+	const I2C_Timing_t *pI2C_Timing; // Built with I2C_TIMING. NULL (or another PCLK1) = solved by I2C_Init
 }I2C_Config_t;
 
+// Queued master transaction (I2C_QueueSubmit): write phase, then read phase after a repeated START
+typedef struct{
+	uint8_t *pTxBuffer;			// Write phase. TxLen = 0: no write
+	uint8_t *pRxBuffer;			// Read phase. RxLen = 0: no read
+	uint8_t TxLen;
+	uint8_t RxLen;				// Bytes to read. Maximum with I2C_TR_LEN_FROM_PREV
+	uint8_t SlaveAddr;
+	uint8_t Flags;				// @I2C_TransactionFlags
+	volatile uint8_t RxCount;	// Bytes read. Written by the driver
+	volatile uint8_t Status;	// I2C_TR_PENDING, I2C_OK, I2C_ERROR_xxx or I2C_TR_ABORTED. Written by the driver
+}I2C_Transaction_t;
+
+#ifndef I2C_QUEUE_SIZE
+#define I2C_QUEUE_SIZE			8		// Queued transactions per bus. Power of 2 (max 128). Can be set from the build options
+#endif
+
+#if ((I2C_QUEUE_SIZE & (I2C_QUEUE_SIZE - 1)) != 0) || (I2C_QUEUE_SIZE > 128)
+#error "I2C_QUEUE_SIZE must be a power of 2 up to 128"
+#endif
+
 // Handle structure for I2Cx Peripheral
 typedef struct{
 	I2C_RegDef_t *pI2Cx;
@@ -30,6 +70,19 @@ typedef struct{
 	uint8_t devAddr;			// To store slave device address
 	uint32_t RxSize;			// To store Rx size
 	uint8_t Sr;					// To repeated start value
+	uint8_t DMATxChannel;		// DMA1 channel serving I2C_TX. Set by I2C_MasterSendDataDMA
+	uint8_t DMARxChannel;		// DMA1 channel serving I2C_RX. Set by I2C_MasterReceiveDataDMA
+	RingBuf_t *pSlaveRxRing;	// Slave Rx bytes are stored here instead of I2C_EV_DATA_RECEIVED. Set by I2C_SlaveSetRxRing
+	GPIO_RegDef_t *pBusGPIOx;	// Port of SCL/SDA for the bus recovery. NULL = default pins of the instance. Set by I2C_SetBusPins
+	uint8_t SCLPin;
+	uint8_t SDAPin;
+	I2C_RecoveryStats_t RecoveryStats;	// Updated by I2C_BusRecovery
+	volatile uint8_t Error;		// I2C_ERROR_xxx of the running IT/DMA transfer. Cleared when a master transfer starts
+	I2C_Transaction_t * volatile pQueue[I2C_QUEUE_SIZE];	// Transaction queue. Only I2C_QueueSubmit writes the slots
+	volatile uint8_t QueueHead;	// Free running write index. Only I2C_QueueSubmit writes it
+	volatile uint8_t QueueTail;	// Free running read index. Only the ISR writes it
+	I2C_Transaction_t * volatile pQueueActive;	// Transaction on the bus. NULL while the queue is not running
+	I2C_Transaction_t *pQueueLast;	// Last finished transaction (I2C_TR_LEN_FROM_PREV)
 }I2C_Handle_t;
 
 /* 							Macros  								*/
@@ -61,13 +114,16 @@ typedef struct{
 #define I2C_EV_STOP				2
 #define I2C_EV_DATA_REQUEST 	3 	// In slave mode
 #define I2C_EV_DATA_RECEIVED	4 	// In slave mode
+#define I2C_EV_BATCH_COMPLETE	5	// Queued transaction without I2C_TR_SR finished (or dropped). Check the Status of the batch
 
-// I2C errors
-#define I2C_ERROR_BERR		0
-#define I2C_ERROR_ARLO		1
-#define I2C_ERROR_AF		2
-#define I2C_ERROR_OVR		3
-#define I2C_ERROR_TIMEOUT	4
+// I2C errors. They share the callback with the events, so the values must not overlap
+#define I2C_ERROR_BERR		8	// The bus has been recovered by the driver (I2C_BusRecovery) before the callback
+#define I2C_ERROR_ARLO		9	// The bus has been recovered by the driver (I2C_BusRecovery) before the callback
+#define I2C_ERROR_AF		10
+#define I2C_ERROR_OVR		11
+#define I2C_ERROR_TIMEOUT	12
+#define I2C_ERROR_DMA		13	// DMA transfer error. The transfer is closed by the driver
+#define I2C_ERROR_BUS_STUCK	14	// The bus recovery could not release SDA/SCL: a slave keeps them low
 
 /*                 Flag related status definitions                  */
 #define I2C_TXE_FLAG 			(1 << I2C_SR1_TXE)
@@ -83,33 +139,151 @@ typedef struct{
 #define I2C_OVR_FLAG			(1 << I2C_SR1_OVR)
 #define I2C_TIMEOUT_FLAG		(1 << I2C_SR1_TIMEOUT)
 
+/*                Blocking API return values                        */
+#define I2C_OK					0
+#define I2C_TIMEOUT				1		// A flag was not set within the deadline. A STOP is requested
+#define I2C_TIMEOUT_DEFAULT_US	25000U	// SMBus limit for a slave holding SCL low
+#define I2C_BUS_STUCK			2		// I2C_BusRecovery could not release the bus
+#define I2C_TIMING_INVALID		3		// No CCR/TRISE for this PCLK1, speed and duty cycle. I2C_Init does nothing
+
+/*                Transaction queue                                 */
+#define I2C_QUEUE_FULL			4		// I2C_QueueSubmit: not enough free slots. Nothing is queued
+#define I2C_QUEUE_INVALID		5		// I2C_QueueSubmit: a transaction without write and read phase
+
+/*                Argument checks                                   */
+#define I2C_INVALID				6		// Invalid argument (DMA length 0, ring refused by RingBuf_Init). Nothing is changed
+
+// Transaction flags @I2C_TransactionFlags
+#define I2C_TR_SR				(1 << 0)	// No STOP at the end: the next transaction starts with a repeated START (same batch)
+#define I2C_TR_LEN_FROM_PREV	(1 << 1)	// Read length = first byte read by the previous transaction, up to RxLen
+
+// Transaction status besides I2C_OK and I2C_ERROR_xxx
+#define I2C_TR_PENDING			0xFF	// Queued or on the bus
+#define I2C_TR_ABORTED			0xFE	// Not run: an earlier transaction of the batch failed
+
+/* Timing solver (RM0008 26.6.8 and 26.6.9). The macros only use their arguments, so with constant arguments
+ * the compiler calculates the register values and I2C_Init is three constant stores:
+ *   static const I2C_Timing_t Timing = I2C_TIMING(36000000U, I2C_CLK_SPEED_FM4K, I2C_FM_DUTYCLYCLE_2);
+ *   I2C_TIMING_ASSERT(36000000U, I2C_CLK_SPEED_FM4K, I2C_FM_DUTYCLYCLE_2, 20000); // Build fails if > 2 %
+ * SCL period = CCR * TPCLK1 * 2 (standard), 3 (fast, Tlow/Thigh = 2) or 25 (fast, 16/9). CCR is rounded
+ * up, so SCL is never faster than requested and Tlow/Thigh stay above their I2C minimum */
+#define I2C_FREQ_MIN_SM			2U		// PCLK1 in MHz
+#define I2C_FREQ_MIN_FM			4U
+#define I2C_FREQ_MAX			36U
+#define I2C_CCR_MIN_SM			4U
+#define I2C_CCR_MIN_FM			1U
+#define I2C_CCR_MAX				0xFFFU
+#define I2C_TRISE_MAX_SM_NS		1000U	// Maximum rise time of SCL
+#define I2C_TRISE_MAX_FM_NS		300U
+
+#define I2C_TIMING_FAST(Speed)				((uint32_t)(Speed) > I2C_CLK_SPEED_SM)
+#define I2C_TIMING_DIV(Speed, Duty)			(I2C_TIMING_FAST(Speed) ? (((Duty) == I2C_FM_DUTYCLYCLE_2) ? 3U : 25U) : 2U)
+#define I2C_TIMING_FREQ(Pclk1)				((uint32_t)(Pclk1) / 1000000U)
+#define I2C_TIMING_CCR(Pclk1, Speed, Duty)	(((uint32_t)(Pclk1) + (I2C_TIMING_DIV(Speed, Duty) * (uint32_t)(Speed)) - 1U) / \
+											 (I2C_TIMING_DIV(Speed, Duty) * (uint32_t)(Speed)))
+#define I2C_TIMING_CCR_REG(Pclk1, Speed, Duty)	(I2C_TIMING_CCR(Pclk1, Speed, Duty) | \
+											 (I2C_TIMING_FAST(Speed) ? ((1U << I2C_CCR_FS) | ((uint32_t)(Duty) << I2C_CCR_DUTY)) : 0U))
+#define I2C_TIMING_TRISE(Pclk1, Speed)		(((I2C_TIMING_FREQ(Pclk1) * \
+											 (I2C_TIMING_FAST(Speed) ? I2C_TRISE_MAX_FM_NS : I2C_TRISE_MAX_SM_NS)) / 1000U) + 1U)
+#define I2C_TIMING_SCL(Pclk1, Speed, Duty)	((uint32_t)(Pclk1) / (I2C_TIMING_DIV(Speed, Duty) * I2C_TIMING_CCR(Pclk1, Speed, Duty)))
+#define I2C_TIMING_ERROR_PPM(Pclk1, Speed, Duty)	((uint32_t)((((uint64_t)(Speed) - I2C_TIMING_SCL(Pclk1, Speed, Duty)) * 1000000U) / (Speed)))
+
+#define I2C_TIMING_VALID(Pclk1, Speed, Duty)	(((uint32_t)(Speed) > 0U) && ((uint32_t)(Speed) <= I2C_CLK_SPEED_FM4K) && \
+		(I2C_TIMING_FREQ(Pclk1) >= (I2C_TIMING_FAST(Speed) ? I2C_FREQ_MIN_FM : I2C_FREQ_MIN_SM)) && \
+		(I2C_TIMING_FREQ(Pclk1) <= I2C_FREQ_MAX) && (I2C_TIMING_CCR(Pclk1, Speed, Duty) <= I2C_CCR_MAX) && \
+		(I2C_TIMING_CCR(Pclk1, Speed, Duty) >= (I2C_TIMING_FAST(Speed) ? I2C_CCR_MIN_FM : I2C_CCR_MIN_SM)))
+
+// Initializer of a I2C_Timing_t
+#define I2C_TIMING(Pclk1, Speed, Duty)		{(Pclk1), I2C_TIMING_SCL(Pclk1, Speed, Duty), (uint16_t)I2C_TIMING_CCR_REG(Pclk1, Speed, Duty), \
+											 (uint8_t)I2C_TIMING_FREQ(Pclk1), (uint8_t)I2C_TIMING_TRISE(Pclk1, Speed)}
+
+// Build time check of a configuration. The error is how much slower than requested SCL runs
+#define I2C_TIMING_ASSERT(Pclk1, Speed, Duty, MaxErrorPpm)	_Static_assert(I2C_TIMING_VALID(Pclk1, Speed, Duty) && \
+		(I2C_TIMING_ERROR_PPM(Pclk1, Speed, Duty) <= (MaxErrorPpm)), "I2C timing: invalid PCLK1/speed/duty cycle or SCL error too large")
+
+// Bus recovery timing: 9 pulses at 100 kHz and the STOP take about 100 us
+#define I2C_RECOVERY_HALF_PERIOD_US		5
+#define I2C_RECOVERY_PULSES				9		// A slave in the middle of a byte needs at most 8 clocks and the ACK
+#define I2C_RECOVERY_STRETCH_US			1000U	// Maximum time a slave can hold SCL low during the recovery
+
+/* Coroutine versions of the IT/DMA master calls (see stm32f1xx_pt.h). The thread yields while another
+ * transfer is running and while its own transfer runs, so a command/length/payload sequence is written
+ * as straight code:
+ *   I2C_PT_MASTER_SEND_IT(pt, &I2C1Handle, &cmd, 1, SLAVE_ADDR, I2C_SR, &status);
+ *   if (status == I2C_OK) I2C_PT_MASTER_RECEIVE_IT(pt, &I2C1Handle, &len, 1, SLAVE_ADDR, I2C_SR, &status);
+ * pStatus points to a uint8_t that is kept between the calls (static or in the thread context). It gets
+ * I2C_OK or the I2C_ERROR_xxx code, or I2C_INVALID when the start call refused the arguments (then the
+ * thread goes on at once). The bus is not locked between transfers: use a PT_Lock_t when several
+ * threads talk on the same bus */
+#define I2C_PT_MASTER(pt, pHandle, Start, pStatus)					\
+	do{																\
+		PT_WAIT_WHILE(pt, I2C_IsBusyState(*(pStatus) = (Start)));	/* Retried while the handle is busy */ \
+		if (*(pStatus) == I2C_READY){								\
+			PT_WAIT_UNTIL(pt, I2C_TransferDone(pHandle, pStatus));	\
+		}															\
+	}while(0)
+
+#define I2C_PT_MASTER_SEND_IT(pt, pHandle, pTxBuffer, len, SlaveAddr, Sr, pStatus)		\
+	I2C_PT_MASTER(pt, pHandle, I2C_MasterSendDataIT(pHandle, pTxBuffer, len, SlaveAddr, Sr), pStatus)
+#define I2C_PT_MASTER_RECEIVE_IT(pt, pHandle, pRxBuffer, len, SlaveAddr, Sr, pStatus)	\
+	I2C_PT_MASTER(pt, pHandle, I2C_MasterReceiveDataIT(pHandle, pRxBuffer, len, SlaveAddr, Sr), pStatus)
+#define I2C_PT_MASTER_SEND_DMA(pt, pHandle, pTxBuffer, len, SlaveAddr, Sr, pStatus)		\
+	I2C_PT_MASTER(pt, pHandle, I2C_MasterSendDataDMA(pHandle, pTxBuffer, len, SlaveAddr, Sr), pStatus)
+#define I2C_PT_MASTER_RECEIVE_DMA(pt, pHandle, pRxBuffer, len, SlaveAddr, Sr, pStatus)	\
+	I2C_PT_MASTER(pt, pHandle, I2C_MasterReceiveDataDMA(pHandle, pRxBuffer, len, SlaveAddr, Sr), pStatus)
+
+// Bit-band view of one SR1 bit (I2C_SR1_xxx). Reads 0/1 with a single load, used in the flag-poll loops
+#define I2C_SR1_BB(pI2Cx, Bit)	BITBAND_PERIPH(&(pI2Cx)->SR1, Bit)
+
 
 /*					APIs Supported by this driver 					*/
 // Enable/Disable peripheral clock
 void I2C_PeriClkCtrl(I2C_RegDef_t *pI2Cx, uint8_t EnOrDi);
 
 // Initialize/De-initialize the I2C
-void I2C_Init(I2C_Handle_t *pI2CxHandle);
+uint8_t I2C_Init(I2C_Handle_t *pI2CxHandle);												// I2C_OK or I2C_TIMING_INVALID
+uint8_t I2C_CalcTiming(uint32_t Pclk1, uint32_t Speed, uint8_t Duty, I2C_Timing_t *pTiming);	// Run time version of I2C_TIMING
 void I2C_DeInit(I2C_RegDef_t *pI2Cx);
 
 // Master send and receive data
-void I2C_MasterSendData(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
-void I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
+uint8_t I2C_MasterSendData(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);		// I2C_OK/I2C_TIMEOUT
+uint8_t I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);	// I2C_OK/I2C_TIMEOUT
 
 //// Master send and receive data with interrupts
 uint8_t I2C_MasterSendDataIT(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
 uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
+
+// Master send and receive data with DMA. The data bytes do not generate I2C interrupts
+uint8_t I2C_MasterSendDataDMA(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
+uint8_t I2C_MasterReceiveDataDMA(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr);
+
+uint8_t I2C_TransferDone(I2C_Handle_t *pI2CxHandle, uint8_t *pStatus);						// 1 when finished. Status: I2C_OK/I2C_ERROR_xxx
+
+// State returned by the IT/DMA master calls: 1 when the call was refused because a transfer is running
+static inline uint8_t I2C_IsBusyState(uint8_t State){
+	return (State == I2C_BUSY_IN_TX) || (State == I2C_BUSY_IN_RX);
+}
+
+// Master transaction queue (interrupts). The ISR chains the transactions without going back to the application
+uint8_t I2C_QueueSubmit(I2C_Handle_t *pI2CxHandle, I2C_Transaction_t *pTransactions, uint8_t Count);	// I2C_OK/I2C_QUEUE_FULL/I2C_QUEUE_INVALID. Thread level only
+
 void I2C_CloseSendData (I2C_Handle_t *pI2CxHandle);
 void I2C_CloseReceiveData (I2C_Handle_t *pI2CxHandle);
 
 void I2C_SlaveSendData(I2C_RegDef_t *pI2Cx, uint8_t data);
 uint8_t I2C_SlaveReceiveData(I2C_RegDef_t *pI2Cx);
+uint8_t I2C_SlaveSetRxRing(I2C_Handle_t *pI2CxHandle, RingBuf_t *pRing);					// NULL = I2C_EV_DATA_RECEIVED per byte. I2C_OK or I2C_INVALID
+
+// Bus recovery
+void I2C_SetBusPins(I2C_Handle_t *pI2CxHandle, GPIO_RegDef_t *pGPIOx, uint8_t SCLPin, uint8_t SDAPin);	// Only needed for non default pins
+uint8_t I2C_BusRecovery(I2C_Handle_t *pI2CxHandle);										// I2C_OK/I2C_BUS_STUCK. Called by the driver on BERR, ARLO and timeouts
 
 // IQR configuration and handling
 void I2C_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);									// To set IRQ Number
 void I2C_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority);							// To set the priority in IRQ
 void I2C_EV_IRQHandling(I2C_Handle_t *pI2CxHandle);
 void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle);
+void I2C_DMA_IRQHandling(I2C_Handle_t *pI2CxHandle);									// To process the DMA channel interrupts
 
 // Other APIs
 void I2C_PeripheralControl(I2C_RegDef_t *pI2Cx, uint8_t EnOrDi);
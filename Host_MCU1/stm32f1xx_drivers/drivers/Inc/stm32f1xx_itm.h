@@ -0,0 +1,60 @@
+/*
+ * stm32f1xx_itm.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// ITM/SWO trace output. Replaces semihosting for printf:
+// - With semihosting every _write stops the core (BKPT) until the debugger has read the text, which
+//   takes milliseconds and changes the timing of the code being debugged. An ITM stimulus port is a
+//   register store: the ITM FIFO and the TPIU send the data on the SWO pin (PB3) while the core runs.
+// - ITM_Init sets the SWO bit rate from the HCLK cached by the RCC driver (TPIU prescaler, NRZ
+//   protocol, no formatter) and enables the ITM. Use the same rate and core clock in the SWV settings
+//   of the debugger.
+// - ITM_Write checks the FIFO ready bit of the port before each store. A full FIFO is waited for
+//   during a few SWO packet times at most; then the rest of the data is dropped and counted, so
+//   nothing blocks when the pin is not being drained. Nothing is written while the port is disabled.
+// - Data goes as 32-bit stimulus writes (4 characters in one 5-byte SWO packet), the tail as
+//   16/8-bit writes.
+// - Built with -DITM_RETARGET, this file also defines _write (stdout and stderr to port 0) and
+//   initialise_monitor_handles (ITM_Init at ITM_SWO_BAUD), so the applications print over SWO without
+//   changes. Link with -specs=nosys.specs instead of -specs=rdimon.specs -lrdimon.
+
+#ifndef INC_STM32F1XX_ITM_H_
+#define INC_STM32F1XX_ITM_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Trace statistics
+typedef struct{
+	uint32_t Written;		// Bytes written to the stimulus ports
+	uint32_t Dropped;		// Bytes lost because the FIFO stayed full
+}ITM_Stats_t;
+
+/* 							Macros  								*/
+#ifndef ITM_SWO_BAUD
+#define ITM_SWO_BAUD			2000000U	// SWO bit rate of ITM_RETARGET. Can be set from the build options
+#endif
+
+#define ITM_SWO_DEBUGGER		0			// ITM_Init argument: keep the TPIU settings written by the debugger
+#define ITM_PORT_STDIO			0			// Port of _write (printf)
+#define ITM_FIFO_WAIT_PACKETS	4			// SWO packet times waited for a full FIFO before dropping
+#define ITM_TRACE_BUS_ID		1			// ATB ID of the ITM trace packets
+
+/*					APIs Supported by this driver 					*/
+uint32_t ITM_Init(uint32_t SWOBaud);											// Returns the SWO bit rate in Hz. Call it again after changing HCLK
+uint32_t ITM_Write(uint8_t Port, const void *pData, uint32_t len);				// Returns the bytes written. Any context
+void ITM_PortControl(uint8_t Port, uint8_t EnOrDi);							// ITM_Init only enables ITM_PORT_STDIO
+void ITM_GetStats(ITM_Stats_t *pStats);
+
+/* The port check is inline: it runs before every write */
+
+// Returns 1 when the ITM and the stimulus port are enabled (by ITM_Init or by the debugger)
+static inline uint8_t ITM_IsEnabled(uint8_t Port){
+	return (ITM->TCR & (1U << ITM_TCR_ITMENA)) && (ITM->TER & (1U << Port));
+}
+
+#endif /* INC_STM32F1XX_ITM_H_ */
@@ -0,0 +1,109 @@
+/*
+ * stm32f1xx_log.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// Deferred binary logging. A log site does not format anything: the text is rebuilt on the PC by
+// Tools/log_decode.py from the ELF file of the application:
+// - The format string of LOG/LOG_DATA is placed in the log_fmt section. The linker script puts it at
+//   address 0 as an INFO section: it is kept in the ELF file but not loaded in the flash. The record
+//   only stores its offset in the section (format ID).
+// - A record is a header word (format ID, number of words), the DWT cycle counter and the arguments
+//   as 32-bit words. It is stored in a RAM ring of words. Like the deferred work queue, the space is
+//   reserved with a compare and swap on Head and the header is stored last, so LOG can be used from
+//   any ISR without disabling interrupts.
+// - LOG_Process sends the stored records to the output (ITM port LOG_ITM_PORT, a USART by DMA or a
+//   file written by semihosting) from the idle loop. Only whole records are released.
+// - The arguments are integers and pointers. %s only works with pointers to constant strings in the
+//   flash (read from the ELF file); use LOG_DATA for bytes in RAM. %f is not supported.
+
+#ifndef INC_STM32F1XX_LOG_H_
+#define INC_STM32F1XX_LOG_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Output function. Sends up to len bytes of the ring and returns how many are done with (sent or
+// copied). Returning less than len (0 while busy) makes LOG_Process give the rest again later
+typedef uint32_t (*LOG_Output_t)(void *pContext, const uint8_t *pData, uint32_t len);
+
+// Logging statistics
+typedef struct{
+	uint32_t Records;		// Records stored
+	uint32_t Dropped;		// Records lost because the ring was full
+	uint32_t MaxWords;		// Most words waiting at the same time. Size the ring with it
+}LOG_Stats_t;
+
+/* 							Macros  								*/
+#ifndef LOG_RING_WORDS
+#define LOG_RING_WORDS			256		// Power of 2. Can be set from the build options
+#endif
+
+#if (LOG_RING_WORDS & (LOG_RING_WORDS - 1)) != 0
+#error "LOG_RING_WORDS must be a power of 2"
+#endif
+
+#define LOG_FMT_SECTION			"log_fmt"	// Not loaded section of the format strings
+#define LOG_ITM_PORT			1			// Stimulus port of LOG_OutputITM. Port 0 stays for printf
+#define LOG_MAX_ARGS			6
+#define LOG_DATA_MAX			128			// Bytes kept by LOG_DATA
+
+// Record header: format ID (bits 31:8), marker (bit 7, never 0 in a stored header), data record
+// (bit 6, the arguments are a length and bytes), number of argument words (bits 5:0)
+#define LOG_HDR_ID				8
+#define LOG_HDR_MARKER			(1U << 7)
+#define LOG_HDR_DATA			(1U << 6)
+#define LOG_HDR_WORDS_MASK		0x3FU
+#define LOG_RECORD_WORDS		2			// Header and timestamp
+
+/*                LOG_Write return values                           */
+#define LOG_OK					0
+#define LOG_FULL				1	// Ring full, the record was dropped
+
+// Argument count (0 to LOG_MAX_ARGS) and conversion to 32-bit words. More arguments do not compile
+// (LOG_MAP_TOO_MANY_ARGS)
+#define LOG_NARGS(...)			LOG_NARGS_(0, ##__VA_ARGS__, TOO_MANY_ARGS, TOO_MANY_ARGS, TOO_MANY_ARGS, TOO_MANY_ARGS, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(z, a, b, c, d, e, f, g, h, i, j, n, ...)	n
+#define LOG_CAT(a, b)			LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)			a##b
+#define LOG_W(x)				((uint32_t)(uintptr_t)(x))
+#define LOG_MAP_0()
+#define LOG_MAP_1(a)					LOG_W(a)
+#define LOG_MAP_2(a, b)					LOG_W(a), LOG_W(b)
+#define LOG_MAP_3(a, b, c)				LOG_W(a), LOG_W(b), LOG_W(c)
+#define LOG_MAP_4(a, b, c, d)			LOG_W(a), LOG_W(b), LOG_W(c), LOG_W(d)
+#define LOG_MAP_5(a, b, c, d, e)		LOG_W(a), LOG_W(b), LOG_W(c), LOG_W(d), LOG_W(e)
+#define LOG_MAP_6(a, b, c, d, e, f)		LOG_W(a), LOG_W(b), LOG_W(c), LOG_W(d), LOG_W(e), LOG_W(f)
+
+// Defines the format string of a log site in the log_fmt section
+#define LOG_FMT(fmt)			static const char LOG_Fmt[] __attribute__((section(LOG_FMT_SECTION), used)) = fmt
+
+// Logs a format string and up to LOG_MAX_ARGS integer/pointer arguments. Any context
+#define LOG(fmt, ...)	do{ \
+		LOG_FMT(fmt); \
+		const uint32_t LOG_Args[LOG_NARGS(__VA_ARGS__) + 1] = {LOG_CAT(LOG_MAP_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)}; \
+		LOG_Write(LOG_Fmt, LOG_Args, LOG_NARGS(__VA_ARGS__)); \
+	}while(0)
+
+// Logs a copy of up to LOG_DATA_MAX bytes, printed by the first %s of the format. Any context
+#define LOG_DATA(fmt, pData, len)	do{ \
+		LOG_FMT(fmt); \
+		LOG_WriteData(LOG_Fmt, (pData), (len)); \
+	}while(0)
+
+/*					APIs Supported by this driver 					*/
+void LOG_Init(LOG_Output_t pOutput, void *pContext);								// Empties the ring and starts the DWT timestamps
+uint8_t LOG_Write(const char *pFmt, const uint32_t *pArgs, uint32_t nArgs);			// Used by LOG. Returns LOG_OK/LOG_FULL
+uint8_t LOG_WriteData(const char *pFmt, const void *pData, uint32_t len);			// Used by LOG_DATA. Returns LOG_OK/LOG_FULL
+uint32_t LOG_Process(void);															// Single consumer (idle loop). Returns the words still waiting
+void LOG_GetStats(LOG_Stats_t *pStats);
+
+// Outputs
+uint32_t LOG_OutputITM(void *pContext, const uint8_t *pData, uint32_t len);			// Context not used. Call ITM_Init first
+uint32_t LOG_OutputUSART(void *pContext, const uint8_t *pData, uint32_t len);		// Context: USART_Handle_t, only used by the log
+uint32_t LOG_OutputFile(void *pContext, const uint8_t *pData, uint32_t len);		// Context: FILE opened "wb" (semihosting on the board)
+
+#endif /* INC_STM32F1XX_LOG_H_ */
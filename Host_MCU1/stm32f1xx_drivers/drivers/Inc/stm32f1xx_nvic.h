@@ -0,0 +1,89 @@
+/*
+ * stm32f1xx_nvic.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// Nested vectored interrupt controller. All the peripheral drivers configure their IRQs through it:
+// - ISER/ICER/ISPR/ICPR are write-1 registers: a plain store of the IRQ bit only touches that IRQ, and
+//   it cannot undo a change done by an interrupt between a read and a write.
+// - Each IRQ has its own priority byte (IP), so a priority is changed with one byte store. Only the
+//   upper NO_PR_BITS_IMPLEMENTED bits of the byte exist.
+// - PRIGROUP (SCB AIRCR) splits the 4 priority bits into a preempt priority (an interrupt only
+//   interrupts a handler with a higher preempt value) and a sub-priority (order of the pending ones).
+
+#ifndef INC_STM32F1XX_NVIC_H_
+#define INC_STM32F1XX_NVIC_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+/* 							Macros  								*/
+// Priority grouping @NVIC_PriorityGroup. Preempt bits . sub-priority bits of the 4 implemented bits
+#define NVIC_PRIGROUP_4_0		3	// 16 preempt levels, no sub-priority. Same split as the reset value
+#define NVIC_PRIGROUP_3_1		4	// 8 preempt levels, 2 sub-priorities
+#define NVIC_PRIGROUP_2_2		5	// 4 preempt levels, 4 sub-priorities
+#define NVIC_PRIGROUP_1_3		6	// 2 preempt levels, 8 sub-priorities
+#define NVIC_PRIGROUP_0_4		7	// No preemption, 16 sub-priorities
+
+#define NVIC_PRIO_SHIFT			(8 - NO_PR_BITS_IMPLEMENTED)	// Position of the priority in the IP byte
+#define NVIC_PRIO_LOWEST		((1U << NO_PR_BITS_IMPLEMENTED) - 1)
+
+/*					APIs Supported by this driver 					*/
+// Priority grouping
+void NVIC_SetPriorityGrouping(uint8_t PriorityGroup);										// @NVIC_PriorityGroup
+uint8_t NVIC_GetPriorityGrouping(void);
+
+// Priority value (0-15) from preempt priority and sub-priority, and back
+uint8_t NVIC_EncodePriority(uint8_t PriorityGroup, uint8_t PreemptPriority, uint8_t SubPriority);
+void NVIC_DecodePriority(uint8_t Priority, uint8_t PriorityGroup, uint8_t *pPreemptPriority, uint8_t *pSubPriority);
+
+// Enable/Disable an IRQ
+void NVIC_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);
+
+/* Single register accesses are inline: they are used from handlers and critical sections */
+
+static inline void NVIC_EnableIRQ(uint8_t IRQNumber){
+	NVIC->ISER[IRQNumber >> 5] = (1U << (IRQNumber & 0x1F));
+}
+
+static inline void NVIC_DisableIRQ(uint8_t IRQNumber){
+	NVIC->ICER[IRQNumber >> 5] = (1U << (IRQNumber & 0x1F));
+}
+
+// Returns 1 when the IRQ is enabled
+static inline uint8_t NVIC_GetEnableIRQ(uint8_t IRQNumber){
+	return (NVIC->ISER[IRQNumber >> 5] >> (IRQNumber & 0x1F)) & 1;
+}
+
+// Software trigger. The handler runs as if the peripheral had requested it
+static inline void NVIC_SetPendingIRQ(uint8_t IRQNumber){
+	NVIC->ISPR[IRQNumber >> 5] = (1U << (IRQNumber & 0x1F));
+}
+
+// A peripheral that still holds its line pends the IRQ again
+static inline void NVIC_ClearPendingIRQ(uint8_t IRQNumber){
+	NVIC->ICPR[IRQNumber >> 5] = (1U << (IRQNumber & 0x1F));
+}
+
+static inline uint8_t NVIC_GetPendingIRQ(uint8_t IRQNumber){
+	return (NVIC->ISPR[IRQNumber >> 5] >> (IRQNumber & 0x1F)) & 1;
+}
+
+// Returns 1 while the handler runs, also when it has been preempted
+static inline uint8_t NVIC_GetActive(uint8_t IRQNumber){
+	return (NVIC->IABR[IRQNumber >> 5] >> (IRQNumber & 0x1F)) & 1;
+}
+
+// Priority 0 (highest) to NVIC_PRIO_LOWEST. Use NVIC_EncodePriority to build it from preempt/sub-priority
+static inline void NVIC_SetPriority(uint8_t IRQNumber, uint8_t Priority){
+	NVIC->IP[IRQNumber] = (uint8_t)((Priority & NVIC_PRIO_LOWEST) << NVIC_PRIO_SHIFT);
+}
+
+static inline uint8_t NVIC_GetPriority(uint8_t IRQNumber){
+	return NVIC->IP[IRQNumber] >> NVIC_PRIO_SHIFT;
+}
+
+#endif /* INC_STM32F1XX_NVIC_H_ */
@@ -0,0 +1,93 @@
+/*
+ * stm32f1xx_pt.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// Stackless coroutines (protothreads). A transaction sequence is written as straight code and the thread
+// returns (yields) where it has to wait, so several threads share main() without an RTOS:
+// - A thread is a function that returns PT_WAITING/PT_YIELDED/PT_ENDED. main() calls all of them in a loop.
+// - The thread keeps one resume point in its PT_t. PT_BEGIN is a switch on it and every wait is a case
+//   label, so the next call jumps back to the wait that returned.
+// - Local variables are not kept between calls: anything used after a wait must be static or live in
+//   the context of the thread. A switch cannot be used between PT_BEGIN and PT_END.
+// - Resume points are numbered with __COUNTER__, so a macro can contain several waits (the I2C_PT_xxx and
+//   SPI_PT_xxx driver calls).
+
+#ifndef INC_STM32F1XX_PT_H_
+#define INC_STM32F1XX_PT_H_
+
+#include <stdint.h> // Generic module: no register access
+
+// Thread state
+typedef struct{
+	uint16_t Resume;	// Resume point. 0 = start of the thread
+}PT_t;
+
+// Cooperative lock (bus shared by several threads). Only threads use it, never the ISRs
+typedef struct{
+	uint8_t Locked;
+}PT_Lock_t;
+
+/* 							Macros  								*/
+// Thread return values
+#define PT_WAITING		0
+#define PT_YIELDED		1
+#define PT_EXITED		2
+#define PT_ENDED		3
+
+// Thread declaration: PT_THREAD(App_Read(PT_t *pt))
+#define PT_THREAD(name_args)		uint8_t name_args
+
+#define PT_INIT(pt)					((pt)->Resume = 0)
+
+#define PT_BEGIN(pt)				{ uint8_t PT_YieldFlag = 1; (void)PT_YieldFlag; switch ((pt)->Resume){ case 0:
+
+#define PT_END(pt)					} PT_YieldFlag = 0; (void)PT_YieldFlag; PT_INIT(pt); return PT_ENDED; }
+
+// A resume point. Id is a constant different from 0 and from the other points of the thread. The code
+// before it falls through to its case label on purpose (-Wimplicit-fallthrough)
+#define PT_RESUME_POINT(pt, Id)		(pt)->Resume = (Id); __attribute__((fallthrough)); case (Id):
+
+#define PT_WAIT_UNTIL_ID(pt, Condition, Id)	\
+	do{										\
+		PT_RESUME_POINT(pt, Id)				\
+		if (!(Condition)){					\
+			return PT_WAITING;				\
+		}									\
+	}while(0)
+
+// Returns to the caller until the condition is true. The condition is checked again in each call
+#define PT_WAIT_UNTIL(pt, Condition)		PT_WAIT_UNTIL_ID(pt, Condition, __COUNTER__ + 1)
+#define PT_WAIT_WHILE(pt, Condition)		PT_WAIT_UNTIL(pt, !(Condition))
+
+#define PT_YIELD_ID(pt, Id)					\
+	do{										\
+		PT_YieldFlag = 0;					\
+		PT_RESUME_POINT(pt, Id)				\
+		if (PT_YieldFlag == 0){				\
+			return PT_YIELDED;				\
+		}									\
+	}while(0)
+
+// Returns to the caller once, so the other threads can run
+#define PT_YIELD(pt)						PT_YIELD_ID(pt, __COUNTER__ + 1)
+
+// Runs a child thread until it ends. The child thread has its own PT_t
+#define PT_WAIT_THREAD(pt, Thread)			PT_WAIT_WHILE(pt, PT_SCHEDULE(Thread))
+#define PT_SPAWN(pt, pChild, Thread)		do{ PT_INIT(pChild); PT_WAIT_THREAD(pt, Thread); }while(0)
+
+// Ends the thread now. PT_RESTART runs it again from PT_BEGIN in the next call
+#define PT_EXIT(pt)							do{ PT_INIT(pt); return PT_EXITED; }while(0)
+#define PT_RESTART(pt)						do{ PT_INIT(pt); return PT_WAITING; }while(0)
+
+// 1 while the thread has not ended
+#define PT_SCHEDULE(Thread)					((Thread) < PT_EXITED)
+
+// Lock shared by several threads. PT_LOCK waits while another thread holds it
+#define PT_LOCK_INIT(pLock)					((pLock)->Locked = 0)
+#define PT_LOCK(pt, pLock)					do{ PT_WAIT_UNTIL(pt, (pLock)->Locked == 0); (pLock)->Locked = 1; }while(0)
+#define PT_UNLOCK(pLock)					((pLock)->Locked = 0)
+
+#endif /* INC_STM32F1XX_PT_H_ */
@@ -0,0 +1,120 @@
+/*
+ * stm32f1xx_rcc.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+#ifndef INC_STM32F1XX_RCC_H_
+#define INC_STM32F1XX_RCC_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Peripheral descriptor. One constant entry per peripheral, see RCC_PeriDesc in stm32f1xx_rcc.c
+typedef struct{
+	uint8_t EnReg;		// Word index of the clock enable register in RCC_RegDef_t. Possible values @RCC_Reg. 0 = unknown peripheral
+	uint8_t RstReg;		// Word index of the reset register in RCC_RegDef_t. Possible values @RCC_Reg. 0 = no reset bit
+	uint8_t Bit;		// Bit in both registers (the enable and reset bits of a peripheral are in the same position)
+	uint8_t IRQ[2];		// IRQ numbers (I2C: event and error, DMA1: channel 1). RCC_NO_IRQ if not used
+	uint8_t Code;		// GPIO: port code for AFIO_EXTICR. Other peripherals: instance number
+}RCC_PeriDesc_t;
+
+// Configuration structure for the clock tree (RCC_ClockConfig)
+typedef struct{
+	uint8_t RCC_SysClkSource;	// Possible values @RCC_SysClk
+	uint8_t RCC_PLLSource;		// Possible values @RCC_PLLSource. Only used with RCC_SYSCLK_PLL
+	uint8_t RCC_PLLMul;			// 2-16. Only used with RCC_SYSCLK_PLL
+	uint8_t RCC_AHBPrescaler;	// Possible values @RCC_AHBPrescaler
+	uint8_t RCC_APB1Prescaler;	// Possible values @RCC_APBPrescaler. PCLK1 must not exceed 36 MHz
+	uint8_t RCC_APB2Prescaler;	// Possible values @RCC_APBPrescaler
+}RCC_ClkConfig_t;
+
+// Bus clocks in Hz. Kept by the driver and updated each time the clock tree changes
+typedef struct{
+	uint32_t SYSCLK;
+	uint32_t HCLK;		// AHB, core, DMA and DWT->CYCCNT
+	uint32_t PCLK1;		// APB1: I2C, SPI2/3, USART2-5
+	uint32_t PCLK2;		// APB2: GPIO, SPI1, USART1
+}RCC_Clocks_t;
+
+/* 							Macros  								*/
+// RCC registers @RCC_Reg (word index in RCC_RegDef_t)
+#define RCC_REG_APB2RSTR		3
+#define RCC_REG_APB1RSTR		4
+#define RCC_REG_AHBENR			5
+#define RCC_REG_APB2ENR			6
+#define RCC_REG_APB1ENR			7
+
+#define RCC_NO_IRQ				0xFF
+
+// System clock source @RCC_SysClk (CFGR SW field)
+#define RCC_SYSCLK_HSI			0
+#define RCC_SYSCLK_HSE			1
+#define RCC_SYSCLK_PLL			2
+
+// PLL input @RCC_PLLSource
+#define RCC_PLLSRC_HSI_DIV2		0
+#define RCC_PLLSRC_HSE			1
+#define RCC_PLLSRC_HSE_DIV2		2
+
+// AHB prescaler @RCC_AHBPrescaler (CFGR HPRE field)
+#define RCC_AHB_DIV_1			0
+#define RCC_AHB_DIV_2			8
+#define RCC_AHB_DIV_4			9
+#define RCC_AHB_DIV_8			10
+#define RCC_AHB_DIV_16			11
+#define RCC_AHB_DIV_64			12
+#define RCC_AHB_DIV_128			13
+#define RCC_AHB_DIV_256			14
+#define RCC_AHB_DIV_512			15
+
+// APB1/APB2 prescaler @RCC_APBPrescaler (CFGR PPRE1/PPRE2 fields)
+#define RCC_APB_DIV_1			0
+#define RCC_APB_DIV_2			4
+#define RCC_APB_DIV_4			5
+#define RCC_APB_DIV_8			6
+#define RCC_APB_DIV_16			7
+
+// Limits of the STM32F103
+#define RCC_SYSCLK_MAX			72000000U
+#define RCC_PCLK1_MAX			36000000U
+
+// Flash wait states: one more every 24 MHz of SYSCLK (RM0008 3.3.3)
+#define RCC_FLASH_WS_STEP		24000000U
+
+// Return values of RCC_ClockConfig
+#define RCC_OK					0
+#define RCC_ERROR				1	// Configuration out of the limits of the MCU. Nothing is changed
+#define RCC_TIMEOUT				2	// An oscillator or the PLL did not start. SYSCLK is left on the previous source
+
+#define RCC_STARTUP_TIMEOUT		0x5000U	// Polls of the ready flags before giving up
+
+// Oscillators
+#define HSI_VALUE				8000000U	// Internal RC oscillator
+#ifndef HSE_VALUE
+#define HSE_VALUE				8000000U	// External crystal (Blue Pill). Can be defined by the build
+#endif
+
+/* Table index of a peripheral. Each peripheral takes 1 KB, so bits [14:10] of the base address give the
+ * position on its bus. Bit 16 (APB2) and bit 17 (AHB) give the bus: APB1 0-31, APB2 32-63, AHB 64-95 */
+#define RCC_PERI_SLOT(addr)		(((((uint32_t)(uintptr_t)(addr)) >> 10) & 0x1F) | ((((uint32_t)(uintptr_t)(addr)) >> 11) & 0x60))
+
+/*					APIs Supported by this driver 					*/
+const RCC_PeriDesc_t *RCC_GetPeriDesc(const volatile void *pPeriph);		// NULL if the peripheral is not in the table
+void RCC_PeriClkCtrl(const volatile void *pPeriph, uint8_t EnOrDi);			// Enable/Disable the peripheral clock
+void RCC_PeriReset(const volatile void *pPeriph);							// Reset all the registers of the peripheral
+
+// Clock tree
+uint8_t RCC_ClockConfig(const RCC_ClkConfig_t *pClkConfig);					// RCC_OK, RCC_ERROR or RCC_TIMEOUT
+uint8_t RCC_SetSysClk72MHz(void);											// HSE 8 MHz x 9, APB1 = 36 MHz, APB2 = 72 MHz
+void RCC_UpdateClocks(void);												// Reload the cache from the registers. Only needed after writing CFGR by hand
+
+// Cached bus clocks in Hz. The registers are only read the first time
+uint32_t RCC_GetSYSCLKValue(void);
+uint32_t RCC_GetHCLKValue(void);											// Also the core and DWT->CYCCNT clock
+uint32_t RCC_GetPCLK1Value(void);
+uint32_t RCC_GetPCLK2Value(void);
+
+#endif /* INC_STM32F1XX_RCC_H_ */
@@ -0,0 +1,80 @@
+/*
+ * stm32f1xx_ringbuf.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// Single producer / single consumer byte ring buffer. Used to move data from an ISR to main() (or back)
+// without disabling interrupts:
+// - Head is only written by the producer and Tail only by the consumer.
+// - The indexes are free running 16-bit counters. The size is a power of 2, so the position in the
+//   buffer is (index & Mask) and (Head - Tail) is the number of bytes, even after a wrap around.
+// - The data is stored before Head is updated, and read before Tail is updated. The buffer and the
+//   indexes are volatile, so the compiler keeps that order, and the Cortex-M3 core does not reorder
+//   its own loads and stores, so no barrier instruction is needed.
+
+#ifndef INC_STM32F1XX_RINGBUF_H_
+#define INC_STM32F1XX_RINGBUF_H_
+
+#include <stdint.h> // Generic module: no register access
+#include <stddef.h> // NULL
+
+// Ring buffer structure
+typedef struct{
+	volatile uint8_t	*pBuffer;	// Storage. Its size is Mask + 1 bytes
+	uint16_t			Mask;		// Size - 1
+	volatile uint16_t	Head;		// Free running write index. Only the producer writes it
+	volatile uint16_t	Tail;		// Free running read index. Only the consumer writes it
+	volatile uint32_t	Dropped;	// Bytes lost because the ring was full. Only the producer writes it
+}RingBuf_t;
+
+/* 							Macros  								*/
+// RingBuf_Init return values
+#define RINGBUF_OK			0
+#define RINGBUF_INVALID		1	// Size 0 or not a power of 2. The ring has no storage (pBuffer = NULL)
+
+/*					APIs Supported by this driver 					*/
+uint8_t RingBuf_Init(RingBuf_t *pRing, uint8_t *pBuffer, uint16_t size);			// size must be a power of 2 (up to 32768)
+uint32_t RingBuf_Write(RingBuf_t *pRing, const uint8_t *pData, uint32_t len);		// Producer. Returns the bytes stored
+uint32_t RingBuf_Read(RingBuf_t *pRing, uint8_t *pData, uint32_t len);				// Consumer. Returns the bytes copied
+void RingBuf_Flush(RingBuf_t *pRing);												// Consumer. Discards the stored bytes
+
+/* The single byte functions are inline: they are the fast path of the ISRs */
+
+// Number of bytes stored. Safe from both sides
+static inline uint32_t RingBuf_Count(RingBuf_t *pRing){
+	return (uint16_t)(pRing->Head - pRing->Tail);
+}
+
+// Number of free bytes. Safe from both sides
+static inline uint32_t RingBuf_Space(RingBuf_t *pRing){
+	return (uint32_t)pRing->Mask + 1 - (uint16_t)(pRing->Head - pRing->Tail);
+}
+
+// Producer. Returns 1 if the byte was stored, 0 if the ring was full (the byte is counted in Dropped)
+static inline uint8_t RingBuf_Put(RingBuf_t *pRing, uint8_t data){
+	uint16_t head = pRing->Head;
+
+	if ((uint16_t)(head - pRing->Tail) > pRing->Mask){
+		pRing->Dropped++;
+		return 0;
+	}
+	pRing->pBuffer[head & pRing->Mask] = data;
+	pRing->Head = head + 1; // Published after the store
+	return 1;
+}
+
+// Consumer. Returns 1 if a byte was read, 0 if the ring was empty
+static inline uint8_t RingBuf_Get(RingBuf_t *pRing, uint8_t *pData){
+	uint16_t tail = pRing->Tail;
+
+	if (pRing->Head == tail){
+		return 0;
+	}
+	*pData = pRing->pBuffer[tail & pRing->Mask];
+	pRing->Tail = tail + 1; // Released after the load
+	return 1;
+}
+
+#endif /* INC_STM32F1XX_RINGBUF_H_ */
@@ -0,0 +1,101 @@
+/*
+ * stm32f1xx_sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains the host register simulator data. Only used when built with -DSTM32F1_HOST_SIM
+
+#ifndef INC_STM32F1XX_SIM_H_
+#define INC_STM32F1XX_SIM_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+#ifdef STM32F1_HOST_SIM
+
+/*
+ * How the simulator works
+ * - The peripheral (0x40000000) and core (0xE0000000) address windows are mapped at their real addresses
+ *   with no access rights, so the *_BASEADDR macros and the drivers are used without changes.
+ * - The bit-band alias of the peripherals (0x42000000) is mapped too. An alias access is run as an access
+ *   to the bit of the real register.
+ * - Every register access traps. The access is single stepped and then the behavioral model of the
+ *   peripheral runs: TXE/RXNE/BTF/SB/ADDR flag sequencing, RCC clock gating and reset bits, EXTI pending
+ *   bits, USART frames, DMA1 channels, NVIC enable/pending registers, PendSV...
+ * - Enabled and pending interrupts are delivered after the access that raised them by calling the
+ *   application IRQHandler with the same name used in the startup file.
+ * - Transfers complete instantly. The time the bus would have needed is accumulated in the statistics.
+ * Linux x86-64 only. Host build example:
+ * gcc -std=gnu11 -DSTM32F1_HOST_SIM -Idrivers/Inc drivers/Src/stm32f1xx_*.c Src/<app>.c -o app
+ */
+
+// Simulated SPI slave: receives the MOSI frame and returns the MISO frame
+typedef uint16_t (*SIM_SPIDevice_t)(void *pContext, uint16_t MOSI);
+
+// Simulated device on the TX line of a USART: receives each frame sent by the MCU
+typedef void (*SIM_USARTDevice_t)(void *pContext, uint16_t Data);
+
+// Simulated SWO receiver: gets each stimulus port write (Size = 1, 2 or 4 bytes, little endian)
+typedef void (*SIM_ITMDevice_t)(void *pContext, uint8_t Port, uint32_t Data, uint8_t Size);
+
+// Simulated I2C slave. Any callback can be NULL
+typedef struct{
+	uint8_t (*Start)(void *pContext, uint8_t Read);		// Address matched. Return 1 to ACK, 0 to NACK
+	uint8_t (*Write)(void *pContext, uint8_t Data);		// Byte written by the master. Return 1 to ACK, 0 to NACK
+	uint8_t (*Read)(void *pContext);					// Byte requested by the master
+	void	(*Stop)(void *pContext);					// STOP condition
+}SIM_I2CDevice_t;
+
+// Simulation statistics
+typedef struct{
+	uint64_t RegReads;			// Register reads done by the code under test
+	uint64_t RegWrites;			// Register writes done by the code under test
+	uint64_t DroppedWrites;		// Writes ignored because the peripheral clock was disabled
+	uint64_t IRQs;				// Interrupt handlers executed
+	uint32_t MaxIRQNesting;		// Deepest handler nesting seen (1 = no preemption)
+	uint64_t BusTime_ns;		// Time the SPI/I2C/USART/SWO lines would have needed for the transfers
+}SIM_Stats_t;
+
+#define SIM_MAX_I2C_DEVICES		4 // Simulated slaves per I2C bus
+
+/*					APIs Supported by the simulator 					*/
+
+// Start/Reset the simulator. SIM_Init runs automatically before main
+void SIM_Init(void);
+void SIM_Reset(void);													// Reset values in all registers, devices detached
+
+// External world
+void SIM_GPIO_SetInputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t value);	// Drive a pin from outside
+void SIM_SPI_AttachDevice(SPI_RegDef_t *pSPIx, SIM_SPIDevice_t Device, void *pContext);	// NULL device = MOSI looped to MISO
+void SIM_I2C_AttachDevice(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, const SIM_I2CDevice_t *pDevice, void *pContext);
+
+// External master talking to the MCU in I2C slave mode. Return the number of bytes transferred
+uint32_t SIM_I2C_MasterWrite(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, const uint8_t *pTxBuffer, uint32_t len);
+uint32_t SIM_I2C_MasterRead(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, uint8_t *pRxBuffer, uint32_t len);
+void SIM_I2C_SetError(I2C_RegDef_t *pI2Cx, uint8_t Flag);								// Bus error, arbitration lost... on the lines
+
+// USART1-3. Frames arrive at once, the line time is accumulated in BusTime_ns
+void SIM_USART_AttachDevice(USART_RegDef_t *pUSARTx, SIM_USARTDevice_t Device, void *pContext);	// NULL device = frames discarded
+uint32_t SIM_USART_Receive(USART_RegDef_t *pUSARTx, const uint8_t *pRxBuffer, uint32_t len);	// Frames to RX, then idle line. Returns the frames stored
+void SIM_USART_SetError(USART_RegDef_t *pUSARTx, uint8_t Flag);							// PE, FE, NE or ORE
+
+// ITM stimulus ports (SWO). The FIFO is always ready, the SWO time is accumulated in BusTime_ns
+void SIM_ITM_AttachDevice(SIM_ITMDevice_t Device, void *pContext);
+
+// DMA. Used by DMA_MEM_ADDR: CMAR cannot hold a 64-bit host pointer
+uint32_t SIM_DMA_MemAddr(const volatile void *pMem);
+
+// Interrupts
+void SIM_IRQPoll(void);													// Deliver pending interrupts from loops that never touch a register
+void SIM_SetPRIMASK(uint8_t Masked);									// IRQ_DISABLE/IRQ_ENABLE
+uint8_t SIM_GetPRIMASK(void);											// IRQ_SAVE_DISABLE
+void SIM_WaitForInterrupt(void);										// WFI: the host sleeps until an interrupt can be taken
+
+// Statistics
+void SIM_GetStats(SIM_Stats_t *pStats);
+void SIM_ResetStats(void);
+
+#endif /* STM32F1_HOST_SIM */
+
+#endif /* INC_STM32F1XX_SIM_H_ */
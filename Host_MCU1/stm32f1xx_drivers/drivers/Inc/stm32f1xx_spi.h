@@ -27,10 +27,15 @@ typedef struct{
 	SPI_Config_t	SPI_Config; // Holds pin configuration settings
 	uint8_t 		*pTxBuffer; // To store the app Tx Buffer address
 	uint8_t 		*pRxBuffer; // To store the app Rx Buffer address
-	uint8_t 		TxLen;		// To store Tx length
-	uint8_t 		RxLen;		// To store Rx Length
+	uint32_t 		TxLen;		// To store Tx length
+	uint32_t 		RxLen;		// To store Rx Length
 	uint8_t 		TxState;	// To store Tx State
 	uint8_t 		RxState;	// To store Rx State
+	uint8_t			DMATxChannel;	// DMA1 channel serving SPI_TX. Set by SPI_TransferDMA
+	uint8_t			DMARxChannel;	// DMA1 channel serving SPI_RX. Set by SPI_TransferDMA
+	RingBuf_t		*pRxRing;		// Rx ring used by SPI_TransferData_Inter. Set by SPI_SetRxRing
+	volatile uint8_t	RxRingStalled;	// Set by the ISR when the ring is full. Cleared by SPI_RxRingRead
+	uint8_t			FrameSize;		// Bytes per frame (1 or 2) of the running transfer
 }SPI_Handle_t;
 
 /* 							Macros  								*/
@@ -53,6 +58,9 @@ typedef struct{
 #define SPI_SCLK_SPEED_DIV_128			6
 #define SPI_SCLK_SPEED_DIV_256			7
 
+// Fastest SCK of the STM32F103 SPI (datasheet fSCK). Used by SPI_CalcBaudRate as upper limit
+#define SPI_SCLK_MAX					18000000U
+
 // Data frame format @SPI_DFF
 #define SPI_DFF_8BITS					0
 #define SPI_DFF_16BITS					1
@@ -74,15 +82,50 @@ typedef struct{
 #define SPI_RXE_FLAG					(1 << SPI_SR_RXNE)
 #define SPI_BUSY_FLAG					(1 << SPI_SR_BSY)
 
+/*                Blocking API return values                        */
+#define SPI_OK							0
+#define SPI_TIMEOUT						1	// A flag was not set within the deadline
+#define SPI_TIMEOUT_DEFAULT_US			1000U	// A 16-bit frame at the slowest clock (8 MHz PCLK/256) takes 512 us
+
+/* Coroutine versions of the interrupt/DMA calls (see stm32f1xx_pt.h). The thread yields while the handle
+ * is busy with another transfer and while its own transfer runs:
+ *   SPI_PT_TRANSFER_DMA(pt, &SPI1Handle, cmd, NULL, 2, &status);
+ *   if (status == SPI_READY) SPI_PT_TRANSFER_DMA(pt, &SPI1Handle, NULL, answer, len, &status);
+ * pStatus points to a uint8_t that is kept between the calls (static or in the thread context). It gets
+ * SPI_READY when the transfer has run, or the refusal of the start call (SPI_DMA_NOT_AVAILABLE,
+ * SPI_INVALID); then the thread goes on at once. Transfer errors are still reported through
+ * SPI_ApplicationEventCallback. The slave select is not handled: use a PT_Lock_t when several threads
+ * use the same bus */
+#define SPI_PT_CALL(pt, pHandle, Start, pStatus)						\
+	do{																\
+		PT_WAIT_WHILE(pt, SPI_IsBusyState(*(pStatus) = (Start)));	/* Retried while the handle is busy */ \
+		if (*(pStatus) == SPI_READY){								\
+			PT_WAIT_UNTIL(pt, SPI_TransferDone(pHandle));			\
+		}															\
+	}while(0)
+
+#define SPI_PT_SEND_IT(pt, pHandle, pTxBuffer, len, pStatus)				SPI_PT_CALL(pt, pHandle, SPI_SendData_Inter(pHandle, pTxBuffer, len), pStatus)
+#define SPI_PT_RECEIVE_IT(pt, pHandle, pRxBuffer, len, pStatus)			SPI_PT_CALL(pt, pHandle, SPI_ReceiveData_Inter(pHandle, pRxBuffer, len), pStatus)
+#define SPI_PT_TRANSFER_DMA(pt, pHandle, pTxBuffer, pRxBuffer, len, pStatus)	SPI_PT_CALL(pt, pHandle, SPI_TransferDMA(pHandle, pTxBuffer, pRxBuffer, len), pStatus)
+
+// Bit-band view of one SR bit (SPI_SR_xxx). Reads 0/1 with a single load, used in the flag-poll loops
+#define SPI_SR_BB(pSPIx, Bit)			BITBAND_PERIPH(&(pSPIx)->SR, Bit)
+
 /*                 Interrupt related definitions                    */
 #define SPI_READY 						0
 #define SPI_BUSY_IN_RX					1
 #define SPI_BUSY_IN_TX					2
+#define SPI_DMA_NOT_AVAILABLE			3	// SPI3 requests are served by DMA2 (high-density devices only)
+#define SPI_INVALID						4	// Length 0, odd with 16-bit frames, over 65535 frames (DMA) or no Rx ring (Inter)
 
 /*                Possible SPI Application Events                   */
 #define SPI_EVENT_TX_COMPLETE			1
 #define SPI_EVENT_RX_COMPLETE			2
 #define SPI_EVENT_OVR_COMPLETE			3
+#define SPI_EVENT_DMA_HALF				4
+#define SPI_EVENT_DMA_COMPLETE			5
+#define SPI_EVENT_DMA_ERROR				6
+#define SPI_EVENT_TXRX_COMPLETE			7
 
 /*					APIs Supported by this driver 					*/
 // Enable/Disable peripheral clock
@@ -93,11 +136,32 @@ void SPI_Init(SPI_Handle_t *pSPIxHandle);
 void SPI_DeInit(SPI_RegDef_t *pSPIx);
 
 // Data send and receive
-void SPI_SendData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint32_t len);
-void SPI_ReceiveData(SPI_RegDef_t *pSPIx, uint8_t *pRxBuffer, uint32_t len);
+// Blocking calls return SPI_OK or SPI_TIMEOUT
+uint8_t SPI_SendData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint32_t len);
+uint8_t SPI_ReceiveData(SPI_RegDef_t *pSPIx, uint8_t *pRxBuffer, uint32_t len);
+uint8_t SPI_TransferData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint8_t *pRxBuffer, uint32_t len);	// Full-duplex. NULL Tx = send 0xFF, NULL Rx = discard
+void SPI_SetTimeout(uint32_t Timeout_us);													// Deadline of the blocking calls for each frame
+
+// Baud rate from the bus clock cached by the RCC driver (SPI1: PCLK2, SPI2/3: PCLK1)
+uint8_t SPI_CalcBaudRate(SPI_RegDef_t *pSPIx, uint32_t MaxSCLK_Hz, uint32_t *pSCLK_Hz);	// Returns @SPI_SCLKSpeed. pSCLK_Hz can be NULL
+uint32_t SPI_SetBaudRate(SPI_Handle_t *pSPIxHandle, uint32_t MaxSCLK_Hz);					// Applies it. Returns the achieved SCK in Hz
+uint32_t SPI_GetSCLKValue(SPI_RegDef_t *pSPIx);											// SCK in Hz from CR1 BR
 
 uint8_t SPI_SendData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pTxBuffer, uint32_t len);
 uint8_t SPI_ReceiveData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pRxBuffer, uint32_t len);
+uint8_t SPI_TransferData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pTxBuffer, uint32_t len);	// Full-duplex. Received data goes to the Rx ring
+
+// Rx ring buffer of the full-duplex interrupt mode (the ISR is the producer)
+uint8_t SPI_SetRxRing(SPI_Handle_t *pSPIHandle, RingBuf_t *pRing);							// SPI_OK or SPI_INVALID
+uint32_t SPI_RxRingRead(SPI_Handle_t *pSPIHandle, uint8_t *pBuffer, uint32_t len);			// Returns the number of bytes copied
+
+uint8_t SPI_TransferDMA(SPI_Handle_t *pSPIHandle, uint8_t *pTxBuffer, uint8_t *pRxBuffer, uint32_t len);	// NULL Tx = Rx only, NULL Rx = Tx only
+uint8_t SPI_TransferDone(SPI_Handle_t *pSPIHandle);										// 1 when no transfer is running in either direction
+
+// State returned by the non blocking calls: 1 when the call was refused because a transfer is running
+static inline uint8_t SPI_IsBusyState(uint8_t State){
+	return (State == SPI_BUSY_IN_TX) || (State == SPI_BUSY_IN_RX);
+}
 
 // Interrupt handling
 // void SPI_InterHandler(SPI_Handle_t *pSPIHandle, uint8_t InterType);
@@ -106,6 +170,7 @@ uint8_t SPI_ReceiveData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pRxBuffer, uint
 void SPI_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);									// To set IRQ Number
 void SPI_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority);							// To set the priority in IRQ
 void SPI_IRQHandling(SPI_Handle_t *pSPIxHandle);										// To process interrupt
+void SPI_DMA_IRQHandling(SPI_Handle_t *pSPIxHandle);									// To process the DMA channel interrupts
 
 // Other APIs
 void SPI_PeripheralControl(SPI_RegDef_t *pSPIx, uint8_t EnOrDi);
@@ -115,6 +180,8 @@ uint8_t SPI_GetFlagStatus(SPI_RegDef_t *pSPIx, uint32_t FlagName);
 void SPI_ClearOVRFlag(SPI_RegDef_t *pSPIx);
 void SPI_CloseTransmission(SPI_Handle_t *pSPIxHandle);
 void SPI_CloseReception(SPI_Handle_t *pSPIxHandle);
+void SPI_CloseDMA(SPI_Handle_t *pSPIxHandle);
+void SPI_CloseTransfer(SPI_Handle_t *pSPIxHandle);
 
 // Application callback
 void SPI_ApplicationEventCallback (SPI_Handle_t *pSPIxHandle, uint8_t AppEv);
@@ -0,0 +1,80 @@
+/*
+ * stm32f1xx_spibus.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// SPI bus manager. Several slaves with different modes share one SPI master:
+// - Each device keeps the CR1 mode bits it needs (CPOL, CPHA, DFF and the prescaler for its fastest
+//   SCK). They are calculated once by SPIBus_AddDevice.
+// - The bus keeps a copy of CR1. SPIBus_Select compares it with the device bits and only writes CR1
+//   when they differ: no SPI_Init, no clock enable and no read of CR1. Two devices with the same mode
+//   cost the chip select store only.
+// - The chip select is a GPIO output (active low) driven with one store to BRR/BSRR. The NSS pin of the
+//   SPI is not used (software slave management).
+
+#ifndef INC_STM32F1XX_SPIBUS_H_
+#define INC_STM32F1XX_SPIBUS_H_
+
+#include "stm32f103xx.h" // MCU specific header file. Not included by it: the inline select needs the SPI and GPIO drivers
+
+// Device configuration for SPIBus_AddDevice
+typedef struct{
+	uint8_t			SPI_CPOL;		// @SPI_CPOL
+	uint8_t			SPI_CPHA;		// @SPI_CPHA
+	uint8_t			SPI_DFF;		// @SPI_DFF
+	uint32_t		MaxSCLK_Hz;		// Fastest SCK of the device. The prescaler comes from SPI_CalcBaudRate
+	GPIO_RegDef_t	*pCSPort;		// Chip select port. NULL = no chip select (only device on the bus)
+	uint8_t			CSPin;			// Chip select pin. Active low
+}SPIBus_DeviceConfig_t;
+
+// Device on the bus. Filled by SPIBus_AddDevice
+typedef struct{
+	GPIO_RegDef_t	*pCSPort;
+	uint16_t		CSPinMask;		// GPIO_PIN_MASK of the chip select
+	uint16_t		CR1;			// Mode bits of the device (SPIBUS_CR1_MODE_MASK)
+}SPIBus_Device_t;
+
+// Bus
+typedef struct{
+	SPI_Handle_t	*pSPIHandle;	// Master handle. Configured by SPIBus_Init
+	const SPIBus_Device_t *pSelected;	// Device with the chip select low. NULL = none
+	uint16_t		CR1;			// Copy of CR1, so a select never reads the register
+	uint32_t		Reconfigs;		// Selects that had to write CR1 (statistic)
+}SPIBus_t;
+
+/* 							Macros  								*/
+// CR1 bits that change from device to device
+#define SPIBUS_CR1_MODE_MASK	((1U << SPI_CR1_CPHA) | (1U << SPI_CR1_CPOL) | (0x7U << SPI_CR1_BR) | (1U << SPI_CR1_DFF))
+
+/*					APIs Supported by this driver 					*/
+void SPIBus_Init(SPIBus_t *pBus, SPI_Handle_t *pSPIHandle);								// Master, full-duplex, software NSS. pSPIx must be set
+uint32_t SPIBus_AddDevice(SPIBus_t *pBus, SPIBus_Device_t *pDevice, const SPIBus_DeviceConfig_t *pConfig);	// Returns the SCK of the device in Hz
+uint8_t SPIBus_Deselect(SPIBus_t *pBus);												// Waits for the last frame, then CS high. SPI_OK or SPI_TIMEOUT
+
+/* Select is inline: it runs before every transaction */
+
+// Switches the bus to the mode of the device and pulls its chip select low. Call it with the bus idle
+// (after SPIBus_Deselect). Same mode: one store (CS). Other mode: two more stores to CR1, because
+// CPOL, CPHA, BR and DFF must not change while SPE = 1 (RM0008 25.5.1): SPE is cleared first
+static inline void SPIBus_Select(SPIBus_t *pBus, const SPIBus_Device_t *pDevice){
+
+	uint16_t diff = (pBus->CR1 ^ pDevice->CR1) & SPIBUS_CR1_MODE_MASK;
+
+	if (diff != 0){
+		pBus->pSPIHandle->pSPIx->CR1 = pBus->CR1 & ~(1U << SPI_CR1_SPE);
+		pBus->CR1 ^= diff;
+		pBus->pSPIHandle->pSPIx->CR1 = pBus->CR1;
+		pBus->Reconfigs++;
+	}
+
+	if (pDevice->pCSPort != NULL){
+		GPIO_ResetPins(pDevice->pCSPort, pDevice->CSPinMask);
+	}
+	pBus->pSelected = pDevice;
+}
+
+#endif /* INC_STM32F1XX_SPIBUS_H_ */
@@ -0,0 +1,70 @@
+/*
+ * stm32f1xx_systick.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// SysTick time base. Replaces the delay() busy loops of the applications:
+// - SysTick_Init programs the tick from the HCLK cached by the RCC driver, so the time does not depend
+//   on the clock tree or on the compiler flags. The handler counts the ticks in 64 bits: the time
+//   never wraps around.
+// - SysTick_GetTimeUs adds the part of the current tick read from the counter, so it has the
+//   resolution of one HCLK cycle, not of one tick.
+// - SysTick_DelayUs/Ms sleep in WFI until the last tick of the delay, then wait the rest with the
+//   counter. Interrupts keep running during a delay.
+// - Software timers (one shot or periodic) call their function from the SysTick handler. Keep the
+//   callbacks short or post the work with Defer_Post.
+// - Tickless idle: SysTick_Idle reloads the counter with several ticks at once (up to 2^24 cycles,
+//   233 ms at 72 MHz) so the core sleeps until the next timer instead of waking up on every tick.
+//   When another interrupt wakes it up earlier, the ticks that passed are counted and the tick is
+//   restarted where it was. Each tickless period loses the few cycles the counter is stopped.
+
+#ifndef INC_STM32F1XX_SYSTICK_H_
+#define INC_STM32F1XX_SYSTICK_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Software timer function. Runs in the SysTick handler
+typedef void (*SysTick_Callback_t)(void *pContext);
+
+// Software timer. Owned by the application, linked by the driver while it runs
+typedef struct SysTick_Timer{
+	struct SysTick_Timer *pNext;	// Next timer to expire. Written by the driver
+	uint64_t			Expiry;		// Tick of the next call. Written by the driver
+	uint32_t			Period;		// Ticks between calls. 0 = one shot
+	SysTick_Callback_t	pCallback;
+	void				*pContext;
+	volatile uint8_t	Active;		// 1 while the timer is linked
+}SysTick_Timer_t;
+
+/* 							Macros  								*/
+#ifndef SYSTICK_TICK_HZ
+#define SYSTICK_TICK_HZ			1000U	// Ticks per second. Must divide 1000000. Can be set from the build options
+#endif
+
+#if (1000000U % SYSTICK_TICK_HZ) != 0
+#error "SYSTICK_TICK_HZ must divide 1000000"
+#endif
+
+#define SYSTICK_US_PER_TICK		(1000000U / SYSTICK_TICK_HZ)
+
+/*                SysTick_Init return values                        */
+#define SYSTICK_OK				0
+#define SYSTICK_INVALID			1	// HCLK / SYSTICK_TICK_HZ does not fit the 24-bit counter
+
+/*					APIs Supported by this driver 					*/
+uint8_t SysTick_Init(void);															// Call it again after changing HCLK: the time goes on
+void SysTick_IRQPriority(uint32_t IRQPriority);										// 0-15 (NVIC_PRIO_x). Resets to 0 (highest)
+uint64_t SysTick_GetTicks(void);
+uint64_t SysTick_GetTimeUs(void);													// Microseconds since the first SysTick_Init
+void SysTick_DelayUs(uint32_t Delay_us);											// Sleeps in WFI. DWT busy wait if SysTick is not running
+void SysTick_DelayMs(uint32_t Delay_ms);
+void SysTick_TimerStart(SysTick_Timer_t *pTimer, uint32_t Delay_ms, uint32_t Period_ms, SysTick_Callback_t pCallback, void *pContext);	// Period 0 = one shot
+void SysTick_TimerStop(SysTick_Timer_t *pTimer);
+void SysTick_Idle(void);															// Idle loop. Tickless sleep until the next timer or interrupt
+void SysTick_IRQHandling(void);														// Called by SysTick_Handler
+
+#endif /* INC_STM32F1XX_SYSTICK_H_ */
@@ -0,0 +1,133 @@
+/*
+ * stm32f1xx_usart.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// This header file contains driver specific data
+
+// USART driver. The data moves by DMA in both directions, so the CPU does no work per byte:
+// - Tx: USART_SendDMA hands the buffer to the DMA channel and returns. The TC interrupt (last stop bit
+//   out of the shift register) closes the transfer and reports USART_EVENT_TX_COMPLETE.
+// - Rx: USART_StartRxDMA runs the Rx channel in circular mode over a buffer of the application. The
+//   IDLE interrupt (one frame time without start bit after the last byte) and the DMA half/complete
+//   interrupts deliver the bytes that arrived since the last delivery to USART_RxDataCallback. The
+//   callback gets a pointer into the buffer, so the data is not copied either.
+// - The baud rate divider comes from the bus clock cached by the RCC driver (USART1: PCLK2, the
+//   others: PCLK1). Oversampling is 16, so the fastest rate is PCLK/16: 4.5 Mbaud on USART1 and
+//   2.25 Mbaud on USART2/3 with the 72 MHz clock tree.
+
+#ifndef INC_STM32F1XX_USART_H_
+#define INC_STM32F1XX_USART_H_
+
+#include "stm32f103xx.h" // MCU specific header file
+
+// Configuration structure for a USARTx Peripheral
+typedef struct{
+	uint32_t USART_Baud;			// Bits per second. The divider is calculated by USART_Init
+	uint8_t  USART_Mode;			// @USART_Mode
+	uint8_t  USART_WordLength;		// @USART_WordLength
+	uint8_t  USART_StopBits;		// @USART_StopBits
+	uint8_t  USART_Parity;			// @USART_Parity
+	uint8_t  USART_HWFlowControl;	// @USART_HWFlowControl
+}USART_Config_t;
+
+// Handle structure for USARTx Peripheral
+typedef struct{
+	USART_RegDef_t	*pUSARTx;		// Pointer to hold the base address of the USARTx (1,2,3) or UARTx (4,5)
+	USART_Config_t	USART_Config;
+	volatile uint8_t TxState;		// USART_READY or USART_BUSY_IN_TX
+	uint8_t			RxState;		// USART_READY or USART_BUSY_IN_RX
+	uint8_t			DMATxChannel;	// DMA1 channel serving USART_TX. Set by USART_SendDMA
+	uint8_t			DMARxChannel;	// DMA1 channel serving USART_RX. Set by USART_StartRxDMA
+	uint8_t			*pRxBuffer;		// Circular Rx buffer
+	uint16_t		RxSize;			// Length of the Rx buffer
+	uint16_t		RxPos;			// Index of the first byte not delivered yet
+}USART_Handle_t;
+
+/* 							Macros  								*/
+// Transfer directions @USART_Mode
+#define USART_MODE_TX					1
+#define USART_MODE_RX					2
+#define USART_MODE_TXRX					3
+
+// Frame length, parity bit included @USART_WordLength. The DMA APIs move bytes: 9 data bits without
+// parity are not supported
+#define USART_WORDLEN_8BITS				0
+#define USART_WORDLEN_9BITS				1
+
+// Stop bits @USART_StopBits (CR2 STOP field)
+#define USART_STOPBITS_1				0
+#define USART_STOPBITS_0_5				1
+#define USART_STOPBITS_2				2
+#define USART_STOPBITS_1_5				3
+
+// Parity @USART_Parity. With parity and 8 data bits use USART_WORDLEN_9BITS
+#define USART_PARITY_NONE				0
+#define USART_PARITY_EVEN				1
+#define USART_PARITY_ODD				2
+
+// Hardware flow control @USART_HWFlowControl
+#define USART_HW_FLOW_CTRL_NONE			0
+#define USART_HW_FLOW_CTRL_CTS			1
+#define USART_HW_FLOW_CTRL_RTS			2
+#define USART_HW_FLOW_CTRL_CTS_RTS		3
+
+// Smallest BRR value: USARTDIV = 1 (mantissa 1, fraction 0)
+#define USART_BRR_MIN					16U
+
+/*                 Flag related status definitions                  */
+#define USART_TXE_FLAG					(1 << USART_SR_TXE)
+#define USART_TC_FLAG					(1 << USART_SR_TC)
+#define USART_RXNE_FLAG					(1 << USART_SR_RXNE)
+#define USART_IDLE_FLAG					(1 << USART_SR_IDLE)
+#define USART_ERROR_FLAGS				((1 << USART_SR_PE) | (1 << USART_SR_FE) | (1 << USART_SR_NE) | (1 << USART_SR_ORE))
+
+/*                 Interrupt related definitions                    */
+#define USART_READY						0
+#define USART_BUSY_IN_RX				1
+#define USART_BUSY_IN_TX				2
+#define USART_DMA_NOT_AVAILABLE			3	// UART4/5 requests are served by DMA2 (high-density devices only)
+#define USART_INVALID					4	// Empty buffer, or longer than a DMA transfer (65535 bytes)
+
+/*                Possible USART Application Events                 */
+#define USART_EVENT_TX_COMPLETE			1
+#define USART_EVENT_DMA_ERROR			2	// The channel was disabled by a bus error. The transfer is closed
+#define USART_EVENT_ERR_PE				3	// Parity error
+#define USART_EVENT_ERR_FE				4	// Framing error (break or wrong baud rate)
+#define USART_EVENT_ERR_NE				5	// Noise error
+#define USART_EVENT_ERR_ORE				6	// Overrun: a byte was lost
+
+/*					APIs Supported by this driver 					*/
+// Enable/Disable peripheral clock
+void USART_PeriClkCtrl(USART_RegDef_t *pUSARTx, uint8_t EnOrDi);
+
+// Initialize/De-initialize the USART
+void USART_Init(USART_Handle_t *pUSARTHandle);
+void USART_DeInit(USART_RegDef_t *pUSARTx);
+
+// Baud rate from the bus clock cached by the RCC driver (USART1: PCLK2, the others: PCLK1)
+uint16_t USART_CalcBRR(USART_RegDef_t *pUSARTx, uint32_t Baud, uint32_t *pBaud);			// Returns the BRR value. pBaud (achieved rate) can be NULL
+uint32_t USART_GetBaudValue(USART_RegDef_t *pUSARTx);										// Rate in bits per second from BRR
+
+// Data send and receive
+uint8_t USART_SendDMA(USART_Handle_t *pUSARTHandle, const uint8_t *pTxBuffer, uint32_t len);	// USART_READY = started
+uint8_t USART_StartRxDMA(USART_Handle_t *pUSARTHandle, uint8_t *pRxBuffer, uint32_t len);	// Circular. Runs until USART_StopRxDMA
+void USART_StopRxDMA(USART_Handle_t *pUSARTHandle);											// Delivers what is left, then stops
+
+// IQR configuration and handling
+void USART_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi);									// To set IRQ Number
+void USART_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority);							// To set the priority in IRQ
+void USART_IRQHandling(USART_Handle_t *pUSARTHandle);										// To process interrupt
+void USART_DMA_IRQHandling(USART_Handle_t *pUSARTHandle);									// To process the DMA channel interrupts
+
+// Other APIs
+void USART_PeripheralControl(USART_RegDef_t *pUSARTx, uint8_t EnOrDi);
+uint8_t USART_GetFlagStatus(USART_RegDef_t *pUSARTx, uint32_t FlagName);
+
+// Application callbacks
+void USART_ApplicationEventCallback (USART_Handle_t *pUSARTHandle, uint8_t AppEv);
+void USART_RxDataCallback (USART_Handle_t *pUSARTHandle, const uint8_t *pData, uint16_t len, uint8_t FrameEnd);	// FrameEnd = 1: the line went idle after these bytes
+
+#endif /* INC_STM32F1XX_USART_H_ */
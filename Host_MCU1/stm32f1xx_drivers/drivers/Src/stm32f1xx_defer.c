@@ -0,0 +1,142 @@
+/*
+ * stm32f1xx_defer.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_defer.h"
+
+#define DEFER_QUEUE_MASK		(DEFER_QUEUE_SIZE - 1)
+
+static Defer_Work_t Queue[DEFER_QUEUE_SIZE];
+static volatile uint32_t Head;	// Next slot to reserve. Written by the producers with a compare and swap
+static volatile uint32_t Tail;	// Next slot to run. Only written by Defer_Run
+static Defer_Stats_t Stats;
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			Defer_Init (Deferred work initialization)
+ * @brief			This functions empties the queue and gives PendSV the lowest priority
+ * @param [in]		None
+ * @return			None
+ * @note 			PendSV resets to priority 0. At the lowest priority the deferred work never delays
+ * 					an interrupt, and it runs as soon as the last ISR returns (tail chaining)
+ */
+void Defer_Init(void){
+
+	*SCB_ICSR = (1U << SCB_ICSR_PENDSVCLR);
+
+	for (uint32_t i = 0; i < DEFER_QUEUE_SIZE; i++){
+		Queue[i].pFunc = NULL;
+	}
+	Head = 0;
+	Tail = 0;
+	Stats.Posted = 0;
+	Stats.Dropped = 0;
+	Stats.MaxDepth = 0;
+
+	*SCB_SHPR3 = (*SCB_SHPR3 & ~(0xFFU << SCB_SHPR3_PENDSV)) | ((NVIC_PRIO_LOWEST << NVIC_PRIO_SHIFT) << SCB_SHPR3_PENDSV);
+}
+
+/******************************************************************
+ * @func			Defer_Post (Deferred work post)
+ * @brief			This functions queues a function call and pends PendSV
+ * @param [in]		Function
+ * @param [in]		Context passed to the function
+ * @param [in]		Argument passed to the function
+ * @return			DEFER_OK, DEFER_FULL or DEFER_INVALID
+ * @note 			O(1), no interrupt masking. The compare and swap only repeats when a higher
+ * 					priority ISR reserved a slot in between
+ */
+uint8_t Defer_Post(Defer_Func_t pFunc, void *pContext, uint32_t Arg){
+
+	uint32_t head, tail;
+	uint32_t depth;
+	Defer_Work_t *pWork;
+
+	if (pFunc == NULL){
+		return DEFER_INVALID;
+	}
+
+	do{
+		tail = Tail; // Read before Head: the consumer cannot pass a Head read after it
+		head = Head;
+		depth = head - tail;
+		if (depth >= DEFER_QUEUE_SIZE){
+			__atomic_fetch_add(&Stats.Dropped, 1, __ATOMIC_RELAXED);
+			return DEFER_FULL;
+		}
+	} while (!__atomic_compare_exchange_n(&Head, &head, head + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	pWork = &Queue[head & DEFER_QUEUE_MASK];
+	pWork->pContext = pContext;
+	pWork->Arg = Arg;
+	__atomic_store_n(&pWork->pFunc, pFunc, __ATOMIC_RELEASE); // Published after the context and argument
+
+	__atomic_fetch_add(&Stats.Posted, 1, __ATOMIC_RELAXED);
+	if (depth + 1 > Stats.MaxDepth){
+		Stats.MaxDepth = depth + 1; // Statistic only: a lost update between ISRs is not important
+	}
+
+	*SCB_ICSR = (1U << SCB_ICSR_PENDSVSET);
+	return DEFER_OK;
+}
+
+/******************************************************************
+ * @func			Defer_Run (Deferred work run)
+ * @brief			This functions runs the queued work in order
+ * @param [in]		None
+ * @return			None
+ * @note 			Single consumer: only called from PendSV_Handler. The slot is freed before the
+ * 					call, so the function can post more work (it runs in the same pass)
+ */
+void Defer_Run(void){
+
+	uint32_t tail = Tail;
+	Defer_Work_t *pWork;
+	Defer_Func_t pFunc;
+	void *pContext;
+	uint32_t arg;
+
+	while (1){
+		pWork = &Queue[tail & DEFER_QUEUE_MASK];
+		pFunc = __atomic_load_n(&pWork->pFunc, __ATOMIC_ACQUIRE);
+		if (pFunc == NULL){
+			break; // Empty, or the producer has not published the slot yet
+		}
+		pContext = pWork->pContext;
+		arg = pWork->Arg;
+		pWork->pFunc = NULL;
+		Tail = ++tail; // Released after the slot is read and cleared
+
+		pFunc(pContext, arg);
+	}
+}
+
+/******************************************************************
+ * @func			Defer_GetStats (Deferred work get statistics)
+ * @brief			This functions copies the queue statistics
+ * @param [out]		Statistics
+ * @return			None
+ * @note 			None
+ */
+void Defer_GetStats(Defer_Stats_t *pStats){
+
+	pStats->Posted = Stats.Posted;
+	pStats->Dropped = Stats.Dropped;
+	pStats->MaxDepth = Stats.MaxDepth;
+}
+
+/******************************************************************
+ * @func			PendSV_Handler
+ * @brief			This functions is the PendSV exception handler (name used in the startup file)
+ * @param [in]		None
+ * @return			None
+ * @note 			Replaces the weak default handler of the startup file
+ */
+void PendSV_Handler(void){
+
+	Defer_Run();
+}
@@ -0,0 +1,242 @@
+/*
+ * stm32f1xx_dma.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_dma.h"
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			DMA_PeriClkCtrl (DMA Peripheral Clock Control)
+ * @brief			This functions enables or disables peripheral clock for the given DMA
+ * @param [in]		Base Address of the DMA Peripheral
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			Only DMA1 exists in the STM32F103x8
+ */
+void DMA_PeriClkCtrl(DMA_RegDef_t *pDMAx, uint8_t EnOrDi){
+
+	RCC_PeriClkCtrl(pDMAx, EnOrDi);
+}
+
+/******************************************************************
+ * @func			DMA_Init (DMA Initialization)
+ * @brief			This functions configures a DMA channel
+ * @param [in]		DMA Handle
+ * @return			None
+ * @note 			The channel is left disabled. DMA_Start loads the addresses and enables it
+ */
+void DMA_Init(DMA_Handle_t *pDMAHandle){
+
+	DMA_Channel_RegDef_t *pCh = &pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1];
+	uint32_t temp = 0;
+
+	// Enable clock
+	DMA_PeriClkCtrl(pDMAHandle->pDMAx, ENABLE);
+
+	// The configuration can only be changed while the channel is disabled
+	pCh->CCR &= ~(1 << DMA_CCR_EN);
+
+	temp |= (pDMAHandle->DMA_Config.DMA_Direction << DMA_CCR_DIR);
+	temp |= (pDMAHandle->DMA_Config.DMA_Mode << DMA_CCR_CIRC);
+	temp |= (pDMAHandle->DMA_Config.DMA_MemInc << DMA_CCR_MINC);
+	temp |= (pDMAHandle->DMA_Config.DMA_PeriSize << DMA_CCR_PSIZE);
+	temp |= (pDMAHandle->DMA_Config.DMA_MemSize << DMA_CCR_MSIZE);
+	temp |= (pDMAHandle->DMA_Config.DMA_Priority << DMA_CCR_PL);
+
+	pCh->CCR = temp;
+
+	DMA_ClearFlag(pDMAHandle->pDMAx, pDMAHandle->Channel, DMA_GIF_FLAG);
+}
+
+/******************************************************************
+ * @func			DMA_DeInit (DMA De-initialization)
+ * @brief			This functions puts a DMA channel back to its reset state
+ * @param [in]		DMA Handle
+ * @return			None
+ * @note 			DMA1 has no reset bit in RCC, so the channel registers are cleared one by one
+ */
+void DMA_DeInit(DMA_Handle_t *pDMAHandle){
+
+	DMA_Channel_RegDef_t *pCh = &pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1];
+
+	pCh->CCR = 0;
+	pCh->CNDTR = 0;
+	pCh->CPAR = 0;
+	pCh->CMAR = 0;
+
+	DMA_ClearFlag(pDMAHandle->pDMAx, pDMAHandle->Channel, DMA_GIF_FLAG);
+}
+
+/******************************************************************
+ * @func			DMA_Start (DMA Start transfer)
+ * @brief			This functions loads the addresses and the length and enables the channel
+ * @param [in]		DMA Handle
+ * @param [in]		Peripheral register address (e.g. &SPI1->DR)
+ * @param [in]		Memory buffer
+ * @param [in]		Number of items to transfer (1-65535). Item size = DMA_PeriSize
+ * @return			None
+ * @note 			The transfer starts with the first request of the peripheral
+ */
+void DMA_Start(DMA_Handle_t *pDMAHandle, volatile void *pPeriAddr, void *pMemAddr, uint16_t len){
+
+	DMA_Channel_RegDef_t *pCh = &pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1];
+
+	pCh->CCR &= ~(1 << DMA_CCR_EN);
+
+	// Flags from the previous transfer would trigger the interrupt right away
+	DMA_ClearFlag(pDMAHandle->pDMAx, pDMAHandle->Channel, DMA_GIF_FLAG);
+
+	pCh->CPAR = (uint32_t)(uintptr_t)pPeriAddr;
+	pCh->CMAR = DMA_MEM_ADDR(pMemAddr);
+	pCh->CNDTR = len;
+
+	pCh->CCR |= (1 << DMA_CCR_EN);
+}
+
+/******************************************************************
+ * @func			DMA_Stop (DMA Stop transfer)
+ * @brief			This functions disables a DMA channel
+ * @param [in]		DMA Handle
+ * @return			None
+ * @note 			CNDTR keeps the number of items that were not transferred
+ */
+void DMA_Stop(DMA_Handle_t *pDMAHandle){
+
+	pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1].CCR &= ~(1 << DMA_CCR_EN);
+}
+
+/******************************************************************
+ * @func			DMA_GetRemaining (DMA Get remaining items)
+ * @brief			This functions returns the number of items still to be transferred
+ * @param [in]		DMA Handle
+ * @return			CNDTR value
+ * @note 			None
+ */
+uint16_t DMA_GetRemaining(DMA_Handle_t *pDMAHandle){
+
+	return (uint16_t)pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1].CNDTR;
+}
+
+/******************************************************************
+ * @func			DMA_InterruptControl (DMA Interrupt Control)
+ * @brief			This functions enables or disables the interrupts of a DMA channel
+ * @param [in]		DMA Handle
+ * @param [in]		DMA_TCIF_FLAG, DMA_HTIF_FLAG and/or DMA_TEIF_FLAG
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			The ISR flags and the CCR enable bits use the same positions (1-3)
+ */
+void DMA_InterruptControl(DMA_Handle_t *pDMAHandle, uint32_t Interrupts, uint8_t EnOrDi){
+
+	DMA_Channel_RegDef_t *pCh = &pDMAHandle->pDMAx->CH[pDMAHandle->Channel - 1];
+
+	Interrupts &= (DMA_TCIF_FLAG | DMA_HTIF_FLAG | DMA_TEIF_FLAG);
+
+	if (EnOrDi == ENABLE){
+		pCh->CCR |= Interrupts;
+	} else {
+		pCh->CCR &= ~Interrupts;
+	}
+}
+
+/******************************************************************
+ * @func			DMA_IRQConfig (DMA IRQ Configuration)
+ * @brief			This functions enables or disables an IRQ in the NVIC
+ * @param [in]		IQR Number
+ * @param [in]		Enable or disable
+ * @return			None
+ * @note 			Done by the NVIC driver: one store to ISER/ICER, the other IRQs are not touched
+ */
+void DMA_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
+
+	NVIC_IRQConfig(IRQNumber, EnOrDi);
+}
+
+/******************************************************************
+ * @func			DMA_IRQPriority (DMA IRQ Priority)
+ * @brief			This functions sets the priority of an IRQ
+ * @param [in]		IRQ Number
+ * @param [in]		IRQ Priority (0-15). See NVIC_EncodePriority for preempt/sub-priority
+ * @return			None
+ * @note 			The old priority is replaced with one byte store
+ */
+void DMA_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority){
+
+	NVIC_SetPriority(IRQNumber, (uint8_t)IRQPriority);
+}
+
+/******************************************************************
+ * @func			DMA_IRQHandling (DMA IRQ Handling)
+ * @brief			This functions checks which event triggered the channel interrupt
+ * @param [in]		DMA Handle
+ * @return			None
+ * @note 			Each flag is cleared before the application is notified. A transfer error
+ * 					disables the channel (done by hardware)
+ */
+void DMA_IRQHandling(DMA_Handle_t *pDMAHandle){
+
+	DMA_RegDef_t *pDMAx = pDMAHandle->pDMAx;
+	uint8_t channel = pDMAHandle->Channel;
+	uint32_t ccr = pDMAx->CH[channel - 1].CCR;
+
+	// Check transfer error
+	if ((ccr & (1 << DMA_CCR_TEIE)) && DMA_GetFlagStatus(pDMAx, channel, DMA_TEIF_FLAG)){
+		DMA_ClearFlag(pDMAx, channel, DMA_GIF_FLAG);
+		DMA_ApplicationEventCallback(pDMAHandle, DMA_ERROR_TRANSFER);
+		return;
+	}
+
+	// Check half transfer
+	if ((ccr & (1 << DMA_CCR_HTIE)) && DMA_GetFlagStatus(pDMAx, channel, DMA_HTIF_FLAG)){
+		DMA_ClearFlag(pDMAx, channel, DMA_HTIF_FLAG);
+		DMA_ApplicationEventCallback(pDMAHandle, DMA_EVENT_HALF_COMPLETE);
+	}
+
+	// Check transfer complete
+	if ((ccr & (1 << DMA_CCR_TCIE)) && DMA_GetFlagStatus(pDMAx, channel, DMA_TCIF_FLAG)){
+		DMA_ClearFlag(pDMAx, channel, DMA_TCIF_FLAG);
+		DMA_ApplicationEventCallback(pDMAHandle, DMA_EVENT_COMPLETE);
+	}
+}
+
+/******************************************************************
+ * @func			DMA_GetFlagStatus (DMA get flag status)
+ * @brief			This functions reads a flag of a DMA channel
+ * @param [in]		Base Address of the DMA
+ * @param [in]		Channel (1-7)
+ * @param [in]		Requested flag
+ * @return			FLAG_SET/FLAG_RESET
+ * @note 			None
+ */
+uint8_t DMA_GetFlagStatus(DMA_RegDef_t *pDMAx, uint8_t Channel, uint32_t FlagName){
+
+	if (pDMAx->ISR & (FlagName << (4 * (Channel - 1)))){
+		return FLAG_SET;
+	}
+
+	return FLAG_RESET;
+}
+
+/******************************************************************
+ * @func			DMA_ClearFlag (DMA clear flag)
+ * @brief			This functions clears flags of a DMA channel
+ * @param [in]		Base Address of the DMA
+ * @param [in]		Channel (1-7)
+ * @param [in]		Flags to clear. DMA_GIF_FLAG clears all the flags of the channel
+ * @return			None
+ * @note 			IFCR is write-1-to-clear, so no read-modify-write is needed
+ */
+void DMA_ClearFlag(DMA_RegDef_t *pDMAx, uint8_t Channel, uint32_t FlagName){
+
+	pDMAx->IFCR = (FlagName << (4 * (Channel - 1)));
+}
+
+/* In each application this function will be override according to perform some action  */
+__attribute__((weak)) void DMA_ApplicationEventCallback (DMA_Handle_t *pDMAHandle, uint8_t AppEv){
+	// This is a weak implementation. The application can override this function
+
+}
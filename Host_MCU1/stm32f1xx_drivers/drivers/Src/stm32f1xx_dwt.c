@@ -0,0 +1,96 @@
+/*
+ * stm32f1xx_dwt.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_dwt.h"
+
+static uint32_t CyclesPerUs; // HCLK in MHz. 0 until DWT_Init runs
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			DWT_Init (DWT Initialization)
+ * @brief			This functions starts the cycle counter
+ * @param [in]		None
+ * @return			None
+ * @note 			The cycles per microsecond are taken from the RCC registers, so call it again
+ * 					after changing the clock tree. CYCCNT is not cleared: running deadlines are kept
+ */
+void DWT_Init(void){
+
+	*DEMCR |= (1 << DEMCR_TRCENA); // The DWT unit has no clock until TRCENA is set
+	DWT->CTRL |= (1 << DWT_CTRL_CYCCNTENA);
+
+	CyclesPerUs = RCC_GetHCLKValue() / 1000000U;
+	if (CyclesPerUs == 0){
+		CyclesPerUs = 1; // HCLK below 1 MHz: deadlines are longer than requested, never shorter
+	}
+}
+
+/******************************************************************
+ * @func			DWT_UsToCycles (DWT microseconds to cycles)
+ * @brief			This functions converts a time into core clock cycles
+ * @param [in]		Time in microseconds
+ * @return			Number of cycles. DWT_WAIT_FOREVER if it does not fit in 32 bits
+ * @note 			None
+ */
+uint32_t DWT_UsToCycles(uint32_t Timeout_us){
+
+	uint64_t cycles;
+
+	if (CyclesPerUs == 0){
+		DWT_Init();
+	}
+
+	cycles = (uint64_t)Timeout_us * CyclesPerUs;
+
+	return (cycles >= DWT_WAIT_FOREVER) ? DWT_WAIT_FOREVER : (uint32_t)cycles;
+}
+
+/******************************************************************
+ * @func			DWT_CyclesToUs (DWT cycles to microseconds)
+ * @brief			This functions converts a number of core clock cycles into a time
+ * @param [in]		Number of cycles (e.g. the difference of two DWT_GetCycles)
+ * @return			Time in microseconds, rounded down
+ * @note 			None
+ */
+uint32_t DWT_CyclesToUs(uint32_t Cycles){
+
+	if (CyclesPerUs == 0){
+		DWT_Init();
+	}
+
+	return Cycles / CyclesPerUs;
+}
+
+/******************************************************************
+ * @func			DWT_TimeoutStart (DWT timeout start)
+ * @brief			This functions starts a deadline
+ * @param [in]		Deadline
+ * @param [in]		Time in microseconds. DWT_WAIT_FOREVER never expires
+ * @return			None
+ * @note 			Check it with DWT_TimeoutExpired
+ */
+void DWT_TimeoutStart(DWT_Timeout_t *pTimeout, uint32_t Timeout_us){
+
+	pTimeout->Cycles = (Timeout_us == DWT_WAIT_FOREVER) ? DWT_WAIT_FOREVER : DWT_UsToCycles(Timeout_us);
+	pTimeout->Start = DWT->CYCCNT;
+}
+
+/******************************************************************
+ * @func			DWT_DelayUs (DWT delay in microseconds)
+ * @brief			This functions waits for a given time
+ * @param [in]		Time in microseconds
+ * @return			None
+ * @note 			Busy wait. Interrupts keep running and are counted in the delay
+ */
+void DWT_DelayUs(uint32_t Delay_us){
+
+	DWT_Timeout_t delay;
+
+	DWT_TimeoutStart(&delay, Delay_us);
+	while (!DWT_TimeoutExpired(&delay));
+}
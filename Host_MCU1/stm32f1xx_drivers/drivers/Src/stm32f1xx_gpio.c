@@ -7,6 +7,8 @@
 
 #include"stm32f1xx_gpio.h"
 
+static RingBuf_t *pEventRing = NULL; // EXTI event queue. Set by GPIO_SetEventRing
+
 /* 					APIs Function Implementation 					*/
 
 /******************************************************************
@@ -19,41 +21,8 @@
  */
 void GPIO_PeriClkCtrl(GPIO_RegDef_t *pGPIOx, uint8_t EnOrDi)
 {
-	if (EnOrDi == ENABLE) {
-		if (pGPIOx == GPIOA) {
-			GPIOA_PCLK_EN();
-		} else if (pGPIOx == GPIOB) {
-			GPIOB_PCLK_EN();
-		} else if (pGPIOx == GPIOC) {
-			GPIOC_PCLK_EN();
-		} else if (pGPIOx == GPIOD) {
-			GPIOD_PCLK_EN();
-		} else if (pGPIOx == GPIOE) {
-			GPIOE_PCLK_EN();
-		} else if (pGPIOx == GPIOF) {
-			GPIOF_PCLK_EN();
-		} else {
-			GPIOG_PCLK_EN();
-		}
-	}
-	else
-	{
-		if (pGPIOx == GPIOA) {
-			GPIOA_PCLK_DI();
-		} else if (pGPIOx == GPIOB) {
-			GPIOB_PCLK_DI();
-		} else if (pGPIOx == GPIOC) {
-			GPIOC_PCLK_DI();
-		} else if (pGPIOx == GPIOD) {
-			GPIOD_PCLK_DI();
-		} else if (pGPIOx == GPIOE) {
-			GPIOE_PCLK_DI();
-		} else if (pGPIOx == GPIOF) {
-			GPIOF_PCLK_DI();
-		} else {
-			GPIOG_PCLK_DI();
-		}
-	}
+	// The RCC bit of the port is taken from the peripheral table
+	RCC_PeriClkCtrl(pGPIOx, EnOrDi);
 }
 
 /******************************************************************
@@ -133,21 +102,7 @@ void GPIO_AltFunc_Init(GPIO_Handle_t *pGPIOHandle){
  */
 void GPIO_DeInit(GPIO_RegDef_t *pGPIOx)
 {
-	if (pGPIOx == GPIOA) {
-		GPIOA_REG_RESET();
-	} else if (pGPIOx == GPIOB) {
-		GPIOB_REG_RESET();
-	} else if (pGPIOx == GPIOC) {
-		GPIOC_REG_RESET();
-	} else if (pGPIOx == GPIOD) {
-		GPIOD_REG_RESET();
-	} else if (pGPIOx == GPIOE) {
-		GPIOE_REG_RESET();
-	} else if (pGPIOx == GPIOF) {
-		GPIOF_REG_RESET();
-	} else {
-		GPIOG_REG_RESET();
-	}
+	RCC_PeriReset(pGPIOx);
 }
 
 // Interrupt handling
@@ -201,9 +156,7 @@ void GPIO_InterHandler(GPIO_Handle_t *pGPIOHandle, uint8_t InterType){
  */
 uint8_t GPIO_ReadFromInputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber)
 {
-	uint8_t value;
-	value = (uint8_t) ((pGPIOx->IDR >> PinNumber) & 0x00000001);
-	return value;
+	return (uint8_t)BITBAND_PERIPH(&pGPIOx->IDR, PinNumber); // Bit-band alias: already 0 or 1
 }
 
 /******************************************************************
@@ -233,9 +186,9 @@ uint16_t GPIO_ReadFromInputPort(GPIO_RegDef_t *pGPIOx)
 void GPIO_WriteToOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t value)
 {
 	if (value == GPIO_PIN_SET){
-		pGPIOx->ODR |= (1 << PinNumber);
+		pGPIOx->BSRR = (1 << PinNumber); // Only the pins written with 1 change, so no read-modify-write of ODR is needed
 	} else {
-		pGPIOx->ODR &= ~(1 << PinNumber);
+		pGPIOx->BRR = (1 << PinNumber);
 	}
 }
 
@@ -253,6 +206,21 @@ void GPIO_WriteToOutputPort(GPIO_RegDef_t *pGPIOx, uint16_t value)
 	pGPIOx->ODR = value;
 }
 
+/******************************************************************
+ * @func			GPIO_WriteToOutputPins (GPIO Write to output pins)
+ * @brief			This functions writes a value to a group of pins of a port
+ * @param [in]		Base Address of the GPIO port
+ * @param [in]		Mask of the pins that are going to be written (bit n = pin n)
+ * @param [in]		Value for the pins in the mask. The other bits are ignored
+ * @return			None
+ * @note 			Single store to BSRR: the pins out of the mask are not touched, even if an ISR
+ * 					changes them at the same time
+ */
+void GPIO_WriteToOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, uint16_t value)
+{
+	GPIO_WritePins(pGPIOx, PinMask, value);
+}
+
 /******************************************************************
  * @func			GPIO_ToggleOutputPin (GPIO Toggle pin)
  * @brief			This functions toggles a specific pin
@@ -263,56 +231,48 @@ void GPIO_WriteToOutputPort(GPIO_RegDef_t *pGPIOx, uint16_t value)
  */
 void GPIO_ToggleOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber)
 {
-	pGPIOx->ODR = pGPIOx->ODR ^ (1 << PinNumber); // Same as: pGPIOx->ODR ^= (1 << PinNumber) ^ => XOR
+	GPIO_TogglePins(pGPIOx, (1 << PinNumber));
+}
+
+/******************************************************************
+ * @func			GPIO_ToggleOutputPins (GPIO Toggle pins)
+ * @brief			This functions toggles a group of pins of a port
+ * @param [in]		Base Address of the GPIO port
+ * @param [in]		Mask of the pins that are going to be toggled (bit n = pin n)
+ * @return			None
+ * @note 			ODR is read once and the new levels are written with a single store to BSRR
+ */
+void GPIO_ToggleOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask)
+{
+	GPIO_TogglePins(pGPIOx, PinMask);
 }
 
 
 // IQR configuration and handling
 /******************************************************************
  * @func			GPIO_IRQConfig (GPIO IRQ Configuration)
- * @brief			This functions configures the priority in the IRQ list
+ * @brief			This functions enables or disables an IRQ in the NVIC
  * @param [in]		IQR Number
- * @param [in]		IRQ Priority
  * @param [in]		Enable or disable
  * @return			None
- * @note 			None
+ * @note 			Done by the NVIC driver: one store to ISER/ICER, the other IRQs are not touched
  */
-void GPIO_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi)
-{
-	if (EnOrDi == ENABLE){
-		if (IRQNumber <= 31){ // IRQ Number 0-31
-			*NVIC_ISER0 |= (1<< IRQNumber); // Set ISER0
-		} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-			*NVIC_ISER1 |= (1<< (IRQNumber%32)); // Set ISER1
-		} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-			*NVIC_ISER2 |= (1<< (IRQNumber%64)); // Set ISER2
-		}
-	} else {
-		if (IRQNumber <= 31){ // IRQ Number 0-31
-			*NVIC_ICER0 |= (1<< IRQNumber); // Set ICER0
-		} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-			*NVIC_ICER1 |= (1<< (IRQNumber%32)); // Set ICER1
-		} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-			*NVIC_ICER2 |= (1<< (IRQNumber%64)); // Set ICER2
-		}
-	}
+void GPIO_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
+
+	NVIC_IRQConfig(IRQNumber, EnOrDi);
 }
 
 /******************************************************************
  * @func			GPIO_IRQPriority (GPIO IRQ Priority)
- * @brief			This functions process the IRQ Priority
+ * @brief			This functions sets the priority of an IRQ
  * @param [in]		IRQ Number
- * @param [in]		IRQ Priority
+ * @param [in]		IRQ Priority (0-15). See NVIC_EncodePriority for preempt/sub-priority
  * @return			None
- * @note 			None
+ * @note 			The old priority is replaced with one byte store
  */
 void GPIO_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority){
 
-	uint8_t iprx =  IRQNumber/4; // Define which IPR Register you have to use (0-59)
-	uint8_t iprx_section =  IRQNumber%4; // Define the section on the IPR (0-4) * 8 bc each section is 8 bits
-	uint8_t aux =  ((8* iprx_section) + (8 - NO_PR_BITS_IMPLEMENTED)); // This is the arrangement done bc the 4 first bits of each section are not implemented.
-
-	*(NVIC_PRIO_BASEADDR + (iprx)) |= (IRQPriority <<aux);
+	NVIC_SetPriority(IRQNumber, (uint8_t)IRQPriority);
 }
 
 /******************************************************************
@@ -326,7 +286,30 @@ void GPIO_IRQHandling(uint8_t PinNumber)
 {
 	// Clear the EXTI Pending Register Corresponding to the Pin Number
 	if (EXTI->PR & (1 << PinNumber)){
-		EXTI->PR |= (1 << PinNumber);
+		EXTI->PR = (1 << PinNumber); // Writing 0 has no effect, so the other pending pins are kept
+
+		if (pEventRing != NULL){
+			RingBuf_Put(pEventRing, PinNumber);
+		}
+	}
+}
+
+/******************************************************************
+ * @func			GPIO_SetEventRing (GPIO set event ring buffer)
+ * @brief			This functions sets the queue where GPIO_IRQHandling stores the pin number of each event
+ * @param [in]		Ring buffer initialized with RingBuf_Init. NULL disables the queue
+ * @return			GPIO_OK or GPIO_INVALID if RingBuf_Init refused the ring
+ * @note 			main() reads the events in order with RingBuf_Get/RingBuf_Read. Events that do not fit
+ * 					are counted in the Dropped member of the ring
+ */
+uint8_t GPIO_SetEventRing(RingBuf_t *pRing)
+{
+	if ((pRing != NULL) && (pRing->pBuffer == NULL)){
+		return GPIO_INVALID;
 	}
+
+	pEventRing = pRing;
+
+	return GPIO_OK;
 }
 
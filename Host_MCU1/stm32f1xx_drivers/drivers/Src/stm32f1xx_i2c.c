@@ -7,15 +7,19 @@
 
 #include"stm32f1xx_i2c.h"
 
-uint16_t AHB1_Prescaler[8] = {2,4,8,16,64,128,256,512};
-uint16_t APB1_Prescaler[4] = {2,4,8,16};
-
 static void I2C_GenerateStartCondition(I2C_RegDef_t *pI2Cx);
 static void I2C_ExecuteAddressPhaseWrite(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr);
 static void I2C_ExecuteAddressPhaseRead(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr);
 static void I2C_ClearAddrFlag(I2C_Handle_t *pI2CxHandle);
 static void I2C_MasterHandleTXEIT(I2C_Handle_t *pI2CxHandle);
 static void I2C_MasterHandleRXNEIT(I2C_Handle_t *pI2CxHandle);
+static void I2C_QueueNext(I2C_Handle_t *pI2CxHandle, uint8_t Phase);
+static void I2C_QueueAbort(I2C_Handle_t *pI2CxHandle);
+static void I2C_DMAStart(I2C_RegDef_t *pI2Cx, uint8_t Channel, uint8_t Direction, uint8_t *pBuffer, uint8_t length);
+static uint8_t I2C_WaitFlag(I2C_RegDef_t *pI2Cx, uint8_t Bit, DWT_Timeout_t *pTimeout);
+static uint8_t I2C_MasterTimeout(I2C_Handle_t *pI2CxHandle);
+static GPIO_RegDef_t* I2C_GetBusPins(I2C_Handle_t *pI2CxHandle, uint8_t *pSCLPin, uint8_t *pSDAPin);
+static uint8_t I2C_RecoveryWaitSCL(GPIO_RegDef_t *pGPIOx, uint8_t SCLPin);
 
 /* 				Private Function Implementation 			       */
 
@@ -88,6 +92,16 @@ static void I2C_ClearAddrFlag(I2C_Handle_t *pI2CxHandle){
 				dummy_read = pI2CxHandle->pI2Cx->SR1;
 				dummy_read = pI2CxHandle->pI2Cx->SR2;
 				(void) dummy_read;
+
+				// DMA reception: EOT_1 is never generated for 1 byte, so the STOP is programmed here
+				if ((pI2CxHandle->pI2Cx->CR2 & (1 << I2C_CR2_DMAEN)) && (pI2CxHandle->Sr == I2C_NO_SR)){
+					I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+				}
+			} else {
+				// Clear ADDR flag
+				dummy_read = pI2CxHandle->pI2Cx->SR1;
+				dummy_read = pI2CxHandle->pI2Cx->SR2;
+				(void) dummy_read;
 			}
 		} else {
 			// Clear ADDR flag
@@ -104,6 +118,57 @@ static void I2C_ClearAddrFlag(I2C_Handle_t *pI2CxHandle){
 	}
 }
 
+/******************************************************************
+ * @func			I2C_WaitFlag
+ * @brief			This functions waits until a SR1 flag is set
+ * @param [in]		Base Address of the I2C Peripheral
+ * @param [in]		Bit position of the flag (I2C_SR1_xxx)
+ * @param [in]		Deadline. It is restarted if the flag is not set yet
+ * @return			I2C_OK or I2C_TIMEOUT
+ * @note 			Each iteration is a bit-band load of the flag and a compare of CYCCNT
+ */
+static uint8_t I2C_WaitFlag(I2C_RegDef_t *pI2Cx, uint8_t Bit, DWT_Timeout_t *pTimeout){
+
+	if (I2C_SR1_BB(pI2Cx, Bit)){
+		return I2C_OK; // Fast path: no need to read CYCCNT
+	}
+
+	DWT_TimeoutRestart(pTimeout);
+	while (!I2C_SR1_BB(pI2Cx, Bit)){
+		if (DWT_TimeoutExpired(pTimeout)){
+			return I2C_TIMEOUT;
+		}
+	}
+
+	return I2C_OK;
+}
+
+/******************************************************************
+ * @func			I2C_MasterTimeout
+ * @brief			This functions releases the bus after a blocking call missed its deadline
+ * @param [in]		I2C Handle
+ * @return			I2C_TIMEOUT
+ * @note 			A STOP is requested (it is sent as soon as the slave releases SCL), AF is cleared
+ * 					(address or data NACK) and the ACK configuration is restored.
+ * 					Without a NACK the bus is held by a slave (or BUSY is stuck): it is recovered
+ */
+static uint8_t I2C_MasterTimeout(I2C_Handle_t *pI2CxHandle){
+
+	if (!(pI2CxHandle->pI2Cx->SR1 & (1 << I2C_SR1_AF))){
+		I2C_BusRecovery(pI2CxHandle);
+		return I2C_TIMEOUT;
+	}
+
+	I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+	pI2CxHandle->pI2Cx->SR1 &= ~(1 << I2C_SR1_AF);
+
+	if (pI2CxHandle->I2C_Config.I2C_ACKControl == 1){
+		I2C_ManageAcking(pI2CxHandle->pI2Cx,I2C_ACK_ENABLE);
+	}
+
+	return I2C_TIMEOUT;
+}
+
 /******************************************************************
  * @func			2C_GenerateStopCondition (I2C Generate STOP condition)
  * @brief			This functions generates the stop condition
@@ -117,6 +182,35 @@ void I2C_GenerateStopCondition(I2C_RegDef_t *pI2Cx){
 
 }
 
+/******************************************************************
+ * @func			I2C_DMAStart (I2C DMA start)
+ * @brief			This functions configures and enables the DMA1 channel of a master transfer
+ * @param [in]		Base Address of the I2C Peripheral
+ * @param [in]		DMA1 channel
+ * @param [in]		DMA_DIR_MEM_TO_PERI (Tx) or DMA_DIR_PERI_TO_MEM (Rx)
+ * @param [in]		Buffer
+ * @param [in]		Length
+ * @return			None
+ * @note 			Only the transfer complete and transfer error interrupts are used
+ */
+static void I2C_DMAStart(I2C_RegDef_t *pI2Cx, uint8_t Channel, uint8_t Direction, uint8_t *pBuffer, uint8_t length){
+
+	DMA_Handle_t DMAHandle;
+
+	DMAHandle.pDMAx = DMA1;
+	DMAHandle.Channel = Channel;
+	DMAHandle.DMA_Config.DMA_Direction = Direction;
+	DMAHandle.DMA_Config.DMA_PeriSize = DMA_SIZE_8BITS;
+	DMAHandle.DMA_Config.DMA_MemSize = DMA_SIZE_8BITS;
+	DMAHandle.DMA_Config.DMA_MemInc = ENABLE;
+	DMAHandle.DMA_Config.DMA_Priority = (Direction == DMA_DIR_PERI_TO_MEM) ? DMA_PRIORITY_VERY_HIGH : DMA_PRIORITY_HIGH;
+	DMAHandle.DMA_Config.DMA_Mode = DMA_MODE_NORMAL;
+	DMA_Init(&DMAHandle);
+	DMA_InterruptControl(&DMAHandle, DMA_TCIF_FLAG | DMA_TEIF_FLAG, ENABLE);
+
+	DMA_Start(&DMAHandle, &pI2Cx->DR, pBuffer, length);
+}
+
 /* 					APIs Function Implementation 					*/
 
 /******************************************************************
@@ -128,81 +222,57 @@ void I2C_GenerateStopCondition(I2C_RegDef_t *pI2Cx){
  * @note 			None
  */
 void I2C_PeriClkCtrl(I2C_RegDef_t *pI2Cx, uint8_t EnOrDi){
-	if (EnOrDi == ENABLE) {
-		if (pI2Cx == I2C1) {
-			I2C1_PCLK_EN();
-		} else if (pI2Cx == I2C2) {
-			I2C2_PCLK_EN();
-		}
-	}
-	else
-	{
-		if (pI2Cx == I2C1) {
-			I2C1_PCLK_DI();
-		} else if (pI2Cx == I2C2) {
-			I2C2_PCLK_DI();
-		}
-	}
+
+	// The RCC bit of the I2C is taken from the peripheral table
+	RCC_PeriClkCtrl(pI2Cx, EnOrDi);
 }
 
 /******************************************************************
- * @func			RCC_GetPCLKValue (RCC Get PCLK 1 Value)
- * @brief			This functions calculates the frequency of the APB1 clock
- * @param [in]		None
- * @return			Frequency of the clock
- * @note 			None
+ * @func			I2C_CalcTiming (I2C calculate timing)
+ * @brief			This functions calculates the FREQ, CCR and TRISE values for a SCL speed
+ * @param [in]		APB1 clock in Hz
+ * @param [in]		SCL speed in Hz. Possible values @I2C_SCLSpeed or any value up to 400 kHz
+ * @param [in]		Fast mode duty cycle. Possible values @I2CFMDutyCycle
+ * @param [out]		Register values and achieved SCL frequency
+ * @return			I2C_OK or I2C_TIMING_INVALID
+ * @note 			Same formulas as I2C_TIMING. Used when the values were not built at compile time
  */
-uint32_t RCC_GetPCLK1Value (void){
-
-	uint32_t pclk1, sysclk;
-
-	uint8_t clksrc, temp, ahb1_prescaler, apb1_prescaler;
-
-	/* System clock: Defined on the register CFGR of RCC
-	 * Move the bits two positions to the right so they a in the position 0 and 1.
-	 * Then mask and get the value */
-	clksrc = (RCC ->CFGR >> 2) & 0x3;
-
-	if (clksrc == 0){
-		sysclk = 16000000;
-	} else if (clksrc == 1){
-		sysclk = 8000000;
-	}
-
-	// AHB Prescaler: Defined on register CFGR
-	temp = (RCC ->CFGR >> 4) & 0xF;
-
-	if (temp < 8){
-		ahb1_prescaler = 1;
-	} else {
-		ahb1_prescaler = AHB1_Prescaler[temp-8];
-		/* Example: temp = 9 -> 1001 -> [1] -> 9-8 */
-	}
+uint8_t I2C_CalcTiming(uint32_t Pclk1, uint32_t Speed, uint8_t Duty, I2C_Timing_t *pTiming){
 
-	// APB1 Prescaler
-	temp = (RCC ->CFGR >> 8) & 0x7;
-
-	if (temp < 4){
-		apb1_prescaler = 1;
-	} else {
-		apb1_prescaler = APB1_Prescaler[temp-4];
+	if ((Speed == 0) || !I2C_TIMING_VALID(Pclk1, Speed, Duty)){
+		return I2C_TIMING_INVALID;
 	}
 
-	pclk1 = (sysclk/ahb1_prescaler)/apb1_prescaler;
+	pTiming->PCLK1 = Pclk1;
+	pTiming->SCL_Hz = I2C_TIMING_SCL(Pclk1, Speed, Duty);
+	pTiming->CCR = (uint16_t)I2C_TIMING_CCR_REG(Pclk1, Speed, Duty);
+	pTiming->FREQ = (uint8_t)I2C_TIMING_FREQ(Pclk1);
+	pTiming->TRISE = (uint8_t)I2C_TIMING_TRISE(Pclk1, Speed);
 
-	return pclk1;
+	return I2C_OK;
 }
 
 /******************************************************************
  * @func			I2C_Init (I2C Initialization)
  * @brief			This functions initializes a given I2C
  * @param [in]		Base Address of the I2C Handle
- * @return			None
- * @note 			None
+ * @return			I2C_OK or I2C_TIMING_INVALID (nothing is written)
+ * @note 			The timing built with I2C_TIMING is written as it is. It is solved here when there is
+ * 					none or when it was built for another PCLK1 (e.g. after RCC_ClockConfig)
  */
-void I2C_Init(I2C_Handle_t *pI2CxHandle){
+uint8_t I2C_Init(I2C_Handle_t *pI2CxHandle){
 
 	uint32_t temp = 0;
+	const I2C_Timing_t *pTiming = pI2CxHandle->I2C_Config.pI2C_Timing;
+	I2C_Timing_t timing;
+
+	if ((pTiming == NULL) || (pTiming->PCLK1 != RCC_GetPCLK1Value())){
+		if (I2C_CalcTiming(RCC_GetPCLK1Value(), pI2CxHandle->I2C_Config.I2C_SCLSpeed,
+						   (uint8_t)pI2CxHandle->I2C_Config.I2C_FMDutyCycle, &timing) != I2C_OK){
+			return I2C_TIMING_INVALID;
+		}
+		pTiming = &timing;
+	}
 
 	// Enable clock for I2C peripheral
 	I2C_PeriClkCtrl(pI2CxHandle->pI2Cx, ENABLE);
@@ -213,9 +283,7 @@ void I2C_Init(I2C_Handle_t *pI2CxHandle){
 	pI2CxHandle->pI2Cx->CR1 = temp; */
 
 	// Configuration of the FREQ
-	temp = 0;
-	temp |= RCC_GetPCLK1Value()/ 1000000U;
-	pI2CxHandle->pI2Cx->CR2 = (temp & 0x3F); // To mask the rest of the bits
+	pI2CxHandle->pI2Cx->CR2 = pTiming->FREQ;
 
 	// Configuration of the slave address
 	temp = 0;
@@ -223,42 +291,11 @@ void I2C_Init(I2C_Handle_t *pI2CxHandle){
 	temp |= (1 << 14); // Bit 14 must be 1 according to the manual
 	pI2CxHandle->pI2Cx->OAR1 = temp;
 
-	// CCR calculations
-	uint16_t ccr_value = 0;
-	temp = 0;
-
-	if(pI2CxHandle->I2C_Config.I2C_SCLSpeed <= I2C_CLK_SPEED_SM){
-		// Standard mode
-		ccr_value = RCC_GetPCLK1Value()/(2*pI2CxHandle->I2C_Config.I2C_SCLSpeed);
-		temp |= (ccr_value & 0xFFF);
-	} else{
-		// Fast mode
-		temp |= (1 << 15);
-		temp |= (pI2CxHandle->I2C_Config.I2C_FMDutyCycle << 14);
-
-		if (pI2CxHandle->I2C_Config.I2C_FMDutyCycle == I2C_FM_DUTYCLYCLE_2){
-			ccr_value = RCC_GetPCLK1Value()/(3*pI2CxHandle->I2C_Config.I2C_SCLSpeed);
-		} else {
-			ccr_value = RCC_GetPCLK1Value()/(25*pI2CxHandle->I2C_Config.I2C_SCLSpeed);
-		}
-		temp |= (ccr_value & 0xFFF);
-	}
-
-	pI2CxHandle->pI2Cx->CCR = temp;
-
-	// TRISE configuration
-
-	if(pI2CxHandle->I2C_Config.I2C_SCLSpeed <= I2C_CLK_SPEED_SM){
-		// Standard mode
-
-		temp = (RCC_GetPCLK1Value()/ 1000000U) + 1; // This formula comes from the reference manual
+	// CCR (speed mode, duty cycle and clock control) and TRISE configuration
+	pI2CxHandle->pI2Cx->CCR = pTiming->CCR;
+	pI2CxHandle->pI2Cx->TRISE = pTiming->TRISE;
 
-	} else {
-		// Fast mode
-		temp = (RCC_GetPCLK1Value()*300/ 1000000U) + 1;
-	}
-
-	pI2CxHandle->pI2Cx->TRISE = (temp & 0x3F);
+	return I2C_OK;
 }
 
 /******************************************************************
@@ -269,11 +306,8 @@ void I2C_Init(I2C_Handle_t *pI2CxHandle){
  * @note 			None
  */
 void I2C_DeInit(I2C_RegDef_t *pI2Cx){
-	if (pI2Cx == I2C1) {
-		I2C1_REG_RESET();
-	} else if (pI2Cx == I2C2) {
-		I2C2_REG_RESET();
-	}
+
+	RCC_PeriReset(pI2Cx);
 }
 
 /******************************************************************
@@ -300,43 +334,59 @@ uint8_t I2C_GetFlagStatus(I2C_RegDef_t *pI2Cx, uint32_t FlagName){
  * @param [in]		Tx Buffer
  * @param [in]		Length
  * @param [in]		Slave address
- * @return			None
- * @note 			None
+ * @return			I2C_OK or I2C_TIMEOUT if a flag was not set within the deadline (I2C_Timeout)
+ * @note 			On timeout a STOP is requested to release the bus
  */
-void I2C_MasterSendData(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+uint8_t I2C_MasterSendData(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+
+	DWT_Timeout_t timeout;
+
+	DWT_TimeoutStart(&timeout, pI2CxHandle->I2C_Config.I2C_Timeout ? pI2CxHandle->I2C_Config.I2C_Timeout : I2C_TIMEOUT_DEFAULT_US);
 
 	// Generate start condition
 	I2C_GenerateStartCondition(pI2CxHandle->pI2Cx);
 
 	// Confirm that the START generation is completed by checking the SB flag in the in the SR1 register
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_SB_FLAG)));
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_SB, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
 
 	// Send the address of the slave with the R/NW bit
 	I2C_ExecuteAddressPhaseWrite(pI2CxHandle->pI2Cx, SlaveAddr);
 
 	// Confirm that address phase is completed by checking the ADDR flag in the SR1 register
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_ADDR_FLAG)));
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_ADDR, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
 
 	// Clear ADDR flag
 	I2C_ClearAddrFlag(pI2CxHandle);
 
 	// Send data until length = 0
 	while (length > 0){
-		while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_TXE_FLAG)));
+		if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_TXE, &timeout) != I2C_OK){
+			return I2C_MasterTimeout(pI2CxHandle);
+		}
 		pI2CxHandle->pI2Cx->DR = *pTxBuffer;
 		pTxBuffer ++;
 		length--;
 	}
 
 	// When length = 0, Wait for TXE = 1 and BFT = 1 before generating the STOP condition
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_TXE_FLAG)));
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_BTF_FLAG)));
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_TXE, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_BTF, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
 
 	// Check if a re-start is needed
 	if (Sr == I2C_NO_SR){
 		// Generate STOP condition
 		I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
 	}
+
+	return I2C_OK;
 }
 
 /******************************************************************
@@ -346,22 +396,30 @@ void I2C_MasterSendData(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t l
  * @param [in]		Rx Buffer
  * @param [in]		Length
  * @param [in]		Slave address
- * @return			None
- * @note 			None
+ * @return			I2C_OK or I2C_TIMEOUT if a flag was not set within the deadline (I2C_Timeout)
+ * @note 			On timeout a STOP is requested to release the bus
  */
-void I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+uint8_t I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+
+	DWT_Timeout_t timeout;
+
+	DWT_TimeoutStart(&timeout, pI2CxHandle->I2C_Config.I2C_Timeout ? pI2CxHandle->I2C_Config.I2C_Timeout : I2C_TIMEOUT_DEFAULT_US);
 
 	// Generate start condition
 	I2C_GenerateStartCondition(pI2CxHandle->pI2Cx);
 
 	// Confirm that the START generation is completed by checking the SB flag in the in the SR1 register
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_SB_FLAG)));
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_SB, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
 
 	// Send the address of the slave with the R/NW bit
 	I2C_ExecuteAddressPhaseRead(pI2CxHandle->pI2Cx, SlaveAddr);
 
 	// Confirm that address phase is completed by checking the ADDR flag in the SR1 register
-	while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_ADDR_FLAG)));
+	if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_ADDR, &timeout) != I2C_OK){
+		return I2C_MasterTimeout(pI2CxHandle);
+	}
 
 	// Procedure to read only 1 byte of data
 	if (length == 1){
@@ -377,6 +435,11 @@ void I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_
 			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
 		}
 
+		// Wait until RXNE becomes 1
+		if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_RXNE, &timeout) != I2C_OK){
+			return I2C_MasterTimeout(pI2CxHandle);
+		}
+
 		// Read data into buffer
 		*pRxBuffer = pI2CxHandle->pI2Cx->DR;
 	}
@@ -389,7 +452,9 @@ void I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_
 		for (uint32_t i = length; i > 0; i--){
 
 			// Wait until RXNE becomes 1
-			while(!(I2C_GetFlagStatus(pI2CxHandle->pI2Cx, I2C_RXNE_FLAG)));
+			if (I2C_WaitFlag(pI2CxHandle->pI2Cx, I2C_SR1_RXNE, &timeout) != I2C_OK){
+				return I2C_MasterTimeout(pI2CxHandle);
+			}
 
 			if (i == 2){
 				// Disable acking
@@ -415,6 +480,8 @@ void I2C_MasterReceiveData(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_
 	if (pI2CxHandle->I2C_Config.I2C_ACKControl == 1){
 		I2C_ManageAcking(pI2CxHandle->pI2Cx,I2C_ACK_ENABLE);
 	}
+
+	return I2C_OK;
 }
 
 /******************************************************************
@@ -437,6 +504,7 @@ uint8_t I2C_MasterSendDataIT(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint
 		pI2CxHandle->pTxBuffer = pTxBuffer;
 		pI2CxHandle->TxLen = length;
 		pI2CxHandle->TxRxState = I2C_BUSY_IN_TX;
+		pI2CxHandle->Error = I2C_OK;
 		pI2CxHandle->devAddr = SlaveAddr;
 		pI2CxHandle->Sr = Sr;
 
@@ -476,6 +544,7 @@ uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, u
 		pI2CxHandle->pRxBuffer = pRxBuffer;
 		pI2CxHandle->RxLen = length;
 		pI2CxHandle->TxRxState = I2C_BUSY_IN_RX;
+		pI2CxHandle->Error = I2C_OK;
 		pI2CxHandle->RxSize = length; //Rxsize is used in the ISR code to manage the data reception
 		pI2CxHandle->devAddr = SlaveAddr;
 		pI2CxHandle->Sr = Sr;
@@ -496,52 +565,221 @@ uint8_t I2C_MasterReceiveDataIT(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, u
 	return busystate;
 }
 
+/******************************************************************
+ * @func			I2C_MasterSendDataDMA (I2C Master send data using DMA)
+ * @brief			This functions prepares to send data with the DMA1 channel of the I2C.
+ * @param [in]		I2C Handle
+ * @param [in]		Tx Buffer
+ * @param [in]		Length (1-255)
+ * @param [in]		Slave address
+ * @param [in]		Repeated start condition
+ * @return			State before the call (I2C_READY: started), or I2C_INVALID for length 0
+ * @note 			SB and ADDR are handled by I2C_EV_IRQHandling. The data bytes are written by the
+ * 					DMA, then I2C_DMA_IRQHandling waits for BTF to generate the STOP and notify
+ * 					I2C_EV_TX_COMPLETE. Call I2C_DMA_IRQHandling from DMA1_Channel6_IRQHandler (I2C1)
+ * 					or DMA1_Channel4_IRQHandler (I2C2)
+ */
+uint8_t I2C_MasterSendDataDMA(I2C_Handle_t *pI2CxHandle, uint8_t *pTxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+
+	uint8_t busystate = pI2CxHandle->TxRxState;
+
+	// The DMA channel would never complete with CNDTR = 0: the handle would stay busy
+	if (length == 0){
+		return I2C_INVALID;
+	}
+
+	if( (busystate != I2C_BUSY_IN_TX) && (busystate != I2C_BUSY_IN_RX)) {
+		pI2CxHandle->pTxBuffer = pTxBuffer;
+		pI2CxHandle->TxLen = length;
+		pI2CxHandle->TxRxState = I2C_BUSY_IN_TX;
+		pI2CxHandle->Error = I2C_OK;
+		pI2CxHandle->devAddr = SlaveAddr;
+		pI2CxHandle->Sr = Sr;
+		pI2CxHandle->DMATxChannel = (pI2CxHandle->pI2Cx == I2C1) ? DMA_CH_I2C1_TX : DMA_CH_I2C2_TX;
+
+		I2C_DMAStart(pI2CxHandle->pI2Cx, pI2CxHandle->DMATxChannel, DMA_DIR_MEM_TO_PERI, pTxBuffer, length);
+
+		// TXE requests go to the DMA. ITBUFEN stays disabled
+		pI2CxHandle->pI2Cx->CR2 |= (1 << I2C_CR2_DMAEN);
+
+		//Generate START Condition
+		I2C_GenerateStartCondition(pI2CxHandle->pI2Cx);
+
+		//Enable ITEVFEN Control Bit
+		pI2CxHandle->pI2Cx->CR2 |= ( 1 << I2C_CR2_ITEVTEN);
+
+		//Enable ITERREN Control Bit
+		pI2CxHandle->pI2Cx->CR2 |= ( 1 << I2C_CR2_ITERREN);
+	}
+
+	return busystate;
+}
+
+/******************************************************************
+ * @func			I2C_MasterReceiveDataDMA (I2C Master receive data using DMA)
+ * @brief			This functions prepares to receive data with the DMA1 channel of the I2C.
+ * @param [in]		I2C Handle
+ * @param [in]		Rx Buffer
+ * @param [in]		Length (1-255)
+ * @param [in]		Slave address
+ * @param [in]		Repeated start condition
+ * @return			State before the call (I2C_READY: started), or I2C_INVALID for length 0
+ * @note 			For 1 byte the STOP is generated when ADDR is cleared (see I2C_ClearAddrFlag). The end of the
+ * 					transfer is notified with I2C_EV_RX_COMPLETE from I2C_DMA_IRQHandling, which must be
+ * 					called from DMA1_Channel7_IRQHandler (I2C1) or DMA1_Channel5_IRQHandler (I2C2)
+ */
+uint8_t I2C_MasterReceiveDataDMA(I2C_Handle_t *pI2CxHandle, uint8_t *pRxBuffer, uint8_t length, uint8_t SlaveAddr, uint8_t Sr){
+
+	uint8_t busystate = pI2CxHandle->TxRxState;
+
+	// The DMA channel would never complete with CNDTR = 0: the handle would stay busy
+	if (length == 0){
+		return I2C_INVALID;
+	}
+
+	if( (busystate != I2C_BUSY_IN_TX) && (busystate != I2C_BUSY_IN_RX)){
+		pI2CxHandle->pRxBuffer = pRxBuffer;
+		pI2CxHandle->RxLen = length;
+		pI2CxHandle->TxRxState = I2C_BUSY_IN_RX;
+		pI2CxHandle->Error = I2C_OK;
+		pI2CxHandle->RxSize = length;
+		pI2CxHandle->devAddr = SlaveAddr;
+		pI2CxHandle->Sr = Sr;
+		pI2CxHandle->DMARxChannel = (pI2CxHandle->pI2Cx == I2C1) ? DMA_CH_I2C1_RX : DMA_CH_I2C2_RX;
+
+		I2C_DMAStart(pI2CxHandle->pI2Cx, pI2CxHandle->DMARxChannel, DMA_DIR_PERI_TO_MEM, pRxBuffer, length);
+
+		// The DMA starts reading as soon as ADDR is cleared, so ACK and LAST are set here
+		if (length == 1){
+			// EOT_1 is never generated for 1 byte. The byte is NACKed and the STOP is programmed with ADDR
+			I2C_ManageAcking(pI2CxHandle->pI2Cx, I2C_ACK_DISABLE);
+			pI2CxHandle->pI2Cx->CR2 &= ~(1 << I2C_CR2_LAST);
+		} else {
+			// Every byte is ACKed except the one after EOT_1 (last but one DMA transfer), which is
+			// NACKed by the hardware when LAST = 1
+			I2C_ManageAcking(pI2CxHandle->pI2Cx, I2C_ACK_ENABLE);
+			pI2CxHandle->pI2Cx->CR2 |= (1 << I2C_CR2_LAST);
+		}
+
+		// RXNE requests go to the DMA. ITBUFEN stays disabled
+		pI2CxHandle->pI2Cx->CR2 |= (1 << I2C_CR2_DMAEN);
+
+		//Generate START Condition
+		I2C_GenerateStartCondition(pI2CxHandle->pI2Cx);
+
+		//Enable ITEVFEN Control Bit
+		pI2CxHandle->pI2Cx->CR2 |= ( 1 << I2C_CR2_ITEVTEN);
+
+		//Enable ITERREN Control Bit
+		pI2CxHandle->pI2Cx->CR2 |= ( 1 << I2C_CR2_ITERREN);
+	}
+
+	return busystate;
+}
+
+/******************************************************************
+ * @func			I2C_TransferDone (I2C transfer done)
+ * @brief			This functions checks if the last IT/DMA master transfer has finished
+ * @param [in]		I2C Handle
+ * @param [out]		I2C_OK or the I2C_ERROR_xxx code of the transfer. Only written when it has finished
+ * @return			1 when the transfer has finished (or failed), 0 while it runs
+ * @note 			Wait condition of the coroutine API (I2C_PT_xxx). AF/OVR/TIMEOUT leave the transfer
+ * 					open for the application callback, so it is closed here with a STOP
+ */
+uint8_t I2C_TransferDone(I2C_Handle_t *pI2CxHandle, uint8_t *pStatus){
+
+	uint8_t error = pI2CxHandle->Error;
+
+	if (error != I2C_OK){
+		if (pI2CxHandle->TxRxState == I2C_BUSY_IN_TX){
+			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			I2C_CloseSendData(pI2CxHandle);
+		} else if (pI2CxHandle->TxRxState == I2C_BUSY_IN_RX){
+			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			I2C_CloseReceiveData(pI2CxHandle);
+		}
+		*pStatus = error;
+		return 1;
+	}
+
+	if (pI2CxHandle->TxRxState == I2C_READY){
+		*pStatus = I2C_OK;
+		return 1;
+	}
+
+	return 0;
+}
+
+/******************************************************************
+ * @func			I2C_QueueSubmit (I2C queue submit)
+ * @brief			This functions adds a batch of master transactions to the queue of the bus
+ * @param [in]		I2C Handle
+ * @param [in]		Transactions. They must stay valid until their Status is not I2C_TR_PENDING
+ * @param [in]		Number of transactions
+ * @return			I2C_OK, I2C_QUEUE_FULL or I2C_QUEUE_INVALID (nothing is queued)
+ * @note 			Thread level only: the ISR is the only consumer. The whole batch is visible to the
+ * 					ISR at once, so a chain of I2C_TR_SR transactions runs back to back. The queue is
+ * 					started here when the bus is idle (with the EV/ER/DMA IRQs masked, so the ISR cannot
+ * 					start it too), otherwise when the running transfer finishes.
+ * 					The handle must start zeroed (global variable)
+ */
+uint8_t I2C_QueueSubmit(I2C_Handle_t *pI2CxHandle, I2C_Transaction_t *pTransactions, uint8_t Count){
+
+	uint8_t head = pI2CxHandle->QueueHead;
+	uint32_t primask;
+
+	if ((uint32_t)(uint8_t)(head - pI2CxHandle->QueueTail) + Count > I2C_QUEUE_SIZE){
+		return I2C_QUEUE_FULL;
+	}
+
+	for (uint8_t i = 0; i < Count; i++){
+		if ((pTransactions[i].TxLen == 0) && (pTransactions[i].RxLen == 0)){
+			return I2C_QUEUE_INVALID;
+		}
+	}
+
+	for (uint8_t i = 0; i < Count; i++){
+		pTransactions[i].Status = I2C_TR_PENDING;
+		pTransactions[i].RxCount = 0;
+		pI2CxHandle->pQueue[(uint8_t)(head + i) & (I2C_QUEUE_SIZE - 1)] = &pTransactions[i];
+	}
+	pI2CxHandle->QueueHead = head + Count; // Published after the slots
+
+	// Idle bus: nothing would start the queue. Otherwise the ISR has already seen the new head.
+	// Checked again with the IRQs masked: a transfer closing here may have started the queue
+	IRQ_SAVE_DISABLE(primask);
+	if (pI2CxHandle->pQueueActive == NULL){
+		I2C_QueueNext(pI2CxHandle, I2C_READY);
+	}
+	IRQ_RESTORE(primask);
+
+	return I2C_OK;
+}
+
 /******************************************************************
  * @func			I2C_IRQConfig (I2C IRQ Configuration)
- * @brief			This functions configures the priority in the IRQ list
+ * @brief			This functions enables or disables an IRQ in the NVIC
  * @param [in]		IQR Number
- * @param [in]		IRQ Priority
  * @param [in]		Enable or disable
  * @return			None
- * @note 			None
+ * @note 			Done by the NVIC driver: one store to ISER/ICER, the other IRQs are not touched
  */
 void I2C_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
 
-	if (EnOrDi == ENABLE){
-			if (IRQNumber <= 31){ // IRQ Number 0-31
-				*NVIC_ISER0 |= (1<< IRQNumber); // Set ISER0
-			} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-				*NVIC_ISER1 |= (1<< (IRQNumber%32)); // Set ISER1
-			} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-				*NVIC_ISER2 |= (1<< (IRQNumber%64)); // Set ISER2
-			}
-		} else {
-			if (IRQNumber <= 31){ // IRQ Number 0-31
-				*NVIC_ICER0 |= (1<< IRQNumber); // Set ICER0
-			} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-				*NVIC_ICER1 |= (1<< (IRQNumber%32)); // Set ICER1
-			} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-				*NVIC_ICER2 |= (1<< (IRQNumber%64)); // Set ICER2
-			}
-		}
+	NVIC_IRQConfig(IRQNumber, EnOrDi);
 }
 
 /******************************************************************
  * @func			I2C_IRQPriority (I2C IRQ Priority)
- * @brief			This functions process the IRQ Priority
+ * @brief			This functions sets the priority of an IRQ
  * @param [in]		IRQ Number
- * @param [in]		IRQ Priority
+ * @param [in]		IRQ Priority (0-15). See NVIC_EncodePriority for preempt/sub-priority
  * @return			None
- * @note 			None
+ * @note 			The old priority is replaced with one byte store
  */
-
 void I2C_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority){
 
-	uint8_t iprx =  IRQNumber/4; // Define which IPR Register you have to use (0-59)
-	uint8_t iprx_section =  IRQNumber%4; // Define the section on the IPR (0-4) * 8 bc each section is 8 bits
-	uint8_t aux =  ((8* iprx_section) + (8 - NO_PR_BITS_IMPLEMENTED)); // This is the arrangement done bc the 4 first bits of each section are not implemented.
-
-	*(NVIC_PRIO_BASEADDR + (iprx)) |= (IRQPriority <<aux);
+	NVIC_SetPriority(IRQNumber, (uint8_t)IRQPriority);
 }
 
 /******************************************************************
@@ -582,7 +820,7 @@ void I2C_ManageAcking(I2C_RegDef_t *pI2Cx, uint8_t EnorDi)
 }
 
 /******************************************************************
- * @func			I2C_MasterHandleRXNEIT (I2C Master handle TXE interrupt)
+ * @func			I2C_MasterHandleTXEIT (I2C Master handle TXE interrupt)
  * @brief			This functions sends data implementing interrupts. It handles the interrupt
  * @param [in]		I2C Handle
  * @return			None
@@ -592,7 +830,7 @@ static void I2C_MasterHandleTXEIT(I2C_Handle_t *pI2CxHandle){
 
 	if (pI2CxHandle->TxLen > 0){
 		// Load data into DR
-		pI2CxHandle->pI2Cx->DR = *(pI2CxHandle->pRxBuffer);
+		pI2CxHandle->pI2Cx->DR = *(pI2CxHandle->pTxBuffer);
 
 		// Decrement Tx length
 		pI2CxHandle->TxLen--;
@@ -629,15 +867,131 @@ static void I2C_MasterHandleRXNEIT(I2C_Handle_t *pI2CxHandle){
 	}
 
 	if (pI2CxHandle->RxLen == 0){
-		// Generate STOP condition
-		I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+		// Generate STOP condition. With repeated start the next transfer generates the START
+		if (pI2CxHandle->Sr == I2C_NO_SR){
+			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+		}
 
 		// Close I2C reception
 		I2C_CloseReceiveData(pI2CxHandle);
 
-		// Notify app
-		I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_RX_COMPLETE);
+		// Notify app. Queued transactions go on without it
+		if (pI2CxHandle->pQueueActive == NULL){
+			I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_RX_COMPLETE);
+		}
+		I2C_QueueNext(pI2CxHandle, I2C_BUSY_IN_RX);
+	}
+}
+
+/******************************************************************
+ * @func			I2C_QueueNext (I2C queue next)
+ * @brief			This functions starts the next phase or the next transaction of the queue
+ * @param [in]		I2C Handle
+ * @param [in]		Phase that has just finished: I2C_BUSY_IN_TX, I2C_BUSY_IN_RX or I2C_READY (none)
+ * @return			None
+ * @note 			Called when a transfer closes, so the START (repeated START after I2C_SR) follows
+ * 					without going back to the application. A write phase is followed by the read phase
+ * 					of the same transaction with a repeated START. The application only gets
+ * 					I2C_EV_BATCH_COMPLETE after the STOP of the batch
+ */
+static void I2C_QueueNext(I2C_Handle_t *pI2CxHandle, uint8_t Phase){
+
+	I2C_Transaction_t *pTr = pI2CxHandle->pQueueActive;
+	I2C_Transaction_t *pLast;
+	uint8_t len;
+
+	while (1){
+		if (pTr == NULL){
+			// A direct IT/DMA transfer on the bus starts the queue when it closes
+			if ((pI2CxHandle->TxRxState != I2C_READY) || (pI2CxHandle->QueueTail == pI2CxHandle->QueueHead)){
+				return;
+			}
+			pTr = pI2CxHandle->pQueue[pI2CxHandle->QueueTail & (I2C_QUEUE_SIZE - 1)];
+			pI2CxHandle->pQueueActive = pTr;
+
+			if (pTr->TxLen > 0){
+				I2C_MasterSendDataIT(pI2CxHandle, pTr->pTxBuffer, pTr->TxLen, pTr->SlaveAddr,
+									 ((pTr->RxLen > 0) || (pTr->Flags & I2C_TR_SR)) ? I2C_SR : I2C_NO_SR);
+				return;
+			}
+			Phase = I2C_BUSY_IN_TX; // No write phase: straight to the read phase
+		}
+
+		// Write phase finished: read phase
+		if (Phase == I2C_BUSY_IN_TX){
+			len = pTr->RxLen;
+			if (pTr->Flags & I2C_TR_LEN_FROM_PREV){
+				pLast = pI2CxHandle->pQueueLast;
+				len = 0;
+				if ((pLast != NULL) && (pLast->RxCount > 0)){
+					len = (pLast->pRxBuffer[0] < pTr->RxLen) ? pLast->pRxBuffer[0] : pTr->RxLen;
+				}
+			}
+			pTr->RxCount = len;
+
+			if (len > 0){
+				I2C_MasterReceiveDataIT(pI2CxHandle, pTr->pRxBuffer, len, pTr->SlaveAddr,
+										(pTr->Flags & I2C_TR_SR) ? I2C_SR : I2C_NO_SR);
+				return;
+			}
+
+			// Nothing to read. The write phase kept the bus for it
+			if (!(pTr->Flags & I2C_TR_SR) && (pI2CxHandle->pI2Cx->SR2 & (1 << I2C_SR2_MSL))){
+				I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			}
+		}
+
+		// Transaction finished
+		pTr->Status = I2C_OK;
+		pI2CxHandle->pQueueLast = pTr;
+		pI2CxHandle->QueueTail++;
+		pI2CxHandle->pQueueActive = NULL;
+
+		if (!(pTr->Flags & I2C_TR_SR)){
+			I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_BATCH_COMPLETE);
+		}
+		pTr = NULL;
+	}
+}
+
+/******************************************************************
+ * @func			I2C_QueueAbort (I2C queue abort)
+ * @brief			This functions closes the failed queued transaction and drops the rest of its batch
+ * @param [in]		I2C Handle
+ * @return			None
+ * @note 			The next phases of a batch depend on the failed one (e.g. a register address
+ * 					write before the read). The next batch is started
+ */
+static void I2C_QueueAbort(I2C_Handle_t *pI2CxHandle){
+
+	I2C_Transaction_t *pTr = pI2CxHandle->pQueueActive;
+	uint8_t flags;
+
+	// AF/OVR/TIMEOUT leave the transfer open. After BERR/ARLO the bus recovery has closed it
+	if (pI2CxHandle->TxRxState == I2C_BUSY_IN_TX){
+		I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+		I2C_CloseSendData(pI2CxHandle);
+	} else if (pI2CxHandle->TxRxState == I2C_BUSY_IN_RX){
+		I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+		I2C_CloseReceiveData(pI2CxHandle);
+	}
+
+	pTr->Status = pI2CxHandle->Error;
+	flags = pTr->Flags;
+	pI2CxHandle->QueueTail++;
+
+	while ((flags & I2C_TR_SR) && (pI2CxHandle->QueueTail != pI2CxHandle->QueueHead)){
+		pTr = pI2CxHandle->pQueue[pI2CxHandle->QueueTail & (I2C_QUEUE_SIZE - 1)];
+		pTr->Status = I2C_TR_ABORTED;
+		flags = pTr->Flags;
+		pI2CxHandle->QueueTail++;
 	}
+
+	pI2CxHandle->pQueueLast = NULL;
+	pI2CxHandle->pQueueActive = NULL;
+	I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_BATCH_COMPLETE);
+
+	I2C_QueueNext(pI2CxHandle, I2C_READY);
 }
 
 /******************************************************************
@@ -666,6 +1020,210 @@ uint8_t I2C_SlaveReceiveData(I2C_RegDef_t *pI2Cx){
 	return (uint8_t)pI2Cx->DR;
 }
 
+/******************************************************************
+ * @func			I2C_SlaveSetRxRing (I2C slave set Rx ring buffer)
+ * @brief			This functions makes the ISR store the received bytes in a ring buffer
+ * @param [in]		I2C Handle
+ * @param [in]		Ring buffer initialized with RingBuf_Init. NULL goes back to I2C_EV_DATA_RECEIVED
+ * @return			I2C_OK or I2C_INVALID if RingBuf_Init refused the ring (the handle is not changed)
+ * @note 			The application reads the ring (e.g. after I2C_EV_STOP) with RingBuf_Read.
+ * 					Bytes that do not fit are counted in the Dropped member of the ring
+ */
+uint8_t I2C_SlaveSetRxRing(I2C_Handle_t *pI2CxHandle, RingBuf_t *pRing){
+
+	if ((pRing != NULL) && (pRing->pBuffer == NULL)){
+		return I2C_INVALID;
+	}
+
+	pI2CxHandle->pSlaveRxRing = pRing;
+
+	return I2C_OK;
+}
+
+/******************************************************************
+ * @func			I2C_SetBusPins (I2C set bus pins)
+ * @brief			This functions gives the bus recovery the pins of SCL and SDA
+ * @param [in]		I2C Handle
+ * @param [in]		GPIO port of both pins. NULL goes back to the default pins
+ * @param [in]		SCL pin number
+ * @param [in]		SDA pin number
+ * @return			None
+ * @note 			The default pins are PB6/PB7 (PB8/PB9 with the AFIO remap) for I2C1 and
+ * 					PB10/PB11 for I2C2
+ */
+void I2C_SetBusPins(I2C_Handle_t *pI2CxHandle, GPIO_RegDef_t *pGPIOx, uint8_t SCLPin, uint8_t SDAPin){
+
+	pI2CxHandle->pBusGPIOx = pGPIOx;
+	pI2CxHandle->SCLPin = SCLPin;
+	pI2CxHandle->SDAPin = SDAPin;
+}
+
+/******************************************************************
+ * @func			I2C_GetBusPins
+ * @brief			This functions finds the pins of SCL and SDA
+ * @param [in]		I2C Handle
+ * @param [out]		SCL pin number
+ * @param [out]		SDA pin number
+ * @return			GPIO port of both pins
+ * @note 			None
+ */
+static GPIO_RegDef_t* I2C_GetBusPins(I2C_Handle_t *pI2CxHandle, uint8_t *pSCLPin, uint8_t *pSDAPin){
+
+	if (pI2CxHandle->pBusGPIOx != NULL){
+		*pSCLPin = pI2CxHandle->SCLPin;
+		*pSDAPin = pI2CxHandle->SDAPin;
+		return pI2CxHandle->pBusGPIOx;
+	}
+
+	if (pI2CxHandle->pI2Cx == I2C2){
+		*pSCLPin = GPIO_PIN_10;
+		*pSDAPin = GPIO_PIN_11;
+	} else if (AFIO->MAPR & (1 << AFIO_MAPR_I2C1_REMAP)){
+		*pSCLPin = GPIO_PIN_8;
+		*pSDAPin = GPIO_PIN_9;
+	} else {
+		*pSCLPin = GPIO_PIN_6;
+		*pSDAPin = GPIO_PIN_7;
+	}
+
+	return GPIOB;
+}
+
+/******************************************************************
+ * @func			I2C_RecoveryWaitSCL
+ * @brief			This functions waits until SCL is high
+ * @param [in]		GPIO port of SCL
+ * @param [in]		SCL pin number
+ * @return			I2C_OK or I2C_BUS_STUCK
+ * @note 			The slaves are allowed to stretch the clock up to I2C_RECOVERY_STRETCH_US
+ */
+static uint8_t I2C_RecoveryWaitSCL(GPIO_RegDef_t *pGPIOx, uint8_t SCLPin){
+
+	DWT_Timeout_t stretch;
+
+	DWT_TimeoutStart(&stretch, I2C_RECOVERY_STRETCH_US);
+	while (!GPIO_ReadFromInputPin(pGPIOx, SCLPin)){
+		if (DWT_TimeoutExpired(&stretch)){
+			return I2C_BUS_STUCK;
+		}
+	}
+
+	return I2C_OK;
+}
+
+/******************************************************************
+ * @func			I2C_BusRecovery (I2C bus recovery)
+ * @brief			This functions frees a bus held by a slave and restarts the peripheral
+ * @param [in]		I2C Handle
+ * @return			I2C_OK or I2C_BUS_STUCK (SDA or SCL still low)
+ * @note 			Sequence (UM10204 3.1.16 and the BUSY flag errata of the STM32F10x):
+ * 					1. The running transfer is closed and PE is cleared.
+ * 					2. SCL and SDA become general purpose open drain outputs (GPIO_Init).
+ * 					3. Up to 9 SCL pulses are sent while SDA is low: the slave finishes its byte.
+ * 					4. A STOP is sent by hand and both lines are checked.
+ * 					5. The pins go back to alternate function, SWRST is pulsed and the handle
+ * 					   is configured again (I2C_Init, CR1 and the interrupt enables).
+ * 					It takes about 100 us at I2C_RECOVERY_HALF_PERIOD_US = 5. The duration is
+ * 					stored in the RecoveryStats member of the handle.
+ * 					The driver calls it on BERR, ARLO and timeouts. It assumes a single master
+ */
+uint8_t I2C_BusRecovery(I2C_Handle_t *pI2CxHandle){
+
+	I2C_RegDef_t *pI2Cx = pI2CxHandle->pI2Cx;
+	I2C_RecoveryStats_t *pStats = &pI2CxHandle->RecoveryStats;
+	GPIO_Handle_t BusPins;
+	uint16_t scl, sda;
+	uint8_t sclPin, sdaPin;
+	uint8_t pulses = 0, status = I2C_OK;
+	uint32_t start, cr1, cr2, time;
+
+	start = DWT_GetCycles();
+
+	// 1. Close the transfer and disable the peripheral. The configuration is restored at the end
+	if (pI2CxHandle->TxRxState == I2C_BUSY_IN_TX){
+		I2C_CloseSendData(pI2CxHandle);
+	} else if (pI2CxHandle->TxRxState == I2C_BUSY_IN_RX){
+		I2C_CloseReceiveData(pI2CxHandle);
+	}
+
+	cr1 = pI2Cx->CR1 & ~((1 << I2C_CR1_START) | (1 << I2C_CR1_STOP) | (1 << I2C_CR1_SWREST));
+	cr2 = pI2Cx->CR2 & ((1 << I2C_CR2_ITERREN) | (1 << I2C_CR2_ITEVTEN) | (1 << I2C_CR2_ITBUFEN));
+	I2C_PeripheralControl(pI2Cx, DISABLE);
+
+	// 2. Lines released (ODR = 1) before the pins become outputs
+	BusPins.pGPIOx = I2C_GetBusPins(pI2CxHandle, &sclPin, &sdaPin);
+	scl = GPIO_PIN_MASK(sclPin);
+	sda = GPIO_PIN_MASK(sdaPin);
+	GPIO_PeriClkCtrl(BusPins.pGPIOx, ENABLE); // ODR is not written without the clock
+	GPIO_SetPins(BusPins.pGPIOx, scl | sda);
+
+	BusPins.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_10;
+	BusPins.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_OD;
+	BusPins.GPIO_PinConfig.GPIO_PinNumber = sclPin;
+	GPIO_Init(&BusPins);
+	BusPins.GPIO_PinConfig.GPIO_PinNumber = sdaPin;
+	GPIO_Init(&BusPins);
+
+	// 3. Clock pulses until the slave releases SDA
+	status = I2C_RecoveryWaitSCL(BusPins.pGPIOx, sclPin);
+
+	while ((status == I2C_OK) && !GPIO_ReadFromInputPin(BusPins.pGPIOx, sdaPin) && (pulses < I2C_RECOVERY_PULSES)){
+		GPIO_ResetPins(BusPins.pGPIOx, scl);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		GPIO_SetPins(BusPins.pGPIOx, scl);
+		status = I2C_RecoveryWaitSCL(BusPins.pGPIOx, sclPin);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		pulses++;
+	}
+
+	// 4. STOP: SDA rises while SCL is high
+	if (status == I2C_OK){
+		GPIO_ResetPins(BusPins.pGPIOx, scl);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		GPIO_ResetPins(BusPins.pGPIOx, sda);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		GPIO_SetPins(BusPins.pGPIOx, scl);
+		status = I2C_RecoveryWaitSCL(BusPins.pGPIOx, sclPin);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+		GPIO_SetPins(BusPins.pGPIOx, sda);
+		DWT_DelayUs(I2C_RECOVERY_HALF_PERIOD_US);
+
+		if (!GPIO_ReadFromInputPin(BusPins.pGPIOx, sdaPin) || !GPIO_ReadFromInputPin(BusPins.pGPIOx, sclPin)){
+			status = I2C_BUS_STUCK;
+		}
+	}
+
+	// 5. Pins back to the peripheral, reset of the peripheral (clears BUSY) and configuration
+	BusPins.GPIO_PinConfig.GPIO_Config = ALT_FUNC_OP_TYPE_OD;
+	GPIO_Init(&BusPins);
+	BusPins.GPIO_PinConfig.GPIO_PinNumber = sclPin;
+	GPIO_Init(&BusPins);
+
+	pI2Cx->CR1 |= (1 << I2C_CR1_SWREST);
+	pI2Cx->CR1 &= ~(1 << I2C_CR1_SWREST);
+
+	I2C_Init(pI2CxHandle);
+	pI2Cx->CR2 |= cr2;
+	if (cr1 & (1 << I2C_CR1_PE)){
+		I2C_PeripheralControl(pI2Cx, ENABLE); // ACK can only be set once PE=1
+	}
+	pI2Cx->CR1 = cr1;
+
+	// Statistics
+	time = DWT_CyclesToUs(DWT_GetCycles() - start);
+	pStats->Count++;
+	if (status != I2C_OK){
+		pStats->Failures++;
+	}
+	pStats->LastTime_us = time;
+	if (time > pStats->MaxTime_us){
+		pStats->MaxTime_us = time;
+	}
+	pStats->LastPulses = pulses;
+
+	return status;
+}
+
 
 /******************************************************************
  * @func			I2C_EV_IRQHandling (I2C Event Handling)
@@ -709,6 +1267,11 @@ void I2C_EV_IRQHandling(I2C_Handle_t *pI2CxHandle){
 		// Interrupt happened because of ADDR event
 		// Clear ADDR flag
 		I2C_ClearAddrFlag(pI2CxHandle);
+
+		// The data bytes are moved by the DMA. Events are enabled again by I2C_DMA_IRQHandling when needed
+		if (pI2CxHandle->pI2Cx->CR2 & (1 << I2C_CR2_DMAEN)){
+			pI2CxHandle->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITEVTEN);
+		}
 	}
 
 	/********************************** Handling interrupt generated by BTF event **********************************/
@@ -733,8 +1296,14 @@ void I2C_EV_IRQHandling(I2C_Handle_t *pI2CxHandle){
 					// Reset all member elements of the handle structure
 					I2C_CloseSendData(pI2CxHandle);
 
-					// Notify the app about transmission completion
-					I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_TX_COMPLETE);
+					// Notify the app about transmission completion. Queued transactions go on without it
+					if (pI2CxHandle->pQueueActive == NULL){
+						I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_TX_COMPLETE);
+					}
+					I2C_QueueNext(pI2CxHandle, I2C_BUSY_IN_TX);
+
+					// TXE of a chained transfer is handled after its address phase
+					return;
 				}
 			}
 		} else if (pI2CxHandle->TxRxState == I2C_BUSY_IN_RX){
@@ -794,15 +1363,86 @@ void I2C_EV_IRQHandling(I2C_Handle_t *pI2CxHandle){
 			}
 		} else {
 			// Device is in slave mode
-			// Make sure slave in in transmitter mode by checking TRA bit
+			// Make sure slave in in receiver mode by checking TRA bit
 			// TRA = 1 -> Transmitter mode		TRA = 0 -> Receiver mode
-			if (pI2CxHandle->pI2Cx->SR2 & (1 << I2C_SR2_TRA)){
-				I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_DATA_RECEIVED);
+			if (!(pI2CxHandle->pI2Cx->SR2 & (1 << I2C_SR2_TRA))){
+				if (pI2CxHandle->pSlaveRxRing != NULL){
+					RingBuf_Put(pI2CxHandle->pSlaveRxRing, (uint8_t)pI2CxHandle->pI2Cx->DR);
+				} else {
+					I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_DATA_RECEIVED);
+				}
 			}
 		}
 	}
 }
 
+/******************************************************************
+ * @func			I2C_DMA_IRQHandling (I2C DMA IRQ Handling)
+ * @brief			This functions processes the interrupts of the DMA channels used by the master
+ * 					DMA transfers
+ * @param [in]		I2C Handle
+ * @return			None
+ * @note 			Tx: the last byte is still in the shift register when the DMA finishes, so the
+ * 					event interrupt is enabled again and BTF closes the transfer.
+ * 					Rx: the last byte was already NACKed, the STOP is generated here
+ */
+void I2C_DMA_IRQHandling(I2C_Handle_t *pI2CxHandle){
+
+	uint8_t tx = pI2CxHandle->DMATxChannel;
+	uint8_t rx = pI2CxHandle->DMARxChannel;
+
+	if (!(pI2CxHandle->pI2Cx->CR2 & (1 << I2C_CR2_DMAEN))){
+		return; // No DMA transfer in progress
+	}
+
+	if (pI2CxHandle->TxRxState == I2C_BUSY_IN_TX){
+		// Check transfer error
+		if (DMA_GetFlagStatus(DMA1, tx, DMA_TEIF_FLAG)){
+			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			I2C_CloseSendData(pI2CxHandle);
+			pI2CxHandle->Error = I2C_ERROR_DMA;
+			I2C_ApplicationEventCallback(pI2CxHandle, I2C_ERROR_DMA);
+			return;
+		}
+
+		// Check transfer complete
+		if (DMA_GetFlagStatus(DMA1, tx, DMA_TCIF_FLAG)){
+			DMA_ClearFlag(DMA1, tx, DMA_TCIF_FLAG);
+			pI2CxHandle->TxLen = 0;
+
+			// BTF is handled by I2C_EV_IRQHandling
+			pI2CxHandle->pI2Cx->CR2 |= (1 << I2C_CR2_ITEVTEN);
+		}
+	} else if (pI2CxHandle->TxRxState == I2C_BUSY_IN_RX){
+		// Check transfer error
+		if (DMA_GetFlagStatus(DMA1, rx, DMA_TEIF_FLAG)){
+			I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			I2C_CloseReceiveData(pI2CxHandle);
+			pI2CxHandle->Error = I2C_ERROR_DMA;
+			I2C_ApplicationEventCallback(pI2CxHandle, I2C_ERROR_DMA);
+			return;
+		}
+
+		// Check transfer complete
+		if (DMA_GetFlagStatus(DMA1, rx, DMA_TCIF_FLAG)){
+			// For 1 byte the STOP was generated when ADDR was cleared
+			if ((pI2CxHandle->RxSize > 1) && (pI2CxHandle->Sr == I2C_NO_SR)){
+				I2C_GenerateStopCondition(pI2CxHandle->pI2Cx);
+			}
+			pI2CxHandle->RxLen = 0;
+
+			// Close I2C reception
+			I2C_CloseReceiveData(pI2CxHandle);
+
+			// Notify app
+			I2C_ApplicationEventCallback(pI2CxHandle, I2C_EV_RX_COMPLETE);
+
+			// Transactions queued during the transfer
+			I2C_QueueNext(pI2CxHandle, I2C_READY);
+		}
+	}
+}
+
 /******************************************************************
  * @func			I2C_CloseReceiveData (I2C Close Received Data)
  * @brief			This functions closes communication after the MCU is done receiving data
@@ -812,6 +1452,13 @@ void I2C_EV_IRQHandling(I2C_Handle_t *pI2CxHandle){
  */
 void I2C_CloseReceiveData (I2C_Handle_t *pI2CxHandle){
 
+	// Stop the DMA requests (I2C_MasterReceiveDataDMA)
+	if (pI2CxHandle->pI2Cx->CR2 & (1 << I2C_CR2_DMAEN)){
+		pI2CxHandle->pI2Cx->CR2 &= ~((1 << I2C_CR2_DMAEN) | (1 << I2C_CR2_LAST));
+		DMA1->CH[pI2CxHandle->DMARxChannel - 1].CCR &= ~(1 << DMA_CCR_EN);
+		DMA_ClearFlag(DMA1, pI2CxHandle->DMARxChannel, DMA_GIF_FLAG);
+	}
+
 	// Disable ITBUFFEN
 	pI2CxHandle->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
 
@@ -837,6 +1484,13 @@ void I2C_CloseReceiveData (I2C_Handle_t *pI2CxHandle){
  */
 void I2C_CloseSendData (I2C_Handle_t *pI2CxHandle){
 
+	// Stop the DMA requests (I2C_MasterSendDataDMA)
+	if (pI2CxHandle->pI2Cx->CR2 & (1 << I2C_CR2_DMAEN)){
+		pI2CxHandle->pI2Cx->CR2 &= ~(1 << I2C_CR2_DMAEN);
+		DMA1->CH[pI2CxHandle->DMATxChannel - 1].CCR &= ~(1 << DMA_CCR_EN);
+		DMA_ClearFlag(DMA1, pI2CxHandle->DMATxChannel, DMA_GIF_FLAG);
+	}
+
 	// Disable ITBUFFEN
 	pI2CxHandle->pI2Cx->CR2 &= ~(1 << I2C_CR2_ITBUFEN);
 
@@ -858,6 +1512,7 @@ void I2C_CloseSendData (I2C_Handle_t *pI2CxHandle){
 void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 	uint32_t temp1,temp2;
+	uint8_t status;
 
     //Know the status of  ITERREN control bit in the CR2
 	temp2 = (pI2CxHandle->pI2Cx->CR2) & ( 1 << I2C_CR2_ITERREN);
@@ -871,9 +1526,17 @@ void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 		// Clear the bus error flag
 		pI2CxHandle->pI2Cx->SR1 &= ~( 1 << I2C_SR1_BERR);
+		pI2CxHandle->Error = I2C_ERROR_BERR;
+
+		// A misplaced START/STOP leaves the slaves out of step: free the bus before notifying
+		status = I2C_BusRecovery(pI2CxHandle);
 
 		// Notify the application about the error
 		I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_BERR);
+		if (status == I2C_BUS_STUCK){
+			pI2CxHandle->Error = I2C_ERROR_BUS_STUCK;
+			I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_BUS_STUCK);
+		}
 	}
 
 /***********************Check for arbitration lost error************************************/
@@ -884,9 +1547,17 @@ void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 		// Clear the arbitration lost error flag
 		pI2CxHandle->pI2Cx->SR1 &= ~( 1 << I2C_SR1_ARLO);
+		pI2CxHandle->Error = I2C_ERROR_ARLO;
+
+		// Single master: SDA low while the master sends a 1 is a slave holding the bus
+		status = I2C_BusRecovery(pI2CxHandle);
 
 		//Implement the code to notify the application about the error
 		I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_ARLO);
+		if (status == I2C_BUS_STUCK){
+			pI2CxHandle->Error = I2C_ERROR_BUS_STUCK;
+			I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_BUS_STUCK);
+		}
 
 	}
 
@@ -898,6 +1569,7 @@ void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 		//Implement the code to clear the ACK failure error flag
 		pI2CxHandle->pI2Cx->SR1 &= ~( 1 << I2C_SR1_AF);
+		pI2CxHandle->Error = I2C_ERROR_AF;
 
 		//Implement the code to notify the application about the error
 		I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_AF);
@@ -910,6 +1582,7 @@ void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 		//Implement the code to clear the Overrun/underrun error flag
 		pI2CxHandle->pI2Cx->SR1 &= ~( 1 << I2C_SR1_OVR);
+		pI2CxHandle->Error = I2C_ERROR_OVR;
 
 		//Implement the code to notify the application about the error
 		I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_OVR);
@@ -922,10 +1595,16 @@ void I2C_ER_IRQHandling(I2C_Handle_t *pI2CxHandle){
 
 		//Implement the code to clear the Time out error flag
 		pI2CxHandle->pI2Cx->SR1 &= ~( 1 << I2C_SR1_TIMEOUT);
+		pI2CxHandle->Error = I2C_ERROR_TIMEOUT;
 
 		//Implement the code to notify the application about the error
 		I2C_ApplicationEventCallback(pI2CxHandle,I2C_ERROR_TIMEOUT);
 	}
+
+	// Queued transaction: the driver closes it, drops the rest of its batch and goes on
+	if ((pI2CxHandle->pQueueActive != NULL) && (pI2CxHandle->Error != I2C_OK)){
+		I2C_QueueAbort(pI2CxHandle);
+	}
 }
 
 void I2C_SlaveManageCallbackEvents(I2C_RegDef_t *pI2Cx, uint8_t EnorDi){
@@ -940,3 +1619,9 @@ void I2C_SlaveManageCallbackEvents(I2C_RegDef_t *pI2Cx, uint8_t EnorDi){
 		pI2Cx->CR2 &= ~(1 << I2C_CR2_ITERREN);
 	}
 }
+
+/* In each application this function will be override according to perform some action  */
+__attribute__((weak)) void I2C_ApplicationEventCallback (I2C_Handle_t *pI2CxHandle, uint8_t AppEv){
+	// This is a weak implementation. The application can override this function
+
+}
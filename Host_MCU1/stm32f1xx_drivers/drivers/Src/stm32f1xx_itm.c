@@ -0,0 +1,200 @@
+/*
+ * stm32f1xx_itm.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include<string.h>
+#include"stm32f1xx_itm.h"
+
+/* 			  Private helpers functions	prototypes    				*/
+static uint8_t ITM_WaitReady(volatile uint32_t *pPort);
+
+static uint32_t ITM_WaitCycles;	// Longest wait for a full FIFO. Set by ITM_Init
+static ITM_Stats_t Stats;
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			ITM_Init (ITM Initialization)
+ * @brief			This functions configures the TPIU for SWO and enables the ITM stimulus port 0
+ * @param [in]		SWO bit rate in Hz. ITM_SWO_DEBUGGER keeps the rate set by the debugger
+ * @return			SWO bit rate in Hz
+ * @note 			SWO = HCLK / (ACPR + 1). The prescaler is rounded to the nearest rate: use the
+ * 					returned value in the debugger. TRCENA (DEMCR) is set by DWT_Init, which also
+ * 					starts the cycle counter used for the FIFO wait
+ */
+uint32_t ITM_Init(uint32_t SWOBaud){
+
+	uint32_t hclk = RCC_GetHCLKValue();
+	uint32_t acpr;
+
+	DWT_Init();
+
+	if (SWOBaud != ITM_SWO_DEBUGGER){
+		// PB3 as TRACESWO, asynchronous mode
+		*DBGMCU_CR = (*DBGMCU_CR & ~(0x3U << DBGMCU_CR_TRACE_MODE)) | (1U << DBGMCU_CR_TRACE_IOEN);
+
+		acpr = (hclk + SWOBaud / 2) / SWOBaud;
+		if (acpr == 0){
+			acpr = 1;
+		} else if (acpr > 0x2000){
+			acpr = 0x2000;
+		}
+		TPIU->ACPR = acpr - 1;
+		TPIU->SPPR = (2 << TPIU_SPPR_TXMODE);		// NRZ
+		TPIU->FFCR = (1 << TPIU_FFCR_TRIGIN);		// Formatter off: the ITM packets go straight to the pin
+	}
+	acpr = (TPIU->ACPR & 0x1FFF) + 1;
+
+	// A 32-bit write is a 5-byte packet of 10 bits per byte on the pin
+	ITM_WaitCycles = ITM_FIFO_WAIT_PACKETS * 5 * 10 * acpr;
+
+	ITM->LAR = ITM_LAR_KEY;
+	ITM->TCR = (ITM_TRACE_BUS_ID << ITM_TCR_TRACEBUSID) | (1 << ITM_TCR_SYNCENA) | (1 << ITM_TCR_ITMENA);
+	ITM->TPR = 0;									// All ports usable in unprivileged mode
+	ITM->TER |= (1 << ITM_PORT_STDIO);
+
+	return hclk / acpr;
+}
+
+/******************************************************************
+ * @func			ITM_Write (ITM write)
+ * @brief			This functions writes data to an ITM stimulus port
+ * @param [in]		Stimulus port (0-31)
+ * @param [in]		Data
+ * @param [in]		Length in bytes
+ * @return			Bytes written. Less than len when the FIFO stayed full
+ * @note 			Returns 0 at once if the port is disabled (no trace configured). Any context:
+ * 					a write from an ISR can land between two words of another write
+ */
+uint32_t ITM_Write(uint8_t Port, const void *pData, uint32_t len){
+
+	volatile uint32_t *pPort = &ITM->PORT[Port & 0x1F];
+	const uint8_t *pByte = (const uint8_t*)pData;
+	uint32_t sent = 0;
+	uint32_t word;
+	uint16_t half;
+
+	if (!ITM_IsEnabled(Port & 0x1F)){
+		return 0;
+	}
+
+	while (sent < len){
+		if (!ITM_WaitReady(pPort)){
+			__atomic_fetch_add(&Stats.Dropped, len - sent, __ATOMIC_RELAXED);
+			break;
+		}
+
+		// The access size of the store is the size of the SWO packet
+		if ((len - sent) >= 4){
+			memcpy(&word, &pByte[sent], 4);
+			*pPort = word;
+			sent += 4;
+		} else if ((len - sent) >= 2){
+			memcpy(&half, &pByte[sent], 2);
+			*(volatile uint16_t*)pPort = half;
+			sent += 2;
+		} else {
+			*(volatile uint8_t*)pPort = pByte[sent];
+			sent++;
+		}
+	}
+
+	__atomic_fetch_add(&Stats.Written, sent, __ATOMIC_RELAXED);
+	return sent;
+}
+
+/******************************************************************
+ * @func			ITM_PortControl (ITM port control)
+ * @brief			This functions enables or disables a stimulus port
+ * @param [in]		Stimulus port (0-31)
+ * @param [in]		ENABLE or DISABLE
+ * @return			None
+ * @note 			Writes to a disabled port are discarded (ITM_Write returns 0)
+ */
+void ITM_PortControl(uint8_t Port, uint8_t EnOrDi){
+
+	if (EnOrDi == ENABLE){
+		ITM->TER |= (1U << (Port & 0x1F));
+	} else {
+		ITM->TER &= ~(1U << (Port & 0x1F));
+	}
+}
+
+/******************************************************************
+ * @func			ITM_GetStats (ITM get statistics)
+ * @brief			This functions copies the trace statistics
+ * @param [out]		Statistics
+ * @return			None
+ * @note 			None
+ */
+void ITM_GetStats(ITM_Stats_t *pStats){
+
+	pStats->Written = Stats.Written;
+	pStats->Dropped = Stats.Dropped;
+}
+
+/* 			  Private helpers functions	implementation 				*/
+
+/******************************************************************
+ * @func			ITM_WaitReady
+ * @brief			This functions waits until the stimulus port can take a write
+ * @param [in]		Stimulus port register
+ * @return			1 when ready, 0 after ITM_FIFO_WAIT_PACKETS packet times
+ * @note 			The ready bit is checked first, so the usual case costs one load
+ */
+static uint8_t ITM_WaitReady(volatile uint32_t *pPort){
+
+	DWT_Timeout_t timeout;
+
+	if (*pPort & (1 << ITM_PORT_FIFOREADY)){
+		return 1;
+	}
+
+	timeout.Start = DWT_GetCycles();
+	timeout.Cycles = ITM_WaitCycles;
+	while (!(*pPort & (1 << ITM_PORT_FIFOREADY))){
+		if (DWT_TimeoutExpired(&timeout)){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+#if defined(ITM_RETARGET) && !defined(STM32F1_HOST_SIM)
+
+/* newlib system calls. They replace the semihosting ones of librdimon (link with nosys.specs) */
+
+/******************************************************************
+ * @func			_write
+ * @brief			This functions sends the stdout and stderr data of newlib to ITM port 0
+ * @param [in]		File descriptor
+ * @param [in]		Data
+ * @param [in]		Length
+ * @return			len. Dropped bytes are not retried, so printf never waits for the debugger
+ * @note 			Other descriptors fail with -1
+ */
+int _write(int file, char *ptr, int len){
+
+	if ((file != 1) && (file != 2)){
+		return -1;
+	}
+	ITM_Write(ITM_PORT_STDIO, ptr, (uint32_t)len);
+	return len;
+}
+
+/******************************************************************
+ * @func			initialise_monitor_handles
+ * @brief			This functions sets up the SWO output (called by the applications before printf)
+ * @param [in]		None
+ * @return			None
+ * @note 			Same name as the semihosting call, so the applications do not change
+ */
+void initialise_monitor_handles(void){
+
+	ITM_Init(ITM_SWO_BAUD);
+}
+
+#endif /* ITM_RETARGET */
@@ -0,0 +1,311 @@
+/*
+ * stm32f1xx_log.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include<stdio.h>
+#include<string.h>
+#include"stm32f1xx_log.h"
+
+#define LOG_RING_MASK			(LOG_RING_WORDS - 1)
+
+// The format ID is the offset of the string in log_fmt. On the board the section is linked at address 0
+#ifdef STM32F1_HOST_SIM
+extern const char __start_log_fmt[] __attribute__((weak));	// Weak: applications without log sites have no log_fmt section
+#define LOG_FMT_BASE			((uintptr_t)__start_log_fmt)
+#else
+#define LOG_FMT_BASE			0U
+#endif
+
+/* 			  Private helpers functions	prototypes    				*/
+static uint32_t *LOG_Reserve(uint32_t words, uint32_t *pHead);
+static void LOG_Commit(uint32_t *pHeader, const char *pFmt, uint32_t Flags, uint32_t words);
+
+static uint32_t Ring[LOG_RING_WORDS];
+static volatile uint32_t Head;	// Next word to reserve. Written by the producers with a compare and swap
+static volatile uint32_t Tail;	// First word not released. Only written by LOG_Process
+static uint32_t Ready;			// End of the stored records found by LOG_Process
+static uint32_t Sent;			// Bytes after Tail taken by the output
+static LOG_Output_t pOutputFunc;
+static void *pOutputContext;
+static LOG_Stats_t Stats;
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			LOG_Init (Log initialization)
+ * @brief			This functions empties the ring and selects the output
+ * @param [in]		Output function (LOG_OutputITM, LOG_OutputUSART, LOG_OutputFile or one of the application)
+ * @param [in]		Context passed to the output function
+ * @return			None
+ * @note 			The timestamps are DWT cycles: DWT_Init is called here. With LOG_OutputITM the
+ * 					port LOG_ITM_PORT is enabled (ITM_Init must have been called)
+ */
+void LOG_Init(LOG_Output_t pOutput, void *pContext){
+
+	DWT_Init();
+
+	memset(Ring, 0, sizeof(Ring));
+	Head = 0;
+	Tail = 0;
+	Ready = 0;
+	Sent = 0;
+	Stats.Records = 0;
+	Stats.Dropped = 0;
+	Stats.MaxWords = 0;
+
+	pOutputFunc = pOutput;
+	pOutputContext = pContext;
+	if (pOutput == LOG_OutputITM){
+		ITM_PortControl(LOG_ITM_PORT, ENABLE);
+	}
+}
+
+/******************************************************************
+ * @func			LOG_Write (Log write)
+ * @brief			This functions stores a record with integer arguments
+ * @param [in]		Format string (in the log_fmt section)
+ * @param [in]		Arguments
+ * @param [in]		Number of arguments (up to LOG_MAX_ARGS)
+ * @return			LOG_OK or LOG_FULL
+ * @note 			Called by the LOG macro. No interrupt masking, no formatting
+ */
+uint8_t LOG_Write(const char *pFmt, const uint32_t *pArgs, uint32_t nArgs){
+
+	uint32_t head;
+	uint32_t *pHeader = LOG_Reserve(LOG_RECORD_WORDS + nArgs, &head);
+
+	if (pHeader == NULL){
+		return LOG_FULL;
+	}
+
+	Ring[(head + 1) & LOG_RING_MASK] = DWT_GetCycles();
+	for (uint32_t i = 0; i < nArgs; i++){
+		Ring[(head + LOG_RECORD_WORDS + i) & LOG_RING_MASK] = pArgs[i];
+	}
+	LOG_Commit(pHeader, pFmt, 0, nArgs);
+	return LOG_OK;
+}
+
+/******************************************************************
+ * @func			LOG_WriteData (Log write data)
+ * @brief			This functions stores a record with a copy of a buffer
+ * @param [in]		Format string (in the log_fmt section)
+ * @param [in]		Data
+ * @param [in]		Length. Only the first LOG_DATA_MAX bytes are kept
+ * @return			LOG_OK or LOG_FULL
+ * @note 			The arguments are the length and the bytes, padded to a whole word
+ */
+uint8_t LOG_WriteData(const char *pFmt, const void *pData, uint32_t len){
+
+	const uint8_t *pByte = (const uint8_t*)pData;
+	uint32_t head, word;
+	uint32_t *pHeader;
+
+	if (len > LOG_DATA_MAX){
+		len = LOG_DATA_MAX;
+	}
+	pHeader = LOG_Reserve(LOG_RECORD_WORDS + 1 + (len + 3) / 4, &head);
+	if (pHeader == NULL){
+		return LOG_FULL;
+	}
+
+	Ring[(head + 1) & LOG_RING_MASK] = DWT_GetCycles();
+	Ring[(head + 2) & LOG_RING_MASK] = len;
+	for (uint32_t i = 0; i < len; i += 4){
+		word = 0;
+		memcpy(&word, &pByte[i], (len - i) < 4 ? (len - i) : 4);
+		Ring[(head + 3 + i / 4) & LOG_RING_MASK] = word;
+	}
+	LOG_Commit(pHeader, pFmt, LOG_HDR_DATA, 1 + (len + 3) / 4);
+	return LOG_OK;
+}
+
+/******************************************************************
+ * @func			LOG_Process (Log process)
+ * @brief			This functions sends the stored records to the output
+ * @param [in]		None
+ * @return			Words still waiting in the ring
+ * @note 			Single consumer: call it from the idle loop. The output gets the ring memory
+ * 					itself (two pieces when the records wrap around). A record is cleared and
+ * 					released once all its bytes are done with
+ */
+uint32_t LOG_Process(void){
+
+	uint32_t header, words, index, len, done;
+
+	if (pOutputFunc == NULL){
+		return Head - Tail;
+	}
+
+	while (1){
+		// Stored records after the ones already found. Stops at a record still being written
+		while (Ready != Head){
+			header = __atomic_load_n(&Ring[Ready & LOG_RING_MASK], __ATOMIC_ACQUIRE);
+			if (header == 0){
+				break;
+			}
+			Ready += LOG_RECORD_WORDS + (header & LOG_HDR_WORDS_MASK);
+		}
+
+		// Release the records already sent
+		while (Tail != Ready){
+			words = LOG_RECORD_WORDS + (Ring[Tail & LOG_RING_MASK] & LOG_HDR_WORDS_MASK);
+			if (Sent < words * 4){
+				break;
+			}
+			// Any word can be the header of a later record: they are all cleared
+			for (uint32_t i = 0; i < words; i++){
+				Ring[(Tail + i) & LOG_RING_MASK] = 0;
+			}
+			Sent -= words * 4;
+			__atomic_store_n(&Tail, Tail + words, __ATOMIC_RELEASE); // Released after the words are cleared
+		}
+
+		// Contiguous bytes up to the last stored record or the end of the ring
+		index = (Tail & LOG_RING_MASK) * 4 + Sent;
+		if (index >= LOG_RING_WORDS * 4){
+			index -= LOG_RING_WORDS * 4;
+		}
+		len = (Ready - Tail) * 4 - Sent;
+		if (len > LOG_RING_WORDS * 4 - index){
+			len = LOG_RING_WORDS * 4 - index;
+		}
+		if (len == 0){
+			break;
+		}
+
+		done = pOutputFunc(pOutputContext, (const uint8_t*)Ring + index, len);
+		if (done == 0){
+			break;
+		}
+		Sent += done;
+	}
+
+	return Head - Tail;
+}
+
+/******************************************************************
+ * @func			LOG_GetStats (Log get statistics)
+ * @brief			This functions copies the logging statistics
+ * @param [out]		Statistics
+ * @return			None
+ * @note 			None
+ */
+void LOG_GetStats(LOG_Stats_t *pStats){
+
+	pStats->Records = Stats.Records;
+	pStats->Dropped = Stats.Dropped;
+	pStats->MaxWords = Stats.MaxWords;
+}
+
+/******************************************************************
+ * @func			LOG_OutputITM
+ * @brief			This functions sends log data to the ITM stimulus port LOG_ITM_PORT
+ * @param [in]		Not used
+ * @param [in]		Data
+ * @param [in]		Length
+ * @return			Bytes written
+ * @note 			The SWO stream mixes the ports: decode it with log_decode.py --itm
+ */
+uint32_t LOG_OutputITM(void *pContext, const uint8_t *pData, uint32_t len){
+
+	(void)pContext;
+	return ITM_Write(LOG_ITM_PORT, pData, len);
+}
+
+/******************************************************************
+ * @func			LOG_OutputUSART
+ * @brief			This functions sends log data by USART DMA
+ * @param [in]		USART handle. Its Tx is only used by the log
+ * @param [in]		Data
+ * @param [in]		Length
+ * @return			Bytes of the previous transfer once it is complete, 0 while it is running
+ * @note 			The DMA reads the ring itself: the bytes are only released when the transfer ends
+ */
+uint32_t LOG_OutputUSART(void *pContext, const uint8_t *pData, uint32_t len){
+
+	static uint32_t InFlight;
+	USART_Handle_t *pUSARTHandle = (USART_Handle_t*)pContext;
+	uint32_t done;
+
+	if (pUSARTHandle->TxState != USART_READY){
+		return 0;
+	}
+	if (InFlight != 0){
+		done = InFlight;
+		InFlight = 0;
+		return done;
+	}
+	if (USART_SendDMA(pUSARTHandle, pData, len) == USART_READY){
+		InFlight = len;
+	}
+	return 0;
+}
+
+/******************************************************************
+ * @func			LOG_OutputFile
+ * @brief			This functions writes log data to a file
+ * @param [in]		FILE opened in binary mode
+ * @param [in]		Data
+ * @param [in]		Length
+ * @return			Bytes written
+ * @note 			With rdimon the file is created on the debugger PC (semihosting). The core is
+ * 					stopped during the write: use it when the timing does not matter
+ */
+uint32_t LOG_OutputFile(void *pContext, const uint8_t *pData, uint32_t len){
+
+	return fwrite(pData, 1, len, (FILE*)pContext);
+}
+
+/* 			  Private helpers functions	implementation 				*/
+
+/******************************************************************
+ * @func			LOG_Reserve
+ * @brief			This functions reserves the words of a record in the ring
+ * @param [in]		Words of the record
+ * @param [out]		Free running index of the first word
+ * @return			Header word of the record. NULL when the ring is full
+ * @note 			The compare and swap only repeats when a higher priority ISR reserved space in between
+ */
+static uint32_t *LOG_Reserve(uint32_t words, uint32_t *pHead){
+
+	uint32_t head, tail;
+	uint32_t used;
+
+	do{
+		tail = Tail; // Read before Head: LOG_Process cannot pass a Head read after it
+		head = Head;
+		used = head - tail;
+		if (used + words > LOG_RING_WORDS){
+			__atomic_fetch_add(&Stats.Dropped, 1, __ATOMIC_RELAXED);
+			return NULL;
+		}
+	} while (!__atomic_compare_exchange_n(&Head, &head, head + words, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	if (used + words > Stats.MaxWords){
+		Stats.MaxWords = used + words; // Statistic only: a lost update between ISRs is not important
+	}
+	*pHead = head;
+	return &Ring[head & LOG_RING_MASK];
+}
+
+/******************************************************************
+ * @func			LOG_Commit
+ * @brief			This functions publishes a record by storing its header
+ * @param [in]		Header word of the record
+ * @param [in]		Format string
+ * @param [in]		LOG_HDR_DATA or 0
+ * @param [in]		Argument words
+ * @return			None
+ * @note 			The header is stored after the other words of the record
+ */
+static void LOG_Commit(uint32_t *pHeader, const char *pFmt, uint32_t Flags, uint32_t words){
+
+	uint32_t id = (uint32_t)((uintptr_t)pFmt - LOG_FMT_BASE);
+
+	__atomic_store_n(pHeader, (id << LOG_HDR_ID) | LOG_HDR_MARKER | Flags | words, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&Stats.Records, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,108 @@
+/*
+ * stm32f1xx_nvic.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_nvic.h"
+
+/* 			  Private helpers functions	prototypes    				*/
+static uint8_t NVIC_PreemptBits(uint8_t PriorityGroup);
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			NVIC_SetPriorityGrouping (NVIC set priority grouping)
+ * @brief			This functions sets how the priority bits are split into preempt and sub-priority
+ * @param [in]		Priority group (@NVIC_PriorityGroup)
+ * @return			None
+ * @note 			Set it once before the IRQ priorities, the meaning of the programmed values changes
+ * 					with it. AIRCR ignores writes without VECTKEY. The other AIRCR bits are written as 0
+ */
+void NVIC_SetPriorityGrouping(uint8_t PriorityGroup){
+
+	*SCB_AIRCR = (SCB_AIRCR_VECTKEY_VALUE << SCB_AIRCR_VECTKEY) | ((uint32_t)(PriorityGroup & 0x7) << SCB_AIRCR_PRIGROUP);
+}
+
+/******************************************************************
+ * @func			NVIC_GetPriorityGrouping (NVIC get priority grouping)
+ * @brief			This functions reads the priority grouping
+ * @param [in]		None
+ * @return			PRIGROUP value (0-7). 0-3 behave as NVIC_PRIGROUP_4_0
+ * @note 			None
+ */
+uint8_t NVIC_GetPriorityGrouping(void){
+
+	return (*SCB_AIRCR >> SCB_AIRCR_PRIGROUP) & 0x7;
+}
+
+/******************************************************************
+ * @func			NVIC_EncodePriority (NVIC encode priority)
+ * @brief			This functions builds the priority value of NVIC_SetPriority
+ * @param [in]		Priority group (@NVIC_PriorityGroup)
+ * @param [in]		Preempt priority. Only the bits of the group are used
+ * @param [in]		Sub-priority. Only the bits of the group are used
+ * @return			Priority (0-15)
+ * @note 			Lower values win in both fields
+ */
+uint8_t NVIC_EncodePriority(uint8_t PriorityGroup, uint8_t PreemptPriority, uint8_t SubPriority){
+
+	uint8_t preempt_bits = NVIC_PreemptBits(PriorityGroup);
+	uint8_t sub_bits = NO_PR_BITS_IMPLEMENTED - preempt_bits;
+
+	return (uint8_t)(((PreemptPriority & ((1U << preempt_bits) - 1)) << sub_bits) | (SubPriority & ((1U << sub_bits) - 1)));
+}
+
+/******************************************************************
+ * @func			NVIC_DecodePriority (NVIC decode priority)
+ * @brief			This functions splits a priority value into preempt and sub-priority
+ * @param [in]		Priority (0-15) as read with NVIC_GetPriority
+ * @param [in]		Priority group (@NVIC_PriorityGroup)
+ * @param [out]		Preempt priority
+ * @param [out]		Sub-priority
+ * @return			None
+ * @note 			None
+ */
+void NVIC_DecodePriority(uint8_t Priority, uint8_t PriorityGroup, uint8_t *pPreemptPriority, uint8_t *pSubPriority){
+
+	uint8_t preempt_bits = NVIC_PreemptBits(PriorityGroup);
+	uint8_t sub_bits = NO_PR_BITS_IMPLEMENTED - preempt_bits;
+
+	*pPreemptPriority = (Priority >> sub_bits) & ((1U << preempt_bits) - 1);
+	*pSubPriority = Priority & ((1U << sub_bits) - 1);
+}
+
+/******************************************************************
+ * @func			NVIC_IRQConfig (NVIC IRQ Configuration)
+ * @brief			This functions enables or disables an IRQ
+ * @param [in]		IQR Number
+ * @param [in]		Enable or disable
+ * @return			None
+ * @note 			One store to ISER or ICER. The other IRQs are not touched
+ */
+void NVIC_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
+
+	if (EnOrDi == ENABLE){
+		NVIC_EnableIRQ(IRQNumber);
+	} else {
+		NVIC_DisableIRQ(IRQNumber);
+	}
+}
+
+/* 				  Private helpers functions	 	  				*/
+
+/******************************************************************
+ * @func			NVIC_PreemptBits
+ * @brief			This functions calculates how many implemented priority bits are preempt priority
+ * @param [in]		Priority group (@NVIC_PriorityGroup)
+ * @return			Number of bits (0-4)
+ * @note 			PRIGROUP n puts bits [7:n+1] of the priority byte in the preempt field, and only
+ * 					bits [7:4] exist
+ */
+static uint8_t NVIC_PreemptBits(uint8_t PriorityGroup){
+
+	uint8_t group_bits = 7 - (PriorityGroup & 0x7);
+
+	return (group_bits > NO_PR_BITS_IMPLEMENTED) ? NO_PR_BITS_IMPLEMENTED : group_bits;
+}
@@ -0,0 +1,417 @@
+/*
+ * stm32f1xx_rcc.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_rcc.h"
+
+/* Peripheral descriptor table, indexed by RCC_PERI_SLOT(base address). Built at compile time.
+ * Bits taken from RM0008 7.3.7 (APB2ENR), 7.3.8 (APB1ENR), 7.3.6 (AHBENR), 7.3.4 (APB2RSTR) and 7.3.5 (APB1RSTR) */
+static const RCC_PeriDesc_t RCC_PeriDesc[] = {
+	// APB2
+	[RCC_PERI_SLOT(AFIO_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 0,  {RCC_NO_IRQ, RCC_NO_IRQ}, 0},
+	[RCC_PERI_SLOT(GPIOA_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 2,  {RCC_NO_IRQ, RCC_NO_IRQ}, 0},
+	[RCC_PERI_SLOT(GPIOB_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 3,  {RCC_NO_IRQ, RCC_NO_IRQ}, 1},
+	[RCC_PERI_SLOT(GPIOC_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 4,  {RCC_NO_IRQ, RCC_NO_IRQ}, 2},
+	[RCC_PERI_SLOT(GPIOD_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 5,  {RCC_NO_IRQ, RCC_NO_IRQ}, 3},
+	[RCC_PERI_SLOT(GPIOE_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 6,  {RCC_NO_IRQ, RCC_NO_IRQ}, 4},
+	[RCC_PERI_SLOT(GPIOF_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 7,  {RCC_NO_IRQ, RCC_NO_IRQ}, 5},
+	[RCC_PERI_SLOT(GPIOG_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 8,  {RCC_NO_IRQ, RCC_NO_IRQ}, 6},
+	[RCC_PERI_SLOT(SPI1_BASEADDR)]		= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 12, {IRQ_NO_SPI1, RCC_NO_IRQ}, 1},
+	[RCC_PERI_SLOT(USART1_BASEADDR)]	= {RCC_REG_APB2ENR, RCC_REG_APB2RSTR, 14, {IRQ_NO_USART1, RCC_NO_IRQ}, 1},
+
+	// APB1
+	[RCC_PERI_SLOT(SPI2_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 14, {IRQ_NO_SPI2, RCC_NO_IRQ}, 2},
+	[RCC_PERI_SLOT(SPI3_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 15, {IRQ_NO_SPI3, RCC_NO_IRQ}, 3},
+	[RCC_PERI_SLOT(USART2_BASEADDR)]	= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 17, {IRQ_NO_USART2, RCC_NO_IRQ}, 2},
+	[RCC_PERI_SLOT(USART3_BASEADDR)]	= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 18, {IRQ_NO_USART3, RCC_NO_IRQ}, 3},
+	[RCC_PERI_SLOT(UART4_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 19, {IRQ_NO_UART4, RCC_NO_IRQ}, 4},
+	[RCC_PERI_SLOT(UART5_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 20, {IRQ_NO_UART5, RCC_NO_IRQ}, 5},
+	[RCC_PERI_SLOT(I2C1_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 21, {IRQ_NO_I2C1_EV, IRQ_NO_I2C1_ER}, 1},
+	[RCC_PERI_SLOT(I2C2_BASEADDR)]		= {RCC_REG_APB1ENR, RCC_REG_APB1RSTR, 22, {IRQ_NO_I2C2_EV, IRQ_NO_I2C2_ER}, 2},
+
+	// AHB. DMA1 has no reset bit in the STM32F103
+	[RCC_PERI_SLOT(DMA1_BASEADDR)]		= {RCC_REG_AHBENR,  0,				  0,  {IRQ_NO_DMA1_CH1, RCC_NO_IRQ}, 1},
+};
+
+static RCC_Clocks_t RCC_Clocks; // Cached bus clocks. All 0 until RCC_UpdateClocks runs
+
+static void RCC_CalcClocks(uint32_t Cfgr, uint8_t Source, RCC_Clocks_t *pClocks);
+static uint8_t RCC_WaitFlag(uint32_t Mask, uint32_t Value);
+static uint8_t RCC_SwitchSysClk(uint8_t Source);
+static void RCC_SetPrescalers(uint32_t Prescalers);
+static void RCC_SetFlashLatency(uint32_t SysClk);
+
+/* 				Private Function Implementation 			       */
+
+/******************************************************************
+ * @func			RCC_CalcClocks
+ * @brief			This functions calculates the bus clocks of a CFGR value
+ * @param [in]		CFGR value (PLL and prescaler fields)
+ * @param [in]		System clock source. Possible values @RCC_SysClk
+ * @param [out]		Bus clocks in Hz
+ * @return			None
+ * @note 			Used for the clocks in use and for the target of RCC_ClockConfig
+ */
+static void RCC_CalcClocks(uint32_t Cfgr, uint8_t Source, RCC_Clocks_t *pClocks){
+
+	static const uint16_t ahb_prescaler[8] = {2, 4, 8, 16, 64, 128, 256, 512};
+	uint32_t pllmul, hpre, ppre;
+
+	switch (Source){
+	case RCC_SYSCLK_HSE:
+		pClocks->SYSCLK = HSE_VALUE;
+		break;
+	case RCC_SYSCLK_PLL: // PLLMUL 0 = x2 ... 14 and 15 = x16
+		pllmul = ((Cfgr >> RCC_CFGR_PLLMUL) & 0xF) + 2;
+		if (pllmul > 16){
+			pllmul = 16;
+		}
+		if (Cfgr & (1 << RCC_CFGR_PLLSRC)){
+			pClocks->SYSCLK = ((Cfgr & (1 << RCC_CFGR_PLLXTPRE)) ? (HSE_VALUE / 2) : HSE_VALUE) * pllmul;
+		} else {
+			pClocks->SYSCLK = (HSI_VALUE / 2) * pllmul;
+		}
+		break;
+	default:
+		pClocks->SYSCLK = HSI_VALUE;
+		break;
+	}
+
+	hpre = (Cfgr >> RCC_CFGR_HPRE) & 0xF;
+	pClocks->HCLK = (hpre < 8) ? pClocks->SYSCLK : (pClocks->SYSCLK / ahb_prescaler[hpre - 8]);
+
+	// APB prescalers 4-7 divide by 2-16
+	ppre = (Cfgr >> RCC_CFGR_PPRE1) & 0x7;
+	pClocks->PCLK1 = (ppre < 4) ? pClocks->HCLK : (pClocks->HCLK >> (ppre - 3));
+	ppre = (Cfgr >> RCC_CFGR_PPRE2) & 0x7;
+	pClocks->PCLK2 = (ppre < 4) ? pClocks->HCLK : (pClocks->HCLK >> (ppre - 3));
+}
+
+/******************************************************************
+ * @func			RCC_WaitFlag
+ * @brief			This functions waits until some bits of RCC_CR take a value
+ * @param [in]		Mask of the bits
+ * @param [in]		Expected value of the bits
+ * @return			RCC_OK or RCC_TIMEOUT
+ * @note 			Counted polls: the DWT time base depends on the clock being changed
+ */
+static uint8_t RCC_WaitFlag(uint32_t Mask, uint32_t Value){
+
+	for (uint32_t i = 0; i < RCC_STARTUP_TIMEOUT; i++){
+		if ((RCC->CR & Mask) == Value){
+			return RCC_OK;
+		}
+	}
+
+	return RCC_TIMEOUT;
+}
+
+/******************************************************************
+ * @func			RCC_SwitchSysClk
+ * @brief			This functions selects the system clock source
+ * @param [in]		Source. Possible values @RCC_SysClk
+ * @return			RCC_OK or RCC_TIMEOUT
+ * @note 			The switch is done when SWS shows the new source
+ */
+static uint8_t RCC_SwitchSysClk(uint8_t Source){
+
+	RCC->CFGR = (RCC->CFGR & ~(0x3 << RCC_CFGR_SW)) | ((uint32_t)Source << RCC_CFGR_SW);
+
+	for (uint32_t i = 0; i < RCC_STARTUP_TIMEOUT; i++){
+		if (((RCC->CFGR >> RCC_CFGR_SWS) & 0x3) == Source){
+			return RCC_OK;
+		}
+	}
+
+	return RCC_TIMEOUT;
+}
+
+/******************************************************************
+ * @func			RCC_SetPrescalers
+ * @brief			This functions writes the AHB, APB1 and APB2 prescalers
+ * @param [in]		HPRE, PPRE1 and PPRE2 fields in their CFGR positions
+ * @return			None
+ * @note 			None
+ */
+static void RCC_SetPrescalers(uint32_t Prescalers){
+
+	uint32_t mask = (0xF << RCC_CFGR_HPRE) | (0x7 << RCC_CFGR_PPRE1) | (0x7 << RCC_CFGR_PPRE2);
+
+	RCC->CFGR = (RCC->CFGR & ~mask) | (Prescalers & mask);
+}
+
+/******************************************************************
+ * @func			RCC_SetFlashLatency
+ * @brief			This functions sets the flash wait states for a system clock
+ * @param [in]		System clock in Hz
+ * @return			None
+ * @note 			0 WS up to 24 MHz, 1 WS up to 48 MHz, 2 WS up to 72 MHz. The prefetch buffer is kept on
+ */
+static void RCC_SetFlashLatency(uint32_t SysClk){
+
+	uint32_t latency = (SysClk - 1) / RCC_FLASH_WS_STEP;
+
+	FLASH->ACR = (FLASH->ACR & ~(0x7 << FLASH_ACR_LATENCY)) | (latency << FLASH_ACR_LATENCY) | (1 << FLASH_ACR_PRFTBE);
+}
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			RCC_GetPeriDesc (RCC get peripheral descriptor)
+ * @brief			This functions returns the descriptor of a peripheral
+ * @param [in]		Base Address of the peripheral
+ * @return			Descriptor. NULL if the peripheral is not in the table
+ * @note 			O(1): the base address is turned into the table index
+ */
+const RCC_PeriDesc_t *RCC_GetPeriDesc(const volatile void *pPeriph){
+
+	uint32_t slot = RCC_PERI_SLOT(pPeriph);
+
+	if ((slot >= (sizeof(RCC_PeriDesc) / sizeof(RCC_PeriDesc[0]))) || (RCC_PeriDesc[slot].EnReg == 0)){
+		return NULL;
+	}
+
+	return &RCC_PeriDesc[slot];
+}
+
+/******************************************************************
+ * @func			RCC_PeriClkCtrl (RCC Peripheral Clock Control)
+ * @brief			This functions enables or disables the clock of any peripheral in the table
+ * @param [in]		Base Address of the peripheral
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			Unknown peripherals are ignored
+ */
+void RCC_PeriClkCtrl(const volatile void *pPeriph, uint8_t EnOrDi){
+
+	const RCC_PeriDesc_t *pDesc = RCC_GetPeriDesc(pPeriph);
+
+	if (pDesc == NULL){
+		return;
+	}
+
+	if (EnOrDi == ENABLE){
+		((volatile uint32_t*)RCC)[pDesc->EnReg] |= (1 << pDesc->Bit);
+	} else {
+		((volatile uint32_t*)RCC)[pDesc->EnReg] &= ~(1 << pDesc->Bit);
+	}
+}
+
+/******************************************************************
+ * @func			RCC_PeriReset (RCC Peripheral Reset)
+ * @brief			This functions resets all the registers of a peripheral
+ * @param [in]		Base Address of the peripheral
+ * @return			None
+ * @note 			The reset bit is set and cleared again. Peripherals without a reset bit are ignored
+ */
+void RCC_PeriReset(const volatile void *pPeriph){
+
+	const RCC_PeriDesc_t *pDesc = RCC_GetPeriDesc(pPeriph);
+
+	if ((pDesc == NULL) || (pDesc->RstReg == 0)){
+		return;
+	}
+
+	((volatile uint32_t*)RCC)[pDesc->RstReg] |= (1 << pDesc->Bit);
+	((volatile uint32_t*)RCC)[pDesc->RstReg] &= ~(1 << pDesc->Bit);
+}
+
+/******************************************************************
+ * @func			RCC_ClockConfig (RCC clock configuration)
+ * @brief			This functions configures the system clock, the PLL and the bus prescalers
+ * @param [in]		Clock tree configuration
+ * @return			RCC_OK, RCC_ERROR (limits of the MCU, nothing changed) or RCC_TIMEOUT
+ * @note 			Order of the changes so that no clock is ever out of its limits:
+ * 					1. HSI (fallback) and HSE, if used, are started.
+ * 					2. The flash wait states are set for the faster of the old and new clocks.
+ * 					   When the clock goes up the bus prescalers are set before the switch.
+ * 					3. The PLL is configured with SYSCLK running from HSI.
+ * 					4. Switch. Then the prescalers (clock going down) and the final wait states.
+ * 					The clock cache and the DWT time base are updated, so the drivers take the new
+ * 					values from the next I2C_Init/SPI_Init. On RCC_TIMEOUT SYSCLK stays on HSI or
+ * 					on the previous source and the cache shows it
+ */
+uint8_t RCC_ClockConfig(const RCC_ClkConfig_t *pClkConfig){
+
+	RCC_Clocks_t target;
+	uint32_t prescalers, pll = 0, current;
+	uint8_t source = pClkConfig->RCC_SysClkSource;
+	uint8_t hse = 0, status;
+
+	// Target values of the CFGR fields
+	prescalers = ((uint32_t)pClkConfig->RCC_AHBPrescaler << RCC_CFGR_HPRE) |
+				 ((uint32_t)pClkConfig->RCC_APB1Prescaler << RCC_CFGR_PPRE1) |
+				 ((uint32_t)pClkConfig->RCC_APB2Prescaler << RCC_CFGR_PPRE2);
+
+	if (source == RCC_SYSCLK_PLL){
+		if ((pClkConfig->RCC_PLLMul < 2) || (pClkConfig->RCC_PLLMul > 16)){
+			return RCC_ERROR;
+		}
+		pll = (uint32_t)(pClkConfig->RCC_PLLMul - 2) << RCC_CFGR_PLLMUL;
+		if (pClkConfig->RCC_PLLSource != RCC_PLLSRC_HSI_DIV2){
+			pll |= (1 << RCC_CFGR_PLLSRC);
+			hse = 1;
+		}
+		if (pClkConfig->RCC_PLLSource == RCC_PLLSRC_HSE_DIV2){
+			pll |= (1 << RCC_CFGR_PLLXTPRE);
+		}
+	} else if (source == RCC_SYSCLK_HSE){
+		hse = 1;
+	} else if (source != RCC_SYSCLK_HSI){
+		return RCC_ERROR;
+	}
+
+	RCC_CalcClocks(prescalers | pll, source, &target);
+	if ((target.SYSCLK > RCC_SYSCLK_MAX) || (target.PCLK1 > RCC_PCLK1_MAX)){
+		return RCC_ERROR;
+	}
+
+	current = RCC_GetSYSCLKValue();
+
+	// 1. Oscillators
+	RCC->CR |= (1 << RCC_CR_HSION);
+	status = RCC_WaitFlag((1 << RCC_CR_HSIRDY), (1 << RCC_CR_HSIRDY));
+	if ((status == RCC_OK) && hse){
+		RCC->CR |= (1 << RCC_CR_HSEON);
+		status = RCC_WaitFlag((1 << RCC_CR_HSERDY), (1 << RCC_CR_HSERDY));
+	}
+
+	// 2. Wait states and prescalers of a speed up
+	if (status == RCC_OK){
+		RCC_SetFlashLatency((target.SYSCLK > current) ? target.SYSCLK : current);
+		if (target.SYSCLK >= current){
+			RCC_SetPrescalers(prescalers);
+		}
+	}
+
+	// 3. PLL. It cannot be changed while it is running
+	if ((status == RCC_OK) && (source == RCC_SYSCLK_PLL)){
+		status = RCC_SwitchSysClk(RCC_SYSCLK_HSI);
+		if (status == RCC_OK){
+			RCC->CR &= ~(1 << RCC_CR_PLLON);
+			status = RCC_WaitFlag((1 << RCC_CR_PLLRDY), 0);
+		}
+		if (status == RCC_OK){
+			RCC->CFGR = (RCC->CFGR & ~((0xF << RCC_CFGR_PLLMUL) | (1 << RCC_CFGR_PLLSRC) | (1 << RCC_CFGR_PLLXTPRE))) | pll;
+			RCC->CR |= (1 << RCC_CR_PLLON);
+			status = RCC_WaitFlag((1 << RCC_CR_PLLRDY), (1 << RCC_CR_PLLRDY));
+		}
+	}
+
+	// 4. Switch, prescalers of a slow down and final wait states
+	if (status == RCC_OK){
+		status = RCC_SwitchSysClk(source);
+	}
+	if (status == RCC_OK){
+		RCC_SetPrescalers(prescalers);
+		RCC_SetFlashLatency(target.SYSCLK);
+	}
+
+	RCC_UpdateClocks();
+	DWT_Init();
+
+	return status;
+}
+
+/******************************************************************
+ * @func			RCC_SetSysClk72MHz (RCC set system clock to 72 MHz)
+ * @brief			This functions runs the MCU at its maximum speed
+ * @param [in]		None
+ * @return			RCC_OK, RCC_ERROR or RCC_TIMEOUT (no crystal)
+ * @note 			HSE (HSE_VALUE = 8 MHz) x 9 = 72 MHz. AHB 72 MHz, APB1 36 MHz, APB2 72 MHz, 2 wait states
+ */
+uint8_t RCC_SetSysClk72MHz(void){
+
+	RCC_ClkConfig_t ClkConfig;
+
+	ClkConfig.RCC_SysClkSource = RCC_SYSCLK_PLL;
+	ClkConfig.RCC_PLLSource = RCC_PLLSRC_HSE;
+	ClkConfig.RCC_PLLMul = RCC_SYSCLK_MAX / HSE_VALUE;
+	ClkConfig.RCC_AHBPrescaler = RCC_AHB_DIV_1;
+	ClkConfig.RCC_APB1Prescaler = RCC_APB_DIV_2;
+	ClkConfig.RCC_APB2Prescaler = RCC_APB_DIV_1;
+
+	return RCC_ClockConfig(&ClkConfig);
+}
+
+/******************************************************************
+ * @func			RCC_UpdateClocks (RCC update clocks)
+ * @brief			This functions reloads the cached bus clocks from the RCC registers
+ * @param [in]		None
+ * @return			None
+ * @note 			The source is taken from SWS (the clock really in use), not from SW.
+ * 					RCC_ClockConfig calls it. Only needed after changing CFGR by hand
+ */
+void RCC_UpdateClocks(void){
+
+	uint32_t cfgr = RCC->CFGR;
+
+	RCC_CalcClocks(cfgr, (cfgr >> RCC_CFGR_SWS) & 0x3, &RCC_Clocks);
+}
+
+/******************************************************************
+ * @func			RCC_GetSYSCLKValue (RCC get system clock value)
+ * @brief			This functions returns the frequency of the system clock
+ * @param [in]		None
+ * @return			Frequency of the clock in Hz
+ * @note 			Cached value
+ */
+uint32_t RCC_GetSYSCLKValue(void){
+
+	if (RCC_Clocks.SYSCLK == 0){
+		RCC_UpdateClocks();
+	}
+
+	return RCC_Clocks.SYSCLK;
+}
+
+/******************************************************************
+ * @func			RCC_GetHCLKValue (RCC get AHB clock value)
+ * @brief			This functions returns the frequency of the AHB clock
+ * @param [in]		None
+ * @return			Frequency of the clock in Hz
+ * @note 			Cached value. The Cortex-M3 core and the DWT cycle counter run at this clock
+ */
+uint32_t RCC_GetHCLKValue(void){
+
+	if (RCC_Clocks.SYSCLK == 0){
+		RCC_UpdateClocks();
+	}
+
+	return RCC_Clocks.HCLK;
+}
+
+/******************************************************************
+ * @func			RCC_GetPCLK1Value (RCC get APB1 clock value)
+ * @brief			This functions returns the frequency of the APB1 clock
+ * @param [in]		None
+ * @return			Frequency of the clock in Hz
+ * @note 			Cached value. Clock of I2C1/2 and SPI2/3
+ */
+uint32_t RCC_GetPCLK1Value(void){
+
+	if (RCC_Clocks.SYSCLK == 0){
+		RCC_UpdateClocks();
+	}
+
+	return RCC_Clocks.PCLK1;
+}
+
+/******************************************************************
+ * @func			RCC_GetPCLK2Value (RCC get APB2 clock value)
+ * @brief			This functions returns the frequency of the APB2 clock
+ * @param [in]		None
+ * @return			Frequency of the clock in Hz
+ * @note 			Cached value. Clock of SPI1
+ */
+uint32_t RCC_GetPCLK2Value(void){
+
+	if (RCC_Clocks.SYSCLK == 0){
+		RCC_UpdateClocks();
+	}
+
+	return RCC_Clocks.PCLK2;
+}
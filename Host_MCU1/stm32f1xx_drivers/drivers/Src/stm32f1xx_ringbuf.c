@@ -0,0 +1,107 @@
+/*
+ * stm32f1xx_ringbuf.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_ringbuf.h"
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			RingBuf_Init (Ring buffer Initialization)
+ * @brief			This functions initializes an empty ring buffer
+ * @param [in]		Ring buffer
+ * @param [in]		Storage of the ring
+ * @param [in]		Size of the storage in bytes. It must be a power of 2 (up to 32768)
+ * @return			RINGBUF_OK or RINGBUF_INVALID
+ * @note 			Call it while neither the producer nor the consumer is using the ring. Another size
+ * 					would give a mask that writes past the buffer (0) or aliases the indexes, so the
+ * 					ring is left without storage: the drivers refuse it (SPI_SetRxRing...)
+ */
+uint8_t RingBuf_Init(RingBuf_t *pRing, uint8_t *pBuffer, uint16_t size){
+
+	pRing->Head = 0;
+	pRing->Tail = 0;
+	pRing->Dropped = 0;
+
+	if ((size == 0) || (size & (size - 1))){
+		pRing->pBuffer = NULL;
+		pRing->Mask = 0;
+		return RINGBUF_INVALID;
+	}
+
+	pRing->pBuffer = pBuffer;
+	pRing->Mask = size - 1;
+
+	return RINGBUF_OK;
+}
+
+/******************************************************************
+ * @func			RingBuf_Write (Ring buffer Write)
+ * @brief			This functions stores a block of bytes in the ring
+ * @param [in]		Ring buffer
+ * @param [in]		Data to store
+ * @param [in]		Number of bytes
+ * @return			Number of bytes stored. Less than len if the ring is full
+ * @note 			Producer side. Head is updated once, after all the bytes are stored
+ */
+uint32_t RingBuf_Write(RingBuf_t *pRing, const uint8_t *pData, uint32_t len){
+
+	uint16_t head = pRing->Head;
+	uint32_t space = (uint32_t)pRing->Mask + 1 - (uint16_t)(head - pRing->Tail);
+	uint32_t i;
+
+	if (len > space){
+		len = space;
+	}
+
+	for (i = 0; i < len; i++){
+		pRing->pBuffer[(uint16_t)(head + i) & pRing->Mask] = pData[i];
+	}
+
+	pRing->Head = head + len;
+
+	return len;
+}
+
+/******************************************************************
+ * @func			RingBuf_Read (Ring buffer Read)
+ * @brief			This functions copies a block of bytes out of the ring
+ * @param [in]		Ring buffer
+ * @param [in]		Buffer to store the data
+ * @param [in]		Maximum number of bytes to copy
+ * @return			Number of bytes copied
+ * @note 			Consumer side. Tail is updated once, after all the bytes are copied
+ */
+uint32_t RingBuf_Read(RingBuf_t *pRing, uint8_t *pData, uint32_t len){
+
+	uint16_t tail = pRing->Tail;
+	uint32_t count = (uint16_t)(pRing->Head - tail);
+	uint32_t i;
+
+	if (len > count){
+		len = count;
+	}
+
+	for (i = 0; i < len; i++){
+		pData[i] = pRing->pBuffer[(uint16_t)(tail + i) & pRing->Mask];
+	}
+
+	pRing->Tail = tail + len;
+
+	return len;
+}
+
+/******************************************************************
+ * @func			RingBuf_Flush (Ring buffer Flush)
+ * @brief			This functions discards all the bytes stored in the ring
+ * @param [in]		Ring buffer
+ * @return			None
+ * @note 			Consumer side. Bytes stored by the producer while it runs may be kept
+ */
+void RingBuf_Flush(RingBuf_t *pRing){
+
+	pRing->Tail = pRing->Head;
+}
@@ -0,0 +1,2285 @@
+/*
+ * stm32f1xx_sim.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+// Host register simulator. The whole file is empty unless the project is built with -DSTM32F1_HOST_SIM
+
+#define _GNU_SOURCE // Needed for the ucontext register names and MAP_FIXED_NOREPLACE
+
+#include"stm32f1xx_sim.h"
+
+#ifdef STM32F1_HOST_SIM
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "The register simulator only runs on Linux x86-64"
+#endif
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/* 							Private macros 								*/
+#define SIM_PAGE_SIZE			4096U
+#define SIM_EFLAGS_TF			0x100		// x86 trap flag: trap after the next instruction
+#define SIM_PF_WRITE			0x2			// Page fault error code: the access was a write
+#define SIM_MAX_INFLIGHT		4			// Register accesses done by a single instruction
+#define SIM_IRQ_STORM_LIMIT		100000U	// Handler calls in a row before the IRQ is reported as stuck
+#define SIM_NUM_IRQS			60
+#define SIM_VEC_PENDSV			SIM_NUM_IRQS	// System exceptions are delivered with numbers after the IRQs
+#define SIM_VEC_SYSTICK			(SIM_NUM_IRQS + 1)
+#define SIM_WFI_SLEEP_NS		20000U		// Host sleep between two checks of the wake up condition of WFI
+#define SIM_SYSTICK_CALIB		9000U		// 1 ms at HCLK/8 = 9 MHz
+#define SIM_HSI_VALUE			8000000U
+#define SIM_HSE_VALUE			8000000U	// Blue Pill crystal
+
+#define SIM_SCS_BASEADDR		0xE000E000U	// System control space (NVIC, SysTick, SCB)
+
+/* RCC offsets used by the peripheral table */
+#define SIM_RCC_AHBENR			0x14
+#define SIM_RCC_APB2ENR			0x18
+#define SIM_RCC_APB1ENR			0x1C
+#define SIM_RCC_APB2RSTR		0x0C
+#define SIM_RCC_APB1RSTR		0x10
+
+/* Bits that are not defined in the MCU header */
+#define SIM_RCC_CR_HSION		0
+#define SIM_RCC_CR_HSIRDY		1
+#define SIM_RCC_CR_HSEON		16
+#define SIM_RCC_CR_HSERDY		17
+#define SIM_RCC_CR_PLLON		24
+#define SIM_RCC_CR_PLLRDY		25
+#define SIM_I2C_SR1_FLAGS_MASK	0x00FF		// SR1 bits [15:8] are rc_w0, the rest are read only
+#define SIM_USART_SR_RC_W0		((1 << USART_SR_RXNE) | (1 << USART_SR_TC) | (1 << USART_SR_LBD) | (1 << USART_SR_CTS))
+#define SIM_USART_SR_SEQ_CLR	((1 << USART_SR_PE) | (1 << USART_SR_FE) | (1 << USART_SR_NE) | (1 << USART_SR_ORE) | (1 << USART_SR_IDLE))
+
+/* 							Private types 								*/
+
+// Window of the address space mapped at its real address
+typedef struct{
+	uint32_t BaseAddr;
+	uint32_t Size;
+	uint8_t  *pBacking;		// Second mapping of the same memory, used by the models. Never traps
+}SIM_Window_t;
+
+// A register access that is being single stepped
+typedef struct{
+	uint32_t Addr;
+	uint8_t  Write;
+	uint32_t Pre;			// Register value before the access
+	uint32_t AliasAddr;		// Bit-band alias word used by the instruction. 0 = direct access
+	uint8_t  Bit;			// Bit-band access: bit of the register
+	uint8_t  Size;			// Bytes stored by the instruction (1, 2 or 4). Reads are 4
+}SIM_Access_t;
+
+// Simulated peripheral
+typedef struct{
+	uint32_t BaseAddr;
+	uint8_t  EnReg;			// RCC enable register offset. 0 = always clocked
+	uint8_t  EnBit;
+	uint8_t  RstReg;		// RCC reset register offset. 0 = no reset bit
+	uint8_t  RstBit;
+	void (*Reset)(uint32_t BaseAddr);
+	void (*Access)(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+}SIM_Periph_t;
+
+typedef struct{
+	SIM_SPIDevice_t Device;
+	void 	 *pContext;
+	uint16_t RxData;		// Value returned by DR reads
+	uint16_t TxData;		// Frame written while the SPI was disabled
+	uint8_t  TxPending;
+	uint8_t  OVRDRRead;		// OVR clear sequence: DR read done, SR read pending
+}SIM_SPIState_t;
+
+typedef struct{
+	struct{
+		uint8_t Addr;
+		const SIM_I2CDevice_t *pDevice;
+		void *pContext;
+	}Devices[SIM_MAX_I2C_DEVICES];
+	uint8_t  DeviceCnt;
+	int8_t	 Active;		// Device selected in the address phase. -1 = none
+	uint8_t  Master;
+	uint8_t  Receiving;		// Master receiver: the master keeps clocking bytes in until STOP/START
+	uint8_t  LastAck;		// Master receiver: last byte was ACKed so the slave keeps driving SDA
+	uint8_t  StopPending;
+	uint8_t  RxData;		// Value returned by DR reads
+	uint32_t SR1Read;		// SR1 value seen by the last SR1 read (flag clear sequences)
+	uint8_t  ExtMode;		// External master transfer in progress
+	uint8_t  *pExtBuffer;
+	uint32_t ExtLen;
+	uint32_t ExtCnt;
+}SIM_I2CState_t;
+
+typedef struct{
+	SIM_USARTDevice_t Device;
+	void 	 *pContext;
+	uint16_t RxData;		// Value returned by DR reads
+	uint32_t SRRead;		// SR value seen by the last SR read (flag clear sequence)
+}SIM_USARTState_t;
+
+// DMA1 channel. CPAR/CMAR keep the programmed values, the current addresses live here
+typedef struct{
+	uint32_t  PeriAddr;
+	uintptr_t MemAddr;
+	uint32_t  MemUpper;		// Upper half of the host pointer written in CMAR
+	uint16_t  Len;			// CNDTR when the channel was enabled (half transfer and circular mode)
+}SIM_DMAChannel_t;
+
+#define SIM_EXT_NONE	0
+#define SIM_EXT_WRITE	1
+#define SIM_EXT_READ	2
+
+/* 			  Private helpers functions	prototypes    				*/
+static void SIM_GPIO_Reset(uint32_t BaseAddr);
+static void SIM_GPIO_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_AFIO_Reset(uint32_t BaseAddr);
+static void SIM_AFIO_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_EXTI_Reset(uint32_t BaseAddr);
+static void SIM_EXTI_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_SPI_Reset(uint32_t BaseAddr);
+static void SIM_SPI_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_I2C_Reset(uint32_t BaseAddr);
+static void SIM_I2C_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_USART_Reset(uint32_t BaseAddr);
+static void SIM_USART_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_RCC_Reset(uint32_t BaseAddr);
+static void SIM_RCC_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_DMA_Reset(uint32_t BaseAddr);
+static void SIM_DMA_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_DMA_Service(void);
+static void SIM_NVIC_Reset(uint32_t BaseAddr);
+static void SIM_NVIC_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_NVIC_Refresh(void);
+static void SIM_DWT_Reset(uint32_t BaseAddr);
+static void SIM_DWT_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_ITM_Reset(uint32_t BaseAddr);
+static void SIM_ITM_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre);
+static void SIM_DWT_Update(void);
+static void SIM_SysTick_Update(void);
+static void SIM_DeliverIRQs(void);
+
+/* 							Private data 								*/
+static SIM_Window_t Windows[] = {
+	{PERIPH_BASEADDR,	0x24000, NULL},	// APB1, APB2, DMA, RCC and flash interface
+	{0xE0000000U,		0x43000, NULL},	// ITM, DWT, NVIC, SysTick, SCB, TPIU and DBGMCU
+	{PERIPH_BB_BASEADDR, 0x24000 << 5, NULL}, // Bit-band alias of the first window
+};
+
+static const SIM_Periph_t Periphs[] = {
+	{GPIOA_BASEADDR, SIM_RCC_APB2ENR, 2, SIM_RCC_APB2RSTR, 2, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOB_BASEADDR, SIM_RCC_APB2ENR, 3, SIM_RCC_APB2RSTR, 3, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOC_BASEADDR, SIM_RCC_APB2ENR, 4, SIM_RCC_APB2RSTR, 4, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOD_BASEADDR, SIM_RCC_APB2ENR, 5, SIM_RCC_APB2RSTR, 5, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOE_BASEADDR, SIM_RCC_APB2ENR, 6, SIM_RCC_APB2RSTR, 6, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOF_BASEADDR, SIM_RCC_APB2ENR, 7, SIM_RCC_APB2RSTR, 7, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{GPIOG_BASEADDR, SIM_RCC_APB2ENR, 8, SIM_RCC_APB2RSTR, 8, SIM_GPIO_Reset, SIM_GPIO_Access},
+	{AFIO_BASEADDR,	 SIM_RCC_APB2ENR, 0, SIM_RCC_APB2RSTR, 0, SIM_AFIO_Reset, SIM_AFIO_Access},
+	{EXTI_BASEADDR,	 0,				  0, 0,				   0, SIM_EXTI_Reset, SIM_EXTI_Access},
+	{SPI1_BASEADDR,	 SIM_RCC_APB2ENR, 12, SIM_RCC_APB2RSTR, 12, SIM_SPI_Reset, SIM_SPI_Access},
+	{SPI2_BASEADDR,	 SIM_RCC_APB1ENR, 14, SIM_RCC_APB1RSTR, 14, SIM_SPI_Reset, SIM_SPI_Access},
+	{SPI3_BASEADDR,	 SIM_RCC_APB1ENR, 15, SIM_RCC_APB1RSTR, 15, SIM_SPI_Reset, SIM_SPI_Access},
+	{I2C1_BASEADDR,	 SIM_RCC_APB1ENR, 21, SIM_RCC_APB1RSTR, 21, SIM_I2C_Reset, SIM_I2C_Access},
+	{I2C2_BASEADDR,	 SIM_RCC_APB1ENR, 22, SIM_RCC_APB1RSTR, 22, SIM_I2C_Reset, SIM_I2C_Access},
+	{USART1_BASEADDR, SIM_RCC_APB2ENR, 14, SIM_RCC_APB2RSTR, 14, SIM_USART_Reset, SIM_USART_Access},
+	{USART2_BASEADDR, SIM_RCC_APB1ENR, 17, SIM_RCC_APB1RSTR, 17, SIM_USART_Reset, SIM_USART_Access},
+	{USART3_BASEADDR, SIM_RCC_APB1ENR, 18, SIM_RCC_APB1RSTR, 18, SIM_USART_Reset, SIM_USART_Access},
+	{DMA1_BASEADDR,	 SIM_RCC_AHBENR,  0, 0,				   0, SIM_DMA_Reset, SIM_DMA_Access},
+	{RCC_BASEADDR,	 0,				  0, 0,				   0, SIM_RCC_Reset, SIM_RCC_Access},
+	{SIM_SCS_BASEADDR, 0,			  0, 0,				   0, SIM_NVIC_Reset, SIM_NVIC_Access},
+	{DWT_BASEADDR,	 0,				  0, 0,				   0, SIM_DWT_Reset, SIM_DWT_Access},
+	{ITM_BASEADDR,	 0,				  0, 0,				   0, SIM_ITM_Reset, SIM_ITM_Access},
+};
+
+static SIM_Access_t InFlight[SIM_MAX_INFLIGHT];
+static volatile uint32_t InFlightCnt;
+static volatile uint32_t IsrDepth;
+static volatile uint16_t RunningPrio = 0x100;	// Preempt priority of the running handler. 0x100 = thread mode
+static uint8_t Initialized;
+static SIM_Stats_t Stats;
+
+static SIM_SPIState_t SPIState[3];
+static SIM_I2CState_t I2CState[2];
+static SIM_USARTState_t USARTState[3];
+static uint16_t GPIOExtLevel[7];	// Level forced from outside on each port
+static uint16_t GPIOExtDriven[7];	// Pins forced from outside
+static uint16_t GPIOLevel[7];		// Current pin levels, used for EXTI edge detection
+
+static SIM_DMAChannel_t DMAState[7];
+static uint32_t DMAMemUpper;		// Upper half of the last pointer passed to SIM_DMA_MemAddr
+#define SIM_DMA_MAX_ITEMS		0x100000U	// Items moved per register access (circular transfers never end)
+
+static uint32_t NVICEnabled[3];
+static uint32_t NVICPending[3];		// Software/latched pending bits
+static uint32_t NVICActive[3];
+static uint8_t  PendSVPending;
+static uint8_t  SysTickPending;
+static uint8_t  IRQMasked;			// PRIMASK
+
+static uint64_t DWTLastNs;			// Host time of the last CYCCNT update
+static uint64_t DWTFraction;		// Cycles * 10^9 not added to CYCCNT yet
+static uint64_t SysTickLastNs;		// Host time of the last SysTick counter update
+static uint64_t SysTickFraction;	// Counter clocks * 10^9 not counted yet
+
+static uint8_t  AccessSize = 4;		// Size of the access being modeled. Only the ITM stimulus ports use it
+static SIM_ITMDevice_t ITMDevice;
+static void *ITMContext;
+
+/* Application handlers. Same names used in the startup file */
+#define SIM_WEAK __attribute__((weak))
+extern void WWDG_IRQHandler(void) SIM_WEAK;				extern void PVD_IRQHandler(void) SIM_WEAK;
+extern void TAMPER_IRQHandler(void) SIM_WEAK;			extern void RTC_IRQHandler(void) SIM_WEAK;
+extern void FLASH_IRQHandler(void) SIM_WEAK;			extern void RCC_IRQHandler(void) SIM_WEAK;
+extern void EXTI0_IRQHandler(void) SIM_WEAK;			extern void EXTI1_IRQHandler(void) SIM_WEAK;
+extern void EXTI2_IRQHandler(void) SIM_WEAK;			extern void EXTI3_IRQHandler(void) SIM_WEAK;
+extern void EXTI4_IRQHandler(void) SIM_WEAK;			extern void DMA1_Channel1_IRQHandler(void) SIM_WEAK;
+extern void DMA1_Channel2_IRQHandler(void) SIM_WEAK;	extern void DMA1_Channel3_IRQHandler(void) SIM_WEAK;
+extern void DMA1_Channel4_IRQHandler(void) SIM_WEAK;	extern void DMA1_Channel5_IRQHandler(void) SIM_WEAK;
+extern void DMA1_Channel6_IRQHandler(void) SIM_WEAK;	extern void DMA1_Channel7_IRQHandler(void) SIM_WEAK;
+extern void ADC1_2_IRQHandler(void) SIM_WEAK;			extern void USB_HP_CAN_TX_IRQHandler(void) SIM_WEAK;
+extern void USB_LP_CAN_RX0_IRQHandler(void) SIM_WEAK;	extern void CAN_RX1_IRQHandler(void) SIM_WEAK;
+extern void CAN_SCE_IRQHandler(void) SIM_WEAK;			extern void EXTI9_5_IRQHandler(void) SIM_WEAK;
+extern void TIM1_BRK_IRQHandler(void) SIM_WEAK;			extern void TIM1_UP_IRQHandler(void) SIM_WEAK;
+extern void TIM1_TRG_COM_IRQHandler(void) SIM_WEAK;		extern void TIM1_CC_IRQHandler(void) SIM_WEAK;
+extern void TIM2_IRQHandler(void) SIM_WEAK;				extern void TIM3_IRQHandler(void) SIM_WEAK;
+extern void TIM4_IRQHandler(void) SIM_WEAK;				extern void I2C1_EV_IRQHandler(void) SIM_WEAK;
+extern void I2C1_ER_IRQHandler(void) SIM_WEAK;			extern void I2C2_EV_IRQHandler(void) SIM_WEAK;
+extern void I2C2_ER_IRQHandler(void) SIM_WEAK;			extern void SPI1_IRQHandler(void) SIM_WEAK;
+extern void SPI2_IRQHandler(void) SIM_WEAK;				extern void USART1_IRQHandler(void) SIM_WEAK;
+extern void USART2_IRQHandler(void) SIM_WEAK;			extern void USART3_IRQHandler(void) SIM_WEAK;
+extern void EXTI15_10_IRQHandler(void) SIM_WEAK;		extern void RTCAlarm_IRQHandler(void) SIM_WEAK;
+extern void TIM8_BRK_IRQHandler(void) SIM_WEAK;			extern void TIM8_UP_IRQHandler(void) SIM_WEAK;
+extern void TIM8_TRG_COM_IRQHandler(void) SIM_WEAK;		extern void TIM8_CC_IRQHandler(void) SIM_WEAK;
+extern void ADC3_IRQHandler(void) SIM_WEAK;				extern void FSMC_IRQHandler(void) SIM_WEAK;
+extern void SDIO_IRQHandler(void) SIM_WEAK;				extern void TIM5_IRQHandler(void) SIM_WEAK;
+extern void SPI3_IRQHandler(void) SIM_WEAK;				extern void UART4_IRQHandler(void) SIM_WEAK;
+extern void UART5_IRQHandler(void) SIM_WEAK;			extern void TIM6_IRQHandler(void) SIM_WEAK;
+extern void TIM7_IRQHandler(void) SIM_WEAK;				extern void DMA2_Channel1_IRQHandler(void) SIM_WEAK;
+extern void DMA2_Channel2_IRQHandler(void) SIM_WEAK;	extern void DMA2_Channel3_IRQHandler(void) SIM_WEAK;
+extern void DMA2_Channel4_5_IRQHandler(void) SIM_WEAK;
+extern void PendSV_Handler(void) SIM_WEAK;
+extern void SysTick_Handler(void) SIM_WEAK;
+
+static void (* const IRQHandlers[SIM_NUM_IRQS])(void) = {
+	WWDG_IRQHandler, PVD_IRQHandler, TAMPER_IRQHandler, RTC_IRQHandler, FLASH_IRQHandler, RCC_IRQHandler,
+	EXTI0_IRQHandler, EXTI1_IRQHandler, EXTI2_IRQHandler, EXTI3_IRQHandler, EXTI4_IRQHandler,
+	DMA1_Channel1_IRQHandler, DMA1_Channel2_IRQHandler, DMA1_Channel3_IRQHandler, DMA1_Channel4_IRQHandler,
+	DMA1_Channel5_IRQHandler, DMA1_Channel6_IRQHandler, DMA1_Channel7_IRQHandler, ADC1_2_IRQHandler,
+	USB_HP_CAN_TX_IRQHandler, USB_LP_CAN_RX0_IRQHandler, CAN_RX1_IRQHandler, CAN_SCE_IRQHandler,
+	EXTI9_5_IRQHandler, TIM1_BRK_IRQHandler, TIM1_UP_IRQHandler, TIM1_TRG_COM_IRQHandler, TIM1_CC_IRQHandler,
+	TIM2_IRQHandler, TIM3_IRQHandler, TIM4_IRQHandler, I2C1_EV_IRQHandler, I2C1_ER_IRQHandler,
+	I2C2_EV_IRQHandler, I2C2_ER_IRQHandler, SPI1_IRQHandler, SPI2_IRQHandler, USART1_IRQHandler,
+	USART2_IRQHandler, USART3_IRQHandler, EXTI15_10_IRQHandler, RTCAlarm_IRQHandler, NULL,
+	TIM8_BRK_IRQHandler, TIM8_UP_IRQHandler, TIM8_TRG_COM_IRQHandler, TIM8_CC_IRQHandler, ADC3_IRQHandler,
+	FSMC_IRQHandler, SDIO_IRQHandler, TIM5_IRQHandler, SPI3_IRQHandler, UART4_IRQHandler, UART5_IRQHandler,
+	TIM6_IRQHandler, TIM7_IRQHandler, DMA2_Channel1_IRQHandler, DMA2_Channel2_IRQHandler,
+	DMA2_Channel3_IRQHandler, DMA2_Channel4_5_IRQHandler,
+};
+
+/* 				Private Function Implementation 			       */
+
+/******************************************************************
+ * @func			SIM_FindWindow
+ * @brief			This functions returns the window that contains an address
+ * @param [in]		Address
+ * @return			Window or NULL if the address is not simulated
+ * @note 			None
+ */
+static SIM_Window_t *SIM_FindWindow(uintptr_t Addr){
+
+	for (uint32_t i = 0; i < sizeof(Windows)/sizeof(Windows[0]); i++){
+		if ((Addr >= Windows[i].BaseAddr) && (Addr < (uintptr_t)Windows[i].BaseAddr + Windows[i].Size)){
+			return &Windows[i];
+		}
+	}
+	return NULL;
+}
+
+/******************************************************************
+ * @func			SIM_Reg
+ * @brief			This functions returns the model view of a register
+ * @param [in]		Register address
+ * @return			Pointer to the register in the backing memory
+ * @note 			The models always use this view. Accessing it never traps
+ */
+static volatile uint32_t *SIM_Reg(uint32_t Addr){
+
+	SIM_Window_t *pWindow = SIM_FindWindow(Addr);
+	return (volatile uint32_t*)(pWindow->pBacking + ((Addr & ~3U) - pWindow->BaseAddr));
+}
+
+static const SIM_Periph_t *SIM_FindPeriph(uint32_t Addr){
+
+	for (uint32_t i = 0; i < sizeof(Periphs)/sizeof(Periphs[0]); i++){
+		uint32_t size = ((Periphs[i].BaseAddr == SIM_SCS_BASEADDR) || (Periphs[i].BaseAddr == ITM_BASEADDR)) ? 0x1000 : 0x400;
+		if ((Addr >= Periphs[i].BaseAddr) && (Addr < Periphs[i].BaseAddr + size)){
+			return &Periphs[i];
+		}
+	}
+	return NULL;
+}
+
+/******************************************************************
+ * @func			SIM_PCLKValue
+ * @brief			This functions calculates the APB clock from the simulated RCC registers
+ * @param [in]		APB bus (1 or 2). 0 returns the AHB clock (HCLK)
+ * @return			Frequency of the clock in Hz
+ * @note 			None
+ */
+static uint32_t SIM_PCLKValue(uint8_t Apb){
+
+	uint32_t cfgr = *SIM_Reg(RCC_BASEADDR + 0x04);
+	uint32_t sysclk = SIM_HSI_VALUE;
+	uint32_t temp;
+
+	switch ((cfgr >> 2) & 0x3){
+	case 1:
+		sysclk = SIM_HSE_VALUE;
+		break;
+	case 2:
+		temp = ((cfgr >> 18) & 0xF) + 2;
+		if (temp > 16){
+			temp = 16;
+		}
+		if (cfgr & (1 << 16)){
+			sysclk = ((cfgr & (1 << 17)) ? SIM_HSE_VALUE/2 : SIM_HSE_VALUE) * temp;
+		} else {
+			sysclk = (SIM_HSI_VALUE/2) * temp;
+		}
+		break;
+	default:
+		break;
+	}
+
+	temp = (cfgr >> 4) & 0xF;
+	if (temp >= 8){
+		static const uint16_t ahb_prescaler[8] = {2,4,8,16,64,128,256,512};
+		sysclk /= ahb_prescaler[temp-8];
+	}
+
+	if (Apb == 0){
+		return sysclk;
+	}
+
+	temp = (cfgr >> ((Apb == 1) ? 8 : 11)) & 0x7;
+	if (temp >= 4){
+		sysclk >>= (temp - 3);
+	}
+
+	return sysclk;
+}
+
+/******************************************************************
+ * @func			SIM_GPIO_UpdateLevels
+ * @brief			This functions recalculates the pin levels of a port and detects EXTI edges
+ * @param [in]		Port index (0 = GPIOA)
+ * @return			None
+ * @note 			Output pins read back ODR. Open-drain outputs read low when they are driven low
+ * 					from outside (wired AND, e.g. a slave holding SDA). Input pins read the external
+ * 					level, or the pull selected in ODR when nothing drives them
+ */
+static void SIM_GPIO_UpdateLevels(uint8_t Port){
+
+	uint32_t base = GPIOA_BASEADDR + (Port * 0x400);
+	GPIO_RegDef_t *pGPIO = (GPIO_RegDef_t*)SIM_Reg(base);
+	uint16_t outputs = 0, pulls = 0, opendrain = 0;
+
+	for (uint8_t pin = 0; pin < 16; pin++){
+		uint32_t cr = (pin < 8) ? pGPIO->CRL : pGPIO->CRH;
+		uint8_t cfg = (cr >> (4 * (pin % 8))) & 0xF;
+
+		if (cfg & 0x3){
+			outputs |= (1 << pin);
+			if (cfg & 0x4){
+				opendrain |= (1 << pin); // General purpose or alternate function open drain
+			}
+		} else if ((cfg >> 2) == GPIO_IN_TYPE_PP){
+			pulls |= (1 << pin);
+		}
+	}
+
+	uint16_t odr = (uint16_t)pGPIO->ODR;
+	uint16_t level = (odr & outputs) | (GPIOExtLevel[Port] & GPIOExtDriven[Port] & ~outputs) |
+					 (odr & pulls & ~GPIOExtDriven[Port] & ~outputs);
+	level &= ~(opendrain & GPIOExtDriven[Port] & ~GPIOExtLevel[Port]);
+	uint16_t rising = level & ~GPIOLevel[Port];
+	uint16_t falling = ~level & GPIOLevel[Port];
+
+	GPIOLevel[Port] = level;
+	pGPIO->IDR = level;
+
+	// EXTI lines connected to this port through AFIO_EXTICR
+	EXTI_RegDef_t *pEXTI = (EXTI_RegDef_t*)SIM_Reg(EXTI_BASEADDR);
+	AFIO_RegDef_t *pAFIO = (AFIO_RegDef_t*)SIM_Reg(AFIO_BASEADDR);
+
+	for (uint8_t pin = 0; pin < 16; pin++){
+		if (((pAFIO->EXTICR[pin / 4] >> (4 * (pin % 4))) & 0xF) != Port){
+			continue;
+		}
+		if (((rising >> pin) & (pEXTI->RTSR >> pin) & 1) || ((falling >> pin) & (pEXTI->FTSR >> pin) & 1)){
+			pEXTI->PR |= (1 << pin) & pEXTI->IMR;
+		}
+	}
+}
+
+static void SIM_GPIO_Reset(uint32_t BaseAddr){
+
+	GPIO_RegDef_t *pGPIO = (GPIO_RegDef_t*)SIM_Reg(BaseAddr);
+
+	pGPIO->CRL = 0x44444444; // Floating inputs
+	pGPIO->CRH = 0x44444444;
+	pGPIO->ODR = 0;
+	pGPIO->BSRR = 0;
+	pGPIO->BRR = 0;
+	pGPIO->LCKR = 0;
+	SIM_GPIO_UpdateLevels((BaseAddr - GPIOA_BASEADDR) / 0x400);
+}
+
+static void SIM_GPIO_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	GPIO_RegDef_t *pGPIO = (GPIO_RegDef_t*)SIM_Reg(BaseAddr);
+
+	if (!Write){
+		return;
+	}
+
+	switch (Offset){
+	case 0x08: // IDR is read only
+		pGPIO->IDR = Pre;
+		break;
+	case 0x10: // BSRR: set has priority over reset. Always reads 0
+		pGPIO->ODR = (pGPIO->ODR & ~(pGPIO->BSRR >> 16)) | (pGPIO->BSRR & 0xFFFF);
+		pGPIO->BSRR = 0;
+		break;
+	case 0x14: // BRR. Always reads 0
+		pGPIO->ODR &= ~(pGPIO->BRR & 0xFFFF);
+		pGPIO->BRR = 0;
+		break;
+	default:
+		break;
+	}
+
+	pGPIO->ODR &= 0xFFFF;
+	SIM_GPIO_UpdateLevels((BaseAddr - GPIOA_BASEADDR) / 0x400);
+}
+
+static void SIM_AFIO_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(AFIO_RegDef_t));
+}
+
+static void SIM_AFIO_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+	// Plain configuration registers
+}
+
+static void SIM_EXTI_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(EXTI_RegDef_t));
+}
+
+static void SIM_EXTI_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	EXTI_RegDef_t *pEXTI = (EXTI_RegDef_t*)SIM_Reg(BaseAddr);
+
+	if (!Write){
+		return;
+	}
+
+	switch (Offset){
+	case 0x10: // SWIER: a 0 to 1 transition pends the line if it is not masked
+		pEXTI->PR |= (pEXTI->SWIER & ~Pre) & pEXTI->IMR;
+		break;
+	case 0x14: // PR: rc_w1. Writing 1 also clears SWIER
+		pEXTI->SWIER &= ~pEXTI->PR;
+		pEXTI->PR = Pre & ~pEXTI->PR;
+		break;
+	default:
+		break;
+	}
+}
+
+static SIM_SPIState_t *SIM_SPI_State(uint32_t BaseAddr){
+
+	if (BaseAddr == SPI1_BASEADDR){
+		return &SPIState[0];
+	} else if (BaseAddr == SPI2_BASEADDR){
+		return &SPIState[1];
+	}
+	return &SPIState[2];
+}
+
+/******************************************************************
+ * @func			SIM_SPI_Shift
+ * @brief			This functions exchanges one frame with the attached device
+ * @param [in]		SPI base address
+ * @param [in]		Frame to send
+ * @return			None
+ * @note 			The frame is finished when the function returns. A frame received while RXNE
+ * 					is still set is lost and sets OVR
+ */
+static void SIM_SPI_Shift(uint32_t BaseAddr, uint16_t TxData){
+
+	SPI_RegDef_t *pSPI = (SPI_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_SPIState_t *pState = SIM_SPI_State(BaseAddr);
+	uint16_t mask = (pSPI->CR1 & (1 << SPI_CR1_DFF)) ? 0xFFFF : 0x00FF;
+	uint16_t miso = TxData & mask;
+
+	if (pState->Device){
+		miso = pState->Device(pState->pContext, TxData & mask) & mask;
+	}
+
+	if (pSPI->SR & (1 << SPI_SR_RXNE)){
+		pSPI->SR |= (1 << SPI_SR_OVR);
+	} else {
+		pState->RxData = miso;
+		pSPI->DR = miso;
+		pSPI->SR |= (1 << SPI_SR_RXNE);
+	}
+	pSPI->SR |= (1 << SPI_SR_TXE);
+	pSPI->SR &= ~(1 << SPI_SR_BSY);
+	pState->TxPending = 0;
+
+	uint32_t pclk = SIM_PCLKValue((BaseAddr == SPI1_BASEADDR) ? 2 : 1);
+	uint32_t bits = (mask == 0xFFFF) ? 16 : 8;
+	Stats.BusTime_ns += (uint64_t)bits * (2U << ((pSPI->CR1 >> SPI_CR1_BR) & 0x7)) * 1000000000ULL / pclk;
+}
+
+static void SIM_SPI_Reset(uint32_t BaseAddr){
+
+	SPI_RegDef_t *pSPI = (SPI_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_SPIState_t *pState = SIM_SPI_State(BaseAddr);
+
+	memset((void*)pSPI, 0, sizeof(SPI_RegDef_t));
+	pSPI->SR = (1 << SPI_SR_TXE);
+	pSPI->CRCPR = 0x0007;
+	pState->RxData = 0;
+	pState->TxPending = 0;
+	pState->OVRDRRead = 0;
+}
+
+static void SIM_SPI_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	SPI_RegDef_t *pSPI = (SPI_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_SPIState_t *pState = SIM_SPI_State(BaseAddr);
+	uint8_t enabled = (pSPI->CR1 & (1 << SPI_CR1_SPE)) && (pSPI->CR1 & (1 << SPI_CR1_MSTR));
+
+	switch (Offset){
+	case 0x00: // CR1: a frame written while disabled goes out when the master is enabled
+		if (Write && enabled && pState->TxPending){
+			SIM_SPI_Shift(BaseAddr, pState->TxData);
+		}
+		break;
+	case 0x08: // SR: only CRCERR can be cleared by software
+		if (Write){
+			uint32_t value = pSPI->SR;
+			pSPI->SR = Pre & ~((~value) & (1 << SPI_SR_CRCERR));
+		} else if (pState->OVRDRRead){
+			pSPI->SR &= ~(1 << SPI_SR_OVR);
+			pState->OVRDRRead = 0;
+		}
+		break;
+	case 0x0C: // DR: writes go to the Tx buffer, reads come from the Rx buffer
+		if (Write){
+			pState->TxData = (uint16_t)pSPI->DR;
+			pState->TxPending = 1;
+			pSPI->SR &= ~(1 << SPI_SR_TXE);
+			if (enabled){
+				SIM_SPI_Shift(BaseAddr, pState->TxData);
+			}
+		} else {
+			pSPI->SR &= ~(1 << SPI_SR_RXNE);
+			pState->OVRDRRead = (pSPI->SR & (1 << SPI_SR_OVR)) ? 1 : 0;
+		}
+		pSPI->DR = pState->RxData;
+		break;
+	default:
+		break;
+	}
+}
+
+static SIM_I2CState_t *SIM_I2C_State(uint32_t BaseAddr){
+
+	return (BaseAddr == I2C1_BASEADDR) ? &I2CState[0] : &I2CState[1];
+}
+
+/******************************************************************
+ * @func			SIM_I2C_ByteTime
+ * @brief			This functions adds the time of one byte plus ACK to the bus time
+ * @param [in]		I2C model view
+ * @return			None
+ * @note 			SCL comes from the CCR value written by the driver
+ */
+static void SIM_I2C_ByteTime(I2C_RegDef_t *pI2C){
+
+	uint32_t ccr = pI2C->CCR & 0xFFF;
+	uint32_t factor = 2;
+
+	if (ccr == 0){
+		return;
+	}
+	if (pI2C->CCR & (1 << I2C_CCR_FS)){
+		factor = (pI2C->CCR & (1 << I2C_CCR_DUTY)) ? 25 : 3;
+	}
+	Stats.BusTime_ns += 9ULL * factor * ccr * 1000000000ULL / SIM_PCLKValue(1);
+}
+
+static void SIM_I2C_GenerateStop(I2C_RegDef_t *pI2C, SIM_I2CState_t *pState){
+
+	if ((pState->Active >= 0) && pState->Devices[pState->Active].pDevice->Stop){
+		pState->Devices[pState->Active].pDevice->Stop(pState->Devices[pState->Active].pContext);
+	}
+	pState->Active = -1;
+	pState->Master = 0;
+	pState->Receiving = 0;
+	pState->StopPending = 0;
+	pI2C->CR1 &= ~(1 << I2C_CR1_STOP);
+	pI2C->SR1 &= ~((1 << I2C_SR1_TXE) | (1 << I2C_SR1_BTF));
+	pI2C->SR2 &= ~((1 << I2C_SR2_MSL) | (1 << I2C_SR2_BUSY) | (1 << I2C_SR2_TRA));
+}
+
+/******************************************************************
+ * @func			SIM_I2C_FetchByte
+ * @brief			This functions receives the next byte from the addressed slave (master receiver)
+ * @param [in]		I2C model view
+ * @param [in]		Bus state
+ * @return			None
+ * @note 			The byte is ACKed with the current CR1 ACK bit. After a NACK the slave releases
+ * 					SDA (bytes read 0xFF) and a pending STOP is generated
+ */
+static void SIM_I2C_FetchByte(I2C_RegDef_t *pI2C, SIM_I2CState_t *pState){
+
+	uint8_t data = 0xFF;
+
+	if (pState->LastAck && (pState->Active >= 0) && pState->Devices[pState->Active].pDevice->Read){
+		data = pState->Devices[pState->Active].pDevice->Read(pState->Devices[pState->Active].pContext);
+	}
+	pState->RxData = data;
+	pI2C->DR = data;
+	pI2C->SR1 |= (1 << I2C_SR1_RXNE);
+	pState->Receiving = 1;
+	pState->LastAck = (pI2C->CR1 & (1 << I2C_CR1_ACK)) ? 1 : 0;
+
+	// DMA reception with LAST = 1: the byte after EOT_1 (one item left in the Rx channel) is NACKed,
+	// and so is any byte clocked after it until the STOP
+	if ((pI2C->CR2 & (1 << I2C_CR2_DMAEN)) && (pI2C->CR2 & (1 << I2C_CR2_LAST))){
+		DMA_RegDef_t *pDMA = (DMA_RegDef_t*)SIM_Reg(DMA1_BASEADDR);
+		uint8_t ch = ((pState == &I2CState[0]) ? DMA_CH_I2C1_RX : DMA_CH_I2C2_RX) - 1;
+		if ((pDMA->CH[ch].CCR & (1 << DMA_CCR_EN)) && (pDMA->CH[ch].CNDTR <= 1)){
+			pState->LastAck = 0;
+		}
+	}
+	SIM_I2C_ByteTime(pI2C);
+
+	if (!pState->LastAck && pState->StopPending){
+		SIM_I2C_GenerateStop(pI2C, pState);
+	}
+}
+
+static void SIM_I2C_AddressPhase(I2C_RegDef_t *pI2C, SIM_I2CState_t *pState, uint8_t Data){
+
+	uint8_t read = Data & 1;
+	uint8_t ack = 0;
+
+	pI2C->SR1 &= ~(1 << I2C_SR1_SB);
+	pState->Active = -1;
+	pState->LastAck = 1;
+
+	for (uint8_t i = 0; i < pState->DeviceCnt; i++){
+		if (pState->Devices[i].Addr == (Data >> 1)){
+			const SIM_I2CDevice_t *pDevice = pState->Devices[i].pDevice;
+			ack = (pDevice->Start == NULL) || pDevice->Start(pState->Devices[i].pContext, read);
+			if (ack){
+				pState->Active = i;
+			}
+			break;
+		}
+	}
+	SIM_I2C_ByteTime(pI2C);
+
+	if (!ack){
+		pI2C->SR1 |= (1 << I2C_SR1_AF);
+		return;
+	}
+
+	pI2C->SR1 |= (1 << I2C_SR1_ADDR);
+	if (read){
+		pI2C->SR2 &= ~(1 << I2C_SR2_TRA);
+	} else {
+		pI2C->SR2 |= (1 << I2C_SR2_TRA);
+	}
+}
+
+static void SIM_I2C_Reset(uint32_t BaseAddr){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_I2CState_t *pState = SIM_I2C_State(BaseAddr);
+
+	memset((void*)pI2C, 0, sizeof(I2C_RegDef_t));
+	pI2C->TRISE = 0x0002;
+	pState->Active = -1;
+	pState->Master = 0;
+	pState->Receiving = 0;
+	pState->StopPending = 0;
+	pState->RxData = 0;
+	pState->SR1Read = 0;
+	pState->ExtMode = SIM_EXT_NONE;
+}
+
+static void SIM_I2C_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_I2CState_t *pState = SIM_I2C_State(BaseAddr);
+	uint32_t value;
+
+	switch (Offset){
+	case 0x00: // CR1
+		if (!Write){
+			break;
+		}
+		value = pI2C->CR1;
+		if (value & (1 << I2C_CR1_SWREST)){
+			// Peripheral held in reset
+			SIM_I2C_Reset(BaseAddr);
+			pI2C->CR1 = (1 << I2C_CR1_SWREST);
+			break;
+		}
+		if (!(value & (1 << I2C_CR1_PE))){
+			pState->Master = 0;
+			pState->Active = -1;
+			pI2C->SR1 = 0;
+			pI2C->SR2 = 0;
+			pI2C->CR1 = value & ~((1 << I2C_CR1_START) | (1 << I2C_CR1_STOP));
+			break;
+		}
+		// STOPF clear sequence: SR1 read followed by a CR1 write
+		if (pState->SR1Read & (1 << I2C_SR1_STOPF)){
+			pI2C->SR1 &= ~(1 << I2C_SR1_STOPF);
+			pState->SR1Read &= ~(1 << I2C_SR1_STOPF);
+		}
+		if (value & (1 << I2C_CR1_START)){
+			// START or repeated START
+			pI2C->CR1 &= ~(1 << I2C_CR1_START);
+			pState->Master = 1;
+			pState->Receiving = 0;
+			pState->StopPending = 0;
+			pI2C->SR1 &= ~((1 << I2C_SR1_TXE) | (1 << I2C_SR1_BTF) | (1 << I2C_SR1_RXNE));
+			pI2C->SR1 |= (1 << I2C_SR1_SB);
+			pI2C->SR2 |= (1 << I2C_SR2_MSL) | (1 << I2C_SR2_BUSY);
+			pI2C->SR2 &= ~(1 << I2C_SR2_TRA);
+		}
+		if (value & (1 << I2C_CR1_STOP)){
+			if (!pState->Master){
+				pI2C->CR1 &= ~(1 << I2C_CR1_STOP);
+			} else if (!pState->Receiving || !pState->LastAck){
+				SIM_I2C_GenerateStop(pI2C, pState);
+			} else {
+				pState->StopPending = 1; // Generated after the byte being received
+			}
+		}
+		break;
+
+	case 0x10: // DR
+		if (Write){
+			uint8_t data = (uint8_t)pI2C->DR;
+			if ((pI2C->SR1 & (1 << I2C_SR1_SB)) && (pState->SR1Read & (1 << I2C_SR1_SB))){
+				// SB clear sequence: SR1 read followed by the address write
+				pState->SR1Read &= ~(1 << I2C_SR1_SB);
+				SIM_I2C_AddressPhase(pI2C, pState, data);
+			} else if (pState->Master && (pI2C->SR2 & (1 << I2C_SR2_TRA)) && !(pI2C->SR1 & (1 << I2C_SR1_ADDR))){
+				// Master transmitter
+				if ((pState->Active >= 0) && pState->Devices[pState->Active].pDevice->Write){
+					if (!pState->Devices[pState->Active].pDevice->Write(pState->Devices[pState->Active].pContext, data)){
+						pI2C->SR1 |= (1 << I2C_SR1_AF);
+					}
+				}
+				pI2C->SR1 |= (1 << I2C_SR1_TXE) | (1 << I2C_SR1_BTF);
+				SIM_I2C_ByteTime(pI2C);
+			} else if ((pState->ExtMode == SIM_EXT_READ) && (pI2C->SR1 & (1 << I2C_SR1_TXE))){
+				// Slave transmitter: the external master takes the byte
+				pState->pExtBuffer[pState->ExtCnt++] = data;
+				SIM_I2C_ByteTime(pI2C);
+				if (pState->ExtCnt == pState->ExtLen){
+					// Last byte NACKed by the master, then STOP
+					pI2C->SR1 &= ~(1 << I2C_SR1_TXE);
+					pI2C->SR1 |= (1 << I2C_SR1_AF);
+					pI2C->SR2 &= ~((1 << I2C_SR2_BUSY) | (1 << I2C_SR2_TRA));
+					pState->ExtMode = SIM_EXT_NONE;
+				}
+			}
+		} else {
+			pI2C->SR1 &= ~((1 << I2C_SR1_RXNE) | (1 << I2C_SR1_BTF));
+			if (pState->Master && pState->Receiving){
+				SIM_I2C_FetchByte(pI2C, pState);
+			}
+		}
+		pI2C->DR = pState->RxData;
+		break;
+
+	case 0x14: // SR1
+		if (Write){
+			value = pI2C->SR1;
+			pI2C->SR1 = (Pre & SIM_I2C_SR1_FLAGS_MASK) | (Pre & value & ~SIM_I2C_SR1_FLAGS_MASK);
+		} else {
+			pState->SR1Read = Pre;
+		}
+		break;
+
+	case 0x18: // SR2
+		if (Write){
+			pI2C->SR2 = Pre;
+		} else if ((pState->SR1Read & (1 << I2C_SR1_ADDR)) && (pI2C->SR1 & (1 << I2C_SR1_ADDR))){
+			// ADDR clear sequence: SR1 read followed by SR2 read
+			pState->SR1Read &= ~(1 << I2C_SR1_ADDR);
+			pI2C->SR1 &= ~(1 << I2C_SR1_ADDR);
+			if (pState->Master){
+				if (pI2C->SR2 & (1 << I2C_SR2_TRA)){
+					pI2C->SR1 |= (1 << I2C_SR1_TXE);
+				} else {
+					SIM_I2C_FetchByte(pI2C, pState);
+				}
+			} else if (pState->ExtMode == SIM_EXT_READ){
+				pI2C->SR1 |= (1 << I2C_SR1_TXE);
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+static SIM_USARTState_t *SIM_USART_State(uint32_t BaseAddr){
+
+	if (BaseAddr == USART1_BASEADDR){
+		return &USARTState[0];
+	} else if (BaseAddr == USART2_BASEADDR){
+		return &USARTState[1];
+	}
+	return &USARTState[2];
+}
+
+/******************************************************************
+ * @func			SIM_USART_FrameTime
+ * @brief			This functions adds the time of one frame to the bus time
+ * @param [in]		USART base address
+ * @return			None
+ * @note 			Start bit, 8 or 9 bits and the stop bits. The bit time is BRR / PCLK
+ */
+static void SIM_USART_FrameTime(uint32_t BaseAddr){
+
+	USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg(BaseAddr);
+	uint32_t brr = pUSART->BRR & 0xFFFF;
+	uint32_t bits = (pUSART->CR1 & (1 << USART_CR1_M)) ? 11 : 10;
+
+	if (((pUSART->CR2 >> USART_CR2_STOP) & 0x3) == USART_STOPBITS_2){
+		bits++;
+	}
+	Stats.BusTime_ns += (uint64_t)bits * brr * 1000000000ULL / SIM_PCLKValue((BaseAddr == USART1_BASEADDR) ? 2 : 1);
+}
+
+static void SIM_USART_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(USART_RegDef_t));
+	((USART_RegDef_t*)SIM_Reg(BaseAddr))->SR = (1 << USART_SR_TXE) | (1 << USART_SR_TC);
+	SIM_USART_State(BaseAddr)->RxData = 0;
+	SIM_USART_State(BaseAddr)->SRRead = 0;
+}
+
+static void SIM_USART_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg(BaseAddr);
+	SIM_USARTState_t *pState = SIM_USART_State(BaseAddr);
+	uint16_t mask = (pUSART->CR1 & (1 << USART_CR1_M)) ? 0x1FF : 0xFF;
+
+	switch (Offset){
+	case 0x00: // SR: RXNE, TC, LBD and CTS are rc_w0, the rest are read only
+		if (Write){
+			pUSART->SR = Pre & ~((~pUSART->SR) & SIM_USART_SR_RC_W0);
+		} else {
+			pState->SRRead = Pre;
+		}
+		break;
+	case 0x04: // DR: writes are sent right away, reads come from the Rx buffer
+		if (Write){
+			if ((pUSART->CR1 & (1 << USART_CR1_UE)) && (pUSART->CR1 & (1 << USART_CR1_TE))){
+				if (pState->Device){
+					pState->Device(pState->pContext, (uint16_t)(pUSART->DR & mask));
+				}
+				pUSART->SR |= (1 << USART_SR_TXE) | (1 << USART_SR_TC);
+				SIM_USART_FrameTime(BaseAddr);
+			}
+		} else {
+			// PE, FE, NE, ORE and IDLE: SR read followed by DR read (the DMA read counts too)
+			pUSART->SR &= ~((1 << USART_SR_RXNE) | (pState->SRRead & SIM_USART_SR_SEQ_CLR));
+			pState->SRRead = 0;
+		}
+		pUSART->DR = pState->RxData;
+		break;
+	default:
+		break;
+	}
+}
+
+static void SIM_RCC_Reset(uint32_t BaseAddr){
+
+	RCC_RegDef_t *pRCC = (RCC_RegDef_t*)SIM_Reg(BaseAddr);
+
+	memset((void*)pRCC, 0, sizeof(RCC_RegDef_t));
+	pRCC->CR = 0x00000083; // HSI on and ready
+	pRCC->AHBENR = 0x00000014; // SRAM and FLITF clocks
+	pRCC->CSR = 0x0C000000;
+}
+
+static void SIM_RCC_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	RCC_RegDef_t *pRCC = (RCC_RegDef_t*)SIM_Reg(BaseAddr);
+	uint32_t value, rising;
+
+	if (!Write){
+		return;
+	}
+
+	switch (Offset){
+	case 0x00: // CR: oscillators are ready as soon as they are switched on
+		value = pRCC->CR & ~((1 << SIM_RCC_CR_HSIRDY) | (1 << SIM_RCC_CR_HSERDY) | (1 << SIM_RCC_CR_PLLRDY));
+		value |= ((value >> SIM_RCC_CR_HSION) & 1) << SIM_RCC_CR_HSIRDY;
+		value |= ((value >> SIM_RCC_CR_HSEON) & 1) << SIM_RCC_CR_HSERDY;
+		value |= ((value >> SIM_RCC_CR_PLLON) & 1) << SIM_RCC_CR_PLLRDY;
+		pRCC->CR = value;
+		break;
+	case 0x04: // CFGR: SWS follows SW when the selected source is ready
+		value = pRCC->CFGR & ~(0x3 << 2);
+		switch (value & 0x3){
+		case 0:
+			rising = pRCC->CR & (1 << SIM_RCC_CR_HSIRDY);
+			break;
+		case 1:
+			rising = pRCC->CR & (1 << SIM_RCC_CR_HSERDY);
+			break;
+		case 2:
+			rising = pRCC->CR & (1 << SIM_RCC_CR_PLLRDY);
+			break;
+		default:
+			rising = 0;
+			break;
+		}
+		pRCC->CFGR = value | (rising ? ((value & 0x3) << 2) : (Pre & (0x3 << 2)));
+		break;
+	case SIM_RCC_APB2RSTR:
+	case SIM_RCC_APB1RSTR: // Reset the peripherals whose bit goes from 0 to 1
+		rising = (Offset == SIM_RCC_APB2RSTR ? pRCC->APB2RSTR : pRCC->APB1RSTR) & ~Pre;
+		for (uint32_t i = 0; i < sizeof(Periphs)/sizeof(Periphs[0]); i++){
+			if ((Periphs[i].RstReg == Offset) && (rising & (1U << Periphs[i].RstBit))){
+				Periphs[i].Reset(Periphs[i].BaseAddr);
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/******************************************************************
+ * @func			SIM_DMA_PeriRequest
+ * @brief			This functions returns the DMA request line of a DMA1 channel
+ * @param [in]		Channel index (0 = channel 1)
+ * @return			1 if a peripheral mapped to the channel is requesting a transfer
+ * @note 			RM0008 Table 78. Only the simulated peripherals are listed
+ */
+static uint8_t SIM_DMA_PeriRequest(uint8_t Ch){
+
+	static const struct{ uint8_t Ch; uint32_t BaseAddr; uint8_t Tx; } requests[] = {
+		{1, SPI1_BASEADDR, 0}, {2, SPI1_BASEADDR, 1}, {3, SPI2_BASEADDR, 0}, {4, SPI2_BASEADDR, 1},
+		{3, I2C2_BASEADDR, 1}, {4, I2C2_BASEADDR, 0}, {5, I2C1_BASEADDR, 1}, {6, I2C1_BASEADDR, 0},
+		{3, USART1_BASEADDR, 1}, {4, USART1_BASEADDR, 0}, {6, USART2_BASEADDR, 1}, {5, USART2_BASEADDR, 0},
+		{1, USART3_BASEADDR, 1}, {2, USART3_BASEADDR, 0},
+	};
+
+	for (uint8_t i = 0; i < sizeof(requests)/sizeof(requests[0]); i++){
+		if (requests[i].Ch != Ch){
+			continue;
+		}
+		if ((requests[i].BaseAddr == I2C1_BASEADDR) || (requests[i].BaseAddr == I2C2_BASEADDR)){
+			I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg(requests[i].BaseAddr);
+			if (!(pI2C->CR2 & (1 << I2C_CR2_DMAEN))){
+				continue;
+			}
+			if (requests[i].Tx && (pI2C->SR1 & (1 << I2C_SR1_TXE))){
+				return 1;
+			}
+			if (!requests[i].Tx && (pI2C->SR1 & (1 << I2C_SR1_RXNE))){
+				return 1;
+			}
+			continue;
+		}
+		if ((requests[i].BaseAddr == USART1_BASEADDR) || (requests[i].BaseAddr == USART2_BASEADDR) ||
+			(requests[i].BaseAddr == USART3_BASEADDR)){
+			USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg(requests[i].BaseAddr);
+			if (requests[i].Tx && (pUSART->CR3 & (1 << USART_CR3_DMAT)) && (pUSART->SR & (1 << USART_SR_TXE))){
+				return 1;
+			}
+			if (!requests[i].Tx && (pUSART->CR3 & (1 << USART_CR3_DMAR)) && (pUSART->SR & (1 << USART_SR_RXNE))){
+				return 1;
+			}
+			continue;
+		}
+		SPI_RegDef_t *pSPI = (SPI_RegDef_t*)SIM_Reg(requests[i].BaseAddr);
+		if (requests[i].Tx && (pSPI->CR2 & (1 << SPI_CR2_TXDMAEN)) && (pSPI->SR & (1 << SPI_SR_TXE))){
+			return 1;
+		}
+		if (!requests[i].Tx && (pSPI->CR2 & (1 << SPI_CR2_RXDMAEN)) && (pSPI->SR & (1 << SPI_SR_RXNE))){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/******************************************************************
+ * @func			SIM_DMA_BusAccess
+ * @brief			This functions reads or writes a simulated register on behalf of the DMA
+ * @param [in]		Register address
+ * @param [in]		1 = write
+ * @param [in]		Value to write
+ * @return			Value read
+ * @note 			Runs the same peripheral model as a CPU access, but it is not counted
+ */
+static uint32_t SIM_DMA_BusAccess(uint32_t Addr, uint8_t Write, uint32_t Value){
+
+	const SIM_Periph_t *pPeriph = SIM_FindPeriph(Addr);
+	volatile uint32_t *pReg = SIM_Reg(Addr);
+	uint32_t pre = *pReg;
+
+	if (pPeriph && pPeriph->EnReg && !(*SIM_Reg(RCC_BASEADDR + pPeriph->EnReg) & (1U << pPeriph->EnBit))){
+		if (Write){
+			Stats.DroppedWrites++;
+		}
+		return pre;
+	}
+	if (Write){
+		*pReg = Value;
+	}
+	if (pPeriph){
+		pPeriph->Access(pPeriph->BaseAddr, (Addr & ~3U) - pPeriph->BaseAddr, Write, pre);
+	}
+	return pre;
+}
+
+/******************************************************************
+ * @func			SIM_DMA_Transfer
+ * @brief			This functions moves one item of a DMA1 channel
+ * @param [in]		Channel index (0 = channel 1)
+ * @return			None
+ * @note 			Addresses that are not simulated registers are host memory. A NULL memory
+ * 					address is a transfer error, which disables the channel
+ */
+static void SIM_DMA_Transfer(uint8_t Ch){
+
+	DMA_RegDef_t *pDMA = (DMA_RegDef_t*)SIM_Reg(DMA1_BASEADDR);
+	DMA_Channel_RegDef_t *pCh = &pDMA->CH[Ch];
+	SIM_DMAChannel_t *pState = &DMAState[Ch];
+	uint32_t ccr = pCh->CCR;
+	uint8_t psize = 1 << ((ccr >> DMA_CCR_PSIZE) & 0x3);
+	uint8_t msize = 1 << ((ccr >> DMA_CCR_MSIZE) & 0x3);
+	uint32_t value = 0;
+
+	if ((pState->MemAddr == 0) || (SIM_FindWindow(pState->PeriAddr) == NULL)){
+		pDMA->ISR |= ((1 << DMA_ISR_TEIF) | (1 << DMA_ISR_GIF)) << (4 * Ch);
+		pCh->CCR &= ~(1 << DMA_CCR_EN);
+		return;
+	}
+
+	// CNDTR is updated before the peripheral model runs, so the I2C model sees EOT_1 (LAST bit)
+	pCh->CNDTR--;
+
+	if (ccr & (1 << DMA_CCR_DIR)){
+		// Memory to peripheral
+		memcpy(&value, (void*)pState->MemAddr, msize);
+		SIM_DMA_BusAccess(pState->PeriAddr, 1, value & (0xFFFFFFFFU >> (32 - 8 * psize)));
+	} else {
+		// Peripheral to memory
+		value = SIM_DMA_BusAccess(pState->PeriAddr, 0, 0) & (0xFFFFFFFFU >> (32 - 8 * psize));
+		memcpy((void*)pState->MemAddr, &value, msize);
+	}
+
+	if (ccr & (1 << DMA_CCR_PINC)){
+		pState->PeriAddr += psize;
+	}
+	if (ccr & (1 << DMA_CCR_MINC)){
+		pState->MemAddr += msize;
+	}
+
+	if (pCh->CNDTR == (uint32_t)(pState->Len - pState->Len / 2)){
+		pDMA->ISR |= ((1 << DMA_ISR_HTIF) | (1 << DMA_ISR_GIF)) << (4 * Ch);
+	}
+	if (pCh->CNDTR == 0){
+		pDMA->ISR |= ((1 << DMA_ISR_TCIF) | (1 << DMA_ISR_GIF)) << (4 * Ch);
+		if (ccr & (1 << DMA_CCR_CIRC)){
+			pCh->CNDTR = pState->Len;
+			pState->PeriAddr = pCh->CPAR;
+			pState->MemAddr = ((uintptr_t)pState->MemUpper << 32) | pCh->CMAR;
+		}
+	}
+}
+
+/******************************************************************
+ * @func			SIM_DMA_Service
+ * @brief			This functions serves the pending DMA1 requests
+ * @param [in]		None
+ * @return			None
+ * @note 			The channel with the highest priority level goes first, then the lowest
+ * 					channel number. Transfers finish instantly, like the SPI/I2C frames
+ */
+static void SIM_DMA_Service(void){
+
+	DMA_RegDef_t *pDMA = (DMA_RegDef_t*)SIM_Reg(DMA1_BASEADDR);
+
+	if (!(*SIM_Reg(RCC_BASEADDR + SIM_RCC_AHBENR) & (1 << 0))){
+		return; // DMA1 clock disabled
+	}
+
+	for (uint32_t items = 0; items < SIM_DMA_MAX_ITEMS; items++){
+		int8_t best = -1;
+		uint8_t best_pl = 0;
+
+		for (uint8_t ch = 0; ch < 7; ch++){
+			uint32_t ccr = pDMA->CH[ch].CCR;
+			uint8_t pl = (ccr >> DMA_CCR_PL) & 0x3;
+			if (!(ccr & (1 << DMA_CCR_EN)) || (pDMA->CH[ch].CNDTR == 0)){
+				continue;
+			}
+			if (!(ccr & (1 << DMA_CCR_MEM2MEM)) && !SIM_DMA_PeriRequest(ch)){
+				continue;
+			}
+			if ((best < 0) || (pl > best_pl)){
+				best = ch;
+				best_pl = pl;
+			}
+		}
+		if (best < 0){
+			return;
+		}
+		SIM_DMA_Transfer(best);
+	}
+}
+
+static void SIM_DMA_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(DMA_RegDef_t));
+	memset(DMAState, 0, sizeof(DMAState));
+}
+
+static void SIM_DMA_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	DMA_RegDef_t *pDMA = (DMA_RegDef_t*)SIM_Reg(BaseAddr);
+	uint32_t value;
+
+	if (!Write){
+		return;
+	}
+
+	if (Offset == 0x00){				// ISR is read only
+		pDMA->ISR = Pre;
+	} else if (Offset == 0x04){			// IFCR: write 1 to clear. CGIFx clears the 4 flags of the channel
+		value = pDMA->IFCR;
+		for (uint8_t ch = 0; ch < 7; ch++){
+			if (value & ((1 << DMA_ISR_GIF) << (4 * ch))){
+				value |= (0xFU << (4 * ch));
+			}
+		}
+		pDMA->ISR &= ~value;
+		pDMA->IFCR = 0;
+	} else if (Offset < 0x08 + 7 * sizeof(DMA_Channel_RegDef_t)){
+		uint8_t ch = (Offset - 0x08) / sizeof(DMA_Channel_RegDef_t);
+		uint8_t reg = (Offset - 0x08) % sizeof(DMA_Channel_RegDef_t);
+		DMA_Channel_RegDef_t *pCh = &pDMA->CH[ch];
+		volatile uint32_t *pReg = SIM_Reg(BaseAddr + Offset);
+
+		if (reg == 0x00){
+			pCh->CCR &= 0x7FFF;
+			if (!(Pre & (1 << DMA_CCR_EN)) && (pCh->CCR & (1 << DMA_CCR_EN))){
+				// Channel enabled: load the current addresses and the length
+				DMAState[ch].Len = (uint16_t)pCh->CNDTR;
+				DMAState[ch].PeriAddr = pCh->CPAR;
+				DMAState[ch].MemAddr = ((uintptr_t)DMAState[ch].MemUpper << 32) | pCh->CMAR;
+			}
+		} else if (reg == 0x10){		// Reserved
+			*pReg = 0;
+		} else if (pCh->CCR & (1 << DMA_CCR_EN)){
+			*pReg = Pre; // CNDTR/CPAR/CMAR are write protected while the channel is enabled
+		} else if (reg == 0x04){
+			pCh->CNDTR &= 0xFFFF;
+		} else if (reg == 0x0C){
+			DMAState[ch].MemUpper = DMAMemUpper;
+		}
+	}
+}
+
+static void SIM_NVIC_Reset(uint32_t BaseAddr){
+
+	memset(NVICEnabled, 0, sizeof(NVICEnabled));
+	memset(NVICPending, 0, sizeof(NVICPending));
+	memset(NVICActive, 0, sizeof(NVICActive));
+	PendSVPending = 0;
+	SysTickPending = 0;
+	memset((void*)SIM_Reg(BaseAddr), 0, 0x1000);
+	*SIM_Reg(BaseAddr + 0xD0C) = 0xFA050000; // AIRCR reads VECTKEYSTAT
+	*SIM_Reg(SYSTICK_BASEADDR + 0x0C) = SIM_SYSTICK_CALIB;
+	SIM_NVIC_Refresh();
+}
+
+static void SIM_NVIC_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	volatile uint32_t *pReg = SIM_Reg(BaseAddr + Offset);
+	uint32_t idx = (Offset >> 2) & 0x1F;
+
+	if (!Write){
+		if (Offset == 0x10){
+			*pReg &= ~(1U << SYSTICK_CSR_COUNTFLAG); // COUNTFLAG is cleared by the read
+		}
+		return;
+	}
+
+	if ((Offset >= 0x100) && (Offset < 0x10C)){			// ISER: write 1 to enable
+		NVICEnabled[idx] |= *pReg;
+	} else if ((Offset >= 0x180) && (Offset < 0x18C)){	// ICER: write 1 to disable
+		NVICEnabled[idx] &= ~*pReg;
+	} else if ((Offset >= 0x200) && (Offset < 0x20C)){	// ISPR: write 1 to pend
+		NVICPending[idx] |= *pReg;
+	} else if ((Offset >= 0x280) && (Offset < 0x28C)){	// ICPR: write 1 to un-pend
+		NVICPending[idx] &= ~*pReg;
+	} else if ((Offset >= 0x400) && (Offset < 0x43C)){	// IPR: only the 4 upper bits of each byte exist
+		*pReg &= 0xF0F0F0F0;
+	} else if (Offset == 0x10){							// SysTick CSR: COUNTFLAG is read only
+		*pReg = (*pReg & 0x7) | (Pre & (1U << SYSTICK_CSR_COUNTFLAG));
+	} else if (Offset == 0x14){							// SysTick RVR: 24 bits
+		*pReg &= SYSTICK_RVR_MAX;
+	} else if (Offset == 0x18){							// SysTick CVR: any write clears it and COUNTFLAG
+		*pReg = 0;
+		*SIM_Reg(SYSTICK_BASEADDR) &= ~(1U << SYSTICK_CSR_COUNTFLAG);
+		SysTickFraction = 0;
+	} else if (Offset == 0x1C){							// SysTick CALIB is read only
+		*pReg = Pre;
+	} else if (Offset == 0xD04){						// ICSR: PENDSVSET/PENDSVCLR and PENDSTSET/PENDSTCLR are write 1
+		if (*pReg & (1U << SCB_ICSR_PENDSVSET)){
+			PendSVPending = 1;
+		} else if (*pReg & (1U << SCB_ICSR_PENDSVCLR)){
+			PendSVPending = 0;
+		}
+		if (*pReg & (1U << SCB_ICSR_PENDSTSET)){
+			SysTickPending = 1;
+		} else if (*pReg & (1U << SCB_ICSR_PENDSTCLR)){
+			SysTickPending = 0;
+		}
+	} else if (Offset == 0xD20){						// SHPR3: PendSV and SysTick bytes
+		*pReg &= 0xF0F00000;
+	} else if (Offset == 0xD0C){						// AIRCR: needs the VECTKEY
+		if ((*pReg >> 16) == 0x05FA){
+			*pReg = 0xFA050000 | (*pReg & (0x7 << 8));
+		} else {
+			*pReg = Pre;
+		}
+	} else if (Offset == 0xF00){						// STIR
+		if ((*pReg & 0x1FF) < SIM_NUM_IRQS){
+			NVICPending[(*pReg & 0x1FF) / 32] |= (1U << ((*pReg & 0x1FF) % 32));
+		}
+	} else if ((Offset >= 0x300) && (Offset < 0x30C)){	// IABR is read only
+		*pReg = Pre;
+	}
+}
+
+/******************************************************************
+ * @func			SIM_IRQLines
+ * @brief			This functions calculates the interrupt requests of the simulated peripherals
+ * @param [out]		Bit map of the asserted IRQ lines
+ * @return			None
+ * @note 			Peripheral interrupts are level sensitive: the line stays asserted while the
+ * 					flag and its enable bit are set
+ */
+static void SIM_IRQLines(uint32_t *pLines){
+
+	EXTI_RegDef_t *pEXTI = (EXTI_RegDef_t*)SIM_Reg(EXTI_BASEADDR);
+	uint32_t exti = pEXTI->PR & pEXTI->IMR;
+
+	memset(pLines, 0, 3 * sizeof(uint32_t));
+
+#define SIM_SET_LINE(irq) (pLines[(irq) / 32] |= (1U << ((irq) % 32)))
+
+	for (uint8_t line = 0; line < 5; line++){
+		if (exti & (1 << line)){
+			SIM_SET_LINE(IRQ_NO_EXTI0 + line);
+		}
+	}
+	if (exti & 0x03E0){
+		SIM_SET_LINE(IRQ_NO_EXTI9_5);
+	}
+	if (exti & 0xFC00){
+		SIM_SET_LINE(IRQ_NO_EXTI15_10);
+	}
+
+	DMA_RegDef_t *pDMA = (DMA_RegDef_t*)SIM_Reg(DMA1_BASEADDR);
+	for (uint8_t ch = 0; ch < 7; ch++){
+		if ((pDMA->ISR >> (4 * ch)) & pDMA->CH[ch].CCR & 0xE){ // TCIF/HTIF/TEIF and TCIE/HTIE/TEIE share positions
+			SIM_SET_LINE(IRQ_NO_DMA1_CH1 + ch);
+		}
+	}
+
+	static const struct{ uint32_t BaseAddr; uint8_t IRQ; } spis[] = {
+		{SPI1_BASEADDR, IRQ_NO_SPI1}, {SPI2_BASEADDR, IRQ_NO_SPI2}, {SPI3_BASEADDR, IRQ_NO_SPI3},
+	};
+	for (uint8_t i = 0; i < 3; i++){
+		SPI_RegDef_t *pSPI = (SPI_RegDef_t*)SIM_Reg(spis[i].BaseAddr);
+		if (((pSPI->SR & (1 << SPI_SR_TXE)) && (pSPI->CR2 & (1 << SPI_CR2_TXNEIE))) ||
+			((pSPI->SR & (1 << SPI_SR_RXNE)) && (pSPI->CR2 & (1 << SPI_CR2_RXNEIE))) ||
+			((pSPI->SR & ((1 << SPI_SR_OVR) | (1 << SPI_SR_MODF) | (1 << SPI_SR_CRCERR))) && (pSPI->CR2 & (1 << SPI_CR2_ERRIE)))){
+			SIM_SET_LINE(spis[i].IRQ);
+		}
+	}
+
+	static const struct{ uint32_t BaseAddr; uint8_t EvIRQ; uint8_t ErIRQ; } i2cs[] = {
+		{I2C1_BASEADDR, IRQ_NO_I2C1_EV, IRQ_NO_I2C1_ER}, {I2C2_BASEADDR, IRQ_NO_I2C2_EV, IRQ_NO_I2C2_ER},
+	};
+	for (uint8_t i = 0; i < 2; i++){
+		I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg(i2cs[i].BaseAddr);
+		uint32_t ev = (1 << I2C_SR1_SB) | (1 << I2C_SR1_ADDR) | (1 << I2C_SR1_ADD10) | (1 << I2C_SR1_STOPF) | (1 << I2C_SR1_BTF);
+		uint32_t buf = (1 << I2C_SR1_TXE) | (1 << I2C_SR1_RXNE);
+		if (pI2C->CR2 & (1 << I2C_CR2_ITEVTEN)){
+			if ((pI2C->SR1 & ev) || ((pI2C->CR2 & (1 << I2C_CR2_ITBUFEN)) && (pI2C->SR1 & buf))){
+				SIM_SET_LINE(i2cs[i].EvIRQ);
+			}
+		}
+		if ((pI2C->CR2 & (1 << I2C_CR2_ITERREN)) && (pI2C->SR1 & ~SIM_I2C_SR1_FLAGS_MASK)){
+			SIM_SET_LINE(i2cs[i].ErIRQ);
+		}
+	}
+
+	static const struct{ uint32_t BaseAddr; uint8_t IRQ; } usarts[] = {
+		{USART1_BASEADDR, IRQ_NO_USART1}, {USART2_BASEADDR, IRQ_NO_USART2}, {USART3_BASEADDR, IRQ_NO_USART3},
+	};
+	for (uint8_t i = 0; i < 3; i++){
+		USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg(usarts[i].BaseAddr);
+		uint32_t sr = pUSART->SR;
+		uint32_t cr1 = pUSART->CR1;
+		if (((sr & (1 << USART_SR_TXE)) && (cr1 & (1 << USART_CR1_TXEIE))) ||
+			((sr & (1 << USART_SR_TC)) && (cr1 & (1 << USART_CR1_TCIE))) ||
+			((sr & ((1 << USART_SR_RXNE) | (1 << USART_SR_ORE))) && (cr1 & (1 << USART_CR1_RXNEIE))) ||
+			((sr & (1 << USART_SR_IDLE)) && (cr1 & (1 << USART_CR1_IDLEIE))) ||
+			((sr & (1 << USART_SR_PE)) && (cr1 & (1 << USART_CR1_PEIE))) ||
+			((sr & ((1 << USART_SR_FE) | (1 << USART_SR_NE) | (1 << USART_SR_ORE))) &&
+			 (pUSART->CR3 & (1 << USART_CR3_EIE)) && (pUSART->CR3 & (1 << USART_CR3_DMAR)))){
+			SIM_SET_LINE(usarts[i].IRQ);
+		}
+	}
+
+#undef SIM_SET_LINE
+}
+
+/******************************************************************
+ * @func			SIM_NVIC_Refresh
+ * @brief			This functions updates the NVIC registers read by the code under test
+ * @param [in]		None
+ * @return			None
+ * @note 			ISER/ICER read the enable bits, ISPR/ICPR the pending bits, IABR the active bits
+ */
+static void SIM_NVIC_Refresh(void){
+
+	uint32_t lines[3];
+
+	SIM_IRQLines(lines);
+	for (uint8_t i = 0; i < 3; i++){
+		*SIM_Reg(SIM_SCS_BASEADDR + 0x100 + 4*i) = NVICEnabled[i];
+		*SIM_Reg(SIM_SCS_BASEADDR + 0x180 + 4*i) = NVICEnabled[i];
+		*SIM_Reg(SIM_SCS_BASEADDR + 0x200 + 4*i) = NVICPending[i] | lines[i];
+		*SIM_Reg(SIM_SCS_BASEADDR + 0x280 + 4*i) = NVICPending[i] | lines[i];
+		*SIM_Reg(SIM_SCS_BASEADDR + 0x300 + 4*i) = NVICActive[i];
+	}
+	*SIM_Reg(SIM_SCS_BASEADDR + 0xD04) = ((uint32_t)PendSVPending << SCB_ICSR_PENDSVSET) | ((uint32_t)SysTickPending << SCB_ICSR_PENDSTSET);
+}
+
+/******************************************************************
+ * @func			SIM_SysTick_Update
+ * @brief			This functions counts the SysTick counter down with the host time elapsed
+ * @param [in]		None
+ * @return			None
+ * @note 			Called before every SCS access and before selecting an interrupt. The counter
+ * 					reaches 0 (COUNTFLAG, SysTick pending with TICKINT) every RVR + 1 clocks: a 0
+ * 					loads RVR on the next clock
+ */
+static void SIM_SysTick_Update(void){
+
+	SysTick_RegDef_t *pSysTick = (SysTick_RegDef_t*)SIM_Reg(SYSTICK_BASEADDR);
+	struct timespec ts;
+	uint64_t now, elapsed, clocks;
+	uint32_t clk, reload;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = ((uint64_t)ts.tv_sec * 1000000000U) + ts.tv_nsec;
+	elapsed = now - SysTickLastNs;
+	SysTickLastNs = now;
+
+	if (!(pSysTick->CSR & (1U << SYSTICK_CSR_ENABLE))){
+		SysTickFraction = 0;
+		return;
+	}
+
+	clk = SIM_PCLKValue(0);
+	if (!(pSysTick->CSR & (1U << SYSTICK_CSR_CLKSOURCE))){
+		clk /= 8;
+	}
+	SysTickFraction += (elapsed % 1000000000U) * clk;
+	clocks = (elapsed / 1000000000U) * clk + SysTickFraction / 1000000000U;
+	SysTickFraction %= 1000000000U;
+
+	reload = pSysTick->RVR & SYSTICK_RVR_MAX;
+	while (clocks > 0){
+		if (pSysTick->CVR == 0){
+			pSysTick->CVR = reload;	// A reload of 0 stops the counter
+			clocks--;
+			if (reload == 0){
+				break;
+			}
+			if (clocks > (uint64_t)reload + 1){
+				clocks = (clocks - reload) % ((uint64_t)reload + 1) + reload; // Whole periods only set the flags again
+				pSysTick->CSR |= (1U << SYSTICK_CSR_COUNTFLAG);
+				SysTickPending |= (pSysTick->CSR >> SYSTICK_CSR_TICKINT) & 1;
+			}
+		} else if (clocks >= pSysTick->CVR){
+			clocks -= pSysTick->CVR;
+			pSysTick->CVR = 0;
+			pSysTick->CSR |= (1U << SYSTICK_CSR_COUNTFLAG);
+			SysTickPending |= (pSysTick->CSR >> SYSTICK_CSR_TICKINT) & 1;
+		} else {
+			pSysTick->CVR -= (uint32_t)clocks;
+			clocks = 0;
+		}
+	}
+	*SIM_Reg(SIM_SCS_BASEADDR + 0xD04) = ((uint32_t)PendSVPending << SCB_ICSR_PENDSVSET) | ((uint32_t)SysTickPending << SCB_ICSR_PENDSTSET);
+}
+
+/******************************************************************
+ * @func			SIM_Priority
+ * @brief			This functions reads the priority byte of an IRQ or system exception
+ * @param [in]		IRQ number or SIM_VEC_xxx
+ * @return			Priority byte (IPR or SHPR)
+ * @note 			None
+ */
+static uint8_t SIM_Priority(uint32_t Vector){
+
+	if (Vector == SIM_VEC_PENDSV){
+		return *SIM_Reg(SIM_SCS_BASEADDR + 0xD20) >> SCB_SHPR3_PENDSV;
+	}
+	if (Vector == SIM_VEC_SYSTICK){
+		return *SIM_Reg(SIM_SCS_BASEADDR + 0xD20) >> SCB_SHPR3_SYSTICK;
+	}
+	return ((volatile uint8_t*)SIM_Reg(SIM_SCS_BASEADDR + 0x400))[Vector];
+}
+
+/******************************************************************
+ * @func			SIM_PreemptPrio
+ * @brief			This functions calculates the preempt (group) priority of an IRQ or system exception
+ * @param [in]		IRQ number or SIM_VEC_xxx
+ * @return			Priority byte with the sub-priority bits cleared
+ * @note 			AIRCR PRIGROUP n: bits [7:n+1] of the priority byte are the preempt priority
+ */
+static uint16_t SIM_PreemptPrio(uint32_t Vector){
+
+	uint32_t prigroup = (*SIM_Reg(SIM_SCS_BASEADDR + 0xD0C) >> 8) & 0x7;
+
+	return SIM_Priority(Vector) & (0xFF << (prigroup + 1)) & 0xFF;
+}
+
+/******************************************************************
+ * @func			SIM_NextIRQ
+ * @brief			This functions selects the enabled and pending IRQ with the highest priority
+ * @param [in]		Preempt priority of the running handler (0x100 = thread mode)
+ * @return			IRQ number, SIM_VEC_xxx or -1 when there is nothing to do
+ * @note 			Lower priority value wins, then lower exception number (PendSV, SysTick, IRQs).
+ * 					Only IRQs with a lower preempt priority than the running handler are taken
+ */
+static int32_t SIM_NextIRQ(uint16_t Running){
+
+	uint32_t lines[3];
+	int32_t best = -1;
+	uint8_t best_prio = 0xFF;
+
+	SIM_SysTick_Update();
+	if (PendSVPending && (SIM_PreemptPrio(SIM_VEC_PENDSV) < Running)){
+		best = SIM_VEC_PENDSV;
+		best_prio = SIM_Priority(SIM_VEC_PENDSV);
+	}
+	if (SysTickPending && (SIM_PreemptPrio(SIM_VEC_SYSTICK) < Running)){
+		if ((best < 0) || (SIM_Priority(SIM_VEC_SYSTICK) < best_prio)){
+			best = SIM_VEC_SYSTICK;
+			best_prio = SIM_Priority(SIM_VEC_SYSTICK);
+		}
+	}
+
+	SIM_IRQLines(lines);
+	for (int32_t irq = 0; irq < SIM_NUM_IRQS; irq++){
+		uint32_t bit = 1U << (irq % 32);
+		if ((NVICEnabled[irq / 32] & bit) && ((NVICPending[irq / 32] | lines[irq / 32]) & bit) &&
+			(SIM_PreemptPrio(irq) < Running)){
+			if ((best < 0) || (SIM_Priority(irq) < best_prio)){
+				best = irq;
+				best_prio = SIM_Priority(irq);
+			}
+		}
+	}
+	return best;
+}
+
+/******************************************************************
+ * @func			SIM_DeliverIRQs
+ * @brief			This functions runs the handlers of the pending interrupts
+ * @param [in]		None
+ * @return			None
+ * @note 			An interrupt raised inside a handler preempts it when its preempt priority is
+ * 					lower (AIRCR PRIGROUP). Otherwise it runs after the handler returns (tail
+ * 					chaining). A line that stays asserted forever aborts the run
+ */
+static void SIM_DeliverIRQs(void){
+
+	uint32_t storm = 0;
+	uint16_t running = RunningPrio;
+	int32_t irq;
+
+	if (!Initialized || IRQMasked){
+		return;
+	}
+
+	while ((irq = SIM_NextIRQ(running)) >= 0){
+		void (*pHandler)(void) = (irq == SIM_VEC_PENDSV) ? PendSV_Handler :
+								 (irq == SIM_VEC_SYSTICK) ? SysTick_Handler : IRQHandlers[irq];
+
+		if (pHandler == NULL){
+			fprintf(stderr, "SIM: IRQ %d is enabled and pending but has no handler\n", (int)irq);
+			abort();
+		}
+		if (++storm > SIM_IRQ_STORM_LIMIT){
+			fprintf(stderr, "SIM: IRQ %d still pending after %u handler calls\n", (int)irq, SIM_IRQ_STORM_LIMIT);
+			abort();
+		}
+
+		if (irq == SIM_VEC_PENDSV){
+			PendSVPending = 0;
+		} else if (irq == SIM_VEC_SYSTICK){
+			SysTickPending = 0;
+		} else {
+			NVICPending[irq / 32] &= ~(1U << (irq % 32));
+			NVICActive[irq / 32] |= (1U << (irq % 32));
+		}
+		SIM_NVIC_Refresh();
+		IsrDepth++;
+		RunningPrio = SIM_PreemptPrio(irq);
+		if (IsrDepth > Stats.MaxIRQNesting){
+			Stats.MaxIRQNesting = IsrDepth;
+		}
+
+		pHandler();
+
+		RunningPrio = running;
+		IsrDepth--;
+		if (irq < SIM_NUM_IRQS){
+			NVICActive[irq / 32] &= ~(1U << (irq % 32));
+		}
+		SIM_NVIC_Refresh();
+		Stats.IRQs++;
+	}
+}
+
+/******************************************************************
+ * @func			SIM_DWT_Update
+ * @brief			This functions advances CYCCNT with the host time elapsed at the simulated HCLK
+ * @param [in]		None
+ * @return			None
+ * @note 			Called before every DWT access, so a read of CYCCNT is always up to date.
+ * 					CYCCNT only counts while DEMCR.TRCENA and DWT_CTRL.CYCCNTENA are set
+ */
+static void SIM_DWT_Update(void){
+
+	struct timespec ts;
+	uint64_t now, elapsed;
+	uint32_t hclk;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = ((uint64_t)ts.tv_sec * 1000000000U) + ts.tv_nsec;
+	elapsed = now - DWTLastNs;
+	DWTLastNs = now;
+
+	if (!(*SIM_Reg(SIM_SCS_BASEADDR + 0xDFC) & (1U << DEMCR_TRCENA)) || !(*SIM_Reg(DWT_BASEADDR) & (1U << DWT_CTRL_CYCCNTENA))){
+		DWTFraction = 0;
+		return;
+	}
+
+	// Whole seconds and the rest are scaled apart so the product never overflows
+	hclk = SIM_PCLKValue(0);
+	DWTFraction += (elapsed % 1000000000U) * hclk;
+	*SIM_Reg(DWT_BASEADDR + 0x04) += (uint32_t)((elapsed / 1000000000U) * hclk + DWTFraction / 1000000000U);
+	DWTFraction %= 1000000000U;
+}
+
+static void SIM_DWT_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(DWT_RegDef_t));
+	*SIM_Reg(BaseAddr) = 0x40000000; // CTRL.NUMCOMP: 4 comparators
+	DWTFraction = 0;
+}
+
+static void SIM_DWT_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	if (Write && (Offset == 0x00)){
+		*SIM_Reg(BaseAddr) = (*SIM_Reg(BaseAddr) & 0x0FFFFFFF) | (Pre & 0xF0000000); // NUMCOMP is read only
+	}
+}
+
+/******************************************************************
+ * @func			SIM_ITM_Ready
+ * @brief			This functions updates the FIFO ready bit read from the stimulus ports
+ * @param [in]		None
+ * @return			None
+ * @note 			The simulated FIFO never fills: ready while the ITM is enabled
+ */
+static void SIM_ITM_Ready(void){
+
+	ITM_RegDef_t *pITM = (ITM_RegDef_t*)SIM_Reg(ITM_BASEADDR);
+	uint32_t ready = (pITM->TCR & (1 << ITM_TCR_ITMENA)) ? (1 << ITM_PORT_FIFOREADY) : 0;
+
+	for (uint8_t port = 0; port < 32; port++){
+		pITM->PORT[port] = ready;
+	}
+}
+
+static void SIM_ITM_Reset(uint32_t BaseAddr){
+
+	memset((void*)SIM_Reg(BaseAddr), 0, sizeof(ITM_RegDef_t));
+	((ITM_RegDef_t*)SIM_Reg(BaseAddr))->LSR = 0x3; // Lock implemented and locked
+	SIM_ITM_Ready();
+}
+
+static void SIM_ITM_Access(uint32_t BaseAddr, uint32_t Offset, uint8_t Write, uint32_t Pre){
+
+	ITM_RegDef_t *pITM = (ITM_RegDef_t*)SIM_Reg(BaseAddr);
+
+	if (!Write){
+		return;
+	}
+
+	if (Offset < 0x80){
+		// Stimulus port: the store size is the size of the SWO packet
+		uint8_t port = Offset / 4;
+		uint32_t data = pITM->PORT[port] & (0xFFFFFFFFU >> (32 - 8 * AccessSize));
+		if ((pITM->TCR & (1 << ITM_TCR_ITMENA)) && (pITM->TER & (1U << port))){
+			if (ITMDevice){
+				ITMDevice(ITMContext, port, data, AccessSize);
+			}
+			uint32_t acpr = (*SIM_Reg(TPIU_BASEADDR + 0x10) & 0x1FFF) + 1;
+			Stats.BusTime_ns += (1ULL + AccessSize) * 10 * acpr * 1000000000ULL / SIM_PCLKValue(0);
+		}
+	} else if (Offset == 0xFB0){
+		pITM->LSR = (pITM->LAR == ITM_LAR_KEY) ? 0x1 : 0x3;
+		pITM->LAR = 0;
+	} else if (pITM->LSR & 0x2){
+		*SIM_Reg(BaseAddr + Offset) = Pre; // TER/TPR/TCR are write protected while locked
+	}
+	SIM_ITM_Ready();
+}
+
+/******************************************************************
+ * @func			SIM_StoreSize
+ * @brief			This functions finds the size of the store done by an x86-64 instruction
+ * @param [in]		First byte of the instruction
+ * @return			1, 2 or 4
+ * @note 			Only the MOV encodings used for volatile stores are decoded (88/89/C6/C7 with
+ * 					the 66 and REX prefixes). Anything else is taken as 4 bytes
+ */
+static uint8_t SIM_StoreSize(const uint8_t *pInstr){
+
+	uint8_t size = 4;
+
+	while ((*pInstr == 0x66) || (*pInstr == 0x67) || (*pInstr == 0x2E) || (*pInstr == 0x3E)){
+		if (*pInstr == 0x66){
+			size = 2;
+		}
+		pInstr++;
+	}
+	if ((*pInstr & 0xF0) == 0x40){
+		pInstr++; // REX. 64-bit stores do not reach the registers of this MCU
+	}
+	if ((*pInstr == 0x88) || (*pInstr == 0xC6)){
+		size = 1;
+	}
+	return size;
+}
+
+/******************************************************************
+ * @func			SIM_PostAccess
+ * @brief			This functions runs the model of the register that has just been accessed
+ * @param [in]		Access record
+ * @return			None
+ * @note 			Writes to a peripheral without clock are dropped like in the real MCU
+ */
+static void SIM_PostAccess(const SIM_Access_t *pAccess){
+
+	const SIM_Periph_t *pPeriph = SIM_FindPeriph(pAccess->Addr);
+
+	if (pAccess->Write){
+		Stats.RegWrites++;
+	} else {
+		Stats.RegReads++;
+	}
+
+	if (pPeriph == NULL){
+		return; // Plain memory
+	}
+
+	if (pAccess->Write && pPeriph->EnReg && !(*SIM_Reg(RCC_BASEADDR + pPeriph->EnReg) & (1U << pPeriph->EnBit))){
+		*SIM_Reg(pAccess->Addr) = pAccess->Pre;
+		Stats.DroppedWrites++;
+		return;
+	}
+
+	AccessSize = pAccess->Size;
+	pPeriph->Access(pPeriph->BaseAddr, (pAccess->Addr & ~3U) - pPeriph->BaseAddr, pAccess->Write, pAccess->Pre);
+	AccessSize = 4;
+	SIM_DMA_Service();
+	SIM_NVIC_Refresh();
+}
+
+/******************************************************************
+ * @func			SIM_SegvHandler
+ * @brief			This functions catches a register access and lets it run for one instruction
+ * @param [in]		Signal information
+ * @return			None
+ * @note 			Faults outside the simulated windows are real crashes
+ */
+static void SIM_SegvHandler(int Sig, siginfo_t *pInfo, void *pContext){
+
+	ucontext_t *pUC = (ucontext_t*)pContext;
+	uintptr_t addr = (uintptr_t)pInfo->si_addr;
+	SIM_Window_t *pWindow = SIM_FindWindow(addr);
+
+	if ((pWindow == NULL) || (InFlightCnt >= SIM_MAX_INFLIGHT)){
+		signal(SIGSEGV, SIG_DFL); // The instruction faults again and the program stops
+		return;
+	}
+
+	SIM_Access_t *pAccess = &InFlight[InFlightCnt++];
+	pAccess->Addr = (uint32_t)addr;
+	pAccess->Write = (pUC->uc_mcontext.gregs[REG_ERR] & SIM_PF_WRITE) ? 1 : 0;
+	pAccess->AliasAddr = 0;
+	pAccess->Size = pAccess->Write ? SIM_StoreSize((const uint8_t*)pUC->uc_mcontext.gregs[REG_RIP]) : 4;
+
+	if (pWindow->BaseAddr == PERIPH_BB_BASEADDR){
+		// Bit-band alias: the access is turned into an access to the bit of the real register.
+		// The alias word gets the current value of the bit, so a read returns 0/1
+		pAccess->AliasAddr = (uint32_t)addr;
+		pAccess->Addr = PERIPH_BASEADDR + ((((uint32_t)addr - PERIPH_BB_BASEADDR) >> 5) & ~3U);
+		pAccess->Bit = ((uint32_t)addr >> 2) & 0x1F;
+		*SIM_Reg(pAccess->AliasAddr) = (*SIM_Reg(pAccess->Addr) >> pAccess->Bit) & 1;
+	}
+	if ((pAccess->Addr & ~0x3FFU) == DWT_BASEADDR){
+		SIM_DWT_Update(); // CYCCNT is only brought up to date when it is used
+	} else if ((pAccess->Addr & ~0xFFFU) == SIM_SCS_BASEADDR){
+		SIM_SysTick_Update(); // CVR, COUNTFLAG and PENDSTSET too
+	}
+	pAccess->Pre = *SIM_Reg(pAccess->Addr);
+
+	mprotect((void*)(addr & ~(uintptr_t)(SIM_PAGE_SIZE - 1)), SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+	pUC->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+/******************************************************************
+ * @func			SIM_TrapHandler
+ * @brief			This functions runs after the register access instruction has executed
+ * @param [in]		Signal information
+ * @return			None
+ * @note 			Pending interrupts are delivered from here
+ */
+static void SIM_TrapHandler(int Sig, siginfo_t *pInfo, void *pContext){
+
+	ucontext_t *pUC = (ucontext_t*)pContext;
+	SIM_Access_t done[SIM_MAX_INFLIGHT];
+	uint32_t cnt = InFlightCnt;
+
+	if ((cnt == 0) || (pInfo->si_code != TRAP_TRACE)){
+		signal(SIGTRAP, SIG_DFL);
+		raise(SIGTRAP);
+		return;
+	}
+
+	pUC->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+	memcpy(done, InFlight, cnt * sizeof(SIM_Access_t));
+	InFlightCnt = 0;
+
+	for (uint32_t i = 0; i < cnt; i++){
+		uint32_t addr = done[i].AliasAddr ? done[i].AliasAddr : done[i].Addr;
+		mprotect((void*)((uintptr_t)addr & ~(uintptr_t)(SIM_PAGE_SIZE - 1)), SIM_PAGE_SIZE, PROT_NONE);
+	}
+	for (uint32_t i = 0; i < cnt; i++){
+		if (done[i].AliasAddr && done[i].Write){
+			// Bit 0 of the alias word goes to the bit of the register. The other bits are kept
+			volatile uint32_t *pReg = SIM_Reg(done[i].Addr);
+			*pReg = (done[i].Pre & ~(1U << done[i].Bit)) | ((*SIM_Reg(done[i].AliasAddr) & 1) << done[i].Bit);
+		}
+		SIM_PostAccess(&done[i]);
+	}
+
+	SIM_DeliverIRQs();
+}
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			SIM_Init (Simulator initialization)
+ * @brief			This functions maps the register windows and installs the trap handlers
+ * @param [in]		None
+ * @return			None
+ * @note 			Runs automatically before main. Calling it again does nothing
+ */
+__attribute__((constructor)) void SIM_Init(void){
+
+	struct sigaction sa;
+
+	if (Initialized){
+		return;
+	}
+
+	for (uint32_t i = 0; i < sizeof(Windows)/sizeof(Windows[0]); i++){
+		int fd = memfd_create("stm32f1xx_sim", 0);
+		void *pBus;
+
+		if ((fd < 0) || (ftruncate(fd, Windows[i].Size) != 0)){
+			perror("SIM: memfd");
+			exit(1);
+		}
+		pBus = mmap((void*)(uintptr_t)Windows[i].BaseAddr, Windows[i].Size, PROT_NONE,
+					MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+		Windows[i].pBacking = mmap(NULL, Windows[i].Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if ((pBus != (void*)(uintptr_t)Windows[i].BaseAddr) || (Windows[i].pBacking == MAP_FAILED)){
+			fprintf(stderr, "SIM: cannot map the window at 0x%08X\n", (unsigned)Windows[i].BaseAddr);
+			exit(1);
+		}
+		close(fd);
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_flags = SA_SIGINFO | SA_NODEFER; // Handlers access registers too, so they nest
+	sa.sa_sigaction = SIM_SegvHandler;
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = SIM_TrapHandler;
+	sigaction(SIGTRAP, &sa, NULL);
+
+	SIM_Reset();
+	Initialized = 1;
+}
+
+/******************************************************************
+ * @func			SIM_Reset (Simulator reset)
+ * @brief			This functions puts every simulated register at its reset value
+ * @param [in]		None
+ * @return			None
+ * @note 			Attached devices are removed and the statistics are cleared
+ */
+void SIM_Reset(void){
+
+	for (uint32_t i = 0; i < sizeof(Windows)/sizeof(Windows[0]); i++){
+		memset(Windows[i].pBacking, 0, Windows[i].Size);
+	}
+
+	memset(SPIState, 0, sizeof(SPIState));
+	memset(I2CState, 0, sizeof(I2CState));
+	memset(USARTState, 0, sizeof(USARTState));
+	ITMDevice = NULL;
+	memset(GPIOExtLevel, 0, sizeof(GPIOExtLevel));
+	memset(GPIOExtDriven, 0, sizeof(GPIOExtDriven));
+	memset(GPIOLevel, 0, sizeof(GPIOLevel));
+
+	// EXTI and AFIO first so the GPIO reset does not see stale edges
+	for (uint32_t i = 0; i < sizeof(Periphs)/sizeof(Periphs[0]); i++){
+		if ((Periphs[i].BaseAddr == EXTI_BASEADDR) || (Periphs[i].BaseAddr == AFIO_BASEADDR)){
+			Periphs[i].Reset(Periphs[i].BaseAddr);
+		}
+	}
+	for (uint32_t i = 0; i < sizeof(Periphs)/sizeof(Periphs[0]); i++){
+		Periphs[i].Reset(Periphs[i].BaseAddr);
+	}
+	memset((void*)SIM_Reg(EXTI_BASEADDR), 0, sizeof(EXTI_RegDef_t));
+
+	SIM_ResetStats();
+}
+
+/******************************************************************
+ * @func			SIM_GPIO_SetInputPin
+ * @brief			This functions drives a pin from outside the MCU
+ * @param [in]		Base Address of the GPIO port
+ * @param [in]		Pin number
+ * @param [in]		Level (0 or 1)
+ * @return			None
+ * @note 			EXTI edges detected on the pin run their handlers before returning
+ */
+void SIM_GPIO_SetInputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t value){
+
+	uint8_t port = ((uint32_t)(uintptr_t)pGPIOx - GPIOA_BASEADDR) / 0x400;
+
+	GPIOExtDriven[port] |= (1 << PinNumber);
+	if (value == GPIO_PIN_SET){
+		GPIOExtLevel[port] |= (1 << PinNumber);
+	} else {
+		GPIOExtLevel[port] &= ~(1 << PinNumber);
+	}
+	SIM_GPIO_UpdateLevels(port);
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+}
+
+/******************************************************************
+ * @func			SIM_SPI_AttachDevice
+ * @brief			This functions connects a simulated slave to a SPI bus
+ * @param [in]		Base Address of the SPI
+ * @param [in]		Device callback. NULL connects MOSI to MISO
+ * @param [in]		Context passed to the callback
+ * @return			None
+ * @note 			None
+ */
+void SIM_SPI_AttachDevice(SPI_RegDef_t *pSPIx, SIM_SPIDevice_t Device, void *pContext){
+
+	SIM_SPIState_t *pState = SIM_SPI_State((uint32_t)(uintptr_t)pSPIx);
+
+	pState->Device = Device;
+	pState->pContext = pContext;
+}
+
+/******************************************************************
+ * @func			SIM_I2C_AttachDevice
+ * @brief			This functions connects a simulated slave to an I2C bus
+ * @param [in]		Base Address of the I2C
+ * @param [in]		7-bit slave address
+ * @param [in]		Device callbacks
+ * @param [in]		Context passed to the callbacks
+ * @return			None
+ * @note 			Addresses without a device are NACKed
+ */
+void SIM_I2C_AttachDevice(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, const SIM_I2CDevice_t *pDevice, void *pContext){
+
+	SIM_I2CState_t *pState = SIM_I2C_State((uint32_t)(uintptr_t)pI2Cx);
+
+	if (pState->DeviceCnt >= SIM_MAX_I2C_DEVICES){
+		fprintf(stderr, "SIM: too many I2C devices\n");
+		abort();
+	}
+	pState->Devices[pState->DeviceCnt].Addr = SlaveAddr;
+	pState->Devices[pState->DeviceCnt].pDevice = pDevice;
+	pState->Devices[pState->DeviceCnt].pContext = pContext;
+	pState->DeviceCnt++;
+}
+
+/******************************************************************
+ * @func			SIM_I2C_ExtAddress
+ * @brief			This functions addresses the MCU as slave from the external master
+ * @param [in]		Base Address of the I2C
+ * @param [in]		7-bit slave address
+ * @param [in]		Direction seen by the MCU (SIM_EXT_WRITE / SIM_EXT_READ)
+ * @return			1 if the MCU acknowledged and cleared ADDR
+ * @note 			The MCU must serve the transfer from its interrupt handlers
+ */
+static uint8_t SIM_I2C_ExtAddress(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, uint8_t Mode){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg((uint32_t)(uintptr_t)pI2Cx);
+	SIM_I2CState_t *pState = SIM_I2C_State((uint32_t)(uintptr_t)pI2Cx);
+
+	if (!(pI2C->CR1 & (1 << I2C_CR1_PE)) || !(pI2C->CR1 & (1 << I2C_CR1_ACK)) ||
+		(((pI2C->OAR1 >> 1) & 0x7F) != SlaveAddr) || pState->Master){
+		return 0;
+	}
+
+	pState->ExtMode = Mode;
+	pI2C->SR2 |= (1 << I2C_SR2_BUSY);
+	if (Mode == SIM_EXT_READ){
+		pI2C->SR2 |= (1 << I2C_SR2_TRA);
+	} else {
+		pI2C->SR2 &= ~(1 << I2C_SR2_TRA);
+	}
+	pI2C->SR1 |= (1 << I2C_SR1_ADDR);
+	SIM_I2C_ByteTime(pI2C);
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+
+	return (pI2C->SR1 & (1 << I2C_SR1_ADDR)) ? 0 : 1;
+}
+
+/******************************************************************
+ * @func			SIM_I2C_MasterWrite
+ * @brief			This functions writes bytes to the MCU acting as I2C slave
+ * @param [in]		Base Address of the I2C
+ * @param [in]		7-bit slave address
+ * @param [in]		Bytes to write
+ * @param [in]		Length
+ * @return			Bytes transferred
+ * @note 			The transfer stops when the MCU does not read a byte in time
+ */
+uint32_t SIM_I2C_MasterWrite(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, const uint8_t *pTxBuffer, uint32_t len){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg((uint32_t)(uintptr_t)pI2Cx);
+	SIM_I2CState_t *pState = SIM_I2C_State((uint32_t)(uintptr_t)pI2Cx);
+	uint32_t cnt = 0;
+
+	if (SIM_I2C_ExtAddress(pI2Cx, SlaveAddr, SIM_EXT_WRITE)){
+		while ((cnt < len) && !(pI2C->SR1 & (1 << I2C_SR1_RXNE))){
+			pState->RxData = pTxBuffer[cnt++];
+			pI2C->DR = pState->RxData;
+			pI2C->SR1 |= (1 << I2C_SR1_RXNE);
+			SIM_I2C_ByteTime(pI2C);
+			SIM_NVIC_Refresh();
+			SIM_DeliverIRQs();
+		}
+		pI2C->SR1 |= (1 << I2C_SR1_STOPF);
+	}
+
+	pI2C->SR2 &= ~(1 << I2C_SR2_BUSY);
+	pState->ExtMode = SIM_EXT_NONE;
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+
+	return cnt;
+}
+
+/******************************************************************
+ * @func			SIM_I2C_MasterRead
+ * @brief			This functions reads bytes from the MCU acting as I2C slave
+ * @param [in]		Base Address of the I2C
+ * @param [in]		7-bit slave address
+ * @param [out]		Buffer for the received bytes
+ * @param [in]		Length
+ * @return			Bytes transferred
+ * @note 			The last byte is NACKed, which sets AF in the MCU
+ */
+uint32_t SIM_I2C_MasterRead(I2C_RegDef_t *pI2Cx, uint8_t SlaveAddr, uint8_t *pRxBuffer, uint32_t len){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg((uint32_t)(uintptr_t)pI2Cx);
+	SIM_I2CState_t *pState = SIM_I2C_State((uint32_t)(uintptr_t)pI2Cx);
+
+	if (len == 0){
+		return 0;
+	}
+
+	pState->pExtBuffer = pRxBuffer;
+	pState->ExtLen = len;
+	pState->ExtCnt = 0;
+	SIM_I2C_ExtAddress(pI2Cx, SlaveAddr, SIM_EXT_READ);
+
+	// Anything the handlers did not send is lost
+	pI2C->SR1 &= ~(1 << I2C_SR1_TXE);
+	pI2C->SR2 &= ~((1 << I2C_SR2_BUSY) | (1 << I2C_SR2_TRA));
+	pState->ExtMode = SIM_EXT_NONE;
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+
+	return pState->ExtCnt;
+}
+
+/******************************************************************
+ * @func			SIM_I2C_SetError
+ * @brief			This functions raises an error flag of the I2C, as a fault on the lines would
+ * @param [in]		Base Address of the I2C
+ * @param [in]		Error flag bit position (I2C_SR1_BERR, I2C_SR1_ARLO...)
+ * @return			None
+ * @note 			The error interrupt runs before returning if ITERREN is set
+ */
+void SIM_I2C_SetError(I2C_RegDef_t *pI2Cx, uint8_t Flag){
+
+	I2C_RegDef_t *pI2C = (I2C_RegDef_t*)SIM_Reg((uint32_t)(uintptr_t)pI2Cx);
+
+	pI2C->SR1 |= (1 << Flag) & ~SIM_I2C_SR1_FLAGS_MASK;
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+}
+
+/******************************************************************
+ * @func			SIM_USART_AttachDevice
+ * @brief			This functions connects a simulated device to the TX line of a USART
+ * @param [in]		Base Address of the USART
+ * @param [in]		Device callback. NULL discards the frames
+ * @param [in]		Context passed to the callback
+ * @return			None
+ * @note 			None
+ */
+void SIM_USART_AttachDevice(USART_RegDef_t *pUSARTx, SIM_USARTDevice_t Device, void *pContext){
+
+	SIM_USARTState_t *pState = SIM_USART_State((uint32_t)(uintptr_t)pUSARTx);
+
+	pState->Device = Device;
+	pState->pContext = pContext;
+}
+
+/******************************************************************
+ * @func			SIM_USART_Receive
+ * @brief			This functions sends frames to the RX line of a USART, followed by an idle line
+ * @param [in]		Base Address of the USART
+ * @param [in]		Frames
+ * @param [in]		Length
+ * @return			Frames stored in DR. The others were lost (ORE) or the receiver is disabled
+ * @note 			The frames arrive back to back: each one must be read (by the CPU or the DMA)
+ * 					before the next one, or it sets ORE. IDLE is set after the last frame
+ */
+uint32_t SIM_USART_Receive(USART_RegDef_t *pUSARTx, const uint8_t *pRxBuffer, uint32_t len){
+
+	uint32_t base = (uint32_t)(uintptr_t)pUSARTx;
+	USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg(base);
+	SIM_USARTState_t *pState = SIM_USART_State(base);
+	uint32_t cnt = 0;
+
+	if (!(pUSART->CR1 & (1 << USART_CR1_UE)) || !(pUSART->CR1 & (1 << USART_CR1_RE))){
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < len; i++){
+		SIM_USART_FrameTime(base);
+		if (pUSART->SR & (1 << USART_SR_RXNE)){
+			pUSART->SR |= (1 << USART_SR_ORE);
+		} else {
+			pState->RxData = pRxBuffer[i];
+			pUSART->DR = pState->RxData;
+			pUSART->SR |= (1 << USART_SR_RXNE);
+			cnt++;
+		}
+		SIM_DMA_Service();
+		SIM_NVIC_Refresh();
+		SIM_DeliverIRQs();
+	}
+
+	if (len != 0){
+		pUSART->SR |= (1 << USART_SR_IDLE);
+		SIM_NVIC_Refresh();
+		SIM_DeliverIRQs();
+	}
+
+	return cnt;
+}
+
+/******************************************************************
+ * @func			SIM_USART_SetError
+ * @brief			This functions raises an error flag of the USART, as a bad frame on the line would
+ * @param [in]		Base Address of the USART
+ * @param [in]		Error flag bit position (USART_SR_PE, USART_SR_FE, USART_SR_NE or USART_SR_ORE)
+ * @return			None
+ * @note 			The interrupt runs before returning if it is enabled
+ */
+void SIM_USART_SetError(USART_RegDef_t *pUSARTx, uint8_t Flag){
+
+	USART_RegDef_t *pUSART = (USART_RegDef_t*)SIM_Reg((uint32_t)(uintptr_t)pUSARTx);
+
+	pUSART->SR |= (1 << Flag) & SIM_USART_SR_SEQ_CLR & ~(1 << USART_SR_IDLE);
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+}
+
+/******************************************************************
+ * @func			SIM_ITM_AttachDevice
+ * @brief			This functions connects a simulated trace receiver (SWO) to the ITM
+ * @param [in]		Device callback. NULL discards the data
+ * @param [in]		Context passed to the callback
+ * @return			None
+ * @note 			Only writes to enabled ports reach the callback
+ */
+void SIM_ITM_AttachDevice(SIM_ITMDevice_t Device, void *pContext){
+
+	ITMDevice = Device;
+	ITMContext = pContext;
+}
+
+/******************************************************************
+ * @func			SIM_DMA_MemAddr
+ * @brief			This functions converts a host pointer to the value written in CMAR
+ * @param [in]		Memory buffer
+ * @return			Lower 32 bits of the pointer
+ * @note 			The upper half is kept and attached to the channel when CMAR is written
+ */
+uint32_t SIM_DMA_MemAddr(const volatile void *pMem){
+
+	DMAMemUpper = (uint32_t)((uintptr_t)pMem >> 32);
+	return (uint32_t)(uintptr_t)pMem;
+}
+
+/******************************************************************
+ * @func			SIM_IRQPoll
+ * @brief			This functions delivers the pending interrupts
+ * @param [in]		None
+ * @return			None
+ * @note 			Needed in loops that wait on RAM variables only (no register access means
+ * 					no chance to deliver interrupts)
+ */
+void SIM_IRQPoll(void){
+
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+}
+
+/******************************************************************
+ * @func			SIM_SetPRIMASK
+ * @brief			This functions models cpsid i/cpsie i (IRQ_DISABLE/IRQ_ENABLE)
+ * @param [in]		1 = interrupts masked
+ * @return			None
+ * @note 			The interrupts pending while masked run on the unmask
+ */
+void SIM_SetPRIMASK(uint8_t Masked){
+
+	IRQMasked = Masked;
+	if (!Masked){
+		SIM_IRQPoll();
+	}
+}
+
+/******************************************************************
+ * @func			SIM_GetPRIMASK
+ * @brief			This functions models mrs primask (IRQ_SAVE_DISABLE)
+ * @param [in]		None
+ * @return			1 = interrupts masked
+ * @note 			None
+ */
+uint8_t SIM_GetPRIMASK(void){
+
+	return IRQMasked;
+}
+
+/******************************************************************
+ * @func			SIM_WaitForInterrupt
+ * @brief			This functions models wfi: the host sleeps until an interrupt can be taken
+ * @param [in]		None
+ * @return			None
+ * @note 			Like the core, it also wakes up with PRIMASK set (the interrupt runs after the
+ * 					unmask). With nothing to wake it up it never returns
+ */
+void SIM_WaitForInterrupt(void){
+
+	struct timespec ts = {0, SIM_WFI_SLEEP_NS};
+
+	while (SIM_NextIRQ(RunningPrio) < 0){
+		nanosleep(&ts, NULL);
+	}
+	SIM_NVIC_Refresh();
+	SIM_DeliverIRQs();
+}
+
+void SIM_GetStats(SIM_Stats_t *pStats){
+
+	*pStats = Stats;
+}
+
+void SIM_ResetStats(void){
+
+	memset(&Stats, 0, sizeof(Stats));
+}
+
+/* Semihosting is not available on the host. The applications call this before printf */
+__attribute__((weak)) void initialise_monitor_handles(void){
+
+}
+
+#endif /* STM32F1_HOST_SIM */
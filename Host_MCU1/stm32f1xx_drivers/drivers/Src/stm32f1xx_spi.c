@@ -14,6 +14,10 @@
 static void SPI_TXE_Interrupt_Handle(SPI_Handle_t *pSPIxHandle);
 static void SPI_RXNE_Interrupt_Handle(SPI_Handle_t *pSPIxHandle);
 static void SPI_OVR_Interrupt_Handle(SPI_Handle_t *pSPIxHandle);
+static uint8_t SPI_WaitFlag(SPI_RegDef_t *pSPIx, uint8_t Bit, DWT_Timeout_t *pTimeout);
+static uint32_t SPI_GetPCLKValue(SPI_RegDef_t *pSPIx);
+
+static uint32_t SPI_Timeout = SPI_TIMEOUT_DEFAULT_US; // Deadline of the blocking calls. Set by SPI_SetTimeout
 
 /* 					APIs Function Implementation 					*/
 
@@ -26,25 +30,9 @@ static void SPI_OVR_Interrupt_Handle(SPI_Handle_t *pSPIxHandle);
  * @note 			None
  */
 void SPI_PeriClkCtrl(SPI_RegDef_t *pSPIx, uint8_t EnOrDi){
-	if (EnOrDi == ENABLE) {
-		if (pSPIx == SPI1) {
-			SPI1_PCLK_EN();
-		} else if (pSPIx == SPI2) {
-			SPI2_PCLK_EN();
-		} else {
-			SPI3_PCLK_EN();
-		}
-	}
-	else
-	{
-		if (pSPIx == SPI1) {
-			SPI1_PCLK_DI();
-		} else if (pSPIx == SPI2) {
-			SPI2_PCLK_DI();
-		}  else {
-			SPI3_PCLK_DI();
-		}
-	}
+
+	// The RCC bit of the SPI is taken from the peripheral table
+	RCC_PeriClkCtrl(pSPIx, EnOrDi);
 }
 
 /******************************************************************
@@ -93,6 +81,70 @@ void SPI_Init(SPI_Handle_t *pSPIxHandle){
 	pSPIxHandle->pSPIx->CR1 = temp; // Here yoo can use = bc al the bit-fields are already configured
 }
 
+/******************************************************************
+ * @func			SPI_CalcBaudRate (SPI calculate baud rate)
+ * @brief			This functions finds the fastest prescaler that keeps SCK at or below a limit
+ * @param [in]		Base Address of the SPI
+ * @param [in]		Maximum SCK of the slave in Hz
+ * @param [out]		Achieved SCK in Hz. Can be NULL
+ * @return			Prescaler. Possible values @SPI_SCLKSpeed
+ * @note 			SCK = PCLK / 2^(BR + 1). The limit is also capped to SPI_SCLK_MAX. If the slave is
+ * 					slower than PCLK/256, SPI_SCLK_SPEED_DIV_256 is returned and the achieved SCK is
+ * 					above the limit: check it
+ */
+uint8_t SPI_CalcBaudRate(SPI_RegDef_t *pSPIx, uint32_t MaxSCLK_Hz, uint32_t *pSCLK_Hz){
+
+	uint32_t sclk = SPI_GetPCLKValue(pSPIx) / 2;
+	uint8_t br = SPI_SCLK_SPEED_DIV_2;
+
+	if (MaxSCLK_Hz > SPI_SCLK_MAX){
+		MaxSCLK_Hz = SPI_SCLK_MAX;
+	}
+
+	while ((sclk > MaxSCLK_Hz) && (br < SPI_SCLK_SPEED_DIV_256)){
+		sclk /= 2;
+		br++;
+	}
+
+	if (pSCLK_Hz != NULL){
+		*pSCLK_Hz = sclk;
+	}
+
+	return br;
+}
+
+/******************************************************************
+ * @func			SPI_SetBaudRate (SPI set baud rate)
+ * @brief			This functions runs the SPI at the fastest SCK allowed by the slave
+ * @param [in]		SPI Handle
+ * @param [in]		Maximum SCK of the slave in Hz
+ * @return			Achieved SCK in Hz
+ * @note 			The prescaler is stored in SPI_SCLKSpeed and written to CR1. Call it with the bus
+ * 					idle, and again after changing the clock tree (RCC_ClockConfig)
+ */
+uint32_t SPI_SetBaudRate(SPI_Handle_t *pSPIxHandle, uint32_t MaxSCLK_Hz){
+
+	uint32_t sclk;
+
+	pSPIxHandle->SPI_Config.SPI_SCLKSpeed = SPI_CalcBaudRate(pSPIxHandle->pSPIx, MaxSCLK_Hz, &sclk);
+	pSPIxHandle->pSPIx->CR1 = (pSPIxHandle->pSPIx->CR1 & ~(0x7 << SPI_CR1_BR)) |
+							  ((uint32_t)pSPIxHandle->SPI_Config.SPI_SCLKSpeed << SPI_CR1_BR);
+
+	return sclk;
+}
+
+/******************************************************************
+ * @func			SPI_GetSCLKValue (SPI get SCK value)
+ * @brief			This functions calculates the SCK frequency programmed in a SPI
+ * @param [in]		Base Address of the SPI
+ * @return			SCK in Hz
+ * @note 			None
+ */
+uint32_t SPI_GetSCLKValue(SPI_RegDef_t *pSPIx){
+
+	return SPI_GetPCLKValue(pSPIx) >> (((pSPIx->CR1 >> SPI_CR1_BR) & 0x7) + 1);
+}
+
 /******************************************************************
  * @func			SPI_DeInit (SPI De-initialization)
  * @brief			This functions resets a given SPI Port
@@ -101,13 +153,8 @@ void SPI_Init(SPI_Handle_t *pSPIxHandle){
  * @note 			None
  */
 void SPI_DeInit(SPI_RegDef_t *pSPIx){
-	if (pSPIx == SPI1) {
-		SPI1_REG_RESET();
-	} else if (pSPIx == SPI2) {
-		SPI2_REG_RESET();
-	} else {
-		SPI3_REG_RESET();
-	}
+
+	RCC_PeriReset(pSPIx);
 }
 
 /******************************************************************
@@ -133,37 +180,41 @@ uint8_t SPI_GetFlagStatus(SPI_RegDef_t *pSPIx, uint32_t FlagName){
  * @param [in]		Base Address of the SPI
  * @param [in]		Buffer to store the data that is going to be sent
  * @param [in]		Length of the buffer in bytes
- * @return			None
+ * @return			SPI_OK or SPI_TIMEOUT if TXE was not set within the deadline (SPI_SetTimeout)
  * @note 			Blocked communication implemented. The function call will wait until all
- *  				the bytes are transmitted
+ *  				the bytes are transmitted. In 16-bit format each frame takes 2 bytes of the
+ *  				buffer (len/2 frames, little-endian)
  */
-void SPI_SendData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint32_t len){
-
-	while (len > 0){
-		// Wait until TXE is set -> Tx Buffer is empty
-		while((SPI_GetFlagStatus(pSPIx, SPI_TXE_FLAG)) == FLAG_RESET);
-		// When the expression is true and the flag is still in reset, it will wait in the while
+uint8_t SPI_SendData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint32_t len){
 
-		// Check DFF bit
-		if(pSPIx->CR1 & (SPI_CR1_DFF)){
-			// 16-Bit format
-			// Load data into Tx Buffer
-			pSPIx->DR = *((uint16_t*)pTxBuffer); // Dereference the pointer to get the data
+	DWT_Timeout_t timeout;
 
-			// Decrease the length
-			len--;
-			len--; // 2 bytes to decrease
+	DWT_TimeoutStart(&timeout, SPI_Timeout);
 
-			// Increment TxBuffer in order to make it point to the next data item
-			(uint16_t*)pTxBuffer++;
+	// The frame format cannot change during the transfer, so DFF is checked only once
+	if (pSPIx->CR1 & (1 << SPI_CR1_DFF)){
+		// 16-Bit format
+		uint16_t *pTx16 = (uint16_t*)pTxBuffer;
 
-		} else {
-			// 8-Bit format
-			pSPIx->DR = *pTxBuffer;
-			len--;
-			pTxBuffer++;
+		for (len /= 2; len > 0; len--){
+			// Wait until TXE is set -> Tx Buffer is empty
+			if (SPI_WaitFlag(pSPIx, SPI_SR_TXE, &timeout) != SPI_OK){
+				return SPI_TIMEOUT;
+			}
+			pSPIx->DR = *pTx16++;
+		}
+	} else {
+		// 8-Bit format
+		for (; len > 0; len--){
+			// Wait until TXE is set -> Tx Buffer is empty
+			if (SPI_WaitFlag(pSPIx, SPI_SR_TXE, &timeout) != SPI_OK){
+				return SPI_TIMEOUT;
+			}
+			pSPIx->DR = *pTxBuffer++;
 		}
 	}
+
+	return SPI_OK;
 }
 
 
@@ -173,36 +224,118 @@ void SPI_SendData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint32_t len){
  * @param [in]		Base Address of the SPI
  * @param [in]		Pointer to the buffer containing the data that is going to be received
  * @param [in]		Length of the buffer in bytes
- * @return			None
- * @note
+ * @return			SPI_OK or SPI_TIMEOUT if RXNE was not set within the deadline (SPI_SetTimeout)
+ * @note			In 16-bit format each frame takes 2 bytes of the buffer (len/2 frames)
  */
-void SPI_ReceiveData(SPI_RegDef_t *pSPIx, uint8_t *pRxBuffer, uint32_t len){
+uint8_t SPI_ReceiveData(SPI_RegDef_t *pSPIx, uint8_t *pRxBuffer, uint32_t len){
 
-	while (len > 0){
-			// Wait until RXE is set -> Tx Buffer is empty
-			while((SPI_GetFlagStatus(pSPIx, SPI_RXE_FLAG)) == FLAG_RESET);
-			// When the expression is true and the flag is still in reset, it will wait in the while
+	DWT_Timeout_t timeout;
 
-			// Check DFF bit
-			if(pSPIx->CR1 & (SPI_CR1_DFF)){
-				// 16-Bit format
-				// Load data from DR to RxBuffer
-				*((uint16_t*)pRxBuffer) = pSPIx->DR; // Dereference the pointer to get the data
+	DWT_TimeoutStart(&timeout, SPI_Timeout);
 
-				// Decrease the length
-				len--;
-				len--; // 2 bytes to decrease
+	// The frame format cannot change during the transfer, so DFF is checked only once
+	if (pSPIx->CR1 & (1 << SPI_CR1_DFF)){
+		// 16-Bit format
+		uint16_t *pRx16 = (uint16_t*)pRxBuffer;
 
-				// Increment TxBuffer in order to make it point to the next data item
-				(uint16_t*)pRxBuffer++;
+		for (len /= 2; len > 0; len--){
+			// Wait until RXNE is set -> Rx Buffer is not empty
+			if (SPI_WaitFlag(pSPIx, SPI_SR_RXNE, &timeout) != SPI_OK){
+				return SPI_TIMEOUT;
+			}
+			*pRx16++ = (uint16_t)pSPIx->DR;
+		}
+	} else {
+		// 8-Bit format
+		for (; len > 0; len--){
+			// Wait until RXNE is set -> Rx Buffer is not empty
+			if (SPI_WaitFlag(pSPIx, SPI_SR_RXNE, &timeout) != SPI_OK){
+				return SPI_TIMEOUT;
+			}
+			*pRxBuffer++ = (uint8_t)pSPIx->DR;
+		}
+	}
 
+	return SPI_OK;
+}
+
+/******************************************************************
+ * @func			SPI_TransferData (SPI transfer data)
+ * @brief			This functions sends and receives data via SPI at the same time (full-duplex)
+ * @param [in]		Base Address of the SPI
+ * @param [in]		Buffer with the data that is going to be sent. NULL sends 0xFF
+ * @param [in]		Buffer to store the received data. NULL discards it
+ * @param [in]		Length of the buffers in bytes
+ * @return			SPI_OK or SPI_TIMEOUT if no frame moved within the deadline (SPI_SetTimeout)
+ * @note 			Blocked communication implemented. While a frame is in the shift register the next
+ * 					one is already in DR, so there are no gaps between frames. At most 2 frames are in
+ * 					flight, so RXNE is always read before the next frame ends (no OVR)
+ */
+uint8_t SPI_TransferData(SPI_RegDef_t *pSPIx, uint8_t *pTxBuffer, uint8_t *pRxBuffer, uint32_t len){
+
+	uint8_t dff16 = (pSPIx->CR1 & (1 << SPI_CR1_DFF)) ? 1 : 0;
+	uint32_t txcnt, rxcnt;
+	uint32_t sr;
+	uint16_t data;
+	uint8_t progress;
+	DWT_Timeout_t timeout;
+
+	DWT_TimeoutStart(&timeout, SPI_Timeout);
+
+	// Number of frames
+	if (dff16){
+		len /= 2;
+	}
+	txcnt = len;
+	rxcnt = len;
+
+	while (rxcnt > 0){
+		sr = pSPIx->SR;
+		progress = 0;
+
+		// Read first: the frame in DR has to be taken before the next one is completed
+		if (sr & SPI_RXE_FLAG){
+			data = (uint16_t)pSPIx->DR;
+			if (pRxBuffer != NULL){
+				if (dff16){
+					*((uint16_t*)pRxBuffer) = data;
+					pRxBuffer += 2;
+				} else {
+					*pRxBuffer = (uint8_t)data;
+					pRxBuffer++;
+				}
+			}
+			rxcnt--;
+			progress = 1;
+		}
+
+		// Keep DR loaded while the shift register is busy
+		if ((sr & SPI_TXE_FLAG) && (txcnt > 0) && ((rxcnt - txcnt) < 2)){
+			if (pTxBuffer != NULL){
+				if (dff16){
+					data = *((uint16_t*)pTxBuffer);
+					pTxBuffer += 2;
+				} else {
+					data = *pTxBuffer;
+					pTxBuffer++;
+				}
 			} else {
-				// 8-Bit format
-				*pRxBuffer = pSPIx->DR ;
-				len--;
-				pRxBuffer++;
+				data = 0xFFFF;
 			}
+			pSPIx->DR = data;
+			txcnt--;
+			progress = 1;
+		}
+
+		// The deadline only runs while no frame moves
+		if (progress){
+			DWT_TimeoutRestart(&timeout);
+		} else if (DWT_TimeoutExpired(&timeout)){
+			return SPI_TIMEOUT;
 		}
+	}
+
+	return SPI_OK;
 }
 
 /******************************************************************
@@ -266,52 +399,233 @@ uint8_t SPI_ReceiveData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pRxBuffer, uint
 	return state;
 }
 
+/******************************************************************
+ * @func			SPI_TransferData_Inter (SPI transfer data using Interrupts)
+ * @brief			This functions starts a full-duplex transfer handled by TXEIE and RXNEIE
+ * @param [in]		SPI Handle
+ * @param [in]		Buffer with the data that is going to be sent. NULL sends 0xFF
+ * @param [in]		Length of the transfer in bytes. Even with 16-bit frames
+ * @return			State before the call. SPI_READY means the transfer has started, SPI_INVALID
+ * 					that len is 0 or odd with 16-bit frames, or that there is no Rx ring of at least
+ * 					2 frames (nothing is started)
+ * @note			None blocking API. The received bytes go to the ring set by SPI_SetRxRing and
+ * 					are fetched in batches with SPI_RxRingRead, so there is no callback per byte.
+ * 					At most 2 frames are in flight, and a frame is only sent when the ring has
+ * 					room for its answer. SPI_EVENT_TXRX_COMPLETE is sent after the last frame is received
+ */
+uint8_t SPI_TransferData_Inter(SPI_Handle_t *pSPIHandle, uint8_t *pTxBuffer, uint32_t len){
+
+	uint8_t frame;
+
+	if (pSPIHandle->TxState != SPI_READY){
+		return pSPIHandle->TxState;
+	}
+	if (pSPIHandle->RxState != SPI_READY){
+		return pSPIHandle->RxState;
+	}
+
+	// The ISR counts down by frames: any other length would never reach 0
+	frame = (pSPIHandle->pSPIx->CR1 & (1 << SPI_CR1_DFF)) ? 2 : 1;
+	if ((len == 0) || (len & (frame - 1))){
+		return SPI_INVALID;
+	}
+	// TXE only sends a frame when the ring has room for the frames in flight (up to 2)
+	if ((pSPIHandle->pRxRing == NULL) || (((uint32_t)pSPIHandle->pRxRing->Mask + 1) < (2U * frame))){
+		return SPI_INVALID;
+	}
+
+	pSPIHandle->FrameSize = frame;
+	pSPIHandle->pTxBuffer = pTxBuffer;
+	pSPIHandle->pRxBuffer = NULL; // No linear buffer: the ISR stores in the ring
+	pSPIHandle->TxLen = len;
+	pSPIHandle->RxLen = len;
+	pSPIHandle->RxRingStalled = 0;
+
+	// Mark the SPI busy in both directions
+	pSPIHandle->TxState = SPI_BUSY_IN_TX;
+	pSPIHandle->RxState = SPI_BUSY_IN_RX;
+
+	// A frame left in DR would be taken as the first received one
+	SPI_ClearOVRFlag(pSPIHandle->pSPIx);
+
+	pSPIHandle->pSPIx->CR2 |= (1 << SPI_CR2_RXNEIE) | (1 << SPI_CR2_TXNEIE);
+
+	return SPI_READY;
+}
+
+/******************************************************************
+ * @func			SPI_SetRxRing (SPI set Rx ring buffer)
+ * @brief			This functions gives the handle the ring buffer used by SPI_TransferData_Inter
+ * @param [in]		SPI Handle
+ * @param [in]		Ring buffer initialized with RingBuf_Init. At least 4 bytes with 16-bit frames
+ * @return			SPI_OK or SPI_INVALID if RingBuf_Init refused the ring (the handle is not changed)
+ * @note			The SPI ISR is the producer of the ring, the application the consumer
+ */
+uint8_t SPI_SetRxRing(SPI_Handle_t *pSPIHandle, RingBuf_t *pRing){
+
+	if ((pRing == NULL) || (pRing->pBuffer == NULL)){
+		return SPI_INVALID;
+	}
+
+	pSPIHandle->pRxRing = pRing;
+	pSPIHandle->RxRingStalled = 0;
+
+	return SPI_OK;
+}
+
+/******************************************************************
+ * @func			SPI_RxRingRead (SPI Rx ring buffer read)
+ * @brief			This functions copies the received bytes from the Rx ring to the application buffer
+ * @param [in]		SPI Handle
+ * @param [in]		Buffer to store the data
+ * @param [in]		Maximum number of bytes to copy
+ * @return			Number of bytes copied
+ * @note			None blocking API. Use it instead of RingBuf_Read while a transfer is running.
+ * 					If the transfer was stopped because the ring was full, it is resumed here
+ */
+uint32_t SPI_RxRingRead(SPI_Handle_t *pSPIHandle, uint8_t *pBuffer, uint32_t len){
+
+	len = RingBuf_Read(pSPIHandle->pRxRing, pBuffer, len);
+
+	// While the transfer is stalled the ISR does not touch CR2, so it is safe to modify it here
+	if ((len > 0) && pSPIHandle->RxRingStalled){
+		pSPIHandle->RxRingStalled = 0;
+		pSPIHandle->pSPIx->CR2 |= (1 << SPI_CR2_TXNEIE);
+	}
+
+	return len;
+}
+
+/******************************************************************
+ * @func			SPI_TransferDMA (SPI transfer data using DMA)
+ * @brief			This functions starts a full-duplex transfer served by the DMA1 channels
+ * @param [in]		SPI Handle
+ * @param [in]		Buffer with the data that is going to be sent. NULL sends 0xFF (Rx only)
+ * @param [in]		Buffer for the received data. NULL discards it (Tx only)
+ * @param [in]		Length of the buffers in bytes (up to 65535 frames, even with 16-bit frames)
+ * @return			State before the call, SPI_DMA_NOT_AVAILABLE or SPI_INVALID. SPI_READY means the
+ * 					transfer has started
+ * @note			None blocking API. The end of the transfer is notified with SPI_EVENT_DMA_HALF
+ * 					and SPI_EVENT_DMA_COMPLETE from SPI_DMA_IRQHandling, which must be called from
+ * 					the Rx channel IRQ handler (and from the Tx one to catch its errors).
+ * 					The Rx channel is always used: its last item means the last frame is out of
+ * 					the shift register, and OVR cannot happen in Tx only transfers
+ */
+uint8_t SPI_TransferDMA(SPI_Handle_t *pSPIHandle, uint8_t *pTxBuffer, uint8_t *pRxBuffer, uint32_t len){
+
+	static uint16_t dummy_tx = 0xFFFF; // Sent when there is no Tx buffer
+	static uint16_t dummy_rx; // Receives the data when there is no Rx buffer
+	SPI_RegDef_t *pSPIx = pSPIHandle->pSPIx;
+	DMA_Handle_t DMATx, DMARx;
+	uint8_t size = DMA_SIZE_8BITS;
+
+	if (pSPIHandle->TxState != SPI_READY){
+		return pSPIHandle->TxState;
+	}
+	if (pSPIHandle->RxState != SPI_READY){
+		return pSPIHandle->RxState;
+	}
+
+	// Channel mapping of DMA1
+	if (pSPIx == SPI1){
+		pSPIHandle->DMARxChannel = DMA_CH_SPI1_RX;
+		pSPIHandle->DMATxChannel = DMA_CH_SPI1_TX;
+	} else if (pSPIx == SPI2){
+		pSPIHandle->DMARxChannel = DMA_CH_SPI2_RX;
+		pSPIHandle->DMATxChannel = DMA_CH_SPI2_TX;
+	} else {
+		return SPI_DMA_NOT_AVAILABLE;
+	}
+
+	// Check DFF bit. Each item is a full frame
+	if (pSPIx->CR1 & (1 << SPI_CR1_DFF)){
+		if (len & 1){
+			return SPI_INVALID;
+		}
+		size = DMA_SIZE_16BITS;
+		len /= 2;
+	}
+	if ((len == 0) || (len > 0xFFFF)){
+		return SPI_INVALID; // CNDTR holds 16 bits and 0 would never complete
+	}
+
+	// Mark the SPI busy in both directions so that the interrupt APIs cannot take over the peripheral
+	pSPIHandle->TxState = SPI_BUSY_IN_TX;
+	pSPIHandle->RxState = SPI_BUSY_IN_RX;
+
+	// Rx channel. Higher priority than Tx so the received frame is always read before the next one arrives
+	DMARx.pDMAx = DMA1;
+	DMARx.Channel = pSPIHandle->DMARxChannel;
+	DMARx.DMA_Config.DMA_Direction = DMA_DIR_PERI_TO_MEM;
+	DMARx.DMA_Config.DMA_PeriSize = size;
+	DMARx.DMA_Config.DMA_MemSize = size;
+	DMARx.DMA_Config.DMA_MemInc = (pRxBuffer != NULL) ? ENABLE : DISABLE;
+	DMARx.DMA_Config.DMA_Priority = DMA_PRIORITY_VERY_HIGH;
+	DMARx.DMA_Config.DMA_Mode = DMA_MODE_NORMAL;
+	DMA_Init(&DMARx);
+	DMA_InterruptControl(&DMARx, DMA_TCIF_FLAG | DMA_HTIF_FLAG | DMA_TEIF_FLAG, ENABLE);
+
+	// Tx channel
+	DMATx.pDMAx = DMA1;
+	DMATx.Channel = pSPIHandle->DMATxChannel;
+	DMATx.DMA_Config.DMA_Direction = DMA_DIR_MEM_TO_PERI;
+	DMATx.DMA_Config.DMA_PeriSize = size;
+	DMATx.DMA_Config.DMA_MemSize = size;
+	DMATx.DMA_Config.DMA_MemInc = (pTxBuffer != NULL) ? ENABLE : DISABLE;
+	DMATx.DMA_Config.DMA_Priority = DMA_PRIORITY_HIGH;
+	DMATx.DMA_Config.DMA_Mode = DMA_MODE_NORMAL;
+	DMA_Init(&DMATx);
+	DMA_InterruptControl(&DMATx, DMA_TEIF_FLAG, ENABLE);
+
+	// A frame left in DR would be the first item of the Rx channel
+	SPI_ClearOVRFlag(pSPIx);
+
+	// Enable the Rx channel, then the Tx channel, then the requests (RM0008 25.3.9)
+	DMA_Start(&DMARx, &pSPIx->DR, (pRxBuffer != NULL) ? (void*)pRxBuffer : (void*)&dummy_rx, (uint16_t)len);
+	DMA_Start(&DMATx, &pSPIx->DR, (pTxBuffer != NULL) ? (void*)pTxBuffer : (void*)&dummy_tx, (uint16_t)len);
+
+	pSPIx->CR2 |= (1 << SPI_CR2_RXDMAEN);
+	pSPIx->CR2 |= (1 << SPI_CR2_TXDMAEN);
+
+	return SPI_READY;
+}
+
+/******************************************************************
+ * @func			SPI_TransferDone (SPI transfer done)
+ * @brief			This functions checks if the handle has finished its interrupt/DMA transfers
+ * @param [in]		SPI Handle
+ * @return			1 when both directions are SPI_READY, 0 while a transfer runs
+ * @note 			Wait condition of the coroutine API (SPI_PT_xxx)
+ */
+uint8_t SPI_TransferDone(SPI_Handle_t *pSPIHandle){
+
+	return (pSPIHandle->TxState == SPI_READY) && (pSPIHandle->RxState == SPI_READY);
+}
+
 /******************************************************************
  * @func			SPI_IRQConfig (SPI IRQ Configuration)
- * @brief			This functions configures the priority in the IRQ list
+ * @brief			This functions enables or disables an IRQ in the NVIC
  * @param [in]		IQR Number
- * @param [in]		IRQ Priority
  * @param [in]		Enable or disable
  * @return			None
- * @note 			None
+ * @note 			Done by the NVIC driver: one store to ISER/ICER, the other IRQs are not touched
  */
 void SPI_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
 
-	if (EnOrDi == ENABLE){
-			if (IRQNumber <= 31){ // IRQ Number 0-31
-				*NVIC_ISER0 |= (1<< IRQNumber); // Set ISER0
-			} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-				*NVIC_ISER1 |= (1<< (IRQNumber%32)); // Set ISER1
-			} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-				*NVIC_ISER2 |= (1<< (IRQNumber%64)); // Set ISER2
-			}
-		} else {
-			if (IRQNumber <= 31){ // IRQ Number 0-31
-				*NVIC_ICER0 |= (1<< IRQNumber); // Set ICER0
-			} else if (IRQNumber > 31 && IRQNumber < 64){ // IRQ Number 32-63
-				*NVIC_ICER1 |= (1<< (IRQNumber%32)); // Set ICER1
-			} else if (IRQNumber >= 64 && IRQNumber < 96){ // IRQ Number 64-95
-				*NVIC_ICER2 |= (1<< (IRQNumber%64)); // Set ICER2
-			}
-		}
+	NVIC_IRQConfig(IRQNumber, EnOrDi);
 }
 
 /******************************************************************
  * @func			SPI_IRQPriority (SPI IRQ Priority)
- * @brief			This functions process the IRQ Priority
+ * @brief			This functions sets the priority of an IRQ
  * @param [in]		IRQ Number
- * @param [in]		IRQ Priority
+ * @param [in]		IRQ Priority (0-15). See NVIC_EncodePriority for preempt/sub-priority
  * @return			None
- * @note 			None
+ * @note 			The old priority is replaced with one byte store
  */
-
 void SPI_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority){
 
-	uint8_t iprx =  IRQNumber/4; // Define which IPR Register you have to use (0-59)
-	uint8_t iprx_section =  IRQNumber%4; // Define the section on the IPR (0-4) * 8 bc each section is 8 bits
-	uint8_t aux =  ((8* iprx_section) + (8 - NO_PR_BITS_IMPLEMENTED)); // This is the arrangement done bc the 4 first bits of each section are not implemented.
-
-	*(NVIC_PRIO_BASEADDR + (iprx)) |= (IRQPriority <<aux);
+	NVIC_SetPriority(IRQNumber, (uint8_t)IRQPriority);
 }
 
 /******************************************************************
@@ -326,6 +640,16 @@ void SPI_IRQHandling(SPI_Handle_t *pSPIxHandle){
 	// First, find out why the interrupt happened
 	uint8_t temp1, temp2;
 
+	// Check RXNE first: the received frame has to be taken before the next one is sent
+	temp1 = pSPIxHandle->pSPIx->SR & (1 << SPI_SR_RXNE);
+	temp2 = pSPIxHandle->pSPIx->CR2 & (1 << SPI_CR2_RXNEIE);
+
+	// If both temp1 and temp2 = 1, then the interrupt was triggered bc of RXNE flag
+	if (temp1 && temp2){
+		// Handle RXNE
+		SPI_RXNE_Interrupt_Handle(pSPIxHandle);
+	}
+
 	// Check TXE
 	temp1 = pSPIxHandle->pSPIx->SR & (1 << SPI_SR_TXE); // Access the TXE in SR to check the value
 	// if TXE is set, temp1 = 1. If TXE is reset, temp1 = 0
@@ -337,17 +661,6 @@ void SPI_IRQHandling(SPI_Handle_t *pSPIxHandle){
 		SPI_TXE_Interrupt_Handle(pSPIxHandle);
 	}
 
-	// Check RXNE
-	temp1 = pSPIxHandle->pSPIx->SR & (1 << SPI_SR_RXNE);
-	temp2 = pSPIxHandle->pSPIx->CR2 & (1 << SPI_CR2_RXNEIE);
-
-
-	// If both temp1 and temp2 = 1, then the interrupt was triggered bc of RXNE flag
-	if (temp1 && temp2){
-		// Handle RXNE
-		SPI_RXNE_Interrupt_Handle(pSPIxHandle);
-	}
-
 	// Check OVR
 	temp1 = pSPIxHandle->pSPIx->SR & (1 << SPI_SR_OVR);
 	temp2 = pSPIxHandle->pSPIx->CR2 & (1 << SPI_CR2_ERRIE);
@@ -360,6 +673,43 @@ void SPI_IRQHandling(SPI_Handle_t *pSPIxHandle){
 	}
 }
 
+/******************************************************************
+ * @func			SPI_DMA_IRQHandling (SPI DMA IRQ Handling)
+ * @brief			This functions processes the interrupts of the DMA channels used by SPI_TransferDMA
+ * @param [in]		SPI handle
+ * @return			None
+ * @note 			Call it from the IRQ handlers of both channels (e.g. DMA1_Channel2_IRQHandler and
+ * 					DMA1_Channel3_IRQHandler for SPI1)
+ */
+void SPI_DMA_IRQHandling(SPI_Handle_t *pSPIxHandle){
+
+	uint8_t rx = pSPIxHandle->DMARxChannel;
+	uint8_t tx = pSPIxHandle->DMATxChannel;
+
+	if ((pSPIxHandle->TxState != SPI_BUSY_IN_TX) || (pSPIxHandle->RxState != SPI_BUSY_IN_RX)){
+		return; // No DMA transfer in progress
+	}
+
+	// Check transfer error. The hardware has already disabled the channel
+	if (DMA_GetFlagStatus(DMA1, rx, DMA_TEIF_FLAG) || DMA_GetFlagStatus(DMA1, tx, DMA_TEIF_FLAG)){
+		SPI_CloseDMA(pSPIxHandle);
+		SPI_ApplicationEventCallback(pSPIxHandle, SPI_EVENT_DMA_ERROR);
+		return;
+	}
+
+	// Check half transfer
+	if (DMA_GetFlagStatus(DMA1, rx, DMA_HTIF_FLAG)){
+		DMA_ClearFlag(DMA1, rx, DMA_HTIF_FLAG);
+		SPI_ApplicationEventCallback(pSPIxHandle, SPI_EVENT_DMA_HALF);
+	}
+
+	// Check transfer complete. The last frame has been received, so the bus is idle
+	if (DMA_GetFlagStatus(DMA1, rx, DMA_TCIF_FLAG)){
+		SPI_CloseDMA(pSPIxHandle);
+		SPI_ApplicationEventCallback(pSPIxHandle, SPI_EVENT_DMA_COMPLETE);
+	}
+}
+
 /******************************************************************
  * @func			SPI_PeripheralControl (SPI Peripheral Control)
  * @brief			This functions enables/disables SPI *after* the parameters initialization
@@ -409,14 +759,99 @@ void SPI_SSOEConfig(SPI_RegDef_t *pSPIx, uint8_t EnOrDi){
 	}
 }
 
+/******************************************************************
+ * @func			SPI_SetTimeout (SPI set timeout)
+ * @brief			This functions sets the deadline of the blocking calls
+ * @param [in]		Time in microseconds that a blocking call waits for a flag. DWT_WAIT_FOREVER = no limit
+ * @return			None
+ * @note 			The deadline starts again after every frame, so it does not depend on the length.
+ * 					It applies to all the SPI peripherals. Default: SPI_TIMEOUT_DEFAULT_US
+ */
+void SPI_SetTimeout(uint32_t Timeout_us){
+	SPI_Timeout = Timeout_us;
+}
+
 /* 			  Private helpers functions	implementation   				*/
+/******************************************************************
+ * @func			SPI_GetPCLKValue
+ * @brief			This functions returns the bus clock of a SPI
+ * @param [in]		Base Address of the SPI
+ * @return			PCLK2 for SPI1 (APB2), PCLK1 for SPI2 and SPI3 (APB1)
+ * @note 			Cached values of the RCC driver
+ */
+static uint32_t SPI_GetPCLKValue(SPI_RegDef_t *pSPIx){
+
+	return (pSPIx == SPI1) ? RCC_GetPCLK2Value() : RCC_GetPCLK1Value();
+}
+
+/******************************************************************
+ * @func			SPI_WaitFlag
+ * @brief			This functions waits until a SR flag is set
+ * @param [in]		Base Address of the SPI
+ * @param [in]		Bit position of the flag (SPI_SR_xxx)
+ * @param [in]		Deadline. It is restarted if the flag is not set yet
+ * @return			SPI_OK or SPI_TIMEOUT
+ * @note 			Each iteration is a bit-band load of the flag and a compare of CYCCNT
+ */
+static uint8_t SPI_WaitFlag(SPI_RegDef_t *pSPIx, uint8_t Bit, DWT_Timeout_t *pTimeout){
+
+	if (SPI_SR_BB(pSPIx, Bit)){
+		return SPI_OK; // Fast path: no need to read CYCCNT
+	}
+
+	DWT_TimeoutRestart(pTimeout);
+	while (!SPI_SR_BB(pSPIx, Bit)){
+		if (DWT_TimeoutExpired(pTimeout)){
+			return SPI_TIMEOUT;
+		}
+	}
+
+	return SPI_OK;
+}
+
 static void SPI_TXE_Interrupt_Handle(SPI_Handle_t *pSPIxHandle){
 
+	if (pSPIxHandle->pRxBuffer == NULL && pSPIxHandle->RxState == SPI_BUSY_IN_RX){
+		// Full-duplex transfer (SPI_TransferData_Inter)
+		uint32_t inflight = pSPIxHandle->RxLen - pSPIxHandle->TxLen; // Bytes sent but not received yet
+		uint32_t space = RingBuf_Space(pSPIxHandle->pRxRing);
+		uint16_t data = 0xFFFF;
+
+		if (inflight >= (2 * pSPIxHandle->FrameSize)){
+			// DR and the shift register are busy. RXNE enables TXEIE again
+			pSPIxHandle->pSPIx->CR2 &= ~(1 << SPI_CR2_TXNEIE);
+			return;
+		}
+		if (space < (inflight + pSPIxHandle->FrameSize)){
+			// No room for the answer of another frame. SPI_RxRingRead resumes the transfer
+			pSPIxHandle->pSPIx->CR2 &= ~(1 << SPI_CR2_TXNEIE);
+			pSPIxHandle->RxRingStalled = 1;
+			return;
+		}
+
+		if (pSPIxHandle->pTxBuffer != NULL){
+			if (pSPIxHandle->FrameSize == 2){
+				data = *((uint16_t*)pSPIxHandle->pTxBuffer);
+			} else {
+				data = *pSPIxHandle->pTxBuffer;
+			}
+			pSPIxHandle->pTxBuffer += pSPIxHandle->FrameSize;
+		}
+		pSPIxHandle->pSPIx->DR = data;
+		pSPIxHandle->TxLen -= pSPIxHandle->FrameSize;
+
+		if (! pSPIxHandle->TxLen){
+			// All sent. The transfer is closed when the last frame is received
+			pSPIxHandle->pSPIx->CR2 &= ~(1 << SPI_CR2_TXNEIE);
+		}
+		return;
+	}
+
 	if(pSPIxHandle->pSPIx->CR1 & (1 << SPI_CR1_DFF)){
 		pSPIxHandle->pSPIx->DR = *((uint16_t*)pSPIxHandle->pTxBuffer); // Dereference the pointer to get the data
 		pSPIxHandle->TxLen--;
 		pSPIxHandle->TxLen--; // 2 bytes to decrease
-		(uint16_t*)pSPIxHandle->pTxBuffer++;
+		pSPIxHandle->pTxBuffer += 2;
 
 	} else {
 		pSPIxHandle->pSPIx->DR = *pSPIxHandle->pTxBuffer;
@@ -432,19 +867,40 @@ static void SPI_TXE_Interrupt_Handle(SPI_Handle_t *pSPIxHandle){
 
 static void SPI_RXNE_Interrupt_Handle(SPI_Handle_t *pSPIxHandle){
 
+	if (pSPIxHandle->pRxBuffer == NULL){
+		// Full-duplex transfer: one DR read and one store in the ring. TXE made room for it
+		if (pSPIxHandle->FrameSize == 2){
+			uint16_t data = (uint16_t)pSPIxHandle->pSPIx->DR;
+			RingBuf_Put(pSPIxHandle->pRxRing, (uint8_t)data);
+			RingBuf_Put(pSPIxHandle->pRxRing, (uint8_t)(data >> 8));
+		} else {
+			RingBuf_Put(pSPIxHandle->pRxRing, (uint8_t)pSPIxHandle->pSPIx->DR);
+		}
+		pSPIxHandle->RxLen -= pSPIxHandle->FrameSize;
+
+		if (! pSPIxHandle->RxLen){
+			SPI_CloseTransfer(pSPIxHandle);
+			SPI_ApplicationEventCallback(pSPIxHandle, SPI_EVENT_TXRX_COMPLETE);
+		} else if (pSPIxHandle->TxLen && !pSPIxHandle->RxRingStalled){
+			// One frame less in flight, the next one can be sent
+			pSPIxHandle->pSPIx->CR2 |= (1 << SPI_CR2_TXNEIE);
+		}
+		return;
+	}
+
 	if(pSPIxHandle->pSPIx->CR1 & (1 << SPI_CR1_DFF)){
-		pSPIxHandle->pSPIx->DR = *((uint16_t*)pSPIxHandle->pRxBuffer); // Dereference the pointer to get the data
+		*((uint16_t*)pSPIxHandle->pRxBuffer) = (uint16_t)pSPIxHandle->pSPIx->DR; // Read DR into the buffer
 		pSPIxHandle->RxLen--;
 		pSPIxHandle->RxLen--; // 2 bytes to decrease
-		(uint16_t*)pSPIxHandle->pRxBuffer++;
+		pSPIxHandle->pRxBuffer += 2;
 
 	} else {
-		pSPIxHandle->pSPIx->DR = *pSPIxHandle->pRxBuffer;
+		*pSPIxHandle->pRxBuffer = (uint8_t)pSPIxHandle->pSPIx->DR; // Read DR into the buffer
 		pSPIxHandle->RxLen--;
 		pSPIxHandle->pRxBuffer++;
 	}
 
-	if (! pSPIxHandle->RxLen ) { // When Length is zero, close SPI transmission
+	if (! pSPIxHandle->RxLen ) { // When Length is zero, close SPI reception
 		SPI_CloseReception(pSPIxHandle);
 		SPI_ApplicationEventCallback(pSPIxHandle,SPI_EVENT_RX_COMPLETE);
 	}
@@ -489,6 +945,25 @@ void SPI_CloseReception(SPI_Handle_t *pSPIxHandle){
 	pSPIxHandle ->RxState = SPI_READY;
 }
 
+void SPI_CloseTransfer(SPI_Handle_t *pSPIxHandle){
+
+	// Full-duplex transfer. Frames still in flight are left in DR (see SPI_ClearOVRFlag)
+	SPI_CloseTransmission(pSPIxHandle);
+	SPI_CloseReception(pSPIxHandle);
+	pSPIxHandle->RxRingStalled = 0;
+}
+
+void SPI_CloseDMA(SPI_Handle_t *pSPIxHandle){
+
+	pSPIxHandle->pSPIx->CR2 &= ~((1 << SPI_CR2_TXDMAEN) | (1 << SPI_CR2_RXDMAEN)); // No more DMA requests
+	DMA1->CH[pSPIxHandle->DMATxChannel - 1].CCR &= ~(1 << DMA_CCR_EN);
+	DMA1->CH[pSPIxHandle->DMARxChannel - 1].CCR &= ~(1 << DMA_CCR_EN);
+	DMA_ClearFlag(DMA1, pSPIxHandle->DMATxChannel, DMA_GIF_FLAG);
+	DMA_ClearFlag(DMA1, pSPIxHandle->DMARxChannel, DMA_GIF_FLAG);
+	pSPIxHandle->TxState = SPI_READY;
+	pSPIxHandle->RxState = SPI_READY;
+}
+
 /* In each application this function will be override according to perform some action  */
 __attribute__((weak)) void SPI_ApplicationEventCallback (SPI_Handle_t *pSPIxHandle, uint8_t AppEv){
 	// This is a weak implementation. The application can override this function
@@ -0,0 +1,114 @@
+/*
+ * stm32f1xx_spibus.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_spibus.h"
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			SPIBus_Init (SPI bus initialization)
+ * @brief			This functions configures the SPI of the handle as the master of a shared bus
+ * @param [in]		Bus
+ * @param [in]		SPI Handle. pSPIx must be set. The mode fields are the initial mode of the bus
+ * @return			None
+ * @note 			Full-duplex master with software slave management (SSI = 1, the chip selects are
+ * 					GPIOs). The peripheral is enabled and stays enabled: SPIBus_Select only clears
+ * 					SPE while it changes the mode bits
+ */
+void SPIBus_Init(SPIBus_t *pBus, SPI_Handle_t *pSPIHandle){
+
+	pSPIHandle->SPI_Config.SPI_DeviceMode = SPI_DEVICE_MODE_MASTER;
+	pSPIHandle->SPI_Config.SPI_BusConfig = SPI_BUS_CONFIG_FD;
+	pSPIHandle->SPI_Config.SPI_SSM = SPI_SSM_EN;
+	SPI_Init(pSPIHandle);
+
+	// SSI = 1: the master never sees its NSS low (mode fault)
+	pBus->CR1 = (uint16_t)(pSPIHandle->pSPIx->CR1 | (1U << SPI_CR1_SSI) | (1U << SPI_CR1_SPE));
+	pSPIHandle->pSPIx->CR1 = pBus->CR1;
+
+	pBus->pSPIHandle = pSPIHandle;
+	pBus->pSelected = NULL;
+	pBus->Reconfigs = 0;
+}
+
+/******************************************************************
+ * @func			SPIBus_AddDevice (SPI bus add device)
+ * @brief			This functions calculates the mode bits of a device and configures its chip select
+ * @param [in]		Bus
+ * @param [out]		Device
+ * @param [in]		Device configuration
+ * @return			SCK of the device in Hz
+ * @note 			The prescaler depends on the bus clock: add the devices again after changing
+ * 					the clock tree (RCC_ClockConfig). The chip select is set high before the pin
+ * 					becomes an output, so the device never sees a false select
+ */
+uint32_t SPIBus_AddDevice(SPIBus_t *pBus, SPIBus_Device_t *pDevice, const SPIBus_DeviceConfig_t *pConfig){
+
+	GPIO_Handle_t CSPin;
+	uint32_t sclk;
+	uint8_t br = SPI_CalcBaudRate(pBus->pSPIHandle->pSPIx, pConfig->MaxSCLK_Hz, &sclk);
+
+	pDevice->CR1 = (uint16_t)(((uint32_t)pConfig->SPI_CPHA << SPI_CR1_CPHA) | ((uint32_t)pConfig->SPI_CPOL << SPI_CR1_CPOL) |
+							  ((uint32_t)br << SPI_CR1_BR) | ((uint32_t)pConfig->SPI_DFF << SPI_CR1_DFF));
+	pDevice->pCSPort = pConfig->pCSPort;
+	pDevice->CSPinMask = 0;
+
+	if (pConfig->pCSPort != NULL){
+		pDevice->CSPinMask = GPIO_PIN_MASK(pConfig->CSPin);
+
+		GPIO_PeriClkCtrl(pConfig->pCSPort, ENABLE); // ODR is not written without the clock
+		GPIO_SetPins(pConfig->pCSPort, pDevice->CSPinMask);
+
+		CSPin.pGPIOx = pConfig->pCSPort;
+		CSPin.GPIO_PinConfig.GPIO_PinNumber = pConfig->CSPin;
+		CSPin.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_OUT_SPEED_50;
+		CSPin.GPIO_PinConfig.GPIO_Config = GPIO_OP_TYPE_PP;
+		GPIO_Init(&CSPin);
+	}
+
+	return sclk;
+}
+
+/******************************************************************
+ * @func			SPIBus_Deselect (SPI bus deselect)
+ * @brief			This functions waits for the last frame and pulls the chip select high
+ * @param [in]		Bus
+ * @return			SPI_OK or SPI_TIMEOUT if the last frame did not finish within SPI_TIMEOUT_DEFAULT_US
+ * @note 			TXE is set while the last frame is still being shifted out, so BSY is checked
+ * 					after it (RM0008 25.3.8). Both are bit-band loads. In master mode they clear
+ * 					within one frame, unless the peripheral is stuck (clock off, SPE = 0). The chip
+ * 					select is released on a timeout too: the next select must not drive two devices
+ */
+uint8_t SPIBus_Deselect(SPIBus_t *pBus){
+
+	SPI_RegDef_t *pSPIx = pBus->pSPIHandle->pSPIx;
+	const SPIBus_Device_t *pDevice = pBus->pSelected;
+	DWT_Timeout_t timeout;
+	uint8_t status = SPI_OK;
+
+	if (pDevice == NULL){
+		return SPI_OK;
+	}
+
+	// Fast path: the frame is usually done, no need to read CYCCNT
+	if (!SPI_SR_BB(pSPIx, SPI_SR_TXE) || SPI_SR_BB(pSPIx, SPI_SR_BSY)){
+		DWT_TimeoutStart(&timeout, SPI_TIMEOUT_DEFAULT_US);
+		while (!SPI_SR_BB(pSPIx, SPI_SR_TXE) || SPI_SR_BB(pSPIx, SPI_SR_BSY)){
+			if (DWT_TimeoutExpired(&timeout)){
+				status = SPI_TIMEOUT;
+				break;
+			}
+		}
+	}
+
+	if (pDevice->pCSPort != NULL){
+		GPIO_SetPins(pDevice->pCSPort, pDevice->CSPinMask);
+	}
+	pBus->pSelected = NULL;
+
+	return status;
+}
@@ -0,0 +1,433 @@
+/*
+ * stm32f1xx_systick.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_systick.h"
+
+static volatile uint64_t Ticks;			// Ticks counted by the handler
+static volatile uint32_t Seq;			// Incremented on each update of the time base, so a reader can retry
+static volatile uint32_t StepTicks = 1;	// Ticks added at the end of the running counter period
+static volatile uint32_t PeriodStart;	// Cycles of the tick already gone when the running period started
+static volatile uint32_t PeriodCycles;	// Cycles of the running period (RVR + 1 when it was loaded)
+static uint32_t TickCycles;				// HCLK cycles per tick
+static uint32_t HCLKValue;
+static uint8_t Running;
+static SysTick_Timer_t *pTimers;		// Sorted by expiry
+
+// Private helpers functions
+static void SysTick_WaitUntil(uint64_t End_us);
+static void SysTick_Insert(SysTick_Timer_t *pTimer);
+static void SysTick_Remove(SysTick_Timer_t *pTimer);
+static void SysTick_Restart(uint32_t Load);
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			SysTick_Init (SysTick initialization)
+ * @brief			This functions starts the tick from the HCLK value of the RCC driver
+ * @param [in]		None
+ * @return			SYSTICK_OK or SYSTICK_INVALID
+ * @note 			The tick count is kept, so it can be called again after changing HCLK. The
+ * 					interrupt mask (PRIMASK) is restored on exit
+ */
+uint8_t SysTick_Init(void){
+
+	uint32_t hclk = RCC_GetHCLKValue();
+	uint32_t cycles = hclk / SYSTICK_TICK_HZ;
+	uint32_t primask;
+
+	if ((cycles < 2) || (cycles - 1 > SYSTICK_RVR_MAX)){
+		return SYSTICK_INVALID;
+	}
+
+	IRQ_SAVE_DISABLE(primask);
+	SYSTICK->CSR = 0;
+	*SCB_ICSR = (1U << SCB_ICSR_PENDSTCLR);
+
+	Seq++;
+	HCLKValue = hclk;
+	TickCycles = cycles;
+	StepTicks = 1;
+	PeriodStart = 0;
+	PeriodCycles = cycles;
+
+	SYSTICK->RVR = cycles - 1;
+	SYSTICK->CVR = 0;
+	SYSTICK->CSR = (1U << SYSTICK_CSR_CLKSOURCE) | (1U << SYSTICK_CSR_TICKINT) | (1U << SYSTICK_CSR_ENABLE);
+	Running = 1;
+	IRQ_RESTORE(primask);
+
+	return SYSTICK_OK;
+}
+
+/******************************************************************
+ * @func			SysTick_IRQPriority (SysTick priority)
+ * @brief			This functions sets the priority of the SysTick exception
+ * @param [in]		Priority 0-15 (NVIC_PRIO_x)
+ * @return			None
+ * @note 			SysTick is a system exception: its priority is in SHPR3, not in the NVIC
+ */
+void SysTick_IRQPriority(uint32_t IRQPriority){
+
+	*SCB_SHPR3 = (*SCB_SHPR3 & ~(0xFFU << SCB_SHPR3_SYSTICK)) | (((IRQPriority & NVIC_PRIO_LOWEST) << NVIC_PRIO_SHIFT) << SCB_SHPR3_SYSTICK);
+}
+
+/******************************************************************
+ * @func			SysTick_GetTicks (SysTick get ticks)
+ * @brief			This functions returns the ticks counted since the first SysTick_Init
+ * @param [in]		None
+ * @return			Ticks
+ * @note 			During a tickless idle the count is updated when the core wakes up
+ */
+uint64_t SysTick_GetTicks(void){
+
+	uint32_t seq;
+	uint64_t ticks;
+
+	do{
+		seq = Seq;
+		ticks = Ticks;
+	} while (seq != Seq);
+
+	return ticks;
+}
+
+/******************************************************************
+ * @func			SysTick_GetTimeUs (SysTick get time)
+ * @brief			This functions returns the microseconds since the first SysTick_Init
+ * @param [in]		None
+ * @return			Time in us
+ * @note 			Adds the part of the current period read from the counter. A tick ended but not
+ * 					handled yet (SysTick pending, for example in a higher priority ISR) is counted
+ */
+uint64_t SysTick_GetTimeUs(void){
+
+	uint32_t seq, start, cycles, cvr;
+	uint64_t ticks;
+
+	if (!Running){
+		return 0;
+	}
+
+	do{
+		seq = Seq;
+		ticks = Ticks;
+		start = PeriodStart;
+		cycles = PeriodCycles;
+		cvr = SYSTICK->CVR;
+		if (*SCB_ICSR & (1U << SCB_ICSR_PENDSTSET)){
+			// The period ended: the counter was reloaded with one tick
+			ticks += StepTicks;
+			start = 0;
+			cycles = TickCycles;
+			cvr = SYSTICK->CVR;
+		}
+	} while (seq != Seq);
+
+	if (cvr >= cycles){
+		cvr = cycles - 1;
+	}
+	start += cycles - 1 - cvr;
+
+	return (ticks * SYSTICK_US_PER_TICK) + (((uint64_t)start * 1000000U) / HCLKValue);
+}
+
+/******************************************************************
+ * @func			SysTick_DelayUs (SysTick delay us)
+ * @brief			This functions waits at least the given microseconds
+ * @param [in]		Delay in us
+ * @return			None
+ * @note 			Sleeps in WFI while more than one tick is left. From thread mode: an ISR at or
+ * 					above the SysTick priority must use DWT_DelayUs
+ */
+void SysTick_DelayUs(uint32_t Delay_us){
+
+	if (!Running){
+		DWT_DelayUs(Delay_us);
+		return;
+	}
+	SysTick_WaitUntil(SysTick_GetTimeUs() + Delay_us);
+}
+
+/******************************************************************
+ * @func			SysTick_DelayMs (SysTick delay ms)
+ * @brief			This functions waits at least the given milliseconds
+ * @param [in]		Delay in ms
+ * @return			None
+ * @note 			Same as SysTick_DelayUs
+ */
+void SysTick_DelayMs(uint32_t Delay_ms){
+
+	if (!Running){
+		while (Delay_ms--){
+			DWT_DelayUs(1000);
+		}
+		return;
+	}
+	SysTick_WaitUntil(SysTick_GetTimeUs() + ((uint64_t)Delay_ms * 1000U));
+}
+
+/******************************************************************
+ * @func			SysTick_TimerStart (SysTick timer start)
+ * @brief			This functions starts (or restarts) a software timer
+ * @param [in]		Timer
+ * @param [in]		Delay of the first call in ms (at least, rounded up to ticks)
+ * @param [in]		Period in ms, 0 = one shot
+ * @param [in]		Function called from the SysTick handler
+ * @param [in]		Context passed to the function
+ * @return			None
+ * @note 			Can be called from the callback itself or with the interrupts masked. Masks the
+ * 					interrupts for the list update, then restores the previous mask
+ */
+void SysTick_TimerStart(SysTick_Timer_t *pTimer, uint32_t Delay_ms, uint32_t Period_ms, SysTick_Callback_t pCallback, void *pContext){
+
+	uint64_t delay = (((uint64_t)Delay_ms * SYSTICK_TICK_HZ) + 999U) / 1000U;
+	uint64_t period = (((uint64_t)Period_ms * SYSTICK_TICK_HZ) + 999U) / 1000U;
+	uint32_t primask;
+
+	if ((pTimer == NULL) || (pCallback == NULL)){
+		return;
+	}
+	if ((Period_ms != 0) && (period == 0)){
+		period = 1;
+	}
+
+	IRQ_SAVE_DISABLE(primask);
+	if (pTimer->Active){
+		SysTick_Remove(pTimer);
+	}
+	pTimer->pCallback = pCallback;
+	pTimer->pContext = pContext;
+	pTimer->Period = (period > 0xFFFFFFFFU) ? 0xFFFFFFFFU : (uint32_t)period;
+	// The current tick is already started: one more tick makes the delay a minimum
+	pTimer->Expiry = Ticks + delay + 1;
+	SysTick_Insert(pTimer);
+	IRQ_RESTORE(primask);
+}
+
+/******************************************************************
+ * @func			SysTick_TimerStop (SysTick timer stop)
+ * @brief			This functions stops a software timer
+ * @param [in]		Timer
+ * @return			None
+ * @note 			Nothing happens if the timer is not running
+ */
+void SysTick_TimerStop(SysTick_Timer_t *pTimer){
+
+	uint32_t primask;
+
+	IRQ_SAVE_DISABLE(primask);
+	if (pTimer->Active){
+		SysTick_Remove(pTimer);
+	}
+	IRQ_RESTORE(primask);
+}
+
+/******************************************************************
+ * @func			SysTick_Idle (SysTick tickless idle)
+ * @brief			This functions sleeps until the next timer or interrupt without waking up on
+ * 					each tick
+ * @param [in]		None
+ * @return			None
+ * @note 			Call it from the idle loop, never with the interrupts masked: it leaves them
+ * 					enabled. The counter is loaded with the rest of the current tick and the whole
+ * 					ticks up to the next timer (2^24 cycles at most). If another interrupt wakes the
+ * 					core earlier, the ticks that passed are added and the counter restarts at the
+ * 					same place of the tick
+ */
+void SysTick_Idle(void){
+
+	uint64_t next = SYSTICK_RVR_MAX;
+	uint32_t ticks, cvr, gone, load;
+
+	IRQ_DISABLE();
+
+	if (!Running){
+		WFI();
+		IRQ_ENABLE();
+		return;
+	}
+
+	if (pTimers != NULL){
+		next = (pTimers->Expiry > Ticks) ? (pTimers->Expiry - Ticks) : 0;
+	}
+	ticks = (uint32_t)next;
+	if (ticks > ((SYSTICK_RVR_MAX + 1U) / TickCycles)){
+		ticks = (SYSTICK_RVR_MAX + 1U) / TickCycles;
+	}
+
+	if ((ticks <= 1) || (*SCB_ICSR & (1U << SCB_ICSR_PENDSTSET))){
+		WFI();
+		IRQ_ENABLE();
+		return;
+	}
+
+	SYSTICK->CSR &= ~(1U << SYSTICK_CSR_ENABLE);
+	cvr = SYSTICK->CVR;
+	if ((*SCB_ICSR & (1U << SCB_ICSR_PENDSTSET)) || (cvr >= PeriodCycles)){
+		// The tick ended while the counter was stopped
+		SYSTICK->CSR |= (1U << SYSTICK_CSR_ENABLE);
+		IRQ_ENABLE();
+		return;
+	}
+
+	// Rest of the current tick, then ticks - 1 whole ticks
+	gone = PeriodStart + (PeriodCycles - 1 - cvr);
+	load = (TickCycles - gone - 1) + ((ticks - 1) * TickCycles);
+	Seq++;
+	StepTicks = ticks;
+	PeriodStart = gone;
+	PeriodCycles = load + 1;
+	SysTick_Restart(load);
+
+	WFI();
+
+	if (!(*SCB_ICSR & (1U << SCB_ICSR_PENDSTSET))){
+		// Woken up by another interrupt: count the ticks that passed
+		SYSTICK->CSR &= ~(1U << SYSTICK_CSR_ENABLE);
+		cvr = SYSTICK->CVR;
+		if (!(*SCB_ICSR & (1U << SCB_ICSR_PENDSTSET)) && (cvr < PeriodCycles)){
+			gone = PeriodStart + (PeriodCycles - 1 - cvr);
+			Seq++;
+			Ticks += gone / TickCycles;
+			gone %= TickCycles;
+			StepTicks = 1;
+			PeriodStart = gone;
+			PeriodCycles = TickCycles - gone;
+			SysTick_Restart(PeriodCycles - 1);
+		} else {
+			SYSTICK->CSR |= (1U << SYSTICK_CSR_ENABLE);
+		}
+	}
+
+	IRQ_ENABLE(); // The pending SysTick adds StepTicks and runs the timers
+}
+
+/******************************************************************
+ * @func			SysTick_IRQHandling (SysTick interrupt handling)
+ * @brief			This functions counts the ticks of the ended period and calls the expired timers
+ * @param [in]		None
+ * @return			None
+ * @note 			A periodic timer is linked again before its function is called, so the function
+ * 					can stop it
+ */
+void SysTick_IRQHandling(void){
+
+	SysTick_Timer_t *pTimer;
+
+	IRQ_DISABLE();
+	Seq++;
+	Ticks += StepTicks;
+	StepTicks = 1;
+	PeriodStart = 0;
+	PeriodCycles = TickCycles;
+	IRQ_ENABLE();
+
+	while (1){
+		IRQ_DISABLE();
+		pTimer = pTimers;
+		if ((pTimer == NULL) || (pTimer->Expiry > Ticks)){
+			IRQ_ENABLE();
+			break;
+		}
+		SysTick_Remove(pTimer);
+		if (pTimer->Period != 0){
+			pTimer->Expiry += pTimer->Period;
+			SysTick_Insert(pTimer);
+		}
+		IRQ_ENABLE();
+
+		pTimer->pCallback(pTimer->pContext);
+	}
+}
+
+/******************************************************************
+ * @func			SysTick_Handler
+ * @brief			This functions is the SysTick exception handler (name used in the startup file)
+ * @param [in]		None
+ * @return			None
+ * @note 			Replaces the weak default handler of the startup file
+ */
+void SysTick_Handler(void){
+
+	SysTick_IRQHandling();
+}
+
+/* 			Private helpers functions implementation 				*/
+
+/******************************************************************
+ * @func			SysTick_WaitUntil
+ * @brief			This functions sleeps in WFI, then waits the last tick with the counter
+ * @param [in]		End time in us
+ * @return			None
+ * @note 			Any interrupt wakes the core up: the time is checked again
+ */
+static void SysTick_WaitUntil(uint64_t End_us){
+
+	uint64_t now;
+
+	while ((now = SysTick_GetTimeUs()) < End_us){
+		if ((End_us - now) > SYSTICK_US_PER_TICK){
+			WFI(); // The next tick at the latest
+		}
+	}
+}
+
+/******************************************************************
+ * @func			SysTick_Insert
+ * @brief			This functions links a timer in expiry order
+ * @param [in]		Timer
+ * @return			None
+ * @note 			Interrupts masked. After the timers with the same expiry
+ */
+static void SysTick_Insert(SysTick_Timer_t *pTimer){
+
+	SysTick_Timer_t **ppNext = &pTimers;
+
+	while ((*ppNext != NULL) && ((*ppNext)->Expiry <= pTimer->Expiry)){
+		ppNext = &(*ppNext)->pNext;
+	}
+	pTimer->pNext = *ppNext;
+	*ppNext = pTimer;
+	pTimer->Active = 1;
+}
+
+/******************************************************************
+ * @func			SysTick_Remove
+ * @brief			This functions unlinks a timer
+ * @param [in]		Timer
+ * @return			None
+ * @note 			Interrupts masked
+ */
+static void SysTick_Remove(SysTick_Timer_t *pTimer){
+
+	SysTick_Timer_t **ppNext = &pTimers;
+
+	while ((*ppNext != NULL) && (*ppNext != pTimer)){
+		ppNext = &(*ppNext)->pNext;
+	}
+	if (*ppNext != NULL){
+		*ppNext = pTimer->pNext;
+	}
+	pTimer->pNext = NULL;
+	pTimer->Active = 0;
+}
+
+/******************************************************************
+ * @func			SysTick_Restart
+ * @brief			This functions restarts the stopped counter with one period of Load + 1 cycles
+ * @param [in]		Period reload value
+ * @return			None
+ * @note 			Writing CVR makes the counter load RVR at once. The tick reload is written back
+ * 					for the following periods
+ */
+static void SysTick_Restart(uint32_t Load){
+
+	SYSTICK->RVR = Load;
+	SYSTICK->CVR = 0;
+	SYSTICK->CSR |= (1U << SYSTICK_CSR_ENABLE);
+	SYSTICK->RVR = TickCycles - 1;
+}
@@ -0,0 +1,534 @@
+/*
+ * stm32f1xx_usart.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: Daniela
+ */
+
+#include"stm32f1xx_usart.h"
+
+/* 			  Private helpers functions	prototypes    				*/
+static uint32_t USART_GetPCLKValue(USART_RegDef_t *pUSARTx);
+static uint8_t USART_GetDMAChannels(USART_RegDef_t *pUSARTx, uint8_t *pTxChannel, uint8_t *pRxChannel);
+static void USART_RxDeliver(USART_Handle_t *pUSARTHandle, uint8_t FrameEnd);
+static void USART_CloseTx(USART_Handle_t *pUSARTHandle);
+
+/* 					APIs Function Implementation 					*/
+
+/******************************************************************
+ * @func			USART_PeriClkCtrl (USART Peripheral Clock Control)
+ * @brief			This functions enables or disables peripheral clock for the given USART
+ * @param [in]		Base Address of the USART Peripheral
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			None
+ */
+void USART_PeriClkCtrl(USART_RegDef_t *pUSARTx, uint8_t EnOrDi){
+
+	// The RCC bit of the USART is taken from the peripheral table
+	RCC_PeriClkCtrl(pUSARTx, EnOrDi);
+}
+
+/******************************************************************
+ * @func			USART_Init (USART Initialization)
+ * @brief			This functions initializes a given USART and enables it
+ * @param [in]		USART Handle
+ * @return			None
+ * @note 			The baud rate divider is calculated from the cached bus clock. Call USART_Init
+ * 					again after changing the clock tree
+ */
+void USART_Init(USART_Handle_t *pUSARTHandle){
+
+	USART_RegDef_t *pUSARTx = pUSARTHandle->pUSARTx;
+	USART_Config_t *pConfig = &pUSARTHandle->USART_Config;
+	uint32_t temp = 0;
+
+	// Enable clock
+	USART_PeriClkCtrl(pUSARTx, ENABLE);
+
+	// Configuration of the transfer directions
+	if (pConfig->USART_Mode & USART_MODE_TX){
+		temp |= (1 << USART_CR1_TE);
+	}
+	if (pConfig->USART_Mode & USART_MODE_RX){
+		temp |= (1 << USART_CR1_RE);
+	}
+
+	// Configuration of the word length and the parity
+	temp |= (pConfig->USART_WordLength << USART_CR1_M);
+	if (pConfig->USART_Parity == USART_PARITY_EVEN){
+		temp |= (1 << USART_CR1_PCE);
+	} else if (pConfig->USART_Parity == USART_PARITY_ODD){
+		temp |= (1 << USART_CR1_PCE) | (1 << USART_CR1_PS);
+	}
+	pUSARTx->CR1 = temp; // UE = 0 until the rest is configured
+
+	// Configuration of the stop bits
+	pUSARTx->CR2 = (pConfig->USART_StopBits << USART_CR2_STOP);
+
+	// Configuration of the hardware flow control
+	temp = 0;
+	if (pConfig->USART_HWFlowControl & USART_HW_FLOW_CTRL_CTS){
+		temp |= (1 << USART_CR3_CTSE);
+	}
+	if (pConfig->USART_HWFlowControl & USART_HW_FLOW_CTRL_RTS){
+		temp |= (1 << USART_CR3_RTSE);
+	}
+	pUSARTx->CR3 = temp;
+
+	// Configuration of the baud rate
+	pUSARTx->BRR = USART_CalcBRR(pUSARTx, pConfig->USART_Baud, NULL);
+
+	pUSARTHandle->TxState = USART_READY;
+	pUSARTHandle->RxState = USART_READY;
+
+	pUSARTx->CR1 |= (1 << USART_CR1_UE);
+}
+
+/******************************************************************
+ * @func			USART_DeInit (USART De-initialization)
+ * @brief			This functions resets all the registers of a given USART
+ * @param [in]		Base Address of the USART
+ * @return			None
+ * @note 			None
+ */
+void USART_DeInit(USART_RegDef_t *pUSARTx){
+
+	RCC_PeriReset(pUSARTx);
+}
+
+/******************************************************************
+ * @func			USART_CalcBRR (USART calculate baud rate register)
+ * @brief			This functions calculates the BRR value of a baud rate
+ * @param [in]		Base Address of the USART
+ * @param [in]		Baud rate in bits per second
+ * @param [out]		Achieved baud rate. Can be NULL
+ * @return			BRR value
+ * @note 			Oversampling by 16: USARTDIV = PCLK / (16 x Baud) and BRR holds USARTDIV with a 4-bit
+ * 					fraction, so BRR = PCLK / Baud (rounded). Rates above PCLK/16 are capped to it.
+ * 					The receiver tolerates about 3% of error: check the achieved rate
+ */
+uint16_t USART_CalcBRR(USART_RegDef_t *pUSARTx, uint32_t Baud, uint32_t *pBaud){
+
+	uint32_t pclk = USART_GetPCLKValue(pUSARTx);
+	uint32_t brr = 0xFFFF;
+
+	if (Baud != 0){
+		brr = (pclk + Baud / 2) / Baud;
+	}
+
+	if (brr < USART_BRR_MIN){
+		brr = USART_BRR_MIN;
+	} else if (brr > 0xFFFF){
+		brr = 0xFFFF;
+	}
+
+	if (pBaud != NULL){
+		*pBaud = (pclk + brr / 2) / brr;
+	}
+
+	return (uint16_t)brr;
+}
+
+/******************************************************************
+ * @func			USART_GetBaudValue (USART get baud rate value)
+ * @brief			This functions calculates the baud rate programmed in BRR
+ * @param [in]		Base Address of the USART
+ * @return			Baud rate in bits per second. 0 if BRR is not programmed
+ * @note 			Uses the cached bus clock
+ */
+uint32_t USART_GetBaudValue(USART_RegDef_t *pUSARTx){
+
+	uint32_t brr = pUSARTx->BRR & 0xFFFF;
+
+	if (brr == 0){
+		return 0;
+	}
+
+	return (USART_GetPCLKValue(pUSARTx) + brr / 2) / brr;
+}
+
+/******************************************************************
+ * @func			USART_SendDMA (USART send data using DMA)
+ * @brief			This functions starts a transmission served by the DMA1 Tx channel
+ * @param [in]		USART Handle
+ * @param [in]		Buffer with the data that is going to be sent
+ * @param [in]		Length of the buffer in bytes (1-65535)
+ * @return			State before the call. USART_READY means the transmission has started
+ * @note 			None blocking API. The buffer must not change until USART_EVENT_TX_COMPLETE.
+ * 					The DMA transfer complete interrupt enables TC, and the TC interrupt (last stop
+ * 					bit sent) ends the transmission: call USART_DMA_IRQHandling from the Tx channel
+ * 					IRQ handler and USART_IRQHandling from the USART one
+ */
+uint8_t USART_SendDMA(USART_Handle_t *pUSARTHandle, const uint8_t *pTxBuffer, uint32_t len){
+
+	USART_RegDef_t *pUSARTx = pUSARTHandle->pUSARTx;
+	DMA_Handle_t DMATx;
+	uint8_t rx;
+
+	if (pUSARTHandle->TxState != USART_READY){
+		return pUSARTHandle->TxState;
+	}
+	if ((pTxBuffer == NULL) || (len == 0) || (len > 0xFFFF)){
+		return USART_INVALID;
+	}
+	if (USART_GetDMAChannels(pUSARTx, &pUSARTHandle->DMATxChannel, &rx) != USART_READY){
+		return USART_DMA_NOT_AVAILABLE;
+	}
+
+	pUSARTHandle->TxState = USART_BUSY_IN_TX;
+
+	DMATx.pDMAx = DMA1;
+	DMATx.Channel = pUSARTHandle->DMATxChannel;
+	DMATx.DMA_Config.DMA_Direction = DMA_DIR_MEM_TO_PERI;
+	DMATx.DMA_Config.DMA_PeriSize = DMA_SIZE_8BITS;
+	DMATx.DMA_Config.DMA_MemSize = DMA_SIZE_8BITS;
+	DMATx.DMA_Config.DMA_MemInc = ENABLE;
+	DMATx.DMA_Config.DMA_Priority = DMA_PRIORITY_HIGH;
+	DMATx.DMA_Config.DMA_Mode = DMA_MODE_NORMAL;
+	DMA_Init(&DMATx);
+	DMA_InterruptControl(&DMATx, DMA_TCIF_FLAG | DMA_TEIF_FLAG, ENABLE);
+
+	// TC is still set by the previous transmission (or the reset). It is rc_w0: the other bits ignore the 1s
+	pUSARTx->SR = ~(1U << USART_SR_TC);
+
+	DMA_Start(&DMATx, &pUSARTx->DR, (void*)pTxBuffer, (uint16_t)len);
+	pUSARTx->CR3 |= (1 << USART_CR3_DMAT);
+
+	return USART_READY;
+}
+
+/******************************************************************
+ * @func			USART_StartRxDMA (USART start reception using DMA)
+ * @brief			This functions starts a circular reception served by the DMA1 Rx channel
+ * @param [in]		USART Handle
+ * @param [in]		Circular buffer
+ * @param [in]		Length of the buffer in bytes (2-65535)
+ * @return			State before the call. USART_READY means the reception has started
+ * @note 			The received bytes are delivered to USART_RxDataCallback from the IDLE interrupt
+ * 					(end of a frame) and from the DMA half/complete interrupts (the frame is longer
+ * 					than half the buffer, or it wraps). The buffer must hold the bytes received
+ * 					during the worst interrupt latency. Give the USART and the Rx channel IRQs the
+ * 					same priority: both deliver from the same position
+ */
+uint8_t USART_StartRxDMA(USART_Handle_t *pUSARTHandle, uint8_t *pRxBuffer, uint32_t len){
+
+	USART_RegDef_t *pUSARTx = pUSARTHandle->pUSARTx;
+	DMA_Handle_t DMARx;
+	uint8_t tx;
+
+	if (pUSARTHandle->RxState != USART_READY){
+		return pUSARTHandle->RxState;
+	}
+	if ((pRxBuffer == NULL) || (len < 2) || (len > 0xFFFF)){
+		return USART_INVALID;
+	}
+	if (USART_GetDMAChannels(pUSARTx, &tx, &pUSARTHandle->DMARxChannel) != USART_READY){
+		return USART_DMA_NOT_AVAILABLE;
+	}
+
+	pUSARTHandle->RxState = USART_BUSY_IN_RX;
+	pUSARTHandle->pRxBuffer = pRxBuffer;
+	pUSARTHandle->RxSize = (uint16_t)len;
+	pUSARTHandle->RxPos = 0;
+
+	DMARx.pDMAx = DMA1;
+	DMARx.Channel = pUSARTHandle->DMARxChannel;
+	DMARx.DMA_Config.DMA_Direction = DMA_DIR_PERI_TO_MEM;
+	DMARx.DMA_Config.DMA_PeriSize = DMA_SIZE_8BITS;
+	DMARx.DMA_Config.DMA_MemSize = DMA_SIZE_8BITS;
+	DMARx.DMA_Config.DMA_MemInc = ENABLE;
+	DMARx.DMA_Config.DMA_Priority = DMA_PRIORITY_VERY_HIGH;
+	DMARx.DMA_Config.DMA_Mode = DMA_MODE_CIRCULAR;
+	DMA_Init(&DMARx);
+	DMA_InterruptControl(&DMARx, DMA_TCIF_FLAG | DMA_HTIF_FLAG | DMA_TEIF_FLAG, ENABLE);
+
+	// Old flags would deliver an empty frame: SR read followed by DR read clears IDLE and the errors
+	(void)pUSARTx->SR;
+	(void)pUSARTx->DR;
+
+	DMA_Start(&DMARx, &pUSARTx->DR, pRxBuffer, (uint16_t)len);
+	pUSARTx->CR3 |= (1 << USART_CR3_DMAR) | (1 << USART_CR3_EIE);
+	pUSARTx->CR1 |= (1 << USART_CR1_IDLEIE) | (1 << USART_CR1_PEIE);
+
+	return USART_READY;
+}
+
+/******************************************************************
+ * @func			USART_StopRxDMA (USART stop reception using DMA)
+ * @brief			This functions stops the circular reception
+ * @param [in]		USART Handle
+ * @return			None
+ * @note 			The bytes received since the last delivery are delivered before returning
+ * 					(FrameEnd = 0)
+ */
+void USART_StopRxDMA(USART_Handle_t *pUSARTHandle){
+
+	USART_RegDef_t *pUSARTx = pUSARTHandle->pUSARTx;
+	uint8_t ch = pUSARTHandle->DMARxChannel;
+
+	if (pUSARTHandle->RxState != USART_BUSY_IN_RX){
+		return;
+	}
+
+	pUSARTx->CR1 &= ~((1 << USART_CR1_IDLEIE) | (1 << USART_CR1_PEIE));
+	pUSARTx->CR3 &= ~((1 << USART_CR3_DMAR) | (1 << USART_CR3_EIE));
+	DMA1->CH[ch - 1].CCR &= ~(1 << DMA_CCR_EN); // CNDTR keeps the final position
+
+	USART_RxDeliver(pUSARTHandle, 0);
+
+	DMA_ClearFlag(DMA1, ch, DMA_GIF_FLAG);
+	pUSARTHandle->RxState = USART_READY;
+}
+
+/******************************************************************
+ * @func			USART_IRQConfig (USART IRQ Configuration)
+ * @brief			This functions enables or disables an IRQ in the NVIC
+ * @param [in]		IRQ Number
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			One store to ISER/ICER (no read-modify-write)
+ */
+void USART_IRQConfig(uint8_t IRQNumber, uint8_t EnOrDi){
+
+	NVIC_IRQConfig(IRQNumber, EnOrDi);
+}
+
+/******************************************************************
+ * @func			USART_IRQPriority (USART IRQ Priority)
+ * @brief			This functions sets the priority of an IRQ
+ * @param [in]		IRQ Number
+ * @param [in]		IRQ Priority (0-15). See NVIC_EncodePriority for preempt/sub-priority
+ * @return			None
+ * @note 			The old priority is replaced with one byte store
+ */
+void USART_IRQPriority (uint8_t IRQNumber,uint32_t IRQPriority){
+
+	NVIC_SetPriority(IRQNumber, (uint8_t)IRQPriority);
+}
+
+/******************************************************************
+ * @func			USART_IRQHandling (USART IRQ Handling)
+ * @brief			This functions processes the USART interrupts of the DMA transfers
+ * @param [in]		USART handle
+ * @return			None
+ * @note 			Call it from the USART IRQ handler (e.g. USART2_IRQHandler)
+ */
+void USART_IRQHandling(USART_Handle_t *pUSARTHandle){
+
+	USART_RegDef_t *pUSARTx = pUSARTHandle->pUSARTx;
+	uint32_t sr = pUSARTx->SR;
+	uint32_t cr1 = pUSARTx->CR1;
+
+	// Transmission complete: the last stop bit is out
+	if ((sr & USART_TC_FLAG) && (cr1 & (1 << USART_CR1_TCIE))){
+		pUSARTx->CR1 &= ~(1 << USART_CR1_TCIE);
+		pUSARTHandle->TxState = USART_READY;
+		USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_TX_COMPLETE);
+	}
+
+	if (pUSARTHandle->RxState != USART_BUSY_IN_RX){
+		return;
+	}
+
+	// The error flags and IDLE are cleared by the SR read above followed by a DR read. While RXNE is set
+	// the DMA does that read, so no byte is taken from the Rx channel
+	if ((sr & (USART_ERROR_FLAGS | USART_IDLE_FLAG)) && !(sr & USART_RXNE_FLAG)){
+		(void)pUSARTx->DR;
+	}
+
+	// Check errors. The byte with FE/NE/PE is still transferred by the DMA
+	if (sr & (1 << USART_SR_PE)){
+		USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_ERR_PE);
+	}
+	if (sr & (1 << USART_SR_FE)){
+		USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_ERR_FE);
+	}
+	if (sr & (1 << USART_SR_NE)){
+		USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_ERR_NE);
+	}
+	if (sr & (1 << USART_SR_ORE)){
+		USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_ERR_ORE);
+	}
+
+	// Idle line: end of a frame
+	if (sr & USART_IDLE_FLAG){
+		USART_RxDeliver(pUSARTHandle, 1);
+	}
+}
+
+/******************************************************************
+ * @func			USART_DMA_IRQHandling (USART DMA IRQ Handling)
+ * @brief			This functions processes the interrupts of the DMA channels used by the USART
+ * @param [in]		USART handle
+ * @return			None
+ * @note 			Call it from the IRQ handlers of both channels (e.g. DMA1_Channel7_IRQHandler and
+ * 					DMA1_Channel6_IRQHandler for USART2)
+ */
+void USART_DMA_IRQHandling(USART_Handle_t *pUSARTHandle){
+
+	uint8_t tx = pUSARTHandle->DMATxChannel;
+	uint8_t rx = pUSARTHandle->DMARxChannel;
+
+	if (pUSARTHandle->TxState == USART_BUSY_IN_TX){
+		// Check transfer error. The hardware has already disabled the channel
+		if (DMA_GetFlagStatus(DMA1, tx, DMA_TEIF_FLAG)){
+			USART_CloseTx(pUSARTHandle);
+			USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_DMA_ERROR);
+		} else if (DMA_GetFlagStatus(DMA1, tx, DMA_TCIF_FLAG)){
+			// The last byte is in the shift register. TC ends the transmission
+			DMA1->CH[tx - 1].CCR &= ~(1 << DMA_CCR_EN);
+			DMA_ClearFlag(DMA1, tx, DMA_GIF_FLAG);
+			pUSARTHandle->pUSARTx->CR3 &= ~(1 << USART_CR3_DMAT);
+			pUSARTHandle->pUSARTx->CR1 |= (1 << USART_CR1_TCIE);
+		}
+	}
+
+	if (pUSARTHandle->RxState == USART_BUSY_IN_RX){
+		// Check transfer error
+		if (DMA_GetFlagStatus(DMA1, rx, DMA_TEIF_FLAG)){
+			USART_StopRxDMA(pUSARTHandle);
+			USART_ApplicationEventCallback(pUSARTHandle, USART_EVENT_DMA_ERROR);
+			return;
+		}
+
+		// Half or end of the buffer: deliver so the DMA does not overwrite bytes not seen yet
+		if (DMA_GetFlagStatus(DMA1, rx, DMA_HTIF_FLAG | DMA_TCIF_FLAG)){
+			DMA_ClearFlag(DMA1, rx, DMA_HTIF_FLAG | DMA_TCIF_FLAG);
+			USART_RxDeliver(pUSARTHandle, 0);
+		}
+	}
+}
+
+/******************************************************************
+ * @func			USART_PeripheralControl (USART Peripheral Control)
+ * @brief			This functions enables/disables the USART *after* the parameters initialization
+ * @param [in]		Base Address of the USART Peripheral
+ * @param [in]		Enable/Disable Macros
+ * @return			None
+ * @note 			None
+ */
+void USART_PeripheralControl(USART_RegDef_t *pUSARTx, uint8_t EnOrDi){
+	if (EnOrDi == ENABLE){
+		pUSARTx->CR1 |= (1 << USART_CR1_UE);
+	} else {
+		pUSARTx->CR1 &= ~(1 << USART_CR1_UE);
+	}
+}
+
+/******************************************************************
+ * @func			USART_GetFlagStatus (USART get flag status)
+ * @brief			This functions checks a flag of the status register
+ * @param [in]		Base Address of the USART
+ * @param [in]		Requested flag (USART_xxx_FLAG)
+ * @return			FLAG_SET or FLAG_RESET
+ * @note 			None
+ */
+uint8_t USART_GetFlagStatus(USART_RegDef_t *pUSARTx, uint32_t FlagName){
+
+	if (pUSARTx->SR & FlagName){
+		return FLAG_SET;
+	}
+	return FLAG_RESET;
+}
+
+/* 			  Private helpers functions	implementation 				*/
+
+/******************************************************************
+ * @func			USART_GetPCLKValue
+ * @brief			This functions returns the clock of the bus of a USART
+ * @param [in]		Base Address of the USART
+ * @return			PCLK2 for USART1, PCLK1 for the others
+ * @note 			Cached values of the RCC driver
+ */
+static uint32_t USART_GetPCLKValue(USART_RegDef_t *pUSARTx){
+
+	return (pUSARTx == USART1) ? RCC_GetPCLK2Value() : RCC_GetPCLK1Value();
+}
+
+/******************************************************************
+ * @func			USART_GetDMAChannels
+ * @brief			This functions finds the DMA1 channels of a USART
+ * @param [in]		Base Address of the USART
+ * @param [out]		Tx channel
+ * @param [out]		Rx channel
+ * @return			USART_READY or USART_DMA_NOT_AVAILABLE
+ * @note 			RM0008 Table 78
+ */
+static uint8_t USART_GetDMAChannels(USART_RegDef_t *pUSARTx, uint8_t *pTxChannel, uint8_t *pRxChannel){
+
+	if (pUSARTx == USART1){
+		*pTxChannel = DMA_CH_USART1_TX;
+		*pRxChannel = DMA_CH_USART1_RX;
+	} else if (pUSARTx == USART2){
+		*pTxChannel = DMA_CH_USART2_TX;
+		*pRxChannel = DMA_CH_USART2_RX;
+	} else if (pUSARTx == USART3){
+		*pTxChannel = DMA_CH_USART3_TX;
+		*pRxChannel = DMA_CH_USART3_RX;
+	} else {
+		return USART_DMA_NOT_AVAILABLE;
+	}
+	return USART_READY;
+}
+
+/******************************************************************
+ * @func			USART_RxDeliver
+ * @brief			This functions delivers the bytes written by the Rx channel since the last call
+ * @param [in]		USART handle
+ * @param [in]		1 when called for an idle line
+ * @return			None
+ * @note 			The write position is RxSize - CNDTR. Bytes that wrap around the end of the
+ * 					buffer are delivered in two calls. An idle line with nothing new (the HT/TC
+ * 					interrupts already delivered the frame) gives a call with len = 0
+ */
+static void USART_RxDeliver(USART_Handle_t *pUSARTHandle, uint8_t FrameEnd){
+
+	uint16_t pos = pUSARTHandle->RxSize - (uint16_t)DMA1->CH[pUSARTHandle->DMARxChannel - 1].CNDTR;
+
+	if (pos >= pUSARTHandle->RxSize){
+		pos = 0; // CNDTR read while it was reloaded
+	}
+
+	// Wrapped: first the end of the buffer
+	if (pos < pUSARTHandle->RxPos){
+		USART_RxDataCallback(pUSARTHandle, &pUSARTHandle->pRxBuffer[pUSARTHandle->RxPos],
+							 pUSARTHandle->RxSize - pUSARTHandle->RxPos, FrameEnd && (pos == 0));
+		pUSARTHandle->RxPos = 0;
+		if (pos == 0){
+			return;
+		}
+	}
+
+	if ((pos > pUSARTHandle->RxPos) || FrameEnd){
+		USART_RxDataCallback(pUSARTHandle, &pUSARTHandle->pRxBuffer[pUSARTHandle->RxPos], pos - pUSARTHandle->RxPos, FrameEnd);
+		pUSARTHandle->RxPos = pos;
+	}
+}
+
+/******************************************************************
+ * @func			USART_CloseTx
+ * @brief			This functions ends a DMA transmission
+ * @param [in]		USART handle
+ * @return			None
+ * @note 			None
+ */
+static void USART_CloseTx(USART_Handle_t *pUSARTHandle){
+
+	pUSARTHandle->pUSARTx->CR3 &= ~(1 << USART_CR3_DMAT);
+	pUSARTHandle->pUSARTx->CR1 &= ~(1 << USART_CR1_TCIE);
+	DMA1->CH[pUSARTHandle->DMATxChannel - 1].CCR &= ~(1 << DMA_CCR_EN);
+	DMA_ClearFlag(DMA1, pUSARTHandle->DMATxChannel, DMA_GIF_FLAG);
+	pUSARTHandle->TxState = USART_READY;
+}
+
+/* In each application these functions will be override according to perform some action  */
+__attribute__((weak)) void USART_ApplicationEventCallback (USART_Handle_t *pUSARTHandle, uint8_t AppEv){
+	// This is a weak implementation. The application can override this function
+
+}
+
+__attribute__((weak)) void USART_RxDataCallback (USART_Handle_t *pUSARTHandle, const uint8_t *pData, uint16_t len, uint8_t FrameEnd){
+	// This is a weak implementation. The application can override this function
+
+}